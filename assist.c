@@ -115,6 +115,8 @@ U32     lock;                           /* Lock value                */
 U32     lcpa;                           /* Logical CPU address       */
 VADR    newia;                          /* Unsuccessful branch addr  */
 int     acc_mode = 0;                   /* access mode to use        */
+BYTE   *mlock;                          /* Mainstor address of lock  */
+int     obtained = 0;                   /* 1=Lock obtained           */
 
     SSE(inst, regs, b1, effective_addr1, b2, effective_addr2);
 
@@ -126,9 +128,6 @@ int     acc_mode = 0;                   /* access mode to use        */
 
     PERFORM_SERIALIZATION(regs);
 
-    /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
-
     if (ACCESS_REGISTER_MODE(&regs->psw))
         acc_mode = USE_PRIMARY_SPACE;
 
@@ -148,15 +147,23 @@ int     acc_mode = 0;                   /* access mode to use        */
 
     /* Obtain the local lock if not already held by any CPU */
     if (lock == 0
-        && (hlhi_word & PSALCLLI) == 0)
+        && (hlhi_word & PSALCLLI) == 0
+        && (lock_addr & 0x00000003) == 0)
     {
         /* Store the unchanged value into the second operand to
            ensure suppression in the event of an access exception */
         ARCH_DEP(vstore4) ( hlhi_word, effective_addr2, acc_mode, regs );
 
-        /* Store our logical CPU address in ASCBLOCK */
-        ARCH_DEP(vstore4) ( lcpa, lock_addr, acc_mode, regs );
+        /* Store our logical CPU address in ASCBLOCK if it is still
+           zero, interlocked against CS by other CPUs */
+        mlock = MADDR (lock_addr, acc_mode, regs, ACCTYPE_WRITE, regs->psw.pkey);
+        OBTAIN_MAINLOCK_CAS(regs);
+        obtained = cmpxchg4 (&lock, CSWAP32(lcpa), mlock) == 0;
+        RELEASE_MAINLOCK_CAS(regs);
+    }
 
+    if (obtained)
+    {
         /* Set the local lock held bit in the second operand */
         hlhi_word |= PSALCLLI;
         ARCH_DEP(vstore4) ( hlhi_word, effective_addr2, acc_mode, regs );
@@ -183,9 +190,6 @@ int     acc_mode = 0;                   /* access mode to use        */
         UPD_PSW_IA(regs, newia);
     }
 
-    /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
-
     PERFORM_SERIALIZATION(regs);
 
 } /* end function obtain_local_lock */
@@ -210,6 +214,9 @@ U32     susp;                           /* Lock suspend queue        */
 U32     lcpa;                           /* Logical CPU address       */
 VADR    newia;                          /* Unsuccessful branch addr  */
 int     acc_mode = 0;                   /* access mode to use        */
+BYTE   *mlock;                          /* Mainstor address of lock  */
+U64     old;                            /* Lock and suspend queue    */
+int     released = 0;                   /* 1=Lock released           */
 
     SSE(inst, regs, b1, effective_addr1, b2, effective_addr2);
 
@@ -219,9 +226,6 @@ int     acc_mode = 0;                   /* access mode to use        */
     if ((effective_addr1 & 0x00000003) || (effective_addr2 & 0x00000003))
         ARCH_DEP(program_interrupt) (regs, PGM_SPECIFICATION_EXCEPTION);
 
-    /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
-
     if (ACCESS_REGISTER_MODE(&regs->psw))
         acc_mode = USE_PRIMARY_SPACE;
 
@@ -244,15 +248,25 @@ int     acc_mode = 0;                   /* access mode to use        */
        any CMS lock, and the local lock suspend queue is empty */
     if (lock == lcpa
         && (hlhi_word & (PSALCLLI | PSACMSLI)) == PSALCLLI
-        && susp == 0)
+        && susp == 0
+        && (lock_addr & 0x00000007) == 0)
     {
         /* Store the unchanged value into the second operand to
            ensure suppression in the event of an access exception */
         ARCH_DEP(vstore4) ( hlhi_word, effective_addr2, acc_mode, regs );
 
-        /* Set the local lock to zero */
-        ARCH_DEP(vstore4) ( 0, lock_addr, acc_mode, regs );
+        /* Set the local lock to zero if it is still held by this
+           CPU with an empty suspend queue, interlocked against CDS
+           by other CPUs */
+        mlock = MADDR (lock_addr, acc_mode, regs, ACCTYPE_WRITE, regs->psw.pkey);
+        old = CSWAP64((U64)lcpa << 32);
+        OBTAIN_MAINLOCK_CAS(regs);
+        released = cmpxchg8 (&old, 0, mlock) == 0;
+        RELEASE_MAINLOCK_CAS(regs);
+    }
 
+    if (released)
+    {
         /* Clear the local lock held bit in the second operand */
         hlhi_word &= ~PSALCLLI;
         ARCH_DEP(vstore4) ( hlhi_word, effective_addr2, acc_mode, regs );
@@ -279,9 +293,6 @@ int     acc_mode = 0;                   /* access mode to use        */
         UPD_PSW_IA(regs, newia);
     }
 
-    /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
-
 } /* end function release_local_lock */
 
 
@@ -302,6 +313,8 @@ int     lock_arn;                       /* Lock access register      */
 U32     lock;                           /* Lock value                */
 VADR    newia;                          /* Unsuccessful branch addr  */
 int     acc_mode = 0;                   /* access mode to use        */
+BYTE   *mlock;                          /* Mainstor address of lock  */
+int     obtained = 0;                   /* 1=Lock obtained           */
 
     SSE(inst, regs, b1, effective_addr1, b2, effective_addr2);
 
@@ -317,9 +330,6 @@ int     acc_mode = 0;                   /* access mode to use        */
     lock_addr = regs->GR_L(11) & ADDRESS_MAXWRAP(regs);
     lock_arn = 11;
 
-    /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
-
     if (ACCESS_REGISTER_MODE(&regs->psw))
         acc_mode = USE_PRIMARY_SPACE;
 
@@ -335,15 +345,23 @@ int     acc_mode = 0;                   /* access mode to use        */
     /* Obtain the lock if not held by any ASCB, and if this CPU
        holds the local lock and does not hold a CMS lock */
     if (lock == 0
-        && (hlhi_word & (PSALCLLI | PSACMSLI)) == PSALCLLI)
+        && (hlhi_word & (PSALCLLI | PSACMSLI)) == PSALCLLI
+        && (lock_addr & 0x00000003) == 0)
     {
         /* Store the unchanged value into the second operand to
            ensure suppression in the event of an access exception */
         ARCH_DEP(vstore4) ( hlhi_word, effective_addr2, acc_mode, regs );
 
-        /* Store the ASCB address in the CMS lock */
-        ARCH_DEP(vstore4) ( ascb_addr, lock_addr, acc_mode, regs );
+        /* Store the ASCB address in the CMS lock if it is still
+           zero, interlocked against CS by other CPUs */
+        mlock = MADDR (lock_addr, acc_mode, regs, ACCTYPE_WRITE, regs->psw.pkey);
+        OBTAIN_MAINLOCK_CAS(regs);
+        obtained = cmpxchg4 (&lock, CSWAP32(ascb_addr), mlock) == 0;
+        RELEASE_MAINLOCK_CAS(regs);
+    }
 
+    if (obtained)
+    {
         /* Set the CMS lock held bit in the second operand */
         hlhi_word |= PSACMSLI;
         ARCH_DEP(vstore4) ( hlhi_word, effective_addr2, acc_mode, regs );
@@ -370,9 +388,6 @@ int     acc_mode = 0;                   /* access mode to use        */
         UPD_PSW_IA(regs, newia);
     }
 
-    /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
-
     PERFORM_SERIALIZATION(regs);
 
 } /* end function obtain_cms_lock */
@@ -396,6 +411,9 @@ U32     lock;                           /* Lock value                */
 U32     susp;                           /* Lock suspend queue        */
 VADR    newia;                          /* Unsuccessful branch addr  */
 int     acc_mode = 0;                   /* access mode to use        */
+BYTE   *mlock;                          /* Mainstor address of lock  */
+U64     old;                            /* Lock and suspend queue    */
+int     released = 0;                   /* 1=Lock released           */
 
     SSE(inst, regs, b1, effective_addr1, b2, effective_addr2);
 
@@ -409,9 +427,6 @@ int     acc_mode = 0;                   /* access mode to use        */
     lock_addr = regs->GR_L(11) & ADDRESS_MAXWRAP(regs);
     lock_arn = 11;
 
-    /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
-
     if (ACCESS_REGISTER_MODE(&regs->psw))
         acc_mode = USE_PRIMARY_SPACE;
 
@@ -429,15 +444,25 @@ int     acc_mode = 0;                   /* access mode to use        */
        show a CMS lock is held, and the lock suspend queue is empty */
     if (lock == ascb_addr
         && (hlhi_word & PSACMSLI)
-        && susp == 0)
+        && susp == 0
+        && (lock_addr & 0x00000007) == 0)
     {
         /* Store the unchanged value into the second operand to
            ensure suppression in the event of an access exception */
         ARCH_DEP(vstore4) ( hlhi_word, effective_addr2, acc_mode, regs );
 
-        /* Set the CMS lock to zero */
-        ARCH_DEP(vstore4) ( 0, lock_addr, acc_mode, regs );
+        /* Set the CMS lock to zero if it is still held by this
+           ASCB with an empty suspend queue, interlocked against
+           CDS by other CPUs */
+        mlock = MADDR (lock_addr, acc_mode, regs, ACCTYPE_WRITE, regs->psw.pkey);
+        old = CSWAP64((U64)ascb_addr << 32);
+        OBTAIN_MAINLOCK_CAS(regs);
+        released = cmpxchg8 (&old, 0, mlock) == 0;
+        RELEASE_MAINLOCK_CAS(regs);
+    }
 
+    if (released)
+    {
         /* Clear the CMS lock held bit in the second operand */
         hlhi_word &= ~PSACMSLI;
         ARCH_DEP(vstore4) ( hlhi_word, effective_addr2, acc_mode, regs );
@@ -464,9 +489,6 @@ int     acc_mode = 0;                   /* access mode to use        */
         UPD_PSW_IA(regs, newia);
     }
 
-    /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
-
 } /* end function release_cms_lock */
 
 
@@ -162,6 +162,213 @@ void delayed_exit (int exit_code)
 }
 
 
+#if defined(OPTION_STORAGE_POLICY)
+
+#if !defined(MPOL_BIND)
+  #define MPOL_BIND         2           /* <linux/mempolicy.h>       */
+  #define MPOL_INTERLEAVE   3
+#endif
+
+/*-------------------------------------------------------------------*/
+/* Parse a NUMA node list such as "0-1,3" into a node mask           */
+/*-------------------------------------------------------------------*/
+static int parse_numa_nodes(char *list, U64 *mask)
+{
+char   *p;                              /* -> Character after number */
+unsigned long lo, hi;                   /* Node number range         */
+
+    *mask = 0;
+    for (;;)
+    {
+        lo = hi = strtoul(list, &p, 10);
+        if (p == list)
+            return -1;
+        if (*p == '-')
+        {
+            list = p + 1;
+            hi = strtoul(list, &p, 10);
+            if (p == list)
+                return -1;
+        }
+        if (lo > hi || hi > 63)
+            return -1;
+        for (; lo <= hi; lo++)
+            *mask |= 1ULL << lo;
+        if (*p != ',')
+            break;
+        list = p + 1;
+    }
+    return (*p == '\0' || *p == '\n') ? 0 : -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Format a NUMA node mask as a node list                            */
+/*-------------------------------------------------------------------*/
+static char *format_numa_nodes(U64 mask, char *buf, size_t bufl)
+{
+int     lo, hi;                         /* Node number range         */
+size_t  len = 0;                        /* Length of list so far     */
+
+    buf[0] = '\0';
+    for (lo = 0; lo < 64 && len < bufl; lo = hi + 1)
+    {
+        if (!(mask & (1ULL << lo)))
+        {
+            hi = lo;
+            continue;
+        }
+        for (hi = lo; hi < 63 && (mask & (1ULL << (hi + 1))); hi++);
+        len += snprintf(buf + len, bufl - len, hi > lo ? "%s%d-%d" : "%s%d",
+                        len ? "," : "", lo, hi);
+    }
+    return buf;
+}
+
+/*-------------------------------------------------------------------*/
+/* Host NUMA nodes which have memory                                 */
+/*-------------------------------------------------------------------*/
+static U64 host_numa_nodes(void)
+{
+FILE   *fp;                             /* Sysfs node list file      */
+char    buf[256];                       /* Node list                 */
+U64     mask = 0;                       /* Node mask                 */
+
+    if ((fp = fopen("/sys/devices/system/node/has_memory", "r")) != NULL)
+    {
+        if (fgets(buf, sizeof(buf), fp) == NULL
+         || parse_numa_nodes(buf, &mask) != 0)
+            mask = 0;
+        fclose(fp);
+    }
+    return mask ? mask : 1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Map storage with the HUGEPAGES and NUMAPOLICY backing             */
+/*                                                                   */
+/* The storage is aligned on the backing page size and followed by   */
+/* `slack' bytes of ordinary storage.  Hugetlb pages which cannot be */
+/* obtained fall back to transparent huge pages.  Anonymous mappings */
+/* are zeroed by the host.  Returns NULL if no storage was mapped.   */
+/*-------------------------------------------------------------------*/
+static BYTE *map_storage(char *what, size_t size, size_t slack)
+{
+static char *pagename[] = { "host default", "transparent huge",
+                            "2M huge", "1G huge" };
+BYTE   *res;                            /* -> Reserved address range */
+BYTE   *base;                           /* -> Storage                */
+size_t  total;                          /* Reserved length           */
+size_t  len;                            /* Storage length            */
+size_t  pagesz;                         /* Backing page size         */
+int     storpage;                       /* Backing obtained          */
+int     flags;                          /* Additional mmap flags     */
+int     i;                              /* Node number               */
+char    nodes[128];                     /* NUMA node list            */
+char    numamsg[160];                   /* NUMA placement message    */
+unsigned long nodemask[64 / (8 * sizeof(unsigned long))];
+
+    for (storpage = sysblk.storpage; ; storpage = STORPAGE_THP)
+    {
+        switch (storpage) {
+        case STORPAGE_1G: pagesz = 1024 * 1024 * 1024; break;
+        case STORPAGE_2M:
+        case STORPAGE_THP: pagesz = 2 * 1024 * 1024; break;
+        default: pagesz = 4096;
+        }
+
+        flags = 0;
+        if (storpage == STORPAGE_2M || storpage == STORPAGE_1G)
+        {
+#if defined(MAP_HUGETLB)
+            flags = MAP_HUGETLB;
+ #if defined(MAP_HUGE_SHIFT)
+            flags |= (storpage == STORPAGE_1G ? 30 : 21) << MAP_HUGE_SHIFT;
+ #endif
+#else /*!defined(MAP_HUGETLB)*/
+            logmsg(_("HHCCF089W %s storage: %s pages not supported; "
+                    "using transparent huge pages\n"),
+                    what, pagename[storpage]);
+            continue;
+#endif /*!defined(MAP_HUGETLB)*/
+        }
+
+        /* Reserve an address range in which the storage can be
+           aligned, then map the storage and the slack over it */
+        len = (size + pagesz - 1) & ~(pagesz - 1);
+        total = len + pagesz + slack;
+        res = mmap(NULL, total, PROT_NONE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (res == MAP_FAILED)
+            return NULL;
+        base = (BYTE *)(((uintptr_t)res + pagesz - 1) & ~(uintptr_t)(pagesz - 1));
+
+        if (mmap(base, len, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | flags,
+                 -1, 0) != MAP_FAILED
+         && (slack == 0
+          || mmap(base + len, slack, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                  -1, 0) != MAP_FAILED))
+            break;
+
+        munmap(res, total);
+        if (!flags)
+            return NULL;
+        logmsg(_("HHCCF089W %s storage: cannot obtain %s pages: %s; "
+                "using transparent huge pages\n"),
+                what, pagename[storpage], strerror(errno));
+    }
+
+    /* Release the unused parts of the reserved range */
+    if (base > res)
+        munmap(res, base - res);
+    if (res + total > base + len + slack)
+        munmap(base + len + slack, (res + total) - (base + len + slack));
+
+    if (storpage == STORPAGE_THP)
+    {
+#if defined(MADV_HUGEPAGE)
+        if (madvise(base, len, MADV_HUGEPAGE) != 0)
+#endif /*defined(MADV_HUGEPAGE)*/
+            storpage = STORPAGE_NORMAL;
+    }
+
+    numamsg[0] = '\0';
+    if (sysblk.numapol != NUMAPOL_DEFAULT)
+    {
+        memset(nodemask, 0, sizeof(nodemask));
+        for (i = 0; i < 64; i++)
+            if (sysblk.numanodes & (1ULL << i))
+                nodemask[i / (8 * sizeof(unsigned long))]
+                    |= 1UL << (i % (8 * sizeof(unsigned long)));
+        format_numa_nodes(sysblk.numanodes, nodes, sizeof(nodes));
+
+#if defined(SYS_mbind)
+        if (syscall(SYS_mbind, base, len,
+                    sysblk.numapol == NUMAPOL_BIND ? MPOL_BIND
+                                                   : MPOL_INTERLEAVE,
+                    nodemask, 64 + 1, 0) == 0)
+            snprintf(numamsg, sizeof(numamsg), ", %s node%s %s",
+                     sysblk.numapol == NUMAPOL_BIND ? "bound to"
+                                                    : "interleaved on",
+                     (sysblk.numanodes & (sysblk.numanodes - 1)) ? "s" : "",
+                     nodes);
+        else
+#else /*!defined(SYS_mbind)*/
+        errno = ENOSYS;
+#endif /*!defined(SYS_mbind)*/
+            logmsg(_("HHCCF091W %s storage: NUMA policy for nodes %s "
+                    "not applied: %s\n"),
+                    what, nodes, strerror(errno));
+    }
+
+    logmsg(_("HHCCF092I %s storage: %uMB backed by %s pages%s\n"),
+            what, (unsigned)(size >> 20), pagename[storpage], numamsg);
+
+    return base;
+}
+#endif /*defined(OPTION_STORAGE_POLICY)*/
+
 /* storage configuration routine. To be moved *JJ */
 static void config_storage(unsigned mainsize, unsigned xpndsize)
 {
@@ -169,8 +376,22 @@ int off;
 
     /* Obtain main storage */
     sysblk.mainsize = mainsize * 1024 * 1024ULL;
+    sysblk.mainstor = NULL;
 
-    sysblk.mainstor = calloc((size_t)(sysblk.mainsize + 8192), 1);
+#if defined(OPTION_STORAGE_POLICY)
+    if (sysblk.storpage != STORPAGE_NORMAL
+     || sysblk.numapol != NUMAPOL_DEFAULT)
+    {
+        sysblk.mainstor = map_storage("Main",
+                                      (size_t)sysblk.mainsize, 8192);
+        if (sysblk.mainstor == NULL)
+            logmsg(_("HHCCF094W Main storage: cannot map %dMB: %s; "
+                    "HUGEPAGES and NUMAPOLICY not applied\n"),
+                    mainsize, strerror(errno));
+    }
+#endif /*defined(OPTION_STORAGE_POLICY)*/
+    if (sysblk.mainstor == NULL)
+        sysblk.mainstor = calloc((size_t)(sysblk.mainsize + 8192), 1);
 
     if (sysblk.mainstor != NULL)
         sysblk.main_clear = 1;
@@ -220,7 +441,21 @@ int off;
 
         /* Obtain expanded storage */
         sysblk.xpndsize = xpndsize * (1024*1024 / XSTORE_PAGESIZE);
-        sysblk.xpndstor = calloc(sysblk.xpndsize, XSTORE_PAGESIZE);
+        sysblk.xpndstor = NULL;
+#if defined(OPTION_STORAGE_POLICY)
+        if (sysblk.storpage != STORPAGE_NORMAL
+         || sysblk.numapol != NUMAPOL_DEFAULT)
+        {
+            sysblk.xpndstor = map_storage("Expanded",
+                        (size_t)sysblk.xpndsize * XSTORE_PAGESIZE, 0);
+            if (sysblk.xpndstor == NULL)
+                logmsg(_("HHCCF094W Expanded storage: cannot map %dMB: "
+                        "%s; HUGEPAGES and NUMAPOLICY not applied\n"),
+                        xpndsize, strerror(errno));
+        }
+#endif /*defined(OPTION_STORAGE_POLICY)*/
+        if (sysblk.xpndstor == NULL)
+            sysblk.xpndstor = calloc(sysblk.xpndsize, XSTORE_PAGESIZE);
         if (sysblk.xpndstor)
             sysblk.xpnd_clear = 1;
         else
@@ -694,6 +929,11 @@ int    ecpsvmac;                        /* -> ECPS:VM add'l arg cnt  */
 #if defined(OPTION_SHARED_DEVICES)
 char   *sshrdport;                      /* -> Shared device port nbr */
 #endif /*defined(OPTION_SHARED_DEVICES)*/
+#if defined(OPTION_STORAGE_POLICY)
+char   *shugepages;                     /* -> Storage page backing   */
+char   *snumapol;                       /* -> Storage NUMA policy    */
+char   *snumanodes;                     /* -> Storage NUMA node list */
+#endif /*defined(OPTION_STORAGE_POLICY)*/
 U16     version = 0x00;                 /* CPU version code          */
 int     dfltver = 1;                    /* Default version code      */
 U32     serial;                         /* CPU serial number         */
@@ -813,6 +1053,10 @@ char    pathname[MAX_PATH];             /* file path in host format  */
     initialize_lock (&sysblk.todlock);
     initialize_lock (&sysblk.mainlock);
     sysblk.mainowner = LOCK_OWNER_NONE;
+#if defined(OPTION_PLO_LOCKS)
+    for (i = 0; i < OPTION_PLO_LOCKS; i++)
+        initialize_lock (&sysblk.plolock[i]);
+#endif /*defined(OPTION_PLO_LOCKS)*/
     initialize_lock (&sysblk.intlock);
     initialize_lock (&sysblk.iointqlk);
     sysblk.intowner = LOCK_OWNER_NONE;
@@ -824,6 +1068,19 @@ char    pathname[MAX_PATH];             /* file path in host format  */
         initialize_lock (&sysblk.cpulock[i]);
     initialize_condition (&sysblk.sync_cond);
     initialize_condition (&sysblk.sync_bc_cond);
+#if defined(OPTION_MONOTONIC_TOD)
+    {
+        /* The timer thread waits against the monotonic clock, so
+           that setting the host time of day cannot stretch a wait */
+        pthread_condattr_t timerattr;
+        pthread_condattr_init (&timerattr);
+        pthread_condattr_setclock (&timerattr, CLOCK_MONOTONIC);
+        pthread_cond_init (&sysblk.timercond, &timerattr);
+        pthread_condattr_destroy (&timerattr);
+    }
+#else /*!defined(OPTION_MONOTONIC_TOD)*/
+    initialize_condition (&sysblk.timercond);
+#endif /*!defined(OPTION_MONOTONIC_TOD)*/
 #if defined(OPTION_INSTRUCTION_COUNTING)
     initialize_lock (&sysblk.icount_lock);
 #endif
@@ -847,10 +1104,11 @@ char    pathname[MAX_PATH];             /* file path in host format  */
     );
 #else // !defined(OPTION_FISHIO)
     initialize_lock (&sysblk.ioqlock);
-    initialize_condition (&sysblk.ioqcond);
+    for (i = 0; i < MAX_DEVICE_THREAD_QUEUES; i++)
+        initialize_lock (&sysblk.devtq[i].lock);
     /* Set max number device threads */
     sysblk.devtmax = devtmax;
-    sysblk.devtwait = sysblk.devtnbr =
+    sysblk.devtnext = sysblk.devtnbr =
     sysblk.devthwm  = sysblk.devtunavail = 0;
 #endif // defined(OPTION_FISHIO)
 
@@ -998,6 +1256,11 @@ char    pathname[MAX_PATH];             /* file path in host format  */
 #if defined(OPTION_SHARED_DEVICES)
         sshrdport = NULL;
 #endif /*defined(OPTION_SHARED_DEVICES)*/
+#if defined(OPTION_STORAGE_POLICY)
+        shugepages = NULL;
+        snumapol = NULL;
+        snumanodes = NULL;
+#endif /*defined(OPTION_STORAGE_POLICY)*/
 
         /* Check for old-style CPU statement */
         if (scount == 0 && addargc == 5 && strlen(keyword) == 6
@@ -1029,6 +1292,21 @@ char    pathname[MAX_PATH];             /* file path in host format  */
             {
                 sxpndsize = operand;
             }
+#if defined(OPTION_STORAGE_POLICY)
+            else if (strcasecmp (keyword, "hugepages") == 0)
+            {
+                shugepages = operand;
+            }
+            else if (strcasecmp (keyword, "numapolicy") == 0)
+            {
+                snumapol = operand;
+                if (addargc > 0)
+                {
+                    snumanodes = addargv[0];
+                    addargc--;
+                }
+            }
+#endif /*defined(OPTION_STORAGE_POLICY)*/
             else if (strcasecmp (keyword, "cnslport") == 0)
             {
                 config_cnslport = strdup(operand);
@@ -1214,6 +1492,53 @@ char    pathname[MAX_PATH];             /* file path in host format  */
             }
         }
 
+#if defined(OPTION_STORAGE_POLICY)
+        /* Parse storage page backing operand */
+        if (shugepages != NULL)
+        {
+            if (strcasecmp(shugepages, "no") == 0)
+                sysblk.storpage = STORPAGE_NORMAL;
+            else if (strcasecmp(shugepages, "thp") == 0)
+                sysblk.storpage = STORPAGE_THP;
+            else if (strcasecmp(shugepages, "2m") == 0)
+                sysblk.storpage = STORPAGE_2M;
+            else if (strcasecmp(shugepages, "1g") == 0)
+                sysblk.storpage = STORPAGE_1G;
+            else
+            {
+                logmsg(_("HHCCF087S Error in %s line %d: "
+                        "Invalid HUGEPAGES value %s\n"),
+                        fname, inc_stmtnum[inc_level], shugepages);
+                delayed_exit(1);
+            }
+        }
+
+        /* Parse storage NUMA policy operands */
+        if (snumapol != NULL)
+        {
+            if (strcasecmp(snumapol, "default") == 0 && snumanodes == NULL)
+                sysblk.numapol = NUMAPOL_DEFAULT;
+            else if (strcasecmp(snumapol, "interleave") == 0)
+                sysblk.numapol = NUMAPOL_INTERLEAVE;
+            else if (strcasecmp(snumapol, "bind") == 0)
+                sysblk.numapol = NUMAPOL_BIND;
+            else
+                snumapol = NULL;
+
+            if (snumapol == NULL
+             || (snumanodes != NULL
+              && parse_numa_nodes(snumanodes, &sysblk.numanodes) != 0))
+            {
+                logmsg(_("HHCCF088S Error in %s line %d: "
+                        "Invalid NUMAPOLICY operands\n"),
+                        fname, inc_stmtnum[inc_level]);
+                delayed_exit(1);
+            }
+            if (snumanodes == NULL)
+                sysblk.numanodes = host_numa_nodes();
+        }
+#endif /*defined(OPTION_STORAGE_POLICY)*/
+
         /* Parse Hercules priority operand */
         if (shercprio != NULL)
             if (sscanf(shercprio, "%d%c", &hercprio, &c) != 1)
@@ -1817,6 +2142,10 @@ char    pathname[MAX_PATH];             /* file path in host format  */
 
     /* Start the CPUs */
     OBTAIN_INTLOCK(NULL);
+#if defined(OPTION_CPU_AFFINITY)
+    if (sysblk.cpuaffinity != CPUAFF_NONE)
+        apply_cpu_affinity();
+#endif /*defined(OPTION_CPU_AFFINITY)*/
     for(i = 0; i < numcpu; i++)
         configure_cpu(i);
     RELEASE_INTLOCK(NULL);
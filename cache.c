@@ -80,31 +80,26 @@ int cache_hit_percent (int ix)
 
 int cache_lookup (int ix, U64 key, int *o)
 {
-    int i,p;
+    int i,h,n;
     if (o) *o = -1;
     if (cache_check_ix(ix)) return -1;
-    /* `p' is the preferred index */
-    p = (int)(key % cacheblk[ix].nbr);
-    if (cacheblk[ix].cache[p].key == key) {
-        i = p;
-        cacheblk[ix].fasthits++;
+    /* Probe the hash index */
+    for (h = CACHE_HASH(ix, key), n = 1; (i = cacheblk[ix].hash[h]) != 0; n++) {
+        if (cacheblk[ix].cache[i-1].key == key) break;
+        h = (h + 1) & cacheblk[ix].hashmask;
     }
-    else {
-        if (cache_isbusy(ix, p) || cacheblk[ix].age - cacheblk[ix].cache[p].age < 20)
-            p = -2;
-        for (i = 0; i < cacheblk[ix].nbr; i++) {
-            if (cacheblk[ix].cache[i].key == key) break;
-            if (o && !cache_isbusy(ix, i)
-             && (*o < 0 || i == p || cacheblk[ix].cache[i].age < cacheblk[ix].cache[*o].age))
-                if (*o != p) *o = i;
-        }
-    }
-    if (i >= cacheblk[ix].nbr) {
-        i = -1;
+    cacheblk[ix].probes += n;
+    if (n > cacheblk[ix].maxprobe)
+        cacheblk[ix].maxprobe = n;
+    if (i-- == 0) {
         cacheblk[ix].misses++;
+        if (o) *o = cache_clock(ix);
     }
-    else
+    else {
         cacheblk[ix].hits++;
+        if (n == 1) cacheblk[ix].fasthits++;
+        cacheblk[ix].cache[i].ref = 1;
+    }
 
     if (i < 0 && o && *o < 0) cache_adjust(ix,1);
     else cache_adjust(ix, 0);
@@ -127,8 +122,18 @@ int      answer = -1;                   /* Answer from routine       */
 
 int cache_lock(int ix)
 {
+    struct timeval beg, end;
+
     if (cache_check_cache(ix)) return -1;
-    obtain_lock(&cacheblk[ix].lock);
+    if (try_obtain_lock(&cacheblk[ix].lock)) {
+        /* Lock is busy; time the wait */
+        gettimeofday (&beg, NULL);
+        obtain_lock(&cacheblk[ix].lock);
+        gettimeofday (&end, NULL);
+        cacheblk[ix].lockwaits++;
+        cacheblk[ix].lockwaittime += (end.tv_sec - beg.tv_sec) * 1000000LL
+                                   + (end.tv_usec - beg.tv_usec);
+    }
     return 0;
 }
 
@@ -180,7 +185,9 @@ U64 cache_setkey(int ix, int i, U64 key)
     if (cache_check(ix,i)) return (U64)-1;
     empty = cache_isempty(ix, i);
     oldkey = cacheblk[ix].cache[i].key;
+    cache_hash_del(ix, i);
     cacheblk[ix].cache[i].key = key;
+    cache_hash_add(ix, i);
     if (empty && !cache_isempty(ix, i))
         cacheblk[ix].empty--;
     else if (!empty && cache_isempty(ix, i))
@@ -215,10 +222,14 @@ U32 cache_setflag(int ix, int i, U32 andbits, U32 orbits)
         cacheblk[ix].busy--;
     else if (!busy && cache_isbusy(ix, i))
         cacheblk[ix].busy++;
-    if (empty && !cache_isempty(ix, i))
+    if (empty && !cache_isempty(ix, i)) {
         cacheblk[ix].empty--;
-    else if (!empty && cache_isempty(ix, i))
+        cache_hash_add(ix, i);
+    }
+    else if (!empty && cache_isempty(ix, i)) {
         cacheblk[ix].empty++;
+        cache_hash_del(ix, i);
+    }
     return oldflags;
 }
 
@@ -237,7 +248,11 @@ U64 cache_setage(int ix, int i)
     empty = cache_isempty(ix, i);
     oldage = cacheblk[ix].cache[i].age;
     cacheblk[ix].cache[i].age = ++cacheblk[ix].age;
-    if (empty) cacheblk[ix].empty--;
+    cacheblk[ix].cache[i].ref = 1;
+    if (empty) {
+        cacheblk[ix].empty--;
+        cache_hash_add(ix, i);
+    }
     return oldage;
 }
 
@@ -305,6 +320,7 @@ int cache_release(int ix, int i, int flag)
     buf = cacheblk[ix].cache[i].buf;
     len = cacheblk[ix].cache[i].len;
 
+    cache_hash_del(ix, i);
     memset (&cacheblk[ix].cache[i], 0, sizeof(CACHE));
 
     if ((flag & CACHE_FREEBUF) && buf != NULL) {
@@ -352,6 +368,12 @@ DLL_EXPORT int cache_cmd(int argc, char *argv[], char *cmdline)
                 "fast hits ....... %10" I64_FMT "d\n"
                 "misses .......... %10" I64_FMT "d\n"
                 "hit%% ............ %10d\n"
+                "probes .......... %10" I64_FMT "d\n"
+                "avg probe*100 ... %10d\n"
+                "max probe ....... %10d\n"
+                "clock sweeps .... %10" I64_FMT "d\n"
+                "lock waits ...... %10" I64_FMT "d\n"
+                "lock wait usecs . %10" I64_FMT "d\n"
                 "age ............. %10" I64_FMT "d\n"
                 "last adjusted ... %s"
                 "last wait ....... %s"
@@ -359,7 +381,13 @@ DLL_EXPORT int cache_cmd(int argc, char *argv[], char *cmdline)
           ix, cacheblk[ix].nbr, cacheblk[ix].busy, cache_busy_percent(ix),
           cacheblk[ix].empty, cacheblk[ix].waiters, cacheblk[ix].waits,
           cacheblk[ix].size, cacheblk[ix].hits, cacheblk[ix].fasthits,
-          cacheblk[ix].misses, cache_hit_percent(ix), cacheblk[ix].age,
+          cacheblk[ix].misses, cache_hit_percent(ix), cacheblk[ix].probes,
+          cacheblk[ix].hits + cacheblk[ix].misses == 0 ? 0 :
+            (int)((cacheblk[ix].probes * 100)
+                / (cacheblk[ix].hits + cacheblk[ix].misses)),
+          cacheblk[ix].maxprobe, cacheblk[ix].sweeps,
+          cacheblk[ix].lockwaits, cacheblk[ix].lockwaittime,
+          cacheblk[ix].age,
           ctime(&cacheblk[ix].atime), ctime(&cacheblk[ix].wtime),
           cacheblk[ix].adjusts);
         if (argc > 1)
@@ -377,6 +405,8 @@ DLL_EXPORT int cache_cmd(int argc, char *argv[], char *cmdline)
 /*-------------------------------------------------------------------*/
 static int cache_create (int ix)
 {
+    int n;
+
     cache_destroy (ix);
     cacheblk[ix].magic = CACHE_MAGIC;
 //FIXME See the note in cache.h about CACHE_DEFAULT_L2_NBR
@@ -390,6 +420,16 @@ static int cache_create (int ix)
                 ix, cacheblk[ix].nbr * sizeof(CACHE), strerror(errno));
         return -1;
     }
+    /* Hash index is a power of 2 at least twice the number entries */
+    for (n = 1; n < 2 * cacheblk[ix].nbr; n <<= 1);
+    cacheblk[ix].hashmask = n - 1;
+    cacheblk[ix].hash = calloc (n, sizeof(int));
+    if (cacheblk[ix].hash == NULL) {
+        logmsg (_("HHCCH001E calloc failed cache[%d] size %d: %s\n"),
+                ix, n * sizeof(int), strerror(errno));
+        cache_destroy (ix);
+        return -1;
+    }
     return 0;
 }
 
@@ -404,6 +444,8 @@ static int cache_destroy (int ix)
                 cache_release(ix, i, CACHE_FREEBUF);
             free (cacheblk[ix].cache);
         }
+        if (cacheblk[ix].hash)
+            free (cacheblk[ix].hash);
     }
     memset(&cacheblk[ix], 0, sizeof(CACHEBLK));
     return 0;
@@ -442,6 +484,70 @@ static int cache_isempty(int ix, int i)
          && cacheblk[ix].cache[i].age  == 0);
 }
 
+/*-------------------------------------------------------------------*/
+/* Add an entry to the hash index.  Only entries that are not empty */
+/* are indexed; zero is a valid key.                                 */
+/*-------------------------------------------------------------------*/
+static void cache_hash_add(int ix, int i)
+{
+    int h;
+
+    if (cache_isempty(ix, i)) return;
+    for (h = CACHE_HASH(ix, cacheblk[ix].cache[i].key);
+         cacheblk[ix].hash[h] != 0;
+         h = (h + 1) & cacheblk[ix].hashmask);
+    cacheblk[ix].hash[h] = i + 1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Remove an entry from the hash index.  Later slots in the probe    */
+/* sequence are shifted back into the hole so that no deleted slot   */
+/* markers are needed.                                               */
+/*-------------------------------------------------------------------*/
+static void cache_hash_del(int ix, int i)
+{
+    int h, j, k;
+
+    for (h = CACHE_HASH(ix, cacheblk[ix].cache[i].key);
+         cacheblk[ix].hash[h] != i + 1;
+         h = (h + 1) & cacheblk[ix].hashmask)
+        if (cacheblk[ix].hash[h] == 0) return;
+    for (j = h; ; ) {
+        j = (j + 1) & cacheblk[ix].hashmask;
+        if (cacheblk[ix].hash[j] == 0) break;
+        k = CACHE_HASH(ix, cacheblk[ix].cache[cacheblk[ix].hash[j] - 1].key);
+        /* Leave the slot if its home is cyclically within (h, j] */
+        if (h < j ? (h < k && k <= j) : (h < k || k <= j)) continue;
+        cacheblk[ix].hash[h] = cacheblk[ix].hash[j];
+        h = j;
+    }
+    cacheblk[ix].hash[h] = 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Select an entry to be stolen.  The CLOCK hand passes over busy    */
+/* entries and gives referenced entries a second chance; returns -1  */
+/* if every entry is busy.                                           */
+/*-------------------------------------------------------------------*/
+static int cache_clock(int ix)
+{
+    int i, n;
+
+    for (n = 0; n < 2 * cacheblk[ix].nbr; n++) {
+        i = cacheblk[ix].hand;
+        if (++cacheblk[ix].hand >= cacheblk[ix].nbr)
+            cacheblk[ix].hand = 0;
+        cacheblk[ix].sweeps++;
+        if (cache_isbusy(ix, i)) continue;
+        if (cacheblk[ix].cache[i].ref) {
+            cacheblk[ix].cache[i].ref = 0;
+            continue;
+        }
+        return i;
+    }
+    return -1;
+}
+
 static int cache_adjust(int ix, int n)
 {
 #if 0
@@ -17,6 +17,7 @@
       void     *buf;
       int       value;
       U64       age;
+      int       ref;
     The first 8 bits of the flag indicates if the entry is `busy' or
     not.  If any of the first 8 bits are non-zero then the entry is
     considered `busy' and will not be stolen or otherwise reused.
@@ -120,9 +121,13 @@
     Search functions:
       int         cache_lookup(int ix, U64 key, int *o);
                   Search cache `ix' for entry matching `key'.
-                  If a non-NULL pointer `o' is provided, then the
-                  oldest or preferred cache entry index is returned
-                  that is available to be stolen.
+                  If a non-NULL pointer `o' is provided and the key
+                  is not found, then the index of a cache entry that
+                  is available to be stolen is returned, chosen by
+                  a CLOCK sweep over entries that are not busy.
+                  Lookups use a hash index on the key of each entry
+                  that is not empty, which is maintained as entries
+                  are set and released.
 
       int         cache_scan (int ix, int (rtn)(), void *data);
                   Scan a cache routine entry by entry calling routine
@@ -192,6 +197,8 @@ typedef struct _CACHE {                 /* Cache entry               */
       void     *buf;                    /* Buffer address            */
       int       value;                  /* Arbitrary value           */
       U64       age;                    /* Age                       */
+      int       ref;                    /* 1=Referenced since last
+                                           passed by the CLOCK hand  */
     } CACHE;
 
 /*-------------------------------------------------------------------*/
@@ -206,12 +213,21 @@ typedef struct _CACHEBLK {              /* Cache header              */
       int       waits;                  /* Number times waited       */
       long long size;                   /* Allocated buffer size     */
       long long hits;                   /* Number lookup hits        */
-      long long fasthits;               /* Number fast lookup hits   */
+      long long fasthits;               /* Number hits on 1st probe  */
       long long misses;                 /* Number lookup misses      */
+      long long probes;                 /* Number hash index probes  */
+      int       maxprobe;               /* Longest probe sequence    */
+      long long sweeps;                 /* Entries passed by CLOCK   */
+      long long lockwaits;              /* Number contended locks    */
+      long long lockwaittime;           /* Contended lock wait (usec)*/
       U64       age;                    /* Age counter               */
       LOCK      lock;                   /* Lock                      */
       COND      waitcond;               /* Wait for available entry  */
       CACHE    *cache;                  /* Cache table address       */
+      int      *hash;                   /* Hash index; entry index+1
+                                           or 0 if the slot is free  */
+      int       hashmask;               /* Hash index size - 1       */
+      int       hand;                   /* CLOCK hand entry index    */
       time_t    atime;                  /* Time last adjustment      */
       time_t    wtime;                  /* Time last wait            */
       int       adjusts;                /* Number of adjustments     */
@@ -238,6 +254,10 @@ typedef struct _CACHEBLK {              /* Cache header              */
 
 #define CACHE_WAITTIME             1000 /* Wait time for entry(usec) */
 
+#define CACHE_HASH(_ix, _key) \
+  ((int)((((_key) ^ ((_key) >> 29)) * 0x9E3779B97F4A7C15ULL) >> 32) \
+    & cacheblk[(_ix)].hashmask)
+
 #define CACHE_ADJUST_INTERVAL        15 /* Adjustment interval (sec) */
 #define CACHE_ADJUST_NUMBER         128 /* Uninhibited nbr entries   */
 #define CACHE_ADJUST_BUSY1           70 /* Increase when this busy 1 */
@@ -294,6 +314,9 @@ static int  cache_check(int ix, int i);
 static int  cache_isbusy(int ix, int i);
 static int  cache_isempty(int ix, int i);
 static int  cache_adjust(int ix, int n);
+static void cache_hash_add(int ix, int i);
+static void cache_hash_del(int ix, int i);
+static int  cache_clock(int ix);
 #if 0
 static int  cache_resize (int ix, int n);
 #endif
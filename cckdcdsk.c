@@ -48,6 +48,12 @@ DEVBLK         *dev=&devblk;            /* -> DEVBLK                 */
                            ro = 1;
                        else return syntax ();
                        break;
+            case 'z':  if (strcmp (argv[0], "-zd") != 0 || argc < 2)
+                           return syntax ();
+                       if (cckd_zstd_dict (argv[1]) < 0)
+                           return -1;
+                       argc--; argv++;
+                       break;
             case 'v':  if (argv[0][2] != '\0') return syntax ();
                        display_version
                          (stderr, "Hercules cckd chkdsk program ", FALSE);
@@ -111,7 +117,7 @@ DEVBLK         *dev=&devblk;            /* -> DEVBLK                 */
 /*-------------------------------------------------------------------*/
 int syntax()
 {
-    fprintf (stderr, _("\ncckdcdsk [-v] [-f] [-level] [-ro] file1 [file2 ...]\n"
+    fprintf (stderr, _("\ncckdcdsk [-v] [-f] [-level] [-ro] [-zd dfile] file1 [file2 ...]\n"
                 "\n"
                 "      -v      display version and exit\n"
                 "\n"
@@ -125,6 +131,8 @@ int syntax()
                 "      -4  --  recover everything without using meta-data\n"
                 "\n"
                 "      -ro     open file readonly, no repairs\n"
+                "\n"
+                "      -zd     load zstd dictionary dfile\n"
                 "\n"));
     return -1;
 }
@@ -21,6 +21,8 @@ int             i;                      /* Index                     */
 int             rc;                     /* Return code               */
 int             level=-1;               /* Level for chkdsk          */
 int             force=0;                /* 1=Compress if OPENED set  */
+int             comp=-1;                /* Recompress algorithm      */
+int             parm=-1;                /* Recompress parameter      */
 CCKDDASD_DEVHDR cdevhdr;                /* Compressed CKD device hdr */
 DEVBLK          devblk;                 /* DEVBLK                    */
 DEVBLK         *dev=&devblk;            /* -> DEVBLK                 */
@@ -43,6 +45,32 @@ DEVBLK         *dev=&devblk;            /* -> DEVBLK                 */
             case 'f':  if (argv[0][2] != '\0') return syntax ();
                        force = 1;
                        break;
+            case 'c':  if (argv[0][2] != '\0' || argc < 2) return syntax ();
+                       if (strcasecmp (argv[1], "none") == 0)
+                           comp = CCKD_COMPRESS_NONE;
+                       else if (strcasecmp (argv[1], "zlib") == 0)
+                           comp = CCKD_COMPRESS_ZLIB;
+                       else if (strcasecmp (argv[1], "bzip2") == 0)
+                           comp = CCKD_COMPRESS_BZIP2;
+                       else if (strcasecmp (argv[1], "zstd") == 0)
+                           comp = CCKD_COMPRESS_ZSTD;
+                       else if (strcasecmp (argv[1], "lz4") == 0)
+                           comp = CCKD_COMPRESS_LZ4;
+                       else return syntax ();
+                       argc--; argv++;
+                       break;
+            case 'p':  if (argv[0][2] != '\0' || argc < 2) return syntax ();
+                       parm = atoi (argv[1]);
+                       if (parm < -1 || parm > CCKD_ZSTD_MAXLEVEL)
+                           return syntax ();
+                       argc--; argv++;
+                       break;
+            case 'z':  if (strcmp (argv[0], "-zd") != 0 || argc < 2)
+                           return syntax ();
+                       if (cckd_zstd_dict (argv[1]) < 0)
+                           return -1;
+                       argc--; argv++;
+                       break;
             case 'v':  if (argv[0][2] != '\0') return syntax ();
                        display_version 
                          (stderr, "Hercules cckd compress program ", FALSE);
@@ -101,8 +129,11 @@ DEVBLK         *dev=&devblk;            /* -> DEVBLK                 */
             continue;
         }
     
-        /* call compress */
-        rc = cckd_comp (dev);
+        /* call compress, recompressing the images if requested */
+        if (comp >= 0)
+            rc = cckd_recomp (dev, comp, parm);
+        else
+            rc = cckd_comp (dev);
 
         close (dev->fd);
 
@@ -117,12 +148,18 @@ DEVBLK         *dev=&devblk;            /* -> DEVBLK                 */
 
 int syntax()
 {
-    fprintf (stderr, "\ncckdcomp [-v] [-f] [-level] file1 [file2 ... ]\n"
+    fprintf (stderr, "\ncckdcomp [-v] [-f] [-level] [-c comp [-p parm]] [-zd dfile]\n"
+                "         file1 [file2 ... ]\n"
                 "\n"
                 "          -v      display version and exit\n"
                 "\n"
                 "          -f      force check even if OPENED bit is on\n"
                 "\n"
+                "          -c      recompress the track images using comp\n"
+                "                  (none, zlib, bzip2, zstd or lz4)\n"
+                "          -p      compression parameter (zstd level 1-22)\n"
+                "          -zd     load zstd dictionary dfile\n"
+                "\n"
                 "        chkdsk level is a digit 0 - 3:\n"
                 "          -0  --  minimal checking\n"
                 "          -1  --  normal  checking\n"
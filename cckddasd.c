@@ -14,6 +14,11 @@
 #include "devtype.h"
 #include "opcode.h"
 
+#if defined(HAVE_LINUX_IO_URING_H) \
+ && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+  #define CCKD_URING                    /* io_uring engine available */
+#endif
+
 /*-------------------------------------------------------------------*/
 /* Internal functions                                                */
 /*-------------------------------------------------------------------*/
@@ -29,6 +34,9 @@ int     cckd_close (DEVBLK *dev, int sfx);
 int     cckd_read (DEVBLK *dev, int sfx, off_t off, void *buf, size_t len);
 int     cckd_write (DEVBLK *dev, int sfx, off_t off, void *buf, size_t len);
 int     cckd_ftruncate(DEVBLK *dev, int sfx, off_t off);
+void    cckd_io_error(DEVBLK *dev, int sfx, CCKD_IOREQ *req);
+void    cckd_io_submit(CCKD_IOREQ *req, int n);
+void    cckd_io_term();
 void   *cckd_malloc(DEVBLK *dev, char *id, size_t size);
 void   *cckd_calloc(DEVBLK *dev, char *id, size_t n, size_t size);
 void   *cckd_free(DEVBLK *dev, char *id,void *p);
@@ -43,6 +51,7 @@ int     cfba_write_block(DEVBLK *dev, int blkgrp, int off,
 int     cfba_used(DEVBLK *dev);
 int     cckd_read_trk(DEVBLK *dev, int trk, int ra, BYTE *unitstat);
 void    cckd_readahead(DEVBLK *dev, int trk);
+void    cckd_readahead_trks(DEVBLK *dev, int *trks, int n, int ra);
 int     cckd_readahead_scan(int *answer, int ix, int i, void *data);
 void    cckd_ra();
 void    cckd_flush_cache(DEVBLK *dev);
@@ -52,6 +61,11 @@ void    cckd_purge_cache(DEVBLK *dev);
 int     cckd_purge_cache_scan(int *answer, int ix, int i, void *data);
 void    cckd_writer(void *arg);
 int     cckd_writer_scan(int *o, int ix, int i, void *data);
+int     cckd_writer_batch_scan(int *n, int ix, int i, void *data);
+void    cckd_compress_jobs(CCKD_COMPQ *q);
+void    cckd_compress_dequeue(CCKD_COMPQ *q);
+void    cckd_compress_job(CCKD_COMPJOB *job);
+void    cckd_compressor();
 off_t   cckd_get_space(DEVBLK *dev, int *size, int flags);
 void    cckd_rel_space(DEVBLK *dev, off_t pos, int len, int size);
 void    cckd_flush_space(DEVBLK *dev);
@@ -72,7 +86,9 @@ int     cckd_write_l2(DEVBLK *dev);
 int     cckd_read_l2ent(DEVBLK *dev, CCKD_L2ENT *l2, int trk);
 int     cckd_write_l2ent(DEVBLK *dev,   CCKD_L2ENT *l2, int trk);
 int     cckd_read_trkimg(DEVBLK *dev, BYTE *buf, int trk, BYTE *unitstat);
+int     cckd_read_trkimgs(DEVBLK *dev, CCKD_TRKIO *t, int n);
 int     cckd_write_trkimg(DEVBLK *dev, BYTE *buf, int len, int trk, int flags);
+int     cckd_write_trkimgs(DEVBLK *dev, CCKD_TRKIO *t, int n, int flags);
 int     cckd_harden(DEVBLK *dev);
 int     cckd_trklen(DEVBLK *dev, BYTE *buf);
 int     cckd_null_trk(DEVBLK *dev, BYTE *buf, int trk, int nullfmt);
@@ -97,10 +113,17 @@ DEVBLK *cckd_find_device_by_devnum (U16 devnum);
 BYTE   *cckd_uncompress(DEVBLK *dev, BYTE *from, int len, int maxlen, int trk);
 int     cckd_uncompress_zlib(DEVBLK *dev, BYTE *to, BYTE *from, int len, int maxlen);
 int     cckd_uncompress_bzip2(DEVBLK *dev, BYTE *to, BYTE *from, int len, int maxlen);
-int     cckd_compress(DEVBLK *dev, BYTE **to, BYTE *from, int len, int comp, int parm);
+int     cckd_uncompress_zstd(DEVBLK *dev, BYTE *to, BYTE *from, int len, int maxlen);
+int     cckd_uncompress_lz4(DEVBLK *dev, BYTE *to, BYTE *from, int len, int maxlen);
+DLL_EXPORT int cckd_uncompress_trkimg(DEVBLK *dev, BYTE *to, BYTE *from, int len, int maxlen);
+DLL_EXPORT int cckd_compress(DEVBLK *dev, BYTE **to, BYTE *from, int len, int comp, int parm);
 int     cckd_compress_none(DEVBLK *dev, BYTE **to, BYTE *from, int len, int parm);
 int     cckd_compress_zlib(DEVBLK *dev, BYTE **to, BYTE *from, int len, int parm);
 int     cckd_compress_bzip2(DEVBLK *dev, BYTE **to, BYTE *from, int len, int parm);
+int     cckd_compress_zstd(DEVBLK *dev, BYTE **to, BYTE *from, int len, int parm);
+int     cckd_compress_lz4(DEVBLK *dev, BYTE **to, BYTE *from, int len, int parm);
+DLL_EXPORT int cckd_zstd_dict(char *fn);
+void    cckd_zstd_term();
 void    cckd_command_help();
 void    cckd_command_opts();
 void    cckd_command_stats();
@@ -145,6 +168,9 @@ void    cckd_trace(DEVBLK *dev, char *msg, ...);
 /*-------------------------------------------------------------------*/
 static  CCKD_L2ENT empty_l2[CKDDASD_NULLTRK_FMTMAX+1][256];
 static  BYTE eighthexFF[] = {0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff};
+static  char *compname[CCKD_COMPRESS_MASK+1] = {
+        "none", "zlib", "bzip2", "?",  "zstd", "?", "?", "?",
+        "lz4",  "?",    "?",     "?",  "?",    "?", "?", "?" };
 DEVHND  cckddasd_device_hndinfo;
 DEVHND  cfbadasd_device_hndinfo;
 DLL_EXPORT CCKDBLK cckdblk;                        /* cckd global area          */
@@ -171,9 +197,12 @@ int             i, j;                   /* Loop indexes              */
     initialize_lock (&cckdblk.ralock);
     initialize_lock (&cckdblk.wrlock);
     initialize_lock (&cckdblk.devlock);
+    initialize_lock (&cckdblk.ioelock);
+    initialize_lock (&cckdblk.cplock);
     initialize_condition (&cckdblk.gccond);
     initialize_condition (&cckdblk.racond);
     initialize_condition (&cckdblk.wrcond);
+    initialize_condition (&cckdblk.cpcond);
     initialize_condition (&cckdblk.devcond);
     initialize_condition (&cckdblk.termcond);
 
@@ -182,16 +211,24 @@ int             i, j;                   /* Loop indexes              */
     cckdblk.ranbr      = CCKD_DEFAULT_RA_SIZE;
     cckdblk.ramax      = CCKD_DEFAULT_RA;
     cckdblk.wrmax      = CCKD_DEFAULT_WRITER;
+    cckdblk.cpmax      = CCKD_DEFAULT_COMPRESS;
     cckdblk.gcmax      = CCKD_DEFAULT_GCOL;
     cckdblk.gcwait     = CCKD_DEFAULT_GCOLWAIT;
     cckdblk.gcparm     = CCKD_DEFAULT_GCOLPARM;
     cckdblk.readaheads = CCKD_DEFAULT_READAHEADS;
     cckdblk.freepend   = CCKD_DEFAULT_FREEPEND;
+    cckdblk.ioengine   = CCKD_IO_SYNC;
 #ifdef HAVE_LIBZ
     cckdblk.comps     |= CCKD_COMPRESS_ZLIB;
 #endif
 #ifdef CCKD_BZIP2
     cckdblk.comps     |= CCKD_COMPRESS_BZIP2;
+#endif
+#ifdef CCKD_ZSTD
+    cckdblk.comps     |= CCKD_COMPRESS_ZSTD;
+#endif
+#ifdef CCKD_LZ4
+    cckdblk.comps     |= CCKD_COMPRESS_LZ4;
 #endif
     cckdblk.comp       = 0xff;
     cckdblk.compparm   = -1;
@@ -249,6 +286,22 @@ int cckddasd_term ()
     }
     release_lock (&cckdblk.wrlock);
 
+    /* Terminate the compression threads */
+    obtain_lock (&cckdblk.cplock);
+    cckdblk.cpmax = 0;
+    if (cckdblk.cps)
+    {
+        broadcast_condition (&cckdblk.cpcond);
+        wait_condition (&cckdblk.termcond, &cckdblk.cplock);
+    }
+    release_lock (&cckdblk.cplock);
+
+    /* Release the i/o engine rings */
+    cckd_io_term ();
+
+    /* Release the zstd dictionary */
+    cckd_zstd_term ();
+
     memset(&cckdblk, 0, sizeof(CCKDBLK));
 
     return 0;
@@ -624,38 +677,27 @@ int             rc = 0;                 /* Return code               */
 int cckd_read (DEVBLK *dev, int sfx, off_t off, void *buf, size_t len)
 {
 CCKDDASD_EXT   *cckd;                   /* -> cckd extension         */
-int             rc;                     /* Return code               */
+CCKD_IOREQ      req;                    /* I/O engine request        */
 
     cckd = dev->cckd_ext;
 
     cckd_trace (dev, "file[%d] fd[%d] read, off 0x%" I64_FMT "x len %ld\n",
                 sfx, cckd->fd[sfx], (long long)off, (long)len);
 
-    /* Seek to specified offset */
-    if (lseek (cckd->fd[sfx], off, SEEK_SET) < 0)
-    {
-        logmsg (_("HHCCD130E %4.4X file[%d] lseek error, offset 0x%" I64_FMT "x: %s\n"),
-                dev->devnum, sfx, (long long)off, strerror(errno));
-        cckd_print_itrace ();
-        return -1;
-    }
-
     /* Read the data */
-    rc = read (cckd->fd[sfx], buf, len);
-    if (rc < (int)len)
-    {
-        if (rc < 0)
-            logmsg (_("HHCCD130E %4.4X file[%d] read error, offset 0x%" I64_FMT "x: %s\n"),
-                    dev->devnum, sfx, (long long)off, strerror(errno));
-        else
-            logmsg (_("HHCCD130E %4.4X file[%d] read incomplete, offset 0x%" I64_FMT "x: "
-                      "read %d expected %d\n"),
-                    dev->devnum, sfx, (long long)off, rc, len);
-        cckd_print_itrace ();
+    req.fd = cckd->fd[sfx];
+    req.write = 0;
+    req.off = off;
+    req.buf = buf;
+    req.len = len;
+    cckd_io_submit (&req, 1);
+    if (req.rc < (int)len)
+    {
+        cckd_io_error (dev, sfx, &req);
         return -1;
     }
 
-    return rc;
+    return req.rc;
 
 } /* end function cckd_read */
 
@@ -665,39 +707,397 @@ int             rc;                     /* Return code               */
 int cckd_write (DEVBLK *dev, int sfx, off_t off, void *buf, size_t len)
 {
 CCKDDASD_EXT   *cckd;                   /* -> cckd extension         */
-int             rc = 0;                 /* Return code               */
+CCKD_IOREQ      req;                    /* I/O engine request        */
 
     cckd = dev->cckd_ext;
 
     cckd_trace (dev, "file[%d] fd[%d] write, off 0x%" I64_FMT "x len %ld\n",
                 sfx, cckd->fd[sfx], (long long)off, (long)len);
 
-    /* Seek to specified offset */
-    if (lseek (cckd->fd[sfx], off, SEEK_SET) < 0)
-    {
-        logmsg (_("HHCCD130E %4.4X file[%d] lseek error, offset 0x%" I64_FMT "x: %s\n"),
-                dev->devnum, sfx, (long long)off, strerror(errno));
+    /* Write the data */
+    req.fd = cckd->fd[sfx];
+    req.write = 1;
+    req.off = off;
+    req.buf = buf;
+    req.len = len;
+    cckd_io_submit (&req, 1);
+    if (req.rc < (int)len)
+    {
+        cckd_io_error (dev, sfx, &req);
         return -1;
     }
 
-    /* Write the data */
-    rc = write (cckd->fd[sfx], buf, len);
-    if (rc < (int)len)
+    return req.rc;
+
+} /* end function cckd_write */
+
+/*-------------------------------------------------------------------*/
+/* Report a failed or incomplete i/o engine request                  */
+/*-------------------------------------------------------------------*/
+void cckd_io_error (DEVBLK *dev, int sfx, CCKD_IOREQ *req)
+{
+    if (req->rc < 0)
+        logmsg (_("HHCCD130E %4.4X file[%d] %s error, offset 0x%" I64_FMT "x: %s\n"),
+                dev->devnum, sfx, req->write ? "write" : "read",
+                (long long)req->off, strerror(req->err));
+    else
+        logmsg (_("HHCCD130E %4.4X file[%d] %s incomplete, offset 0x%" I64_FMT "x: "
+                  "%s %d expected %d\n"),
+                dev->devnum, sfx, req->write ? "write" : "read",
+                (long long)req->off, req->write ? "wrote" : "read",
+                req->rc, (int)req->len);
+    cckd_print_itrace ();
+
+} /* end function cckd_io_error */
+
+/*-------------------------------------------------------------------*/
+/* I/O engine                                                        */
+/*                                                                   */
+/* All cckd file i/o is passed to cckd_io_submit as an array of      */
+/* requests.  Single requests are always done synchronously with     */
+/* pread/pwrite.  When the io_uring engine is selected, a batch of   */
+/* requests (readahead tracks, writer flushes) is placed on a ring   */
+/* and submitted with one io_uring_enter call that also waits for    */
+/* the completions, so the reads of several track images can be      */
+/* outstanding against a file at the same time.  A ring is owned by  */
+/* one thread for the duration of a submit; rings are created as     */
+/* needed up to CCKD_MAX_RINGS.  If a ring cannot be created the     */
+/* engine reverts to pread/pwrite.                                   */
+/*-------------------------------------------------------------------*/
+#if defined(CCKD_URING)
+
+#define CCKD_MAX_RINGS  (CCKD_MAX_RA + CCKD_MAX_WRITER)
+
+typedef struct _CCKD_RING {             /* io_uring instance         */
+        int              fd;            /* Ring file descriptor      */
+        int              busy;          /* 1=Ring in use             */
+        unsigned int     entries;       /* Number of sq entries      */
+        void            *sqmap;         /* Submission ring mapping   */
+        size_t           sqmaplen;      /* Submission ring map size  */
+        void            *cqmap;         /* Completion ring mapping   */
+        size_t           cqmaplen;      /* Completion ring map size  */
+        struct io_uring_sqe *sqes;      /* Submission queue entries  */
+        size_t           sqeslen;       /* Submission entries size   */
+        unsigned int    *sqhead;        /* -> Submission ring head   */
+        unsigned int    *sqtail;        /* -> Submission ring tail   */
+        unsigned int    *sqmask;        /* -> Submission ring mask   */
+        unsigned int    *sqarray;       /* -> Submission index array */
+        unsigned int    *cqhead;        /* -> Completion ring head   */
+        unsigned int    *cqtail;        /* -> Completion ring tail   */
+        unsigned int    *cqmask;        /* -> Completion ring mask   */
+        struct io_uring_cqe *cqes;      /* Completion queue entries  */
+} CCKD_RING;
+
+static CCKD_RING cckd_ring[CCKD_MAX_RINGS];
+static int       cckd_rings;            /* Number rings created      */
+
+/*-------------------------------------------------------------------*/
+/* Create an io_uring                                                */
+/*-------------------------------------------------------------------*/
+static int cckd_ring_create (CCKD_RING *ring)
+{
+struct io_uring_params p;               /* Ring parameters           */
+BYTE           *sq, *cq;                /* Ring mappings             */
+
+    memset (ring, 0, sizeof(CCKD_RING));
+    memset (&p, 0, sizeof(p));
+
+    ring->fd = syscall (__NR_io_uring_setup, CCKD_MAX_IOBATCH, &p);
+    if (ring->fd < 0)
+        return -1;
+
+    ring->entries  = p.sq_entries;
+    ring->sqmaplen = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+    ring->cqmaplen = p.cq_off.cqes
+                   + p.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqeslen  = p.sq_entries * sizeof(struct io_uring_sqe);
+
+#if defined(IORING_FEAT_SINGLE_MMAP)
+    /* Both rings are in one mapping on newer kernels */
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
     {
+        if (ring->cqmaplen > ring->sqmaplen)
+            ring->sqmaplen = ring->cqmaplen;
+        ring->cqmaplen = 0;
+    }
+#endif
+
+    ring->sqmap = mmap (NULL, ring->sqmaplen, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sqmap == MAP_FAILED)
+        goto cckd_ring_create_error;
+
+    if (ring->cqmaplen)
+    {
+        ring->cqmap = mmap (NULL, ring->cqmaplen, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cqmap == MAP_FAILED)
+        {
+            ring->cqmap = NULL;
+            goto cckd_ring_create_error;
+        }
+    }
+    else
+        ring->cqmap = ring->sqmap;
+
+    ring->sqes = mmap (NULL, ring->sqeslen, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED)
+    {
+        ring->sqes = NULL;
+        goto cckd_ring_create_error;
+    }
+
+    sq = ring->sqmap;
+    cq = ring->cqmap;
+    ring->sqhead  = (unsigned int *)(sq + p.sq_off.head);
+    ring->sqtail  = (unsigned int *)(sq + p.sq_off.tail);
+    ring->sqmask  = (unsigned int *)(sq + p.sq_off.ring_mask);
+    ring->sqarray = (unsigned int *)(sq + p.sq_off.array);
+    ring->cqhead  = (unsigned int *)(cq + p.cq_off.head);
+    ring->cqtail  = (unsigned int *)(cq + p.cq_off.tail);
+    ring->cqmask  = (unsigned int *)(cq + p.cq_off.ring_mask);
+    ring->cqes    = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    return 0;
+
+cckd_ring_create_error:
+
+    if (ring->sqmap && ring->sqmap != MAP_FAILED)
+        munmap (ring->sqmap, ring->sqmaplen);
+    if (ring->cqmap && ring->cqmaplen)
+        munmap (ring->cqmap, ring->cqmaplen);
+    close (ring->fd);
+    memset (ring, 0, sizeof(CCKD_RING));
+    ring->fd = -1;
+    return -1;
+
+} /* end function cckd_ring_create */
+
+/*-------------------------------------------------------------------*/
+/* Destroy an io_uring                                               */
+/*-------------------------------------------------------------------*/
+static void cckd_ring_destroy (CCKD_RING *ring)
+{
+    munmap (ring->sqes, ring->sqeslen);
+    if (ring->cqmaplen)
+        munmap (ring->cqmap, ring->cqmaplen);
+    munmap (ring->sqmap, ring->sqmaplen);
+    close (ring->fd);
+    memset (ring, 0, sizeof(CCKD_RING));
+    ring->fd = -1;
+
+} /* end function cckd_ring_destroy */
+
+/*-------------------------------------------------------------------*/
+/* Obtain an idle ring, creating one if necessary                    */
+/*                                                                   */
+/* Caller holds cckdblk.ioelock                                      */
+/*-------------------------------------------------------------------*/
+static CCKD_RING *cckd_ring_get ()
+{
+int             i;                      /* Ring index                */
+
+    for (i = 0; i < cckd_rings; i++)
+        if (!cckd_ring[i].busy)
+        {
+            cckd_ring[i].busy = 1;
+            return &cckd_ring[i];
+        }
+
+    if (cckd_rings >= CCKD_MAX_RINGS)
+        return NULL;
+
+    if (cckd_ring_create (&cckd_ring[cckd_rings]) < 0)
+    {
+        logmsg (_("HHCCD219W io_uring setup failed: %s; "
+                  "using synchronous i/o\n"), strerror(errno));
+        cckdblk.ioengine = CCKD_IO_SYNC;
+        return NULL;
+    }
+
+    cckd_ring[cckd_rings].busy = 1;
+    return &cckd_ring[cckd_rings++];
+
+} /* end function cckd_ring_get */
+
+/*-------------------------------------------------------------------*/
+/* Submit requests to a ring and wait for them to complete           */
+/*                                                                   */
+/* Returns the number of requests submitted.  Requests the kernel    */
+/* refused are left for the caller to perform synchronously.         */
+/*-------------------------------------------------------------------*/
+static int cckd_ring_submit (CCKD_RING *ring, CCKD_IOREQ *req, int n)
+{
+struct iovec    iov[CCKD_MAX_IOBATCH];  /* I/O vectors               */
+struct io_uring_sqe *sqe;               /* -> Submission entry       */
+struct io_uring_cqe *cqe;               /* -> Completion entry       */
+unsigned int    tail, head, idx;        /* Ring indexes              */
+int             submitted = 0;          /* Requests submitted        */
+int             done = 0;               /* Requests completed        */
+int             i, rc;                  /* Index, return code        */
+
+    if (n > (int)ring->entries)
+        n = ring->entries;
+
+    /* Fill the submission queue */
+    tail = *ring->sqtail;
+    for (i = 0; i < n; i++)
+    {
+        iov[i].iov_base = req[i].buf;
+        iov[i].iov_len = req[i].len;
+        idx = tail & *ring->sqmask;
+        sqe = &ring->sqes[idx];
+        memset (sqe, 0, sizeof(struct io_uring_sqe));
+        sqe->opcode = req[i].write ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe->fd = req[i].fd;
+        sqe->off = (U64)req[i].off;
+        sqe->addr = (U64)(uintptr_t)&iov[i];
+        sqe->len = 1;
+        sqe->user_data = i;
+        ring->sqarray[idx] = idx;
+        tail++;
+    }
+    __sync_synchronize ();
+    *ring->sqtail = tail;
+    __sync_synchronize ();
+
+    /* Submit and reap until every submitted request completes */
+    while (done < n)
+    {
+        rc = syscall (__NR_io_uring_enter, ring->fd, n - submitted,
+                      n - done, IORING_ENTER_GETEVENTS, NULL, 0);
         if (rc < 0)
-            logmsg (_("HHCCD130E %4.4X file[%d] write error, offset 0x%" I64_FMT "x: %s\n"),
-                    dev->devnum, sfx, (long long)off, strerror(errno));
+        {
+            if (errno == EINTR)
+                continue;
+            /* Withdraw the requests the kernel has not consumed */
+            if (submitted < n)
+            {
+                *ring->sqtail = *ring->sqhead;
+                __sync_synchronize ();
+                n = submitted;
+            }
+            if (done >= n)
+                break;
+            continue;
+        }
+        submitted += rc;
+
+        head = *ring->cqhead;
+        __sync_synchronize ();
+        while (head != *ring->cqtail)
+        {
+            cqe = &ring->cqes[head & *ring->cqmask];
+            i = (int)cqe->user_data;
+            if (cqe->res < 0)
+            {
+                req[i].rc = -1;
+                req[i].err = -cqe->res;
+            }
+            else
+                req[i].rc = cqe->res;
+            done++;
+            head++;
+        }
+        __sync_synchronize ();
+        *ring->cqhead = head;
+    }
+
+    return n;
+
+} /* end function cckd_ring_submit */
+#endif /* defined(CCKD_URING) */
+
+/*-------------------------------------------------------------------*/
+/* Perform a request with pread/pwrite                               */
+/*-------------------------------------------------------------------*/
+static void cckd_io_sync (CCKD_IOREQ *req)
+{
+#if defined(_MSVC_)
+    if (lseek (req->fd, req->off, SEEK_SET) < 0)
+        req->rc = -1;
+    else if (req->write)
+        req->rc = write (req->fd, req->buf, req->len);
+    else
+        req->rc = read (req->fd, req->buf, req->len);
+#else
+    do {
+        if (req->write)
+            req->rc = pwrite (req->fd, req->buf, req->len, req->off);
         else
-            logmsg (_("HHCCD130E %4.4X file[%d] write incomplete, offset 0x%" I64_FMT "x: "
-                      "wrote %d expected %d\n"),
-                    dev->devnum, sfx, (long long)off, rc, len);
-        cckd_print_itrace ();
-        return -1;
+            req->rc = pread (req->fd, req->buf, req->len, req->off);
+    } while (req->rc < 0 && errno == EINTR);
+#endif
+    req->err = req->rc < 0 ? errno : 0;
+
+} /* end function cckd_io_sync */
+
+/*-------------------------------------------------------------------*/
+/* Submit i/o requests and wait for their completion                 */
+/*                                                                   */
+/* On return req[i].rc is the number of bytes transferred or -1      */
+/* with the error number in req[i].err                               */
+/*-------------------------------------------------------------------*/
+void cckd_io_submit (CCKD_IOREQ *req, int n)
+{
+int             i = 0;                  /* Request index             */
+#if defined(CCKD_URING)
+CCKD_RING      *ring = NULL;            /* -> Ring                   */
+int             k;                      /* Requests submitted        */
+#endif
+
+    obtain_lock (&cckdblk.ioelock);
+    cckdblk.iodepth += n;
+    if (cckdblk.iodepth > cckdblk.iohwm)
+        cckdblk.iohwm = cckdblk.iodepth;
+    cckdblk.stats_iosubmits++;
+    cckdblk.stats_ioreqs += n;
+#if defined(CCKD_URING)
+    if (n > 1 && cckdblk.ioengine == CCKD_IO_URING)
+        ring = cckd_ring_get ();
+#endif
+    release_lock (&cckdblk.ioelock);
+
+#if defined(CCKD_URING)
+    if (ring)
+    {
+        while (i < n)
+        {
+            k = cckd_ring_submit (ring, req + i, n - i);
+            if (k <= 0) break;
+            i += k;
+        }
+        obtain_lock (&cckdblk.ioelock);
+        ring->busy = 0;
+        release_lock (&cckdblk.ioelock);
     }
+#endif
 
-    return rc;
+    for ( ; i < n; i++)
+        cckd_io_sync (&req[i]);
 
-} /* end function cckd_write */
+    obtain_lock (&cckdblk.ioelock);
+    cckdblk.iodepth -= n;
+    release_lock (&cckdblk.ioelock);
+
+} /* end function cckd_io_submit */
+
+/*-------------------------------------------------------------------*/
+/* Release i/o engine resources                                      */
+/*-------------------------------------------------------------------*/
+void cckd_io_term ()
+{
+#if defined(CCKD_URING)
+int             i;                      /* Ring index                */
+
+    obtain_lock (&cckdblk.ioelock);
+    for (i = 0; i < cckd_rings; i++)
+        cckd_ring_destroy (&cckd_ring[i]);
+    cckd_rings = 0;
+    release_lock (&cckdblk.ioelock);
+#endif
+} /* end function cckd_io_term */
 
 /*-------------------------------------------------------------------*/
 /* Truncate a cckd file                                              */
@@ -1479,6 +1879,134 @@ int             k;                      /* Index                     */
     return 0;
 }
 
+/*-------------------------------------------------------------------*/
+/* Read ahead a set of tracks                                        */
+/*                                                                   */
+/* Cache entries are set up for the tracks that are not already in   */
+/* the cache and the track images are then read with a single i/o    */
+/* engine submit.  Readahead is abandoned for the remaining tracks   */
+/* if no cache entry is available.                                   */
+/*-------------------------------------------------------------------*/
+void cckd_readahead_trks (DEVBLK *dev, int *trks, int n, int ra)
+{
+CCKDDASD_EXT   *cckd;                   /* -> cckd extension         */
+CCKD_TRKIO      t[CCKD_MAX_IOBATCH];    /* Track image i/o entries   */
+int             lru[CCKD_MAX_IOBATCH];  /* Cache entries             */
+int             m = 0;                  /* Number of tracks to read  */
+int             i;                      /* Index                     */
+int             fnd;                    /* Cache index of hit        */
+int             maxlen;                 /* Length for buffer         */
+U16             devnum;                 /* Cached device number      */
+U32             oldtrk;                 /* Cached track              */
+U32             flag;                   /* Cache flags               */
+int             wake = 0;               /* 1=Waiters to be woken     */
+
+    cckd = dev->cckd_ext;
+
+    maxlen = cckd->ckddasd ? dev->ckdtrksz
+                           : CFBA_BLOCK_SIZE + CKDDASD_TRKHDR_SIZE;
+
+    cache_lock (CACHE_DEVBUF);
+
+    for (i = 0; i < n && i < CCKD_MAX_IOBATCH; i++)
+    {
+        cckd_trace (dev, "%d rdtrk     %d\n", ra, trks[i]);
+
+        /* Readahead doesn't care about a cache hit */
+        fnd = cache_lookup (CACHE_DEVBUF,
+                            CCKD_CACHE_SETKEY(dev->devnum, trks[i]), &lru[m]);
+        if (fnd >= 0)
+            continue;
+
+        if (lru[m] < 0)
+        {
+            cckd_trace (dev, "%d rdtrk[%d] %d no available cache entry\n",
+                        ra, lru[m], trks[i]);
+            break;
+        }
+
+        cckd_trace (dev, "%d rdtrk[%d] %d cache miss\n", ra, lru[m], trks[i]);
+
+        CCKD_CACHE_GETKEY(lru[m], devnum, oldtrk);
+        if (devnum != 0)
+        {
+            cckd_trace (dev, "%d rdtrk[%d] %d dropping %4.4X:%d from cache\n",
+                        ra, lru[m], trks[i], devnum, oldtrk);
+            if (!(cache_getflag(CACHE_DEVBUF, lru[m]) & CCKD_CACHE_USED))
+            {
+                cckdblk.stats_readaheadmisses++;  cckd->misses++;
+            }
+        }
+
+        /* Initialize the entry */
+        cache_setkey(CACHE_DEVBUF, lru[m], CCKD_CACHE_SETKEY(dev->devnum, trks[i]));
+        cache_setflag(CACHE_DEVBUF, lru[m], 0, CCKD_CACHE_READING);
+        cache_setage(CACHE_DEVBUF, lru[m]);
+        cache_setval(CACHE_DEVBUF, lru[m], 0);
+        cache_setflag(CACHE_DEVBUF, lru[m], ~CACHE_TYPE,
+                      cckd->ckddasd ? DEVBUF_TYPE_CCKD : DEVBUF_TYPE_CFBA);
+        t[m].trk = trks[i];
+        t[m].buf = cache_getbuf(CACHE_DEVBUF, lru[m], maxlen);
+
+        cckd_trace (dev, "%d rdtrk[%d] %d buf %p len %d\n",
+                    ra, lru[m], trks[i], t[m].buf,
+                    cache_getlen(CACHE_DEVBUF, lru[m]));
+        m++;
+    }
+
+    cache_unlock (CACHE_DEVBUF);
+
+    if (m == 0)
+        return;
+
+    /* Clear the buffers if batch mode */
+    if (dev->batch)
+        for (i = 0; i < m; i++)
+            memset(t[i].buf, 0, maxlen);
+
+    /* Read the track images */
+    obtain_lock (&cckd->filelock);
+    cckd_read_trkimgs (dev, t, m);
+    release_lock (&cckd->filelock);
+
+    for (i = 0; i < m; i++)
+    {
+        if (t[i].rc < 0)
+            t[i].rc = cckd_null_trk (dev, t[i].buf, t[i].trk, 0);
+        cache_setval (CACHE_DEVBUF, lru[i], t[i].rc);
+    }
+
+    obtain_lock (&cckd->iolock);
+
+    /* Turn off the READING bits */
+    cache_lock (CACHE_DEVBUF);
+    for (i = 0; i < m; i++)
+    {
+        flag = cache_setflag(CACHE_DEVBUF, lru[i], ~CCKD_CACHE_READING, 0);
+        if (flag & CCKD_CACHE_IOWAIT) wake = 1;
+    }
+    cache_unlock (CACHE_DEVBUF);
+
+    /* Wakeup other threads waiting for these reads */
+    if (cckd->iowaiters && wake)
+    {   cckd_trace (dev, "%d rdtrk %d tracks signalling read complete\n",
+                    ra, m);
+        broadcast_condition (&cckd->iocond);
+    }
+
+    release_lock (&cckd->iolock);
+
+    cckdblk.stats_readaheads += m; cckd->readaheads += m;
+
+    for (i = 0; i < m; i++)
+        cckd_trace (dev, "%d rdtrk[%d] %d complete buf %p:%2.2x%2.2x%2.2x%2.2x%2.2x\n",
+                    ra, lru[i], t[i].trk, t[i].buf, t[i].buf[0], t[i].buf[1],
+                    t[i].buf[2], t[i].buf[3], t[i].buf[4]);
+
+    if (cache_busy_percent(CACHE_DEVBUF) > 80) cckd_flush_cache_all();
+
+} /* end function cckd_readahead_trks */
+
 /*-------------------------------------------------------------------*/
 /* Asynchronous readahead thread                                     */
 /*-------------------------------------------------------------------*/
@@ -1486,9 +2014,10 @@ void cckd_ra ()
 {
 CCKDDASD_EXT   *cckd;                   /* -> cckd extension         */
 DEVBLK         *dev;                    /* Readahead devblk          */
-int             trk;                    /* Readahead track           */
+int             trks[CCKD_MAX_IOBATCH]; /* Readahead tracks          */
+int             n;                      /* Number readahead tracks   */
 int             ra;                     /* Readahead index           */
-int             r;                      /* Readahead queue index     */
+int             r, next;                /* Readahead queue indexes   */
 TID             tid;                    /* Readahead thread id       */
 
     obtain_lock (&cckdblk.ralock);
@@ -1521,9 +2050,10 @@ TID             tid;                    /* Readahead thread id       */
         if (cckdblk.ra1st < 0) continue;
 
         r = cckdblk.ra1st;
-        trk = cckdblk.ra[r].trk;
+        trks[0] = cckdblk.ra[r].trk;
         dev = cckdblk.ra[r].dev;
         cckd = dev->cckd_ext;
+        n = 1;
 
         /* Requeue the 1st entry to the readahead free queue */
         cckdblk.ra1st = cckdblk.ra[r].next;
@@ -1533,6 +2063,23 @@ TID             tid;                    /* Readahead thread id       */
         cckdblk.ra[r].next = cckdblk.rafree;
         cckdblk.rafree = r;
 
+        /* Take the other queued readaheads for the same device so
+           their reads can be submitted together */
+        for (r = cckdblk.ra1st; r >= 0 && n < CCKD_MAX_IOBATCH; r = next)
+        {
+            next = cckdblk.ra[r].next;
+            if (cckdblk.ra[r].dev != dev) continue;
+            trks[n++] = cckdblk.ra[r].trk;
+            if (cckdblk.ra[r].prev > -1)
+                cckdblk.ra[cckdblk.ra[r].prev].next = next;
+            else cckdblk.ra1st = next;
+            if (next > -1)
+                cckdblk.ra[next].prev = cckdblk.ra[r].prev;
+            else cckdblk.ralast = cckdblk.ra[r].prev;
+            cckdblk.ra[r].next = cckdblk.rafree;
+            cckdblk.rafree = r;
+        }
+
         /* Schedule the other readaheads if any are still pending */
         if (cckdblk.ra1st)
         {
@@ -1547,8 +2094,8 @@ TID             tid;                    /* Readahead thread id       */
         cckd->ras++;
         release_lock (&cckdblk.ralock);
 
-        /* Read the readahead track */
-        cckd_read_trk (dev, trk, ra, NULL);
+        /* Read the readahead tracks */
+        cckd_readahead_trks (dev, trks, n, ra);
 
         obtain_lock (&cckdblk.ralock);
         cckd->ras--;
@@ -1669,18 +2216,23 @@ void cckd_writer(void *arg)
 DEVBLK         *dev;                    /* Device block              */
 CCKDDASD_EXT   *cckd;                   /* -> cckd extension         */
 int             writer;                 /* Writer identifier         */
-int             o;                      /* Cache entry found         */
+int             o[CCKD_MAX_WRBATCH];    /* Cache entries found       */
+int             n;                      /* Number of entries found   */
+int             maxn;                   /* Max entries per pass      */
+int             i;                      /* Index                     */
 U16             devnum;                 /* Device number             */
 BYTE           *buf;                    /* Buffer                    */
-BYTE           *bufp;                   /* Buffer to be written      */
-int             len, bufl;              /* Buffer lengths            */
+int             len;                    /* Buffer length             */
 int             trk;                    /* Track number              */
 int             comp;                   /* Compression algorithm     */
 int             parm;                   /* Compression parameter     */
 TID             tid;                    /* Writer thead id           */
 U32             flag;                   /* Cache flag                */
-static char    *compress[] = {"none", "zlib", "bzip2"};
 BYTE            buf2[65536];            /* Compress buffer           */
+BYTE           *bufx;                   /* Batch compress buffers    */
+CCKD_TRKIO      t[CCKD_MAX_WRBATCH];    /* Track image i/o entries   */
+CCKD_COMPJOB    job[CCKD_MAX_WRBATCH];  /* Compression jobs          */
+CCKD_COMPQ      cq;                     /* Compression queue entry   */
 
     UNREFERENCED(arg);
 
@@ -1709,6 +2261,13 @@ BYTE            buf2[65536];            /* Compress buffer           */
             writer, thread_id(), getpid());
     }
 
+    /* Compress buffers for the other tracks in a pass */
+    bufx = cckd_malloc (NULL, "wrbuf", (CCKD_MAX_WRBATCH - 1) * 65536);
+    maxn = bufx ? CCKD_MAX_WRBATCH : 1;
+
+    cq.job = job;
+    initialize_condition (&cq.cond);
+
     while (writer <= cckdblk.wrmax || cckdblk.wrpending)
     {
         /* Wait for work */
@@ -1721,20 +2280,28 @@ BYTE            buf2[65536];            /* Compress buffer           */
 
         /* Scan the cache for the oldest pending write */
         cache_lock (CACHE_DEVBUF);
-        o = cache_scan (CACHE_DEVBUF, cckd_writer_scan, NULL);
+        o[0] = cache_scan (CACHE_DEVBUF, cckd_writer_scan, NULL);
 
         /* Possibly shutting down if no writes pending */
-        if (o < 0)
+        if (o[0] < 0)
         {
             cache_unlock (CACHE_DEVBUF);
             cckdblk.wrpending = 0;
             continue;
         }
-        cache_setflag (CACHE_DEVBUF, o, ~CCKD_CACHE_WRITE, CCKD_CACHE_WRITING);
+
+        /* Pick up other pending writes for the same device */
+        n = maxn > 1 && cckdblk.wrpending > 1
+          ? cache_scan (CACHE_DEVBUF, cckd_writer_batch_scan, o) : 1;
+        if (n < 1) n = 1;
+        for (i = 0; i < n; i++)
+            cache_setflag (CACHE_DEVBUF, o[i], ~CCKD_CACHE_WRITE, CCKD_CACHE_WRITING);
         cache_unlock (CACHE_DEVBUF);
 
         /* Schedule the other writers if any writes are still pending */
-        cckdblk.wrpending--;
+        cckdblk.wrpending -= n;
+        if (cckdblk.wrpending < 0)
+            cckdblk.wrpending = 0;
         if (cckdblk.wrpending)
         {
             if (cckdblk.wrwaiting)
@@ -1746,50 +2313,76 @@ BYTE            buf2[65536];            /* Compress buffer           */
         }
         release_lock (&cckdblk.wrlock);
 
-        /* Prepare to compress */
-        CCKD_CACHE_GETKEY(o, devnum, trk);
+        CCKD_CACHE_GETKEY(o[0], devnum, trk);
         dev = cckd_find_device_by_devnum (devnum);
         cckd = dev->cckd_ext;
-        buf = cache_getbuf(CACHE_DEVBUF, o, 0);
-        len = cckd_trklen (dev, buf);
-        comp = len < CCKD_COMPRESS_MIN ? CCKD_COMPRESS_NONE
-             : cckdblk.comp == 0xff ? cckd->cdevhdr[cckd->sfn].compress
-             : cckdblk.comp;
-        parm = cckdblk.compparm < 0
-             ? cckd->cdevhdr[cckd->sfn].compress_parm
-             : cckdblk.compparm;
-
-        cckd_trace (dev, "%d wrtrk[%d] %d len %d buf %p:%2.2x%2.2x%2.2x%2.2x%2.2x\n",
-                    writer, o, trk, len, buf, buf[0], buf[1],buf[2],buf[3],buf[4]);
-
-        /* Compress the image if not null */
-        if ((len = cckd_check_null_trk (dev, buf, trk, len)) > CKDDASD_NULLTRK_FMTMAX)
+        cq.n = 0;
+
+        for (i = 0; i < n; i++)
         {
-            /* Stress adjustments */
-            if ((cache_waiters(CACHE_DEVBUF) || cache_busy(CACHE_DEVBUF) > 90)
-             && !cckdblk.nostress)
+            /* Prepare to compress */
+            CCKD_CACHE_GETKEY(o[i], devnum, trk);
+            buf = cache_getbuf(CACHE_DEVBUF, o[i], 0);
+            len = cckd_trklen (dev, buf);
+            comp = len < CCKD_COMPRESS_MIN ? CCKD_COMPRESS_NONE
+                 : cckdblk.comp == 0xff ? cckd->cdevhdr[cckd->sfn].compress
+                 : cckdblk.comp;
+            parm = cckdblk.compparm < 0
+                 ? cckd->cdevhdr[cckd->sfn].compress_parm
+                 : cckdblk.compparm;
+
+            cckd_trace (dev, "%d wrtrk[%d] %d len %d buf %p:%2.2x%2.2x%2.2x%2.2x%2.2x\n",
+                        writer, o[i], trk, len, buf, buf[0], buf[1],buf[2],buf[3],buf[4]);
+
+            t[i].trk = trk;
+
+            /* Compress the image if not null */
+            if ((len = cckd_check_null_trk (dev, buf, trk, len)) > CKDDASD_NULLTRK_FMTMAX)
             {
-                cckdblk.stats_stresswrites++;
-                comp = len < CCKD_STRESS_MINLEN ?
-                       CCKD_COMPRESS_NONE : CCKD_STRESS_COMP;
-                parm = cache_busy(CACHE_DEVBUF) <= 95 ?
-                       CCKD_STRESS_PARM1 : CCKD_STRESS_PARM2;
-            }
+                /* Stress adjustments */
+                if ((cache_waiters(CACHE_DEVBUF) || cache_busy(CACHE_DEVBUF) > 90)
+                 && !cckdblk.nostress)
+                {
+                    cckdblk.stats_stresswrites++;
+                    comp = len < CCKD_STRESS_MINLEN ?
+                           CCKD_COMPRESS_NONE : CCKD_STRESS_COMP;
+                    parm = cache_busy(CACHE_DEVBUF) <= 95 ?
+                           CCKD_STRESS_PARM1 : CCKD_STRESS_PARM2;
+                }
 
-            /* Compress the track image */
-            cckd_trace (dev, "%d wrtrk[%d] %d comp %s parm %d\n",
-                        writer, o, trk, compress[comp], parm);
-            bufp = (BYTE *)&buf2;
-            bufl = cckd_compress(dev, &bufp, buf, len, comp, parm);
-            cckd_trace (dev, "%d wrtrk[%d] %d compressed length %d\n",
-                        writer, o, trk, bufl);
-        }
-        else
-        {
-            bufp = buf;
-            bufl = len;
+                /* Queue the track image to be compressed */
+                cckd_trace (dev, "%d wrtrk[%d] %d comp %s parm %d\n",
+                            writer, o[i], trk, compname[comp & CCKD_COMPRESS_MASK], parm);
+                t[i].io = cq.n;
+                job[cq.n].dev = dev;
+                job[cq.n].from = buf;
+                job[cq.n].len = len;
+                job[cq.n].comp = comp;
+                job[cq.n].parm = parm;
+                job[cq.n].to = i ? bufx + (i - 1) * 65536 : buf2;
+                cq.n++;
+            }
+            else
+            {
+                t[i].io = -1;
+                t[i].buf = buf;
+                t[i].len = len;
+            }
         }
 
+        /* Compress the track images */
+        if (cq.n)
+            cckd_compress_jobs (&cq);
+
+        for (i = 0; i < n; i++)
+            if (t[i].io >= 0)
+            {
+                t[i].buf = job[t[i].io].to;
+                t[i].len = job[t[i].io].rc;
+                cckd_trace (dev, "%d wrtrk[%d] %d compressed length %d\n",
+                            writer, o[i], t[i].trk, t[i].len);
+            }
+
         obtain_lock (&cckd->filelock);
 
         /* Turn on read-write header bits if not already on */
@@ -1799,8 +2392,19 @@ BYTE            buf2[65536];            /* Compress buffer           */
             cckd_write_chdr (dev);
         }
 
-        /* Write the track image */
-        cckd_write_trkimg (dev, bufp, bufl, trk, CCKD_SIZE_ANY);
+        /* Record the id of the zstd dictionary the images need */
+        if (cckdblk.zdictid
+         && fetch_fw (cckd->cdevhdr[cckd->sfn].dictid) != cckdblk.zdictid)
+            for (i = 0; i < n; i++)
+                if (t[i].buf[0] == CCKD_COMPRESS_ZSTD)
+                {
+                    store_fw (cckd->cdevhdr[cckd->sfn].dictid, cckdblk.zdictid);
+                    cckd_write_chdr (dev);
+                    break;
+                }
+
+        /* Write the track images */
+        cckd_write_trkimgs (dev, t, n, CCKD_SIZE_ANY);
 
         release_lock (&cckd->filelock);
 
@@ -1810,22 +2414,28 @@ BYTE            buf2[65536];            /* Compress buffer           */
 
         obtain_lock (&cckd->iolock);
         cache_lock (CACHE_DEVBUF);
-        flag = cache_setflag (CACHE_DEVBUF, o, ~CCKD_CACHE_WRITING, 0);
+        flag = 0;
+        for (i = 0; i < n; i++)
+            flag |= cache_setflag (CACHE_DEVBUF, o[i], ~CCKD_CACHE_WRITING, 0);
         cache_unlock (CACHE_DEVBUF);
-        cckd->wrpending--;
+        cckd->wrpending -= n;
         if (cckd->iowaiters && ((flag & CCKD_CACHE_IOWAIT) || !cckd->wrpending))
         {   cckd_trace (dev, "writer[%d] cache[%2.2d] %d signalling write complete\n",
-                        writer, o, trk);
+                        writer, o[0], t[0].trk);
             broadcast_condition (&cckd->iocond);
         }
         release_lock(&cckd->iolock);
 
-        cckd_trace (dev, "%d wrtrk[%2.2d] %d complete flags:%8.8x\n",
-                    writer, o, trk, cache_getflag(CACHE_DEVBUF,o));
+        for (i = 0; i < n; i++)
+            cckd_trace (dev, "%d wrtrk[%2.2d] %d complete flags:%8.8x\n",
+                        writer, o[i], t[i].trk, cache_getflag(CACHE_DEVBUF,o[i]));
 
         obtain_lock(&cckdblk.wrlock);
     }
 
+    cckd_free (NULL, "wrbuf", bufx);
+    destroy_condition (&cq.cond);
+
     if (!cckdblk.batch)
     logmsg (_("HHCCD012I Writer thread %d stopping: tid="TIDPAT", pid=%d\n"),
             writer, thread_id(), getpid());
@@ -1843,6 +2453,185 @@ int cckd_writer_scan (int *o, int ix, int i, void *data)
         *o = i;
     return 0;
 }
+int cckd_writer_batch_scan (int *n, int ix, int i, void *data)
+{
+int            *o = data;               /* -> Cache entries found    */
+
+    if (*n < 0) *n = 1;
+    if (i != o[0]
+     && (cache_getflag(ix,i) & DEVBUF_TYPE_COMP)
+     && (cache_getflag(ix,i) & CCKD_CACHE_WRITE)
+     && (cache_getkey(ix,i) >> 32) == (cache_getkey(ix,o[0]) >> 32))
+        o[(*n)++] = i;
+    return *n >= CCKD_MAX_WRBATCH;
+}
+
+/*-------------------------------------------------------------------*/
+/* Compress a set of track images                                    */
+/*                                                                   */
+/* The jobs are queued for the compression threads.  The caller      */
+/* compresses jobs too until none are left unclaimed and then waits  */
+/* for the jobs taken by the compression threads to complete.        */
+/*-------------------------------------------------------------------*/
+void cckd_compress_jobs (CCKD_COMPQ *q)
+{
+int             i;                      /* Job index                 */
+int             c;                      /* Compression algorithm     */
+TID             tid;                    /* Compression thread id     */
+
+    q->taken = q->done = 0;
+
+    if (q->n > 1 && cckdblk.cpmax > 0)
+    {
+        obtain_lock (&cckdblk.cplock);
+
+        /* Queue the jobs and schedule the compression threads */
+        q->next = cckdblk.cpq;
+        cckdblk.cpq = q;
+        if (cckdblk.cpwaiting)
+            broadcast_condition (&cckdblk.cpcond);
+        else if (cckdblk.cps < cckdblk.cpmax)
+            create_thread (&tid, JOINABLE, cckd_compressor, NULL, "cckd_compressor");
+
+        /* Compress the jobs not taken by a compression thread */
+        while (q->taken < q->n)
+        {
+            i = q->taken++;
+            if (q->taken == q->n)
+                cckd_compress_dequeue (q);
+            release_lock (&cckdblk.cplock);
+            cckd_compress_job (&q->job[i]);
+            obtain_lock (&cckdblk.cplock);
+            q->done++;
+        }
+
+        /* Wait for the compression threads to finish */
+        while (q->done < q->n)
+            wait_condition (&q->cond, &cckdblk.cplock);
+
+        release_lock (&cckdblk.cplock);
+    }
+    else
+    {
+        for (i = 0; i < q->n; i++)
+            cckd_compress_job (&q->job[i]);
+    }
+
+    for (i = 0; i < q->n; i++)
+    {
+        c = q->job[i].comp & CCKD_COMPRESS_MASK;
+        cckdblk.stats_comptrks[c]++;
+        cckdblk.stats_compin[c] += q->job[i].len;
+        cckdblk.stats_compout[c] += q->job[i].rc;
+        cckdblk.stats_comptime[c] += q->job[i].usecs;
+    }
+
+} /* end function cckd_compress_jobs */
+
+/*-------------------------------------------------------------------*/
+/* Remove a compression queue entry whose jobs have all been taken   */
+/*                                                                   */
+/* Caller holds cckdblk.cplock                                       */
+/*-------------------------------------------------------------------*/
+void cckd_compress_dequeue (CCKD_COMPQ *q)
+{
+CCKD_COMPQ    **pq;                     /* -> Queue link             */
+
+    for (pq = &cckdblk.cpq; *pq; pq = &(*pq)->next)
+        if (*pq == q)
+        {
+            *pq = q->next;
+            break;
+        }
+
+} /* end function cckd_compress_dequeue */
+
+/*-------------------------------------------------------------------*/
+/* Compress a track image                                            */
+/*-------------------------------------------------------------------*/
+void cckd_compress_job (CCKD_COMPJOB *job)
+{
+struct timeval  beg, end;               /* Compression times         */
+
+    gettimeofday (&beg, NULL);
+    job->rc = cckd_compress (job->dev, &job->to, job->from, job->len,
+                             job->comp, job->parm);
+    gettimeofday (&end, NULL);
+    job->usecs = (end.tv_sec - beg.tv_sec) * 1000000
+               + (end.tv_usec - beg.tv_usec);
+
+} /* end function cckd_compress_job */
+
+/*-------------------------------------------------------------------*/
+/* Compression thread                                                */
+/*-------------------------------------------------------------------*/
+void cckd_compressor ()
+{
+CCKD_COMPQ     *q;                      /* -> Compression queue entry*/
+int             cp;                     /* Compression thread index  */
+int             i;                      /* Job index                 */
+TID             tid;                    /* Compression thread id     */
+
+#ifndef WIN32
+    /* Run at the writer priority */
+    if(cckdblk.wrprio >= 0)
+        setpriority (PRIO_PROCESS, 0, cckdblk.wrprio);
+#endif
+
+    obtain_lock (&cckdblk.cplock);
+    cp = ++cckdblk.cps;
+
+    /* Return without messages if too many already started */
+    if (cp > cckdblk.cpmax)
+    {
+        --cckdblk.cps;
+        release_lock (&cckdblk.cplock);
+        return;
+    }
+
+    if (!cckdblk.batch)
+    {
+        logmsg (_("HHCCD004I Compress thread %d started: tid="TIDPAT", pid=%d\n"),
+            cp, thread_id(), getpid());
+    }
+
+    while (cp <= cckdblk.cpmax)
+    {
+        if (cckdblk.cpq == NULL)
+        {
+            cckdblk.cpwaiting++;
+            wait_condition (&cckdblk.cpcond, &cckdblk.cplock);
+            cckdblk.cpwaiting--;
+            continue;
+        }
+
+        /* Take the next job */
+        q = cckdblk.cpq;
+        i = q->taken++;
+        if (q->taken == q->n)
+            cckd_compress_dequeue (q);
+
+        /* Schedule another compression thread if jobs remain */
+        if (cckdblk.cpq && !cckdblk.cpwaiting && cckdblk.cps < cckdblk.cpmax)
+            create_thread (&tid, JOINABLE, cckd_compressor, NULL, "cckd_compressor");
+
+        release_lock (&cckdblk.cplock);
+
+        cckd_compress_job (&q->job[i]);
+
+        obtain_lock (&cckdblk.cplock);
+        if (++q->done == q->n)
+            signal_condition (&q->cond);
+    }
+
+    if (!cckdblk.batch)
+    logmsg (_("HHCCD014I Compress thread %d stopping: tid="TIDPAT", pid=%d\n"),
+            cp, thread_id(), getpid());
+    --cckdblk.cps;
+    if (!cckdblk.cps) signal_condition (&cckdblk.termcond);
+    release_lock (&cckdblk.cplock);
+
+} /* end thread cckd_compressor */
 
 /*-------------------------------------------------------------------*/
 /* Debug routine for checking the free space array                   */
@@ -2323,6 +3112,12 @@ int             sfx;                    /* File index                */
     if (cckd->cdevhdr[sfx].nullfmt == CKDDASD_NULLTRK_FMT2)
         dev->oslinux = 1;
 
+    /* Warn if track images need a zstd dictionary that isn't loaded */
+    if (fetch_fw (cckd->cdevhdr[sfx].dictid) != 0
+     && fetch_fw (cckd->cdevhdr[sfx].dictid) != cckdblk.zdictid)
+        logmsg (_("HHCCD220W %4.4X file[%d] zstd dictionary %8.8X not loaded\n"),
+                dev->devnum, sfx, fetch_fw (cckd->cdevhdr[sfx].dictid));
+
     return 0;
 
 } /* end function cckd_read_chdr */
@@ -3003,133 +3798,259 @@ off_t           off;                    /* L2 entry offset           */
 /*-------------------------------------------------------------------*/
 int cckd_read_trkimg (DEVBLK *dev, BYTE *buf, int trk, BYTE *unitstat)
 {
+CCKD_TRKIO      t;                      /* Track image i/o entry     */
+
+    t.trk = trk;
+    t.buf = buf;
+
+    if (cckd_read_trkimgs (dev, &t, 1) == 0)
+        return t.rc;
+
+    if (unitstat)
+    {
+        ckd_build_sense (dev, SENSE_EC, 0, 0, FORMAT_1, MESSAGE_0);
+        *unitstat = CSW_CE | CSW_DE | CSW_UC;
+    }
+
+    return cckd_null_trk (dev, buf, trk, 0);
+
+} /* end function cckd_read_trkimg */
+
+/*-------------------------------------------------------------------*/
+/* Read track images                                                 */
+/*                                                                   */
+/* The level 2 entries for the tracks are looked up first and the    */
+/* image reads are then passed to the i/o engine in one submit.      */
+/* On return t[i].rc is the image length or -1 if the image could    */
+/* not be read or failed validation.  Returns -1 if any image failed.*/
+/* Caller holds the filelock.                                        */
+/*-------------------------------------------------------------------*/
+int cckd_read_trkimgs (DEVBLK *dev, CCKD_TRKIO *t, int n)
+{
 CCKDDASD_EXT   *cckd;                   /* -> cckd extension         */
-int             rc;                     /* Return code               */
-int             sfx;                    /* File index                */
-CCKD_L2ENT      l2;                     /* Level 2 entry             */
+CCKD_IOREQ      req[CCKD_MAX_IOBATCH];  /* I/O engine requests       */
+int             nreq = 0;               /* Number of requests        */
+int             errs = 0;               /* Number of failed images   */
+int             i;                      /* Index                     */
 
     cckd = dev->cckd_ext;
 
-    cckd_trace (dev, "trk[%d] read_trkimg\n", trk);
+    for (i = 0; i < n; i++)
+    {
+        cckd_trace (dev, "trk[%d] read_trkimg\n", t[i].trk);
 
-    /* Read level 2 entry for the track */
-    if ((sfx = cckd_read_l2ent (dev, &l2, trk)) < 0)
-        goto cckd_read_trkimg_error;
+        t[i].io = -1;
 
-    /* Read the track image or build a null track image */
-    if (l2.pos != 0)
-    {
-        rc = cckd_read (dev, sfx, (off_t)l2.pos, buf, (size_t)l2.len);
-        if (rc < 0)
-            goto cckd_read_trkimg_error;
+        /* Read level 2 entry for the track */
+        if ((t[i].sfx = cckd_read_l2ent (dev, &t[i].l2, t[i].trk)) < 0)
+        {
+            t[i].rc = -1;
+            continue;
+        }
 
-        cckd->reads[sfx]++;
-        cckd->totreads++;
-        cckdblk.stats_reads++;
-        cckdblk.stats_readbytes += rc;
-        if (cckd->notnull == 0 && trk > 1) cckd->notnull = 1;
+        /* Queue the track image read or build a null track image */
+        if (t[i].l2.pos != 0)
+        {
+            t[i].io = nreq;
+            req[nreq].fd = cckd->fd[t[i].sfx];
+            req[nreq].write = 0;
+            req[nreq].off = (off_t)t[i].l2.pos;
+            req[nreq].buf = t[i].buf;
+            req[nreq].len = (size_t)t[i].l2.len;
+            nreq++;
+        }
+        else
+            t[i].rc = cckd_null_trk (dev, t[i].buf, t[i].trk, t[i].l2.len);
     }
-    else
-        rc = cckd_null_trk (dev, buf, trk, l2.len);
 
-    /* Validate the track image */
-    if (cckd_cchh (dev, buf, trk) < 0)
-        goto cckd_read_trkimg_error;
+    if (nreq)
+    {
+        cckd_io_submit (req, nreq);
+        if (nreq > 1) cckdblk.stats_iobatched += nreq;
+    }
 
-    return rc;
+    for (i = 0; i < n; i++)
+    {
+        if (t[i].io >= 0)
+        {
+            if (req[t[i].io].rc < (int)req[t[i].io].len)
+            {
+                cckd_io_error (dev, t[i].sfx, &req[t[i].io]);
+                t[i].rc = -1;
+            }
+            else
+            {
+                t[i].rc = req[t[i].io].rc;
+                cckd->reads[t[i].sfx]++;
+                cckd->totreads++;
+                cckdblk.stats_reads++;
+                cckdblk.stats_readbytes += t[i].rc;
+                if (cckd->notnull == 0 && t[i].trk > 1) cckd->notnull = 1;
+            }
+        }
 
-cckd_read_trkimg_error:
+        /* Validate the track image */
+        if (t[i].rc >= 0 && cckd_cchh (dev, t[i].buf, t[i].trk) < 0)
+            t[i].rc = -1;
 
-    if (unitstat)
-    {
-        ckd_build_sense (dev, SENSE_EC, 0, 0, FORMAT_1, MESSAGE_0);
-        *unitstat = CSW_CE | CSW_DE | CSW_UC;
+        if (t[i].rc < 0) errs++;
     }
 
-    return cckd_null_trk (dev, buf, trk, 0);
+    return errs ? -1 : 0;
 
-} /* end function cckd_read_trkimg */
+} /* end function cckd_read_trkimgs */
 
 /*-------------------------------------------------------------------*/
 /* Write a track image                                               */
 /*-------------------------------------------------------------------*/
 int cckd_write_trkimg (DEVBLK *dev, BYTE *buf, int len, int trk, int flags)
 {
+CCKD_TRKIO      t;                      /* Track image i/o entry     */
+
+    t.trk = trk;
+    t.buf = buf;
+    t.len = len;
+
+    cckd_write_trkimgs (dev, &t, 1, flags);
+
+    /* `rc' is 1 if the new offset is after the old offset */
+    return t.rc;
+
+} /* end function cckd_write_trkimg */
+
+/*-------------------------------------------------------------------*/
+/* Write track images                                                */
+/*                                                                   */
+/* Space is obtained for each image and the image writes are passed  */
+/* to the i/o engine in one submit.  The level 2 entries are updated */
+/* and the previous space released only after the images have been  */
+/* written.  On return t[i].rc is -1 if the image was not written,   */
+/* otherwise 1 if the new offset is after the old offset or 0.       */
+/* Caller holds the filelock.                                        */
+/*-------------------------------------------------------------------*/
+int cckd_write_trkimgs (DEVBLK *dev, CCKD_TRKIO *t, int n, int flags)
+{
 CCKDDASD_EXT   *cckd;                   /* -> cckd extension         */
-int             rc;                     /* Return code               */
+CCKD_IOREQ      req[CCKD_MAX_IOBATCH];  /* I/O engine requests       */
+int             nreq = 0;               /* Number of requests        */
+int             errs = 0;               /* Number of failed images   */
 off_t           off;                    /* File offset               */
-CCKD_L2ENT      l2, oldl2;              /* Level 2 entries           */
 int             sfx,l1x,l2x;            /* Lookup table indices      */
-int             after = 0;              /* 1=New track after old     */
 int             size;                   /* Size of new track         */
+int             i;                      /* Index                     */
 
     cckd = dev->cckd_ext;
 
     sfx = cckd->sfn;
-    l1x = trk >> 8;
-    l2x = trk & 0xff;
-
-    cckd_trace (dev, "file[%d] trk[%d] write_trkimg len %d buf %p:%2.2x%2.2x%2.2x%2.2x%2.2x\n",
-                sfx, trk, len, buf, buf[0], buf[1], buf[2], buf[3], buf[4]);
 
-    /* Validate the new track image */
-    if (cckd_cchh (dev, buf, trk) < 0)
-        return -1;
-
-    /* Get the level 2 table for the track in the active file */
-    if (cckd_read_l2 (dev, sfx, l1x) < 0)
-        return -1;
+    for (i = 0; i < n; i++)
+    {
+        l1x = t[i].trk >> 8;
+        l2x = t[i].trk & 0xff;
+        t[i].sfx = sfx;
+        t[i].io = -1;
+        t[i].rc = -1;
 
-    /* Save the level 2 entry for the track */
-    oldl2.pos = cckd->l2[l2x].pos;
-    oldl2.len = cckd->l2[l2x].len;
-    oldl2.size = cckd->l2[l2x].size;
-    cckd_trace (dev, "file[%d] trk[%d] write_trkimg oldl2 0x%x %d %d\n",
-                sfx, trk, oldl2.pos,oldl2.len,oldl2.size);
+        cckd_trace (dev, "file[%d] trk[%d] write_trkimg len %d buf %p:%2.2x%2.2x%2.2x%2.2x%2.2x\n",
+                    sfx, t[i].trk, t[i].len, t[i].buf, t[i].buf[0], t[i].buf[1],
+                    t[i].buf[2], t[i].buf[3], t[i].buf[4]);
 
-    /* Check if writing a null track */
-    len = cckd_check_null_trk(dev, buf, trk, len);
+        /* Validate the new track image */
+        if (cckd_cchh (dev, t[i].buf, t[i].trk) < 0)
+            continue;
 
-    if (len > CKDDASD_NULLTRK_FMTMAX)
-    {
-        /* Get space for the track image */
-        size = len;
-        if ((off = cckd_get_space (dev, &size, flags)) < 0)
-            return -1;
+        /* Get the level 2 table for the track in the active file */
+        if (cckd_read_l2 (dev, sfx, l1x) < 0)
+            continue;
 
-        l2.pos = (U32)off;
-        l2.len = (U16)len;
-        l2.size = (U16)size;
+        /* Save the level 2 entry for the track */
+        t[i].oldl2.pos = cckd->l2[l2x].pos;
+        t[i].oldl2.len = cckd->l2[l2x].len;
+        t[i].oldl2.size = cckd->l2[l2x].size;
+        cckd_trace (dev, "file[%d] trk[%d] write_trkimg oldl2 0x%x %d %d\n",
+                    sfx, t[i].trk, t[i].oldl2.pos, t[i].oldl2.len, t[i].oldl2.size);
 
-        if (oldl2.pos != 0 && oldl2.pos != 0xffffffff && oldl2.pos < l2.pos)
-            after = 1;
+        /* Check if writing a null track */
+        t[i].len = cckd_check_null_trk(dev, t[i].buf, t[i].trk, t[i].len);
 
-        /* Write the track image */
-        if ((rc = cckd_write (dev, sfx, off, buf, len)) < 0)
-            return -1;
+        if (t[i].len > CKDDASD_NULLTRK_FMTMAX)
+        {
+            /* Get space for the track image */
+            size = t[i].len;
+            if ((off = cckd_get_space (dev, &size, flags)) < 0)
+                continue;
 
-        cckd->writes[sfx]++;
-        cckd->totwrites++;
-        cckdblk.stats_writes++;
-        cckdblk.stats_writebytes += rc;
+            t[i].l2.pos = (U32)off;
+            t[i].l2.len = (U16)t[i].len;
+            t[i].l2.size = (U16)size;
+
+            t[i].rc = t[i].oldl2.pos != 0 && t[i].oldl2.pos != 0xffffffff
+                   && t[i].oldl2.pos < t[i].l2.pos;
+
+            /* Queue the track image write */
+            t[i].io = nreq;
+            req[nreq].fd = cckd->fd[sfx];
+            req[nreq].write = 1;
+            req[nreq].off = off;
+            req[nreq].buf = t[i].buf;
+            req[nreq].len = (size_t)t[i].len;
+            nreq++;
+        }
+        else
+        {
+            t[i].l2.pos = 0;
+            t[i].l2.len = t[i].l2.size = (U16)t[i].len;
+            t[i].rc = 0;
+        }
     }
-    else
+
+    /* Write the track images */
+    if (nreq)
     {
-        l2.pos = 0;
-        l2.len = l2.size = (U16)len;
+        cckd_io_submit (req, nreq);
+        if (nreq > 1) cckdblk.stats_iobatched += nreq;
     }
 
-    /* Update the level 2 entry */
-    if (cckd_write_l2ent (dev, &l2, trk) < 0)
-        return -1;
+    for (i = 0; i < n; i++)
+    {
+        if (t[i].rc < 0)
+        {
+            errs++;
+            continue;
+        }
 
-    /* Release the previous space */
-    cckd_rel_space (dev, (off_t)oldl2.pos, (int)oldl2.len, (int)oldl2.size);
+        if (t[i].io >= 0)
+        {
+            if (req[t[i].io].rc < (int)req[t[i].io].len)
+            {
+                cckd_io_error (dev, sfx, &req[t[i].io]);
+                t[i].rc = -1;
+                errs++;
+                continue;
+            }
+            cckd->writes[sfx]++;
+            cckd->totwrites++;
+            cckdblk.stats_writes++;
+            cckdblk.stats_writebytes += req[t[i].io].rc;
+        }
 
-    /* `after' is 1 if the new offset is after the old offset */
-    return after;
+        /* Update the level 2 entry */
+        if (cckd_read_l2 (dev, sfx, t[i].trk >> 8) < 0
+         || cckd_write_l2ent (dev, &t[i].l2, t[i].trk) < 0)
+        {
+            t[i].rc = -1;
+            errs++;
+            continue;
+        }
 
-} /* end function cckd_write_trkimg */
+        /* Release the previous space */
+        cckd_rel_space (dev, (off_t)t[i].oldl2.pos, (int)t[i].oldl2.len,
+                        (int)t[i].oldl2.size);
+    }
+
+    return errs ? -1 : 0;
+
+} /* end function cckd_write_trkimgs */
 
 /*-------------------------------------------------------------------*/
 /* Harden the file                                                   */
@@ -3351,7 +4272,6 @@ U16             cyl;                    /* Cylinder                  */
 U16             head;                   /* Head                      */
 int             t;                      /* Calculated track          */
 BYTE            badcomp=0;              /* 1=Unsupported compression */
-static char    *comp[] = {"none", "zlib", "bzip2"};
 
     cckd = dev->cckd_ext;
 
@@ -3411,7 +4331,7 @@ static char    *comp[] = {"none", "zlib", "bzip2"};
                 "%s compression unsupported\n"),
                 dev->devnum, cckd->sfn,
                 cckd->ckddasd ? "trk" : "blk",
-                cckd->ckddasd ? "trk" : "blk", t, comp[buf[0]]);
+                cckd->ckddasd ? "trk" : "blk", t, compname[buf[0]]);
     }
     else
     {
@@ -4209,8 +5129,12 @@ int             rc;                     /* Return code               */
     /* harden the current file */
     cckd_harden (dev);
 
-    /* Call the compress function */
-    rc = cckd_comp (dev);
+    /* Call the compress function.  If a compression is forced by
+       `cckd comp=' the track images are recompressed first */
+    if (cckdblk.comp != 0xff)
+        rc = cckd_recomp (dev, cckdblk.comp, cckdblk.compparm);
+    else
+        rc = cckd_comp (dev);
 
     /* Perform initial read */
     rc = cckd_read_init (dev);
@@ -5013,7 +5937,6 @@ CCKDDASD_EXT   *cckd;
 BYTE           *to = NULL;                /* Uncompressed buffer     */
 int             newlen;                   /* Uncompressed length     */
 BYTE            comp;                     /* Compression type        */
-static char    *compress[] = {"none", "zlib", "bzip2"};
 
     cckd = dev->cckd_ext;
 
@@ -5046,6 +5969,14 @@ static char    *compress[] = {"none", "zlib", "bzip2"};
         to = cckd->newbuf;
         newlen = cckd_uncompress_bzip2 (dev, to, from, len, maxlen);
         break;
+    case CCKD_COMPRESS_ZSTD:
+        to = cckd->newbuf;
+        newlen = cckd_uncompress_zstd (dev, to, from, len, maxlen);
+        break;
+    case CCKD_COMPRESS_LZ4:
+        to = cckd->newbuf;
+        newlen = cckd_uncompress_lz4 (dev, to, from, len, maxlen);
+        break;
     default:
         newlen = -1;
         break;
@@ -5103,12 +6034,34 @@ static char    *compress[] = {"none", "zlib", "bzip2"};
         return to;
     }
 
+    /* zstd compression */
+    to = cckd->newbuf;
+    newlen = cckd_uncompress_zstd (dev, to, from, len, maxlen);
+    newlen = cckd_validate (dev, to, trk, newlen);
+    if (newlen > 0)
+    {
+        cckd->newbuf = from;
+        cckd->bufused = 1;
+        return to;
+    }
+
+    /* lz4 compression */
+    to = cckd->newbuf;
+    newlen = cckd_uncompress_lz4 (dev, to, from, len, maxlen);
+    newlen = cckd_validate (dev, to, trk, newlen);
+    if (newlen > 0)
+    {
+        cckd->newbuf = from;
+        cckd->bufused = 1;
+        return to;
+    }
+
     /* Unable to uncompress */
     logmsg (_("HHCCD193E %4.4X file[%d] uncompress error trk %d: %2.2x%2.2x%2.2x%2.2x%2.2x\n"),
             dev->devnum, cckd->sfn, trk, from[0], from[1], from[2], from[3], from[4]);
     if (comp & ~cckdblk.comps)
         logmsg (_("HHCCD194E %4.4X file[%d] %s compression not supported\n"),
-                dev->devnum, cckd->sfn, compress[comp]);
+                dev->devnum, cckd->sfn, compname[comp]);
     return NULL;
 }
 
@@ -5177,11 +6130,113 @@ int rc;
 #endif
 }
 
+int cckd_uncompress_zstd (DEVBLK *dev, BYTE *to, BYTE *from, int len, int maxlen)
+{
+#if defined(CCKD_ZSTD)
+ZSTD_DCtx *dctx;
+size_t newlen;
+
+    memcpy (to, from, CKDDASD_TRKHDR_SIZE);
+
+    /* Frames compressed with a dictionary need the dictionary */
+    if (cckdblk.zddict
+     && ZSTD_getDictID_fromFrame (&from[CKDDASD_TRKHDR_SIZE],
+                                  len - CKDDASD_TRKHDR_SIZE) != 0)
+    {
+        if ((dctx = ZSTD_createDCtx ()) == NULL)
+            return -1;
+        newlen = ZSTD_decompress_usingDDict (dctx,
+                    &to[CKDDASD_TRKHDR_SIZE], maxlen - CKDDASD_TRKHDR_SIZE,
+                    &from[CKDDASD_TRKHDR_SIZE], len - CKDDASD_TRKHDR_SIZE,
+                    (ZSTD_DDict *)cckdblk.zddict);
+        ZSTD_freeDCtx (dctx);
+    }
+    else
+        newlen = ZSTD_decompress (&to[CKDDASD_TRKHDR_SIZE],
+                    maxlen - CKDDASD_TRKHDR_SIZE,
+                    &from[CKDDASD_TRKHDR_SIZE], len - CKDDASD_TRKHDR_SIZE);
+
+    cckd_trace (dev, "uncompress zstd newlen %d rc %s\n",
+                ZSTD_isError (newlen) ? -1 : (int)newlen,
+                ZSTD_isError (newlen) ? ZSTD_getErrorName (newlen) : "ok");
+
+    if (ZSTD_isError (newlen))
+        return -1;
+
+    to[0] = 0;
+    return (int)newlen + CKDDASD_TRKHDR_SIZE;
+#else
+    UNREFERENCED(dev);
+    UNREFERENCED(to);
+    UNREFERENCED(from);
+    UNREFERENCED(len);
+    UNREFERENCED(maxlen);
+    return -1;
+#endif
+}
+int cckd_uncompress_lz4 (DEVBLK *dev, BYTE *to, BYTE *from, int len, int maxlen)
+{
+#if defined(CCKD_LZ4)
+int newlen;
+
+    memcpy (to, from, CKDDASD_TRKHDR_SIZE);
+    newlen = LZ4_decompress_safe ((char *)&from[CKDDASD_TRKHDR_SIZE],
+                                  (char *)&to[CKDDASD_TRKHDR_SIZE],
+                                  len - CKDDASD_TRKHDR_SIZE,
+                                  maxlen - CKDDASD_TRKHDR_SIZE);
+    if (newlen >= 0)
+    {
+        newlen += CKDDASD_TRKHDR_SIZE;
+        to[0] = 0;
+    }
+    else
+        newlen = -1;
+
+    cckd_trace (dev, "uncompress lz4 newlen %d\n", newlen);
+
+    return newlen;
+#else
+    UNREFERENCED(dev);
+    UNREFERENCED(to);
+    UNREFERENCED(from);
+    UNREFERENCED(len);
+    UNREFERENCED(maxlen);
+    return -1;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Uncompress a track image into a caller supplied buffer            */
+/*                                                                   */
+/* Used where the image does not pass through the device buffers,    */
+/* such as when a file is recompressed in place.  Returns the        */
+/* uncompressed length or -1.                                        */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int cckd_uncompress_trkimg (DEVBLK *dev, BYTE *to, BYTE *from,
+                                       int len, int maxlen)
+{
+    switch (from[0] & CCKD_COMPRESS_MASK) {
+    case CCKD_COMPRESS_NONE:
+        if (len > maxlen) return -1;
+        memcpy (to, from, len);
+        return len;
+    case CCKD_COMPRESS_ZLIB:
+        return cckd_uncompress_zlib (dev, to, from, len, maxlen);
+    case CCKD_COMPRESS_BZIP2:
+        return cckd_uncompress_bzip2 (dev, to, from, len, maxlen);
+    case CCKD_COMPRESS_ZSTD:
+        return cckd_uncompress_zstd (dev, to, from, len, maxlen);
+    case CCKD_COMPRESS_LZ4:
+        return cckd_uncompress_lz4 (dev, to, from, len, maxlen);
+    }
+    return -1;
+}
+
 /*-------------------------------------------------------------------*/
 /* Compress a track image                                            */
 /*-------------------------------------------------------------------*/
-int cckd_compress (DEVBLK *dev, BYTE **to, BYTE *from, int len,
-                   int comp, int parm)
+DLL_EXPORT int cckd_compress (DEVBLK *dev, BYTE **to, BYTE *from, int len,
+                              int comp, int parm)
 {
 int newlen;
 
@@ -5195,6 +6250,12 @@ int newlen;
     case CCKD_COMPRESS_BZIP2:
         newlen = cckd_compress_bzip2 (dev, to, from, len, parm);
         break;
+    case CCKD_COMPRESS_ZSTD:
+        newlen = cckd_compress_zstd (dev, to, from, len, parm);
+        break;
+    case CCKD_COMPRESS_LZ4:
+        newlen = cckd_compress_lz4 (dev, to, from, len, parm);
+        break;
     default:
         newlen = cckd_compress_bzip2 (dev, to, from, len, parm);
         break;
@@ -5224,7 +6285,7 @@ BYTE *buf;
     newlen = 65535 - CKDDASD_TRKHDR_SIZE;
     rc = compress2 (&buf[CKDDASD_TRKHDR_SIZE], &newlen,
                     &from[CKDDASD_TRKHDR_SIZE], len - CKDDASD_TRKHDR_SIZE,
-                    parm);
+                    parm <= 9 ? parm : 9);
     newlen += CKDDASD_TRKHDR_SIZE;
     if (rc != Z_OK || (int)newlen >= len)
     {
@@ -5271,6 +6332,203 @@ BYTE *buf;
 #endif
 }
 
+#if defined(CCKD_ZSTD)
+/*-------------------------------------------------------------------*/
+/* Get the zstd compression dictionary for a level                   */
+/*                                                                   */
+/* A digested dictionary is bound to a compression level so one is   */
+/* built the first time each level is used and kept until the cckd   */
+/* global area is terminated.                                        */
+/*-------------------------------------------------------------------*/
+static ZSTD_CDict *cckd_zstd_cdict (int level)
+{
+    if (cckdblk.zcdict[level] == NULL)
+    {
+        obtain_lock (&cckdblk.cplock);
+        if (cckdblk.zcdict[level] == NULL)
+            cckdblk.zcdict[level] = ZSTD_createCDict (cckdblk.zdict,
+                                                cckdblk.zdictlen, level);
+        release_lock (&cckdblk.cplock);
+    }
+    return (ZSTD_CDict *)cckdblk.zcdict[level];
+}
+#endif
+int cckd_compress_zstd (DEVBLK *dev, BYTE **to, BYTE *from, int len, int parm)
+{
+#if defined(CCKD_ZSTD)
+size_t newlen;
+int level;
+ZSTD_CCtx *cctx;
+ZSTD_CDict *cdict;
+BYTE *buf;
+
+    UNREFERENCED(dev);
+    level = parm >= 1 ? parm : CCKD_ZSTD_DEFLEVEL;
+    if (level > ZSTD_maxCLevel ()) level = ZSTD_maxCLevel ();
+    if (level > CCKD_ZSTD_MAXLEVEL) level = CCKD_ZSTD_MAXLEVEL;
+    buf = *to;
+    from[0] = CCKD_COMPRESS_NONE;
+    memcpy (buf, from, CKDDASD_TRKHDR_SIZE);
+    buf[0] = CCKD_COMPRESS_ZSTD;
+    if (cckdblk.zdict && (cdict = cckd_zstd_cdict (level)) != NULL
+     && (cctx = ZSTD_createCCtx ()) != NULL)
+    {
+        newlen = ZSTD_compress_usingCDict (cctx,
+                    &buf[CKDDASD_TRKHDR_SIZE], 65535 - CKDDASD_TRKHDR_SIZE,
+                    &from[CKDDASD_TRKHDR_SIZE], len - CKDDASD_TRKHDR_SIZE,
+                    cdict);
+        ZSTD_freeCCtx (cctx);
+    }
+    else
+        newlen = ZSTD_compress (
+                    &buf[CKDDASD_TRKHDR_SIZE], 65535 - CKDDASD_TRKHDR_SIZE,
+                    &from[CKDDASD_TRKHDR_SIZE], len - CKDDASD_TRKHDR_SIZE,
+                    level);
+    if (ZSTD_isError (newlen)
+     || (int)newlen + CKDDASD_TRKHDR_SIZE >= len)
+    {
+        *to = from;
+        return len;
+    }
+    return (int)newlen + CKDDASD_TRKHDR_SIZE;
+#else
+    return cckd_compress_zlib (dev, to, from, len, parm);
+#endif
+}
+int cckd_compress_lz4 (DEVBLK *dev, BYTE **to, BYTE *from, int len, int parm)
+{
+#if defined(CCKD_LZ4)
+int newlen;
+BYTE *buf;
+
+    UNREFERENCED(dev);
+    buf = *to;
+    from[0] = CCKD_COMPRESS_NONE;
+    memcpy (buf, from, CKDDASD_TRKHDR_SIZE);
+    buf[0] = CCKD_COMPRESS_LZ4;
+    /* For lz4 the parameter is the acceleration factor */
+    newlen = LZ4_compress_fast ((char *)&from[CKDDASD_TRKHDR_SIZE],
+                                (char *)&buf[CKDDASD_TRKHDR_SIZE],
+                                len - CKDDASD_TRKHDR_SIZE,
+                                65535 - CKDDASD_TRKHDR_SIZE,
+                                parm >= 1 ? parm : 1);
+    newlen += CKDDASD_TRKHDR_SIZE;
+    if (newlen <= CKDDASD_TRKHDR_SIZE || newlen >= len)
+    {
+        *to = from;
+        newlen = len;
+    }
+    return newlen;
+#else
+    return cckd_compress_zlib (dev, to, from, len, parm);
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Load a trained zstd dictionary                                    */
+/*                                                                   */
+/* Track images compressed with the dictionary carry its id and can  */
+/* only be read while the same dictionary is loaded, so once loaded  */
+/* the dictionary is not replaced.                                   */
+/*-------------------------------------------------------------------*/
+DLL_EXPORT int cckd_zstd_dict (char *fn)
+{
+#if defined(CCKD_ZSTD)
+int             fd;                     /* File descriptor           */
+struct stat     fst;                    /* File status buffer        */
+BYTE           *dict;                   /* Dictionary                */
+int             len;                    /* Dictionary length         */
+U32             id;                     /* Dictionary id             */
+void           *ddict;                  /* Digested dictionary       */
+char            pathname[MAX_PATH];     /* file path in host format  */
+
+    /* Initialize the global cckd block if necessary */
+    if (memcmp (&cckdblk.id, "CCKDBLK ", sizeof(cckdblk.id)))
+        cckddasd_init (0, NULL);
+
+    if (cckdblk.zdict)
+    {
+        logmsg (_("HHCCD221E zstd dictionary %8.8X already loaded\n"),
+                cckdblk.zdictid);
+        return -1;
+    }
+
+    hostpath(pathname, fn, sizeof(pathname));
+    if ((fd = hopen(pathname, O_RDONLY|O_BINARY)) < 0)
+    {
+        logmsg (_("HHCCD222E %s open error: %s\n"), fn, strerror(errno));
+        return -1;
+    }
+    if (fstat (fd, &fst) < 0 || fst.st_size <= 0 || fst.st_size > 0x7fffffff)
+    {
+        logmsg (_("HHCCD223E %s is not a zstd dictionary\n"), fn);
+        close (fd);
+        return -1;
+    }
+    len = (int)fst.st_size;
+    if ((dict = malloc (len)) == NULL)
+    {
+        logmsg (_("HHCCD222E %s malloc error: %s\n"), fn, strerror(errno));
+        close (fd);
+        return -1;
+    }
+    if (read (fd, dict, len) != len)
+    {
+        logmsg (_("HHCCD222E %s read error: %s\n"), fn, strerror(errno));
+        free (dict);
+        close (fd);
+        return -1;
+    }
+    close (fd);
+
+    /* Only trained dictionaries have an id to stamp the frames with */
+    if ((id = ZSTD_getDictID_fromDict (dict, len)) == 0
+     || (ddict = ZSTD_createDDict (dict, len)) == NULL)
+    {
+        logmsg (_("HHCCD223E %s is not a zstd dictionary\n"), fn);
+        free (dict);
+        return -1;
+    }
+
+    cckdblk.zdict = dict;
+    cckdblk.zdictlen = len;
+    cckdblk.zdictid = id;
+    cckdblk.zddict = ddict;
+
+    logmsg (_("HHCCD224I zstd dictionary %8.8X loaded from %s, %d bytes\n"),
+            id, fn, len);
+    return 0;
+#else
+    UNREFERENCED(fn);
+    logmsg (_("HHCCD223E zstd compression is not supported\n"));
+    return -1;
+#endif
+}
+
+/*-------------------------------------------------------------------*/
+/* Release the zstd dictionary                                       */
+/*-------------------------------------------------------------------*/
+void cckd_zstd_term ()
+{
+#if defined(CCKD_ZSTD)
+int             i;                      /* Index                     */
+
+    for (i = 0; i <= CCKD_ZSTD_MAXLEVEL; i++)
+        if (cckdblk.zcdict[i])
+        {
+            ZSTD_freeCDict ((ZSTD_CDict *)cckdblk.zcdict[i]);
+            cckdblk.zcdict[i] = NULL;
+        }
+    if (cckdblk.zddict)
+        ZSTD_freeDDict ((ZSTD_DDict *)cckdblk.zddict);
+    free (cckdblk.zdict);
+    cckdblk.zddict = NULL;
+    cckdblk.zdict = NULL;
+    cckdblk.zdictlen = 0;
+    cckdblk.zdictid = 0;
+#endif
+}
+
 /*-------------------------------------------------------------------*/
 /* cckd command help                                                 */
 /*-------------------------------------------------------------------*/
@@ -5280,12 +6538,17 @@ void cckd_command_help()
              "help\t\tDisplay help message\n"
              "stats\t\tDisplay cckd statistics\n"
              "opts\t\tDisplay cckd options\n"
-             "comp=<n>\t\tOverride compression\t\t(-1 .. 2)\n"
-             "compparm=<n>\tOverride compression parm\t\t(-1 .. 9)\n"
+             "comp=<n>\t\tOverride compression\t\t(-1,0,1,2,4,8)\n"
+             "\t\t    (0=none 1=zlib 2=bzip2 4=zstd 8=lz4)\n"
+             "compparm=<n>\tOverride compression parm\t\t(-1 .. 22)\n"
+             "zstddict=<file>\tLoad a trained zstd dictionary\n"
              "ra=<n>\t\tSet number readahead threads\t\t(1 .. 9)\n"
              "raq=<n>\t\tSet readahead queue size\t\t(0 .. 16)\n"
              "rat=<n>\t\tSet number tracks to read ahead\t\t(0 .. 16)\n"
              "wr=<n>\t\tSet number writer threads\t\t(1 .. 9)\n"
+             "cw=<n>\t\tSet number compression threads\t\t(0 .. 16)\n"
+             "io=<n>\t\tSet i/o engine\t\t\t\t(0 .. 1)\n"
+             "\t\t    (0=pread/pwrite 1=io_uring)\n"
              "gcint=<n>\tSet garbage collector interval (sec)\t(1 .. 60)\n"
              "gcparm=<n>\tSet garbage collector parameter\t\t(-8 .. 8)\n"
              "\t\t    (least agressive ... most aggressive)\n"
@@ -5302,14 +6565,15 @@ void cckd_command_help()
 void cckd_command_opts()
 {
     logmsg ("comp=%d,compparm=%d,ra=%d,raq=%d,rat=%d,"
-             "wr=%d,gcint=%d,gcparm=%d,nostress=%d,\n"
-             "\tfreepend=%d,fsync=%d,trace=%d,linuxnull=%d\n",
+             "wr=%d,cw=%d,gcint=%d,gcparm=%d,nostress=%d,\n"
+             "\tfreepend=%d,fsync=%d,trace=%d,linuxnull=%d,io=%d\n",
              cckdblk.comp == 0xff ? -1 : cckdblk.comp,
              cckdblk.compparm, cckdblk.ramax,
              cckdblk.ranbr, cckdblk.readaheads,
-             cckdblk.wrmax, cckdblk.gcwait,
+             cckdblk.wrmax, cckdblk.cpmax, cckdblk.gcwait,
              cckdblk.gcparm, cckdblk.nostress, cckdblk.freepend,
-             cckdblk.fsync, cckdblk.itracen, cckdblk.linuxnull);
+             cckdblk.fsync, cckdblk.itracen, cckdblk.linuxnull,
+             cckdblk.ioengine);
 } /* end function cckd_command_opts */
 
 /*-------------------------------------------------------------------*/
@@ -5317,12 +6581,16 @@ void cckd_command_opts()
 /*-------------------------------------------------------------------*/
 void cckd_command_stats()
 {
+int             i;                      /* Index                     */
+
     logmsg("reads....%10" I64_FMT "d Kbytes...%10" I64_FMT "d writes...%10" I64_FMT "d Kbytes...%10" I64_FMT "d\n"
             "readaheads%9" I64_FMT "d misses...%10" I64_FMT "d syncios..%10" I64_FMT "d misses...%10" I64_FMT "d\n"
             "switches.%10" I64_FMT "d l2 reads.%10" I64_FMT "d              stress writes...%10" I64_FMT "d\n"
             "cachehits%10" I64_FMT "d misses...%10" I64_FMT "d l2 hits..%10" I64_FMT "d misses...%10" I64_FMT "d\n"
             "waits                                   i/o......%10" I64_FMT "d cache....%10" I64_FMT "d\n"
-            "garbage collector   moves....%10" I64_FMT "d Kbytes...%10" I64_FMT "d\n",
+            "garbage collector   moves....%10" I64_FMT "d Kbytes...%10" I64_FMT "d\n"
+            "i/o engine %-8s submits..%10" I64_FMT "d requests.%10" I64_FMT "d batched..%10" I64_FMT "d\n"
+            "queue depth%8d hwm......%10d\n",
             cckdblk.stats_reads, cckdblk.stats_readbytes >> 10,
             cckdblk.stats_writes, cckdblk.stats_writebytes >> 10,
             cckdblk.stats_readaheads, cckdblk.stats_readaheadmisses,
@@ -5332,7 +6600,21 @@ void cckd_command_stats()
             cckdblk.stats_cachehits, cckdblk.stats_cachemisses,
             cckdblk.stats_l2cachehits, cckdblk.stats_l2cachemisses,
             cckdblk.stats_iowaits, cckdblk.stats_cachewaits,
-            cckdblk.stats_gcolmoves, cckdblk.stats_gcolbytes >> 10);
+            cckdblk.stats_gcolmoves, cckdblk.stats_gcolbytes >> 10,
+            cckdblk.ioengine == CCKD_IO_URING ? "uring" : "sync",
+            cckdblk.stats_iosubmits, cckdblk.stats_ioreqs,
+            cckdblk.stats_iobatched,
+            cckdblk.iodepth, cckdblk.iohwm);
+
+    /* Compression throughput by algorithm */
+    for (i = 0; i <= CCKD_COMPRESS_MASK; i++)
+        if (cckdblk.stats_comptrks[i])
+            logmsg("compress %-5s tracks...%10" I64_FMT "d in Kb....%10" I64_FMT "d "
+                   "out Kb...%10" I64_FMT "d MB/s.....%10" I64_FMT "d\n",
+                   compname[i], cckdblk.stats_comptrks[i],
+                   cckdblk.stats_compin[i] >> 10, cckdblk.stats_compout[i] >> 10,
+                   cckdblk.stats_comptime[i]
+                   ? cckdblk.stats_compin[i] / cckdblk.stats_comptime[i] : 0);
 } /* end function cckd_command_stats */
 
 /*-------------------------------------------------------------------*/
@@ -5403,7 +6685,8 @@ int   val, opts = 0;
         }
         else if (strcasecmp (kw, "comp") == 0)
         {
-            if (val < -1 || (val & ~cckdblk.comps) || c != '\0')
+            if (val < -1 || (val & ~cckdblk.comps) || (val & (val - 1))
+             || c != '\0')
             {
                 logmsg ("Invalid value for comp=\n");
                 return -1;
@@ -5414,9 +6697,19 @@ int   val, opts = 0;
                 opts = 1;
             }
         }
+        else if (strcasecmp (kw, "zstddict") == 0)
+        {
+            if (p == NULL || *p == '\0')
+            {
+                logmsg ("Invalid value for zstddict=\n");
+                return -1;
+            }
+            if (cckd_zstd_dict (p) < 0)
+                return -1;
+        }
         else if (strcasecmp (kw, "compparm") == 0)
         {
-            if (val < -1 || val > 9 || c != '\0')
+            if (val < -1 || val > CCKD_ZSTD_MAXLEVEL || c != '\0')
             {
                 logmsg ("Invalid value for compparm=\n");
                 return -1;
@@ -5479,6 +6772,43 @@ int   val, opts = 0;
                 opts = 1;
             }
         }
+        else if (strcasecmp (kw, "cw") == 0)
+        {
+            if (val < CCKD_MIN_COMPRESS || val > CCKD_MAX_COMPRESS || c != '\0')
+            {
+                logmsg ("Invalid value for cw=\n");
+                return -1;
+            }
+            else
+            {
+                obtain_lock (&cckdblk.cplock);
+                cckdblk.cpmax = val;
+                if (cckdblk.cpwaiting)
+                    broadcast_condition (&cckdblk.cpcond);
+                release_lock (&cckdblk.cplock);
+                opts = 1;
+            }
+        }
+        else if (strcasecmp (kw, "io") == 0)
+        {
+            if (val < CCKD_IO_SYNC || val > CCKD_IO_URING || c != '\0')
+            {
+                logmsg ("Invalid value for io=\n");
+                return -1;
+            }
+#if !defined(CCKD_URING)
+            else if (val == CCKD_IO_URING)
+            {
+                logmsg ("io=1 not supported on this host\n");
+                return -1;
+            }
+#endif
+            else
+            {
+                cckdblk.ioengine = val;
+                opts = 1;
+            }
+        }
         else if (strcasecmp (kw, "gcint") == 0)
         {
             if (val < 1 || val > 60 || c != '\0')
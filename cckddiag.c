@@ -162,8 +162,11 @@ int decomptrk(
 /* This code based on decompression logic in cdsk_valid_trk.         */
 /* Returns length of decompressed data or -1 on error.               */
 {
-#if defined( HAVE_LIBZ ) || defined( CCKD_BZIP2 )
+#if defined( HAVE_LIBZ ) || defined( CCKD_BZIP2 ) \
+ || defined( CCKD_ZSTD ) || defined( CCKD_LZ4 )
 int             rc;                     /* Return code               */
+#endif
+#if defined( HAVE_LIBZ ) || defined( CCKD_BZIP2 )
 BYTE           *bufp;                   /* Buffer pointer            */
 #endif
 size_t          bufl;                   /* Buffer length             */
@@ -171,7 +174,8 @@ size_t          bufl;                   /* Buffer length             */
 unsigned int    ubufl;                  /* when size_t != unsigned int */
 #endif
 
-#if !defined( HAVE_LIBZ ) && !defined( CCKD_BZIP2 )
+#if !defined( HAVE_LIBZ ) && !defined( CCKD_BZIP2 ) \
+ && !defined( CCKD_ZSTD ) && !defined( CCKD_LZ4 )
     UNREFERENCED(heads);
     UNREFERENCED(trk);
     UNREFERENCED(msg);
@@ -231,6 +235,26 @@ unsigned int    ubufl;                  /* when size_t != unsigned int */
         break;
 #endif
 
+#if defined( CCKD_ZSTD ) || defined( CCKD_LZ4 )
+#ifdef CCKD_ZSTD
+    case CCKD_COMPRESS_ZSTD:
+#endif
+#ifdef CCKD_LZ4
+    case CCKD_COMPRESS_LZ4:
+#endif
+        rc = cckd_uncompress_trkimg (NULL, obuf, ibuf, ibuflen, obuflen);
+        if (rc < 0) {
+            if (msg)
+                snprintf(msg, 80, "%s %d decompress error;"
+                         "%2.2x%2.2x%2.2x%2.2x%2.2x",
+                         heads >= 0 ? "trk" : "blk", trk,
+                         ibuf[0], ibuf[1], ibuf[2], ibuf[3], ibuf[4]);
+            return -1;
+        }
+        bufl = rc;
+        break;
+#endif
+
     default:
         return -1;
 
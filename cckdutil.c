@@ -48,7 +48,10 @@ static int  cdsk_valid_trk (int trk, BYTE *buf, int heads, int len);
 static BYTE  eighthexFF[] = {0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff};
 static char *spaces[] = { "none", "devhdr", "cdevhdr", "l1",  "l2",
                           "trk",  "blkgrp", "free",    "eof" }; 
-static char *comps[]  = { "none", "zlib",   "bzip2" };
+static char *comps[]  = { "none", "zlib",   "bzip2", "?",
+                          "zstd", "?",      "?",     "?",
+                          "lz4",  "?",      "?",     "?",
+                          "?",    "?",      "?",     "?" };
 
 /*-------------------------------------------------------------------*/
 /* Change the endianess of a compressed file                         */
@@ -843,6 +846,273 @@ comp_error:
 
 } /* cckd_comp() */
 
+/*-------------------------------------------------------------------
+ * Recompress the track images in a compressed ckd file
+ *
+ * Each track image not already compressed using `comp' is
+ * uncompressed and compressed again.  The new image replaces the
+ * old one if it fits in the old space, otherwise it is written at
+ * the end of the file.  The file is then compressed by cckd_comp()
+ * which releases the space left behind.
+ *-------------------------------------------------------------------*/
+DLL_EXPORT int cckd_recomp (DEVBLK *dev, int comp, int parm)
+{
+CCKDDASD_EXT   *cckd;                   /* -> cckd extension         */
+int             fd;                     /* File descriptor           */
+struct stat     fst;                    /* File status buffer        */
+long long       maxsize;                /* Max cckd file size        */
+int             rc;                     /* Return code               */
+off_t           off;                    /* File offset               */
+off_t           eof;                    /* End of file offset        */
+int             len;                    /* Length                    */
+int             newlen;                 /* New image length          */
+int             i, j;                   /* Work variables            */
+int             l1size;                 /* l1 table size             */
+int             n = 0;                  /* Images recompressed       */
+int             errs = 0;               /* Images not recompressed   */
+int             dirty;                  /* 1=l2 table updated        */
+CCKD_DEVHDR     cdevhdr;                /* CCKD device header        */
+CCKD_L1ENT     *l1=NULL;                /* -> l1 table               */
+CCKD_L2ENT      l2[256];                /* l2 table                  */
+BYTE           *p;                      /* -> compressed image       */
+BYTE           *buf=NULL;               /* Image buffer              */
+BYTE           *buf2;                   /* Uncompressed buffer       */
+BYTE           *buf3;                   /* Compressed buffer         */
+
+    /*---------------------------------------------------------------
+     * Get fd
+     *---------------------------------------------------------------*/
+    cckd = dev->cckd_ext;
+    if (cckd == NULL)
+        fd = dev->fd;
+    else
+        fd = cckd->fd[cckd->sfn];
+
+    /*---------------------------------------------------------------
+     * Check the compression is supported
+     *---------------------------------------------------------------*/
+    if ((comp & CCKD_COMPRESS_MASK) != comp || (comp & (comp - 1)))
+        goto recomp_comp_error;
+#if !defined(HAVE_LIBZ)
+    if (comp == CCKD_COMPRESS_ZLIB)
+        goto recomp_comp_error;
+#endif
+#if !defined(CCKD_BZIP2)
+    if (comp == CCKD_COMPRESS_BZIP2)
+        goto recomp_comp_error;
+#endif
+#if !defined(CCKD_ZSTD)
+    if (comp == CCKD_COMPRESS_ZSTD)
+        goto recomp_comp_error;
+#endif
+#if !defined(CCKD_LZ4)
+    if (comp == CCKD_COMPRESS_LZ4)
+        goto recomp_comp_error;
+#endif
+
+    if (fstat (fd, &fst) < 0)
+        goto recomp_fstat_error;
+    maxsize = sizeof(off_t) == 4 ? 0x7fffffffll : 0xffffffffll;
+    eof = fst.st_size;
+
+recomp_restart:
+
+    /*---------------------------------------------------------------
+     * Read compressed device header
+     *---------------------------------------------------------------*/
+    off = CCKD_DEVHDR_POS;
+    if (lseek (fd, off, SEEK_SET) < 0)
+        goto recomp_lseek_error;
+    len = CCKD_DEVHDR_SIZE;
+    if ((rc = read (fd, &cdevhdr, len)) != len)
+        goto recomp_read_error;
+
+    if ((cdevhdr.options & CCKD_BIGENDIAN) != cckd_endian())
+    {
+        cckdumsg (dev, 101, "converting to %s\n",
+                  cckd_endian() ? "big-endian" : "little-endian");
+        if (cckd_swapend (dev) < 0)
+            goto recomp_error;
+        else
+            goto recomp_restart;
+    }
+
+    if (parm < 0)
+        parm = cdevhdr.compress_parm;
+
+    len = 3 * 65536;
+    if ((buf = malloc (len)) == NULL)
+        goto recomp_malloc_error;
+    buf2 = buf + 65536;
+    buf3 = buf2 + 65536;
+
+    /*---------------------------------------------------------------
+     * Read the l1 table
+     *---------------------------------------------------------------*/
+    l1size = len = cdevhdr.numl1tab * CCKD_L1ENT_SIZE;
+    if ((l1 = malloc (len)) == NULL)
+        goto recomp_malloc_error;
+    off = CCKD_L1TAB_POS;
+    if (lseek (fd, off, SEEK_SET) < 0)
+        goto recomp_lseek_error;
+    if ((rc = read (fd, l1, len)) != len)
+        goto recomp_read_error;
+
+    /*---------------------------------------------------------------
+     * Recompress the images for each l2 table
+     *---------------------------------------------------------------*/
+    for (i = 0; i < cdevhdr.numl1tab; i++)
+    {
+        if (l1[i] == 0 || l1[i] == 0xffffffff)
+            continue;
+
+        off = (off_t)l1[i];
+        if (lseek (fd, off, SEEK_SET) < 0)
+            goto recomp_lseek_error;
+        len = CCKD_L2TAB_SIZE;
+        if ((rc = read (fd, l2, len)) != len)
+            goto recomp_read_error;
+
+        for (j = dirty = 0; j < 256; j++)
+        {
+            if (l2[j].pos == 0 || l2[j].pos == 0xffffffff)
+                continue;
+
+            /* Read the image */
+            off = (off_t)l2[j].pos;
+            if (lseek (fd, off, SEEK_SET) < 0)
+                goto recomp_lseek_error;
+            len = l2[j].len;
+            if ((rc = read (fd, buf, len)) != len)
+                goto recomp_read_error;
+
+            if ((buf[0] & CCKD_COMPRESS_MASK) == comp)
+                continue;
+
+            /* Uncompress and compress the image again */
+            len = cckd_uncompress_trkimg (dev, buf2, buf, len, 65536);
+            if (len <= CKDDASD_TRKHDR_SIZE)
+            {
+                errs++;
+                continue;
+            }
+            p = buf3;
+            newlen = cckd_compress (dev, &p, buf2, len, comp, parm);
+
+            /* Write it in place or at the end of the file */
+            if (newlen <= l2[j].size)
+                off = (off_t)l2[j].pos;
+            else if (eof + newlen <= maxsize)
+            {
+                off = eof;
+                eof += newlen;
+                l2[j].pos = (U32)off;
+                l2[j].size = (U16)newlen;
+            }
+            else
+            {
+                errs++;
+                continue;
+            }
+            if (lseek (fd, off, SEEK_SET) < 0)
+                goto recomp_lseek_error;
+            len = newlen;
+            if ((rc = write (fd, p, len)) != len)
+                goto recomp_write_error;
+            l2[j].len = (U16)newlen;
+            dirty = 1;
+            n++;
+        } /* for each l2 entry */
+
+        /* Write the updated l2 table */
+        if (dirty)
+        {
+            off = (off_t)l1[i];
+            if (lseek (fd, off, SEEK_SET) < 0)
+                goto recomp_lseek_error;
+            len = CCKD_L2TAB_SIZE;
+            if ((rc = write (fd, l2, len)) != len)
+                goto recomp_write_error;
+        }
+    } /* for each l1 entry */
+
+    /*---------------------------------------------------------------
+     * Update the compressed device header
+     *---------------------------------------------------------------*/
+    cdevhdr.options |= CCKD_ORDWR;
+    cdevhdr.compress = comp;
+    cdevhdr.compress_parm = parm;
+    cdevhdr.size = cdevhdr.used = (U32)eof;
+    if (comp == CCKD_COMPRESS_ZSTD && cckdblk.zdictid)
+        store_fw (cdevhdr.dictid, cckdblk.zdictid);
+    else if (errs == 0)
+        store_fw (cdevhdr.dictid, 0);
+    off = CCKD_DEVHDR_POS;
+    if (lseek (fd, off, SEEK_SET) < 0)
+        goto recomp_lseek_error;
+    len = CCKD_DEVHDR_SIZE;
+    if ((rc = write (fd, &cdevhdr, len)) != len)
+        goto recomp_write_error;
+
+    cckdumsg (dev, 105, "%d images recompressed using %s\n",
+              n, comps[comp]);
+    if (errs)
+        cckdumsg (dev, 106, "%d images could not be recompressed\n", errs);
+
+    free (buf);
+    free (l1);
+
+    /* Release the space left behind */
+    return cckd_comp (dev);
+
+    /*---------------------------------------------------------------
+     * Error exits
+     *---------------------------------------------------------------*/
+
+recomp_comp_error:
+
+    cckdumsg (dev, 107, "%s compression not supported\n",
+              comps[comp & CCKD_COMPRESS_MASK]);
+    goto recomp_error;
+
+recomp_fstat_error:
+
+    cckdumsg (dev, 701, "fstat error: %s\n",
+              strerror(errno));
+    goto recomp_error;
+
+recomp_lseek_error:
+
+    cckdumsg (dev, 702, "lseek error, offset 0x%" I64_FMT "x: %s\n",
+              (long long)off, strerror(errno));
+    goto recomp_error;
+
+recomp_read_error:
+
+    cckdumsg (dev, 703, "read error rc=%d, offset 0x%" I64_FMT "x len %d: %s\n",
+              rc, (long long)off, len, rc < 0 ? strerror(errno) : "incomplete");
+    goto recomp_error;
+
+recomp_write_error:
+
+    cckdumsg (dev, 704, "write error rc=%d, offset 0x%" I64_FMT "x len %d: %s\n",
+              rc, (long long)off, len, rc < 0 ? strerror(errno) : "incomplete");
+    goto recomp_error;
+
+recomp_malloc_error:
+
+    cckdumsg (dev, 705, "malloc error, size %d: %s\n",
+              len, strerror(errno));
+    goto recomp_error;
+
+recomp_error:
+
+    if (buf) free (buf);
+    if (l1) free (l1);
+    return -1;
+
+} /* cckd_recomp() */
+
 /*-------------------------------------------------------------------
  * cckd_comp() space table sort
  *-------------------------------------------------------------------*/
@@ -955,6 +1225,16 @@ BYTE            buf[4*65536];           /* buffer                    */
 #else
     compmask[CCKD_COMPRESS_BZIP2] = 2;
 #endif
+#if defined(CCKD_ZSTD)
+    compmask[CCKD_COMPRESS_ZSTD] = 0;
+#else
+    compmask[CCKD_COMPRESS_ZSTD] = 4;
+#endif
+#if defined(CCKD_LZ4)
+    compmask[CCKD_COMPRESS_LZ4] = 0;
+#else
+    compmask[CCKD_COMPRESS_LZ4] = 8;
+#endif
 
     /*---------------------------------------------------------------
      * Header checks
@@ -1716,6 +1996,10 @@ cdsk_recovery:
                     else if (comp == CCKD_COMPRESS_BZIP2
                      && (buf[i+5] != 'B' || buf[i+6] != 'Z'))
                         continue;
+                    /* Quick validation for zstd */
+                    else if (comp == CCKD_COMPRESS_ZSTD
+                     && fetch_fw(buf + i + 5) != 0x28b52ffd)
+                        continue;
                     /*
                      * If we are in `borrowed space' then start over
                      * with the current position at the beginning
@@ -1771,6 +2055,10 @@ cdsk_recovery:
                         else if (buf[j] == CCKD_COMPRESS_BZIP2
                          && (buf[j+5] != 'B' || buf[j+6] != 'Z'))
                                 continue;
+                        /* check zstd compressed header */
+                        else if (buf[j] == CCKD_COMPRESS_ZSTD
+                         && fetch_fw(buf + j + 5) != 0x28b52ffd)
+                                continue;
 
                         /* check to possible trkhdr */
                         l = j - i;
@@ -1934,6 +2222,10 @@ cdsk_ckd_recover:
                     else if (comp == CCKD_COMPRESS_BZIP2
                      && (buf[i+5] != 'B' || buf[i+6] != 'Z'))
                         continue;
+                    /* Quick validation for zstd */
+                    else if (comp == CCKD_COMPRESS_ZSTD
+                     && fetch_fw(buf + i + 5) != 0x28b52ffd)
+                        continue;
                     /*
                      * If we are in `borrowed space' then start over
                      * with the current position at the beginning
@@ -1994,6 +2286,10 @@ cdsk_ckd_recover:
                         else if (buf[j] == CCKD_COMPRESS_BZIP2
                          && (buf[j+5] != 'B' || buf[j+6] != 'Z'))
                                 continue;
+                        /* check zstd compressed header */
+                        else if (buf[j] == CCKD_COMPRESS_ZSTD
+                         && fetch_fw(buf + j + 5) != 0x28b52ffd)
+                                continue;
 
                         /* check to possible trkhdr */
                         l = j - i;
@@ -2591,6 +2887,9 @@ unsigned int    bz2len;
 #endif
 #if defined(HAVE_LIBZ) || defined(CCKD_BZIP2)
 int             rc;                     /* Return code               */
+#endif
+#if defined(HAVE_LIBZ) || defined(CCKD_BZIP2) \
+ || defined(CCKD_ZSTD) || defined(CCKD_LZ4)
 BYTE            buf2[65536];            /* Uncompressed buffer       */
 #endif
 
@@ -2636,6 +2935,21 @@ BYTE            buf2[65536];            /* Uncompressed buffer       */
         break;
 #endif
 
+#if defined(CCKD_ZSTD) || defined(CCKD_LZ4)
+#ifdef CCKD_ZSTD
+    case CCKD_COMPRESS_ZSTD:
+#endif
+#ifdef CCKD_LZ4
+    case CCKD_COMPRESS_LZ4:
+#endif
+        if (len < 0) return 0;
+        bufp = (BYTE *)buf2;
+        bufl = cckd_uncompress_trkimg (NULL, buf2, buf, len, sizeof(buf2));
+        if (bufl < 0)
+            return 0;
+        break;
+#endif
+
     default:
         return 0;
 
@@ -34,6 +34,10 @@
 
 void  call_execute_ccw_chain(int arch_mode, void* pDevBlk);
 
+#if !defined(OPTION_FISHIO)
+static int devtq_remove (DEVBLK *dev);
+#endif // !defined(OPTION_FISHIO)
+
 #ifdef OPTION_IODELAY_KLUDGE
 #define IODELAY(_dev) \
 do { \
@@ -323,9 +327,7 @@ IOINT *ioint=NULL;
     /* Update interrupt status */
     if(ioint)
     {
-        OBTAIN_INTLOCK(regs);
-        UPDATE_IC_IOPENDING();
-        RELEASE_INTLOCK(regs);
+        POST_IC_IOPENDING(regs);
     }
 
     /* Return the condition code */
@@ -433,9 +435,7 @@ int      pending = 0;                   /* New interrupt pending     */
     /* Update interrupt status */
     if (pending)
     {
-        OBTAIN_INTLOCK(regs);
-        UPDATE_IC_IOPENDING();
-        RELEASE_INTLOCK(regs);
+        POST_IC_IOPENDING(regs);
     }
 
     /* Return the condition code */
@@ -482,50 +482,25 @@ int     cc;                             /* Condition code            */
     {
         cc = 2;
 #if !defined(OPTION_FISHIO)
-        obtain_lock(&sysblk.ioqlock);
-        if(sysblk.ioq != NULL)
+        /* Remove device from the i/o queue */
+        if (devtq_remove(dev))
         {
-         DEVBLK *tmp;
+            cc = 0;
 
-            /* special case for head of queue */
-            if(sysblk.ioq == dev)
-            {
-                /* Remove device from the i/o queue */
-                sysblk.ioq = dev->nextioq;
-                cc = 0;
-            }
-            else
+            /* Terminate suspended channel program */
+            if (dev->scsw.flag3 & SCSW3_AC_SUSP)
             {
-                /* Search for device on i/o queue */
-                for(tmp = sysblk.ioq; tmp->nextioq != NULL && tmp->nextioq != dev; tmp = tmp->nextioq);
-                /* Remove from queue if found */
-                if(tmp->nextioq == dev)
-                {
-                    tmp->nextioq = tmp->nextioq->nextioq;
-                    cc = 0;
-                }
+                dev->suspended = 0;
+                signal_condition (&dev->resumecond);
             }
 
-            /* Reset the device */
-            if(!cc)
-            {
-                /* Terminate suspended channel program */
-                if (dev->scsw.flag3 & SCSW3_AC_SUSP)
-                {
-                    dev->suspended = 0;
-                    signal_condition (&dev->resumecond);
-                }
-
-                /* Reset the scsw */
-                dev->scsw.flag2 &= ~(SCSW2_AC_RESUM | SCSW2_FC_START | SCSW2_AC_START);
-                dev->scsw.flag3 &= ~(SCSW3_AC_SUSP);
-
-                /* Reset the device busy indicator */
-                dev->busy = dev->startpending = 0;
+            /* Reset the scsw */
+            dev->scsw.flag2 &= ~(SCSW2_AC_RESUM | SCSW2_FC_START | SCSW2_AC_START);
+            dev->scsw.flag3 &= ~(SCSW3_AC_SUSP);
 
-            }
+            /* Reset the device busy indicator */
+            dev->busy = dev->startpending = 0;
         }
-        release_lock(&sysblk.ioqlock);
 #endif /*!defined(OPTION_FISHIO)*/
     }
 
@@ -608,9 +583,7 @@ int     cc;                             /* Condition code            */
         release_lock (&dev->lock);
 
         /* Update interrupt status */
-        OBTAIN_INTLOCK(regs);
-        UPDATE_IC_IOPENDING();
-        RELEASE_INTLOCK(regs);
+        POST_IC_IOPENDING(regs);
 
         /* Return condition code 0 to indicate status was pending */
         return 0;
@@ -735,9 +708,7 @@ int     cc;                             /* Condition code            */
             release_lock (&dev->lock);
 
             /* Update interrupt status */
-            OBTAIN_INTLOCK(regs);
-            UPDATE_IC_IOPENDING();
-            RELEASE_INTLOCK(regs);
+            POST_IC_IOPENDING(regs);
 
             /* Signal console thread to redrive select */
             if (dev->console)
@@ -761,9 +732,7 @@ int     cc;                             /* Condition code            */
     release_lock (&dev->lock);
 
     /* Update interrupt status */
-    OBTAIN_INTLOCK(regs);
-    UPDATE_IC_IOPENDING();
-    RELEASE_INTLOCK(regs);
+    POST_IC_IOPENDING(regs);
 
     /* Signal console thread to redrive select */
     if (dev->console)
@@ -870,9 +839,7 @@ int pending = 0;
     /* Update interrupt status */
     if (pending)
     {
-        OBTAIN_INTLOCK(regs);
-        UPDATE_IC_IOPENDING();
-        RELEASE_INTLOCK(regs);
+        POST_IC_IOPENDING(regs);
     }
 
 } /* end function clear_subchan */
@@ -952,21 +919,9 @@ int pending = 0;
 
 #if !defined(OPTION_FISHIO)
         /* Remove the device from the ioq if startpending */
-        obtain_lock(&sysblk.ioqlock);
         if(dev->startpending)
-        {
-            if(sysblk.ioq == dev)
-                sysblk.ioq = dev->nextioq;
-            else if ( sysblk.ioq != NULL )      /* add check for empty IOQ */
-            {
-             DEVBLK *tmp;
-                for(tmp = sysblk.ioq; tmp->nextioq != NULL && tmp->nextioq != dev; tmp = tmp->nextioq);
-                if(tmp->nextioq == dev)
-                    tmp->nextioq = tmp->nextioq->nextioq;
-            }
-        }
+            devtq_remove(dev);
         dev->startpending = 0;
-        release_lock(&sysblk.ioqlock);
 #endif /*!defined(OPTION_FISHIO)*/
 
         /* Invoke the provided halt_device routine @ISW */
@@ -1016,9 +971,7 @@ int pending = 0;
     /* Update interrupt status */
     if (pending)
     {
-        OBTAIN_INTLOCK(regs);
-        UPDATE_IC_IOPENDING();
-        RELEASE_INTLOCK(regs);
+        POST_IC_IOPENDING(regs);
     }
 
     if (dev->ccwtrace || dev->ccwstep)
@@ -1309,6 +1262,153 @@ void adjust_thread_priority(int *newprio)
     SETMODE(USER);
 }
 
+/*-------------------------------------------------------------------*/
+/* Device thread I/O queues                                          */
+/*                                                                   */
+/* Start requests are queued on one of MAX_DEVICE_THREAD_QUEUES      */
+/* queues, chosen by the device's first channel path, so that the    */
+/* I/O for a channel path tends to be run by the same threads.  Each */
+/* device thread is homed on one queue: it takes requests from its   */
+/* home queue first and steals them from the other queues when its   */
+/* own queue is empty.  An idle thread waits on its own condition on */
+/* its home queue's idle list, so that each new request wakes at     */
+/* most one thread.  sysblk.ioqlock only serializes the thread count.*/
+/*-------------------------------------------------------------------*/
+struct DEVTW {                          /* Idle device thread        */
+        struct DEVTW *next;             /* -> next idle thread       */
+        COND    cond;                   /* Wakeup condition          */
+        int     signalled;              /* 1=Woken for a request     */
+};
+
+/*-------------------------------------------------------------------*/
+/* Wake one idle thread homed on a queue; queue lock must be held    */
+/*-------------------------------------------------------------------*/
+static int devtq_signal (DEVTQ *q)
+{
+struct DEVTW *w;                        /* -> Idle thread            */
+
+    if ((w = q->idleq) == NULL)
+        return 0;
+
+    q->idleq = w->next;
+    q->idle--;
+    w->signalled = 1;
+    signal_condition (&w->cond);
+    return 1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Queue a start request for execution by a device thread            */
+/*-------------------------------------------------------------------*/
+static int devtq_enqueue (DEVBLK *dev)
+{
+DEVTQ  *q;                              /* -> I/O queue              */
+DEVBLK *previoq, *ioq;                  /* Device I/O queue pointers */
+int     i, n;                           /* Queue indexes             */
+int     rc;                             /* Return code               */
+
+    n = dev->pmcw.chpid[0] % MAX_DEVICE_THREAD_QUEUES;
+    q = &sysblk.devtq[n];
+
+    obtain_lock (&q->lock);
+
+    /* Insert the device into the I/O queue */
+    for (previoq = NULL, ioq = q->ioq; ioq; ioq = ioq->nextioq)
+    {
+        if (dev->priority < ioq->priority) break;
+        previoq = ioq;
+    }
+    dev->nextioq = ioq;
+    if (previoq) previoq->nextioq = dev;
+    else q->ioq = dev;
+    dev->devtqix = n;
+
+    q->queued++;
+    if (++q->depth > q->hwm)
+        q->hwm = q->depth;
+
+    /* Signal a device thread homed on this queue if one is waiting */
+    rc = devtq_signal (q);
+
+    release_lock (&q->lock);
+
+    /* Otherwise signal a thread waiting on another queue to steal
+       the request */
+    for (i = 1; !rc && i < MAX_DEVICE_THREAD_QUEUES; i++)
+    {
+        q = &sysblk.devtq[(n + i) % MAX_DEVICE_THREAD_QUEUES];
+        if (q->idleq == NULL)
+            continue;
+        obtain_lock (&q->lock);
+        rc = devtq_signal (q);
+        release_lock (&q->lock);
+    }
+    if (rc)
+        return 0;
+
+    /* Otherwise create a device thread if the maximum number
+       hasn't been created */
+    obtain_lock (&sysblk.ioqlock);
+    if (sysblk.devtmax == 0 || sysblk.devtnbr < sysblk.devtmax)
+    {
+        rc = create_thread (&dev->tid, DETACHED,
+                    device_thread, NULL, "idle device thread");
+        if (rc != 0 && sysblk.devtnbr != 0)
+            rc = 0;
+    }
+    else
+        sysblk.devtunavail++;
+    release_lock (&sysblk.ioqlock);
+
+    return rc;
+}
+
+/*-------------------------------------------------------------------*/
+/* Remove a device from its I/O queue; returns 1 if it was queued    */
+/*-------------------------------------------------------------------*/
+static int devtq_remove (DEVBLK *dev)
+{
+DEVTQ  *q = &sysblk.devtq[dev->devtqix];
+DEVBLK *tmp;
+int     found = 0;
+
+    obtain_lock (&q->lock);
+    if (q->ioq == dev)
+    {
+        q->ioq = dev->nextioq;
+        found = 1;
+    }
+    else if (q->ioq != NULL)
+    {
+        for (tmp = q->ioq; tmp->nextioq != NULL && tmp->nextioq != dev; tmp = tmp->nextioq);
+        if (tmp->nextioq == dev)
+        {
+            tmp->nextioq = dev->nextioq;
+            found = 1;
+        }
+    }
+    if (found)
+        q->depth--;
+    release_lock (&q->lock);
+
+    return found;
+}
+
+/*-------------------------------------------------------------------*/
+/* Wake all idle device threads, e.g. so that they can terminate     */
+/*-------------------------------------------------------------------*/
+void device_thread_wakeup (void)
+{
+int     i;
+
+    for (i = 0; i < MAX_DEVICE_THREAD_QUEUES; i++)
+    {
+        obtain_lock (&sysblk.devtq[i].lock);
+        while (devtq_signal (&sysblk.devtq[i]));
+        release_lock (&sysblk.devtq[i].lock);
+    }
+}
+
 /*-------------------------------------------------------------------*/
 /* Execute a queued I/O                                              */
 /*-------------------------------------------------------------------*/
@@ -1316,29 +1416,66 @@ void *device_thread (void *arg)
 {
 char    thread_name[32];
 DEVBLK *dev;
+DEVTQ  *home;                           /* -> Home I/O queue         */
+DEVTQ  *q;                              /* -> I/O queue              */
+struct DEVTW idle, **pw;                /* Idle wait element         */
 int     current_priority;               /* Current thread priority   */
+int     i, n;                           /* Queue indexes             */
+int     nidle;                          /* Number of idle threads    */
+int     busy;                           /* 1=Request queued          */
+int     timeout = 0;                    /* 1=Idle wait timed out     */
 
     UNREFERENCED(arg);
 
+#if defined(OPTION_CPU_AFFINITY)
+    /* Keep off the host CPUs of the CPU thread which started us */
+    bind_thread_affinity(-1);
+#endif /*defined(OPTION_CPU_AFFINITY)*/
+
     adjust_thread_priority(&sysblk.devprio);
     current_priority = getpriority(PRIO_PROCESS, 0);
 
+    initialize_condition (&idle.cond);
+
     obtain_lock(&sysblk.ioqlock);
 
     sysblk.devtnbr++;
     if (sysblk.devtnbr > sysblk.devthwm)
         sysblk.devthwm = sysblk.devtnbr;
+    n = sysblk.devtnext++ % MAX_DEVICE_THREAD_QUEUES;
+    home = &sysblk.devtq[n];
+
+    release_lock (&sysblk.ioqlock);
 
     while (1)
     {
-        while ((dev=sysblk.ioq) != NULL)
+        /* Take a request from the home queue, or steal one from
+           the other queues if the home queue is empty */
+        for (dev = NULL, i = 0; !dev && i < MAX_DEVICE_THREAD_QUEUES; i++)
+        {
+            q = &sysblk.devtq[(n + i) % MAX_DEVICE_THREAD_QUEUES];
+            if (q->ioq == NULL)
+                continue;
+            obtain_lock (&q->lock);
+            if ((dev = q->ioq) != NULL)
+            {
+                q->ioq = dev->nextioq;
+                q->depth--;
+                if (q == home)
+                    q->executed++;
+                else
+                    q->stolen++;
+            }
+            release_lock (&q->lock);
+        }
+
+        if (dev)
         {
             snprintf ( thread_name, sizeof(thread_name),
                 "device %4.4X thread", dev->devnum );
             thread_name[sizeof(thread_name)-1]=0;
             SET_THREAD_NAME(thread_name);
 
-            sysblk.ioq = dev->nextioq;
             dev->tid = thread_id();
 
             /* Set priority to requested device priority */
@@ -1346,29 +1483,65 @@ int     current_priority;               /* Current thread priority   */
                 adjust_thread_priority(&dev->devprio);
             current_priority = dev->devprio;
 
-            release_lock (&sysblk.ioqlock);
-
             call_execute_ccw_chain(sysblk.arch_mode, dev);
 
-            obtain_lock(&sysblk.ioqlock);
             dev->tid = 0;
+            timeout = 0;
+            continue;
         }
 
         SET_THREAD_NAME("idle device thread");
 
+        for (nidle = i = 0; i < MAX_DEVICE_THREAD_QUEUES; i++)
+            nidle += sysblk.devtq[i].idle;
+
         if (sysblk.devtmax < 0
-         || (sysblk.devtmax == 0 && sysblk.devtwait > 3)
+         || (sysblk.devtmax == 0 && nidle >= MAX_DEVICE_THREAD_QUEUES)
          || (sysblk.devtmax >  0 && sysblk.devtnbr > sysblk.devtmax)
-         || (sysblk.shutdown))
+         || (sysblk.shutdown)
+         || (timeout))
             break;
 
+        /* Join the idle list of the home queue */
+        obtain_lock (&home->lock);
+        idle.signalled = 0;
+        idle.next = home->idleq;
+        home->idleq = &idle;
+        home->idle++;
+        release_lock (&home->lock);
+
+        /* Look at the queues again: a request queued before we
+           joined the idle list did not signal us */
+        for (busy = i = 0; !busy && i < MAX_DEVICE_THREAD_QUEUES; i++)
+        {
+            obtain_lock (&sysblk.devtq[i].lock);
+            busy = (sysblk.devtq[i].ioq != NULL);
+            release_lock (&sysblk.devtq[i].lock);
+        }
+
         /* Wait for work to arrive */
-        sysblk.devtwait++;
-        wait_condition (&sysblk.ioqcond, &sysblk.ioqlock);
+        obtain_lock (&home->lock);
+        while (!busy && !idle.signalled && !timeout)
+            timeout = timed_wait_condition_relative_usecs (&idle.cond,
+                        &home->lock, MAX_DEVICE_THREAD_IDLE_SECS * 1000000,
+                        NULL) == ETIMEDOUT;
+        if (!idle.signalled)
+        {
+            /* Leave the idle list */
+            for (pw = &home->idleq; *pw != &idle; pw = &(*pw)->next);
+            *pw = idle.next;
+            home->idle--;
+        }
+        else
+            timeout = 0;
+        release_lock (&home->lock);
     }
 
+    obtain_lock (&sysblk.ioqlock);
     sysblk.devtnbr--;
     release_lock (&sysblk.ioqlock);
+
+    destroy_condition (&idle.cond);
     return NULL;
 
 } /* end function device_thread */
@@ -1434,9 +1607,7 @@ static void ARCH_DEP(raise_pci) (
     release_lock (&dev->lock);
 
     /* Update interrupt status */
-    OBTAIN_INTLOCK(devregs(dev));
-    UPDATE_IC_IOPENDING();
-    RELEASE_INTLOCK(devregs(dev));
+    POST_IC_IOPENDING(devregs(dev));
 
 } /* end function raise_pci */
 
@@ -2130,9 +2301,7 @@ DLL_EXPORT int ARCH_DEP(device_attention) (DEVBLK *dev, BYTE unitstat)
     release_lock (&dev->lock);
 
     /* Update interrupt status */
-    OBTAIN_INTLOCK(devregs(dev));
-    UPDATE_IC_IOPENDING();
-    RELEASE_INTLOCK(devregs(dev));
+    POST_IC_IOPENDING(devregs(dev));
 
     return 0;
 } /* end function device_attention */
@@ -2157,10 +2326,6 @@ DLL_EXPORT int ARCH_DEP(device_attention) (DEVBLK *dev, BYTE unitstat)
 int ARCH_DEP(startio) (REGS *regs, DEVBLK *dev, ORB *orb)      /*@IWZ*/
 {
 int     syncio;                         /* 1=Do synchronous I/O      */
-#if !defined(OPTION_FISHIO)
-int     rc;                             /* Return code               */
-DEVBLK *previoq, *ioq;                  /* Device I/O queue pointers */
-#endif // !defined(OPTION_FISHIO)
 
     obtain_lock (&dev->lock);
 
@@ -2300,43 +2465,14 @@ DEVBLK *previoq, *ioq;                  /* Device I/O queue pointers */
 #else // !defined(OPTION_FISHIO)
     if (sysblk.devtmax >= 0)
     {
-        /* Queue the I/O request */
-        obtain_lock (&sysblk.ioqlock);
-
-        /* Insert the device into the I/O queue */
-        for (previoq = NULL, ioq = sysblk.ioq; ioq; ioq = ioq->nextioq)
-        {
-            if (dev->priority < ioq->priority) break;
-            previoq = ioq;
-        }
-        dev->nextioq = ioq;
-        if (previoq) previoq->nextioq = dev;
-        else sysblk.ioq = dev;
-
-        /* Signal a device thread if one is waiting, otherwise create
-           a device thread if the maximum number hasn't been created */
-        if (sysblk.devtwait)
-        {
-            sysblk.devtwait--;
-            signal_condition(&sysblk.ioqcond);
-        }
-        else if (sysblk.devtmax == 0 || sysblk.devtnbr < sysblk.devtmax)
+        /* Queue the I/O request for a device thread */
+        if (devtq_enqueue (dev) != 0)
         {
-            rc = create_thread (&dev->tid, DETACHED,
-                        device_thread, NULL, "idle device thread");
-            if (rc != 0 && sysblk.devtnbr == 0)
-            {
-                logmsg (_("HHCCP067E %4.4X create_thread error: %s"),
-                        dev->devnum, strerror(errno));
-                release_lock (&sysblk.ioqlock);
-                release_lock (&dev->lock);
-                return 2;
-            }
+            logmsg (_("HHCCP067E %4.4X create_thread error: %s"),
+                    dev->devnum, strerror(errno));
+            release_lock (&dev->lock);
+            return 2;
         }
-        else
-            sysblk.devtunavail++;
-
-        release_lock (&sysblk.ioqlock);
     }
     else
     {
@@ -2538,9 +2674,7 @@ int     cmdretry = 255;                 /* Limit command retry       */
         release_lock (&dev->lock);
 
         /* Update interrupt status */
-        OBTAIN_INTLOCK(devregs(dev));
-        UPDATE_IC_IOPENDING();
-        RELEASE_INTLOCK(devregs(dev));
+        POST_IC_IOPENDING(devregs(dev));
 
         if (dev->ccwtrace || dev->ccwstep || tracethis)
             logmsg (_("HHCCP069I Device %4.4X initial status interrupt\n"),
@@ -2580,9 +2714,7 @@ int     cmdretry = 255;                 /* Limit command retry       */
             release_lock (&dev->lock);
 
             /* Update interrupt status */
-            OBTAIN_INTLOCK(devregs(dev));
-            UPDATE_IC_IOPENDING();
-            RELEASE_INTLOCK(devregs(dev));
+            POST_IC_IOPENDING(devregs(dev));
 
             if (dev->ccwtrace || dev->ccwstep || tracethis)
                 logmsg (_("HHCCP070I Device %4.4X attention completed\n"),
@@ -2651,9 +2783,7 @@ int     cmdretry = 255;                 /* Limit command retry       */
             release_lock (&dev->lock);
 
             /* Update interrupt status */
-            OBTAIN_INTLOCK(devregs(dev));
-            UPDATE_IC_IOPENDING();
-            RELEASE_INTLOCK(devregs(dev));
+            POST_IC_IOPENDING(devregs(dev));
 
             if (dev->ccwtrace || dev->ccwstep || tracethis)
                 logmsg (_("HHCCP071I Device %4.4X clear completed\n"),
@@ -2711,9 +2841,7 @@ int     cmdretry = 255;                 /* Limit command retry       */
             release_lock (&dev->lock);
 
             /* Update interrupt status */
-            OBTAIN_INTLOCK(devregs(dev));
-            UPDATE_IC_IOPENDING();
-            RELEASE_INTLOCK(devregs(dev));
+            POST_IC_IOPENDING(devregs(dev));
 
             if (dev->ccwtrace || dev->ccwstep || tracethis)
                 logmsg (_("HHCCP072I Device %4.4X halt completed\n"),
@@ -2876,9 +3004,7 @@ int     cmdretry = 255;                 /* Limit command retry       */
 
                     /* Update interrupt status */
                     release_lock (&dev->lock);
-                    OBTAIN_INTLOCK(devregs(dev));
-                    UPDATE_IC_IOPENDING();
-                    RELEASE_INTLOCK(devregs(dev));
+                    POST_IC_IOPENDING(devregs(dev));
                     obtain_lock (&dev->lock);
                 }
 
@@ -3316,10 +3442,15 @@ resume_suspend:
     release_lock (&dev->lock);
 
     /* Present the interrupt */
-    OBTAIN_INTLOCK(devregs(dev));
-    if (dev->regs) dev->regs->hostregs->syncio = 0;
-    UPDATE_IC_IOPENDING();
-    RELEASE_INTLOCK(devregs(dev));
+    if (dev->regs)
+    {
+        OBTAIN_INTLOCK(devregs(dev));
+        dev->regs->hostregs->syncio = 0;
+        UPDATE_IC_IOPENDING();
+        RELEASE_INTLOCK(devregs(dev));
+    }
+    else
+        POST_IC_IOPENDING(devregs(dev));
 
     return NULL;
 
@@ -3497,7 +3628,7 @@ retry:
         }
 
         /* See if another CPU can take this interrupt */
-        WAKEUP_CPU_MASK (sysblk.waiting_mask);
+        WAKEUP_ENABLED_CPU (BIT(IC_IO));
 
     } /* end for(io) */
 
@@ -195,6 +195,93 @@
 /*-------------------------------------------------------------------*/
 static  BYTE eighthexFF[] = {0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xff};
 
+#if defined(OPTION_DASD_MMAP)
+/*-------------------------------------------------------------------*/
+/* Map the CKD image files                                           */
+/*                                                                   */
+/* With the mmap option track images are accessed in place in the    */
+/* host page cache instead of being read into a device cache buffer. */
+/* If any file cannot be mapped the device uses read and write.      */
+/*-------------------------------------------------------------------*/
+static void ckddasd_munmap (DEVBLK *dev);
+static int ckddasd_mmap (DEVBLK *dev)
+{
+int             i;                      /* File index                */
+int             prot;                   /* Protection                */
+off_t           len;                    /* File length               */
+
+    /* Map read only unless every file is open for writing */
+    dev->dasdmapro = dev->ckdrdonly;
+    for (i = 0; i < dev->ckdnumfd; i++)
+        if ((fcntl (dev->ckdfd[i], F_GETFL) & O_ACCMODE) == O_RDONLY)
+            dev->dasdmapro = 1;
+    prot = dev->dasdmapro ? PROT_READ : PROT_READ | PROT_WRITE;
+
+    for (i = 0; i < dev->ckdnumfd; i++)
+    {
+        len = CKDDASD_DEVHDR_SIZE + (off_t)dev->ckdtrksz
+            * (dev->ckdhitrk[i] - (i ? dev->ckdhitrk[i-1] : 0));
+        if ((off_t)(size_t)len != len)
+        {
+            logmsg (_("HHCDA084W %s file %d too large to map\n"),
+                    dev->filename, i + 1);
+            ckddasd_munmap (dev);
+            return -1;
+        }
+        dev->dasdmap[i] = mmap (NULL, (size_t)len, prot, MAP_SHARED,
+                                dev->ckdfd[i], 0);
+        if (dev->dasdmap[i] == MAP_FAILED)
+        {
+            logmsg (_("HHCDA085W %s file %d mmap error: %s\n"),
+                    dev->filename, i + 1, strerror(errno));
+            dev->dasdmap[i] = NULL;
+            ckddasd_munmap (dev);
+            return -1;
+        }
+        dev->dasdmaplen[i] = (size_t)len;
+    }
+
+    dev->dasdmmap = 1;
+    logmsg (_("HHCDA086I %s mapped%s%s\n"), dev->filename,
+            dev->dasdmapro ? " readonly" : "",
+            dev->dasdmapseq ? " with sequential advice" : "");
+    return 0;
+} /* end function ckddasd_mmap */
+
+/*-------------------------------------------------------------------*/
+/* Unmap the CKD image files                                         */
+/*-------------------------------------------------------------------*/
+static void ckddasd_munmap (DEVBLK *dev)
+{
+int             i;                      /* File index                */
+
+    for (i = 0; i < dev->ckdnumfd; i++)
+    {
+        if (dev->dasdmap[i] == NULL)
+            continue;
+        if (!dev->dasdmapro)
+            msync (dev->dasdmap[i], dev->dasdmaplen[i], MS_SYNC);
+        munmap (dev->dasdmap[i], dev->dasdmaplen[i]);
+        dev->dasdmap[i] = NULL;
+        dev->dasdmaplen[i] = 0;
+    }
+    dev->dasdmapadv = NULL;
+    dev->dasdmapadvlen = 0;
+    dev->dasdmmap = 0;
+} /* end function ckddasd_munmap */
+
+/*-------------------------------------------------------------------*/
+/* Schedule write back of part of a mapped track image               */
+/*-------------------------------------------------------------------*/
+static int ckddasd_msync (BYTE *addr, int len)
+{
+BYTE           *page;                   /* -> Containing page        */
+
+    page = (BYTE *)((uintptr_t)addr & ~((uintptr_t)getpagesize() - 1));
+    return msync (page, len + (addr - page), MS_ASYNC);
+} /* end function ckddasd_msync */
+#endif /*defined(OPTION_DASD_MMAP)*/
+
 /*-------------------------------------------------------------------*/
 /* Initialize the device handler                                     */
 /*-------------------------------------------------------------------*/
@@ -256,6 +343,11 @@ char            pathname[MAX_PATH];     /* file path in host format  */
     /* No active track or cache entry */
     dev->bufcur = dev->cache = -1;
 
+#if defined(OPTION_DASD_MMAP)
+    /* Image files are not mapped unless requested */
+    dev->dasdmmap = dev->dasdmapseq = 0;
+#endif /*defined(OPTION_DASD_MMAP)*/
+
     /* Locate and save the last character of the file name */
     sfxptr = strrchr (dev->filename, '/');
     if (sfxptr == NULL) sfxptr = dev->filename + 1;
@@ -343,6 +435,19 @@ char            pathname[MAX_PATH];     /* file path in host format  */
             dev->syncio = 1;
             continue;
         }
+#if defined(OPTION_DASD_MMAP)
+        if (strcasecmp ("mmap", argv[i]) == 0)
+        {
+            dev->dasdmmap = 1;
+            continue;
+        }
+        if (strcasecmp ("mmapseq", argv[i]) == 0)
+        {
+            dev->dasdmmap = 1;
+            dev->dasdmapseq = 1;
+            continue;
+        }
+#endif /*defined(OPTION_DASD_MMAP)*/
 
         logmsg (_("HHCDA003E parameter %d is invalid: %s\n"),
                 i + 1, argv[i]);
@@ -631,6 +736,19 @@ char            pathname[MAX_PATH];     /* file path in host format  */
        a single buffer before passing data to the device handler */
     dev->cdwmerge = 1;
 
+#if defined(OPTION_DASD_MMAP)
+    /* Map the image files if requested */
+    if (dev->dasdmmap)
+    {
+        dev->dasdmmap = 0;
+        if (cckd)
+            logmsg (_("HHCDA083W %s mmap ignored for compressed dasd\n"),
+                    dev->filename);
+        else if (dev->dasdcopy == 0)
+            ckddasd_mmap (dev);
+    }
+#endif /*defined(OPTION_DASD_MMAP)*/
+
     if (!cckd) return 0;
     else return cckddasd_init_handler(dev, argc, argv);
 
@@ -690,6 +808,12 @@ BYTE    unitstat;                       /* Unit Status               */
                 dev->devnum, dev->cachehits, dev->cachemisses,
                 dev->cachewaits);
 
+#if defined(OPTION_DASD_MMAP)
+    /* Unmap the CKD image files */
+    if (dev->dasdmmap)
+        ckddasd_munmap (dev);
+#endif /*defined(OPTION_DASD_MMAP)*/
+
     /* Close all of the CKD image files */
     for (i = 0; i < dev->ckdnumfd; i++)
         if (dev->ckdfd[i] > 2)
@@ -755,6 +879,93 @@ int             sz;                     /* Size so far               */
     return sz;
 }
 
+#if defined(OPTION_DASD_MMAP)
+/*-------------------------------------------------------------------*/
+/* Read a track image from a mapped CKD image file                   */
+/*-------------------------------------------------------------------*/
+static
+int ckddasd_read_mapped_track (DEVBLK *dev, int trk, BYTE *unitstat)
+{
+int             cyl;                    /* Cylinder                  */
+int             head;                   /* Head                      */
+int             f;                      /* File index                */
+CKDDASD_TRKHDR *trkhdr;                 /* -> New track header       */
+
+    /* Write back the previous track image if modified */
+    if (dev->bufupd)
+    {
+        logdevtr (dev, _("HHCDA025I read track: updating track %d\n"),
+                  dev->bufcur);
+
+        dev->bufupd = 0;
+
+        if (ckddasd_msync (dev->buf + dev->bufupdlo,
+                           dev->bufupdhi - dev->bufupdlo) < 0)
+        {
+            logmsg (_("HHCDA087E error writing trk %d: msync error: %s\n"),
+                    dev->bufcur, strerror(errno));
+            ckd_build_sense (dev, SENSE_EC, 0, 0,
+                            FORMAT_1, MESSAGE_0);
+            *unitstat = CSW_CE | CSW_DE | CSW_UC;
+            dev->bufupdlo = dev->bufupdhi = 0;
+            dev->bufcur = -1;
+            return -1;
+        }
+
+        dev->bufupdlo = dev->bufupdhi = 0;
+    }
+
+    dev->bufcur = -1;
+
+    /* Return on special case when called by the close handler */
+    if (trk < 0)
+        return 0;
+
+    /* Calculate cylinder and head */
+    cyl = trk / dev->ckdheads;
+    head = trk % dev->ckdheads;
+
+    /* Set the file descriptor */
+    for (f = 0; f < dev->ckdnumfd; f++)
+        if (trk < dev->ckdhitrk[f]) break;
+    dev->fd = dev->ckdfd[f];
+
+    /* Calculate the track offset */
+    dev->ckdtrkoff = CKDDASD_DEVHDR_SIZE +
+         (off_t)(trk - (f ? dev->ckdhitrk[f-1] : 0)) * dev->ckdtrksz;
+
+    logdevtr (dev, _("HHCDA031I read trk %d reading file %d offset %" I64_FMT "d len %d\n"),
+              trk, f+1, (long long)dev->ckdtrkoff, dev->ckdtrksz);
+
+    /* The track image is used where it is mapped */
+    dev->buf = dev->dasdmap[f] + dev->ckdtrkoff;
+
+    /* Validate the track header */
+    trkhdr = (CKDDASD_TRKHDR *)dev->buf;
+    if (trkhdr->bin != 0
+      || trkhdr->cyl[0] != (cyl >> 8)
+      || trkhdr->cyl[1] != (cyl & 0xFF)
+      || trkhdr->head[0] != (head >> 8)
+      || trkhdr->head[1] != (head & 0xFF))
+    {
+        logmsg (_("HHCDA035E %4.4X invalid track header for cyl %d head %d "
+                " %2.2x%2.2x%2.2x%2.2x%2.2x\n"), dev->devnum, cyl, head,
+                trkhdr->bin,trkhdr->cyl[0],trkhdr->cyl[1],trkhdr->head[0],trkhdr->head[1]);
+        ckd_build_sense (dev, 0, SENSE1_ITF, 0, 0, 0);
+        *unitstat = CSW_CE | CSW_DE | CSW_UC;
+        return -1;
+    }
+
+    dev->bufcur = trk;
+    dev->bufoff = 0;
+    dev->bufoffhi = dev->ckdtrksz;
+    dev->buflen = ckd_trklen (dev, dev->buf);
+    dev->bufsize = dev->ckdtrksz;
+
+    return 0;
+} /* end function ckddasd_read_mapped_track */
+#endif /*defined(OPTION_DASD_MMAP)*/
+
 /*-------------------------------------------------------------------*/
 /* Read a track image                                                */
 /*-------------------------------------------------------------------*/
@@ -783,6 +994,12 @@ CKDDASD_TRKHDR *trkhdr;                 /* -> New track header       */
     if (trk >= 0 && trk == dev->bufcur)
         return 0;
 
+#if defined(OPTION_DASD_MMAP)
+    /* Mapped track images need no cache buffer */
+    if (dev->dasdmmap)
+        return ckddasd_read_mapped_track (dev, trk, unitstat);
+#endif /*defined(OPTION_DASD_MMAP)*/
+
     /* Turn off the synchronous I/O bit if trk overflow or trk 0 */
     active = dev->syncio_active;
     if (dev->ckdtrkof || trk <= 0)
@@ -1035,7 +1252,11 @@ int             rc;                     /* Return code               */
         return len;
 
     /* Error if opened read-only */
-    if (dev->ckdrdonly)
+    if (dev->ckdrdonly
+#if defined(OPTION_DASD_MMAP)
+     || (dev->dasdmmap && dev->dasdmapro)
+#endif /*defined(OPTION_DASD_MMAP)*/
+       )
     {
         ckd_build_sense (dev, SENSE_EC, SENSE1_WRI, 0,
                         FORMAT_1, MESSAGE_0);
@@ -1100,6 +1321,16 @@ BYTE    unitstat;                       /* Unit Status               */
 
     /* Write the last track image if it's modified */
     (dev->hnd->read) (dev, -1, &unitstat);
+
+#if defined(OPTION_DASD_MMAP) && defined(MADV_SEQUENTIAL)
+    /* Withdraw sequential advice given for a multitrack operation */
+    if (dev->dasdmapadv)
+    {
+        madvise ((void *)dev->dasdmapadv, dev->dasdmapadvlen, MADV_NORMAL);
+        dev->dasdmapadv = NULL;
+        dev->dasdmapadvlen = 0;
+    }
+#endif /*defined(OPTION_DASD_MMAP) && defined(MADV_SEQUENTIAL)*/
 }
 
 /*-------------------------------------------------------------------*/
@@ -1536,6 +1767,51 @@ int             rc;                     /* Return code               */
 } /* end function ckd_seek */
 
 
+#if defined(OPTION_DASD_MMAP) && defined(MADV_SEQUENTIAL)
+/*-------------------------------------------------------------------*/
+/* Advise sequential access for a multitrack operation               */
+/*                                                                   */
+/* The advice covers the tracks from cyl/head to the end of the      */
+/* defined extent (or of the cylinder) and is withdrawn when the     */
+/* channel program ends.                                             */
+/*-------------------------------------------------------------------*/
+static void ckd_mmap_advise (DEVBLK *dev, int cyl, int head)
+{
+int             trk;                    /* First track               */
+int             endtrk;                 /* Last track                */
+int             f;                      /* File index                */
+BYTE           *addr;                   /* -> First track            */
+BYTE           *page;                   /* -> Containing page        */
+
+    trk = cyl * dev->ckdheads + head;
+    if (dev->ckdxtdef)
+        endtrk = dev->ckdxecyl * dev->ckdheads + dev->ckdxehead;
+    else
+        endtrk = cyl * dev->ckdheads + dev->ckdheads - 1;
+
+    /* Limit the advice to the file containing the first track */
+    for (f = 0; f < dev->ckdnumfd; f++)
+        if (trk < dev->ckdhitrk[f]) break;
+    if (f >= dev->ckdnumfd)
+        return;
+    if (endtrk >= dev->ckdhitrk[f])
+        endtrk = dev->ckdhitrk[f] - 1;
+
+    addr = dev->dasdmap[f] + CKDDASD_DEVHDR_SIZE
+         + (size_t)(trk - (f ? dev->ckdhitrk[f-1] : 0)) * dev->ckdtrksz;
+    page = (BYTE *)((uintptr_t)addr & ~((uintptr_t)getpagesize() - 1));
+
+    dev->dasdmapadvlen = (addr - page)
+                       + (size_t)(endtrk - trk + 1) * dev->ckdtrksz;
+    logdevtr (dev, _("HHCDA093I mmap sequential advice trk %d-%d\n"),
+              trk, endtrk);
+    if (madvise ((void *)page, dev->dasdmapadvlen, MADV_SEQUENTIAL) == 0)
+        dev->dasdmapadv = page;
+    else
+        dev->dasdmapadvlen = 0;
+} /* end function ckd_mmap_advise */
+#endif /*defined(OPTION_DASD_MMAP) && defined(MADV_SEQUENTIAL)*/
+
 /*-------------------------------------------------------------------*/
 /* Advance to next track for multitrack operation                    */
 /*-------------------------------------------------------------------*/
@@ -1600,6 +1876,13 @@ int             head;                   /* Next head for multitrack  */
     rc = ckd_seek (dev, cyl, head, NULL, unitstat);
     if (rc < 0) return -1;
 
+#if defined(OPTION_DASD_MMAP) && defined(MADV_SEQUENTIAL)
+    /* Advise sequential access to the mapped tracks that remain
+       in the extent, or in the cylinder if no extent is defined */
+    if (dev->dasdmmap && dev->dasdmapseq && dev->dasdmapadv == NULL)
+        ckd_mmap_advise (dev, cyl, head);
+#endif /*defined(OPTION_DASD_MMAP) && defined(MADV_SEQUENTIAL)*/
+
     /* Successful return */
     return 0;
 
@@ -42,6 +42,39 @@ void csr_reset()
 }
 
 static U64 universal_tod;
+#if defined(OPTION_MONOTONIC_TOD)
+static S64 universal_base;     /* Realtime less monotonic clock (ns) */
+static U64 universal_clock(void) /* really: any clock used as a base */
+{
+    struct timespec ts;
+    S64 nsecs;
+
+    /* The monotonic clock is read through the vDSO (from the TSC
+       where the host kernel trusts it) and does not step back when
+       the host time of day is set.  It is related to the time of day
+       once, when the clock is first read */
+    if (!universal_base)
+    {
+        struct timespec rt;
+        clock_gettime (CLOCK_REALTIME, &rt);
+        clock_gettime (CLOCK_MONOTONIC, &ts);
+        universal_base = ((S64)rt.tv_sec - ts.tv_sec) * 1000000000
+                       + rt.tv_nsec - ts.tv_nsec;
+    }
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+
+    /* Nanoseconds since 00:00:00 01 Jan 1970 */
+    nsecs = (S64)ts.tv_sec * 1000000000 + ts.tv_nsec + universal_base;
+
+    /* Convert to units of 1/16 microsecond so that bits 0-7=TOD Clock
+       Epoch, bits 8-63=TOD Clock bits 0-55 */
+    universal_tod = ((U64)(nsecs / 1000000000) + SECONDS_IN_SEVENTY_YEARS)
+                  * TOD_SEC + (nsecs % 1000000000) * 2 / 125;
+
+    return universal_tod;
+}
+#else /*!defined(OPTION_MONOTONIC_TOD)*/
 static U64 universal_clock(void) /* really: any clock used as a base */
 {
     struct timeval tv;
@@ -62,6 +95,7 @@ static U64 universal_clock(void) /* really: any clock used as a base */
 
     return universal_tod;
 }
+#endif /*!defined(OPTION_MONOTONIC_TOD)*/
 
 
 /* The hercules hardware clock, based on the universal clock, but    */
@@ -342,6 +376,34 @@ int pending = 0;
 
     return pending;
 }
+
+
+/* Returns the number of hardware clock units until chk_int_timer    */
+/* will find an interval timer interrupt pending, or zero if none is */
+/* due.  The interval timer goes negative one unit after it reaches  */
+/* zero, as TOD_TO_ITIMER truncates towards zero.                    */
+U64 int_timer_due(REGS *regs)
+{
+S64 due;
+U64 wait = 0;
+
+    if(regs->old_timer >= 0)
+    {
+        due = (S64)(regs->int_timer - hw_tod) + ITIMER_TO_TOD(1) + 1;
+        if(due > 0)
+            wait = due;
+    }
+#if defined(_FEATURE_ECPSVM)
+    if(regs->ecps_vtmrpt && regs->ecps_oldtmr >= 0)
+    {
+        due = (S64)(regs->ecps_vtimer - hw_tod) + ITIMER_TO_TOD(1) + 1;
+        if(due > 0 && (!wait || (U64)due < wait))
+            wait = due;
+    }
+#endif /*defined(_FEATURE_ECPSVM)*/
+
+    return wait;
+}
 #endif /*defined(_FEATURE_INTERVAL_TIMER)*/
 
 
@@ -145,6 +145,7 @@ COMMAND ( "ptt",       PANEL+CONFIG, EXT_CMD(ptt_cmd),
      "  (no)control - control trace\n"
      "  (no)prog    - program interrupt trace\n"
      "  (no)inter   - interlock failure trace\n"
+     "  (no)ints    - interrupt posting contention trace\n"
      "  (no)sie     - sie trace\n"
      "  (no)signal  - signaling trace\n"
      "  (no)io      - io trace\n"
@@ -178,6 +179,18 @@ COMMAND ( "lparname",  PANEL+CONFIG, lparname_cmd, "set LPAR name\n", NULL )
 
 COMMAND ( "lparnum",   PANEL+CONFIG, lparnum_cmd,  "set LPAR identification number\n", NULL )
 
+#if defined(OPTION_CPU_AFFINITY)
+COMMAND ( "cpuaffinity",PANEL+CONFIG,cpuaffinity_cmd,
+  "Set or display CPU thread affinity\n",
+    "Format: \"cpuaffinity [NONE | AUTO | cpulist]\". Binds each emulated CPU\n"
+    "thread to a host CPU. AUTO gives each CPU its own host CPU (on the NUMAPOLICY\n"
+    "nodes if any) and cpulist (for example \"2-5\") names the host CPUs in CPU\n"
+    "order; CPUs beyond the list run with the other threads. The device, timer\n"
+    "and logger threads are kept off the bound host CPUs.\n"
+    "NONE (the default) leaves placement to the host. Entering the command without\n"
+    "any argument displays the host CPUs each thread may run on.\n" )
+#endif /*defined(OPTION_CPU_AFFINITY)*/
+
 #if defined(OPTION_SET_STSI_INFO)
 COMMAND ( "model",     CONFIG,       stsi_model_cmd,"Set STSI model code", NULL )
 
@@ -287,6 +300,14 @@ COMMAND ( "pr",        PANEL,        pr_cmd,        "display prefix register", N
 
 COMMAND ( "timerint",  PANEL+CONFIG, timerint_cmd,"display or set timers update interval", NULL )
 
+#if defined(OPTION_IDLE_WAIT)
+COMMAND ( "idlespin",  PANEL+CONFIG, idlespin_cmd,  "display or set CPU idle wait spin limit",
+    "Format: \"idlespin [nnnn]\" where 'nnnn' is the longest time, in\n"
+    "microseconds, that a CPU entering the wait state polls for an interrupt\n"
+    "before it goes to sleep. The limit used by each CPU adapts to how soon\n"
+    "its recent waits ended. The default is 0, which disables spinning.\n" )
+#endif
+
 COMMAND ( "clocks",    PANEL,        clocks_cmd,    "display tod clkc and cpu timer", NULL )
 
 COMMAND ( "ipending",  PANEL,        ipending_cmd,  "display pending interrupts", NULL )
@@ -308,7 +329,11 @@ COMMAND ( "v",         PANEL,        v_cmd,
 
 COMMAND ( "u",         PANEL,        u_cmd,         "disassemble storage", NULL )
 
-COMMAND ( "devtmax",   PANEL+CONFIG, devtmax_cmd,   "display or set max device threads", NULL )
+COMMAND ( "devtmax",   PANEL+CONFIG, devtmax_cmd,   "display or set max device threads",
+    "Format: \"devtmax [n]\" where n is the maximum number of device threads,\n"
+    "0 for no limit or -1 to start a new thread for each I/O.  With no operand\n"
+    "the device thread counts are displayed along with the start I/O rate since\n"
+    "the previous display and the statistics for each device thread I/O queue.\n" )
 
 COMMAND ( "k",         PANEL,        k_cmd,         "display cckd internal trace\n", NULL )
 
@@ -570,8 +595,44 @@ COMMAND ( "msghld",    PANEL,        msghld_cmd,
 
 COMMAND ( "syncio",    PANEL,        syncio_cmd,    "display syncio devices statistics", NULL )
 
-#if defined(OPTION_INSTRUCTION_COUNTING)
-COMMAND ( "icount",    PANEL,        icount_cmd,    "display individual instruction counts", NULL )
+#if defined(OPTION_INSTRUCTION_COUNTING) || defined(OPTION_INSTRUCTION_FUSION)
+COMMAND ( "icount",    PANEL,        icount_cmd,    "display individual instruction counts",
+    "Format: \"icount [clear]\". Displays the individual instruction counts\n"
+    "and the decoded and fused counts of each fusible instruction pair,\n"
+    "or resets all of them to zero if \"clear\" is specified.\n" )
+#endif
+
+#if defined(OPTION_INSTRUCTION_FUSION)
+COMMAND ( "fusion",    PANEL+CONFIG, fusion_cmd,    "display or set instruction pair fusion",
+    "Format: \"fusion [on|off]\". When on, common adjacent instruction\n"
+    "pairs (L+LTR, LA+BCT, CLI+BC, ICM+BC and LR+AR) are dispatched as a\n"
+    "single fused operation. The default is off. Use the \"icount\"\n"
+    "command to display how often each pair was decoded and fused.\n" )
+#endif
+
+#if defined(OPTION_PLO_LOCKS)
+COMMAND ( "plostat",   PANEL,        plostat_cmd,   "display perform locked operation counts",
+    "Format: \"plostat [clear]\". Displays, for each PLO function code that\n"
+    "has been used, the number of operations performed and the number of\n"
+    "times the lock selected by the program lock token was already held by\n"
+    "another CPU, or resets the counts to zero if \"clear\" is specified.\n" )
+#endif
+
+#if defined(OPTION_TIMER_LATENCY)
+COMMAND ( "timerlat",  PANEL,        timerlat_cmd,  "display timer interrupt latency histogram",
+    "Format: \"timerlat [clear]\". Displays how long after a clock comparator\n"
+    "or CPU timer event fell due the timer thread made its interrupt pending,\n"
+    "counted in power of two microsecond ranges, and how often the timer\n"
+    "thread woke up. \"clear\" resets the counts to zero.\n" )
+#endif
+
+#if defined(OPTION_IDLE_WAIT)
+COMMAND ( "idlestat",  PANEL,        idlestat_cmd,  "display CPU idle wait statistics",
+    "Format: \"idlestat [clear]\". Displays, for each CPU, how often it was\n"
+    "woken from the wait state, how often it was woken while still spinning,\n"
+    "the average and maximum time in microseconds from the wakeup being\n"
+    "posted to the CPU running again, and its current spin limit. \"clear\"\n"
+    "resets the counts to zero.\n" )
 #endif
 
 #ifdef OPTION_MIPS_COUNTING
@@ -176,6 +176,7 @@
 /* Constants                                                                  */
 /*----------------------------------------------------------------------------*/
 #define MINPROC_SIZE         32768     /* Minumum processing size             */
+#define ECSIZE               (8192 * 7)  /* Expanded index symbol cache size    */
 
 /*----------------------------------------------------------------------------*/
 /* Typedefs and prototypes                                                    */
@@ -186,7 +187,14 @@ struct cc                              /* Compress context                    */
   BYTE *cce;                           /* Character entry under investigation */
   int cr;                              /* Characters read to check #261       */
   unsigned dctsz;                      /* Dictionary size                     */
-  BYTE deadadm[8192][0x100 / 8];       /* Dead end administration             */
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  CMPSCDC *dc;                         /* Dictionary cache                    */
+  U64 dep;                             /* Pages used by current search        */
+  U64 valid;                           /* Pages compared by this instruction  */
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+  BYTE (*deadadm)[0x100 / 8];          /* Dead end administration             */
   BYTE deadend;                        /* Dead end indicator                  */
   BYTE *dest;                          /* Destination MADDR address           */
   BYTE *dict[32];                      /* Dictionary MADDR addresses          */
@@ -208,13 +216,20 @@ struct cc                              /* Compress context                    */
 
 struct ec                              /* Expand context                      */
 {
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  CMPSCDC *dc;                         /* Dictionary cache                    */
+  U32 dep;                             /* Pages used by current expansion     */
+  U32 valid;                           /* Pages compared by this instruction  */
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
   BYTE *dest;                          /* Destination MADDR page address      */
   BYTE *dict[32];                      /* Dictionary MADDR addresses          */
   GREG dictor;                         /* Dictionary origin                   */
-  BYTE ec[8192 * 7];                   /* Expanded index symbol cache         */
-  int eci[8192];                       /* Index within cache for is           */
-  int ecl[8192];                       /* Size of expanded is                 */
-  int ecwm;                            /* Water mark                          */
+  BYTE *ec;                            /* Expanded index symbol cache         */
+  int *eci;                            /* Index within cache for is           */
+  int *ecl;                            /* Size of expanded is                 */
+  int *ecwm;                           /* Water mark                          */
   REGS *iregs;                         /* Intermediate registers              */
   BYTE oc[8 * 260];                    /* Output cache                        */
   unsigned ocl;                        /* Output cache length                 */
@@ -235,15 +250,28 @@ struct ec                              /* Expand context                      */
 };
 #endif /* #ifndef NO_2ND_COMPILE */
 
+#ifndef NO_2ND_COMPILE
+static void  cmpsc_alphabet(BYTE *ec, int *eci, int *ecl, int *ecwm);
+#ifdef OPTION_CMPSC_DICT_CACHE
+static void  cmpsc_flush_cdict(CMPSCDC *dc);
+static void  cmpsc_flush_edict(CMPSCDC *dc);
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+#endif /* #ifndef NO_2ND_COMPILE */
+static BYTE *ARCH_DEP(cmpsc_cdict)(struct cc *cc, int pg);
 static void  ARCH_DEP(cmpsc_compress)(int r1, int r2, REGS *regs, REGS *iregs);
 static int   ARCH_DEP(cmpsc_compress_single_is)(struct cc *cc);
+static int   ARCH_DEP(cmpsc_dead_end)(struct cc *cc, U16 is, BYTE ch);
+static BYTE *ARCH_DEP(cmpsc_edict)(struct ec *ec, int pg);
 static void  ARCH_DEP(cmpsc_expand)(int r1, int r2, REGS *regs, REGS *iregs);
 static void  ARCH_DEP(cmpsc_expand_is)(struct ec *ec, U16 is);
 static int   ARCH_DEP(cmpsc_expand_single_is)(struct ec *ec);
+static int   ARCH_DEP(cmpsc_expanded)(struct ec *ec, U16 is);
 static BYTE *ARCH_DEP(cmpsc_fetch_cce)(struct cc *cc, unsigned index);
 static int   ARCH_DEP(cmpsc_fetch_ch)(struct cc *cc);
 static int   ARCH_DEP(cmpsc_fetch_is)(struct ec *ec, U16 *is);
 static void  ARCH_DEP(cmpsc_fetch_iss)(struct ec *ec, U16 is[8]);
+static void  ARCH_DEP(cmpsc_map_cdict)(struct cc *cc, int pg);
+static void  ARCH_DEP(cmpsc_map_edict)(struct ec *ec, int pg);
 #ifdef OPTION_CMPSC_DEBUG
 static void  cmpsc_print_cce(BYTE *cce);
 static void  cmpsc_print_ece(BYTE *ece);
@@ -442,12 +470,38 @@ DEF_INST(compression_call)
 
 /*============================================================================*/
 
+/*----------------------------------------------------------------------------*/
+/* cmpsc_cdict (compression dictionary page)                                  */
+/*----------------------------------------------------------------------------*/
+/* Pages 0-31 are the compression dictionary, pages 32-63 the second half of  */
+/* format-1 sibling descriptors in the expansion dictionary.                  */
+/*----------------------------------------------------------------------------*/
+static BYTE *ARCH_DEP(cmpsc_cdict)(struct cc *cc, int pg)
+{
+  BYTE **dict;                         /* Dictionary MADDR address            */
+
+  dict = pg < 32 ? &cc->dict[pg] : &cc->edict[pg - 32];
+  if(unlikely(!*dict))
+    ARCH_DEP(cmpsc_map_cdict)(cc, pg);
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  cc->dep |= (U64) 1 << pg;
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+  return(*dict);
+}
+
 /*----------------------------------------------------------------------------*/
 /* cmpsc_compress                                                             */
 /*----------------------------------------------------------------------------*/
 static void ARCH_DEP(cmpsc_compress)(int r1, int r2, REGS *regs, REGS *iregs)
 {
   struct cc cc;                        /* Compression context                 */
+
+#ifndef OPTION_CMPSC_DICT_CACHE
+  BYTE deadadm[8192][0x100 / 8];       /* Dead end administration             */
+#endif /* #ifndef OPTION_CMPSC_DICT_CACHE */
+
   int i;                               /* Index                               */
   U16 is;                              /* Last matched index symbol           */
   int j;                               /* Index                               */
@@ -455,7 +509,24 @@ static void ARCH_DEP(cmpsc_compress)(int r1, int r2, REGS *regs, REGS *iregs)
 
   /* Initialize compression context */
   cc.dctsz = GR0_dctsz(regs);
-  memset(cc.deadadm, 0, sizeof(cc.deadadm));
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  /* Keep the dead ends of the previous instruction for the same dictionary */
+  cc.dc = regs->cmpscdc;
+  if(unlikely(cc.dc->cdictor != GR1_dictor(iregs) || cc.dc->cgr0 != (regs->GR_L(0) & 0x0000F200)))
+  {
+    cmpsc_flush_cdict(cc.dc);
+    cc.dc->cdictor = GR1_dictor(iregs);
+    cc.dc->cgr0 = regs->GR_L(0) & 0x0000F200;
+  }
+  cc.deadadm = cc.dc->deadadm;
+  cc.dep = 0;
+  cc.valid = 0;
+#else
+  memset(deadadm, 0, sizeof(deadadm));
+  cc.deadadm = deadadm;
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
   cc.dest = NULL;
   memset(cc.dict, 0, sizeof(cc.dict));
   memset(cc.edict, 0, sizeof(cc.edict));
@@ -507,14 +578,14 @@ static void ARCH_DEP(cmpsc_compress)(int r1, int r2, REGS *regs, REGS *iregs)
       cc.cr = 1;
 
       /* Check for alphabet entry ch dead end combination */
-      if(unlikely(!(cc.src && BIT_get(cc.deadadm, is, *cc.src))))
+      if(unlikely(!(cc.src && ARCH_DEP(cmpsc_dead_end)(&cc, is, *cc.src))))
       {
         /* Get the alphabet entry and try to find a child */
         cc.cce = ARCH_DEP(cmpsc_fetch_cce)(&cc, is);
         while(ARCH_DEP(cmpsc_search_cce)(&cc, &is))
         {
           /* Check for other dead end combination */
-          if(unlikely(cc.src && BIT_get(cc.deadadm, is, *cc.src)))
+          if(unlikely(cc.src && ARCH_DEP(cmpsc_dead_end)(&cc, is, *cc.src)))
           {
 
 #ifdef OPTION_CMPSC_DEBUG
@@ -546,6 +617,11 @@ static void ARCH_DEP(cmpsc_compress)(int r1, int r2, REGS *regs, REGS *iregs)
           /* Registrate all discovered dead ends */ 
           for(j = 0; j < 0x100 / 8; j++)
             cc.deadadm[is][j] = ~cc.searchadm[0][j];
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+          cc.dc->deaddep[is] = cc.dep;
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
         }
       }
 
@@ -607,14 +683,14 @@ static int ARCH_DEP(cmpsc_compress_single_is)(struct cc *cc)
   cc->cr = 1;
 
   /* Search for child when no src and no dead end combination */
-  if(unlikely(!(cc->src && BIT_get(cc->deadadm, is, *cc->src))))
+  if(unlikely(!(cc->src && ARCH_DEP(cmpsc_dead_end)(cc, is, *cc->src))))
   {
     /* Get the alphabet entry and try to find a child */
     cc->cce = ARCH_DEP(cmpsc_fetch_cce)(cc, is);
     while(ARCH_DEP(cmpsc_search_cce)(cc, &is))
     {
       /* Check for (found cce entry + ch) dead end combination */
-      if(unlikely(cc->src && BIT_get(cc->deadadm, is, *cc->src)))
+      if(unlikely(cc->src && ARCH_DEP(cmpsc_dead_end)(cc, is, *cc->src)))
       {
 
 #ifdef OPTION_CMPSC_DEBUG
@@ -646,6 +722,11 @@ static int ARCH_DEP(cmpsc_compress_single_is)(struct cc *cc)
       /* Registrate all discovered dead ends */ 
       for(i = 0; i < 0x100 / 8; i++)
         cc->deadadm[is][i] = ~cc->searchadm[0][i];
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+      cc->dc->deaddep[is] = cc->dep;
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
     }
   }
 
@@ -663,6 +744,41 @@ static int ARCH_DEP(cmpsc_compress_single_is)(struct cc *cc)
   return(0);
 }
 
+/*----------------------------------------------------------------------------*/
+/* cmpsc_dead_end (index symbol and character combination)                    */
+/*----------------------------------------------------------------------------*/
+static int ARCH_DEP(cmpsc_dead_end)(struct cc *cc, U16 is, BYTE ch)
+{
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  int pg;                              /* Dictionary page                     */
+  U64 pages;                           /* Pages still to compare              */
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+  if(likely(!BIT_get(cc->deadadm, is, ch)))
+    return(0);
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  /* Only trust a dead end when all its pages are held in the cache */
+  if(unlikely(cc->dc->deaddep[is] & ~cc->dc->cpages))
+    return(0);
+
+  /* Compare the pages not yet used by this instruction */
+  pages = cc->dc->deaddep[is] & ~cc->valid;
+  for(pg = 0; unlikely(pages); pg++, pages >>= 1)
+  {
+    if(pages & 1)
+      ARCH_DEP(cmpsc_map_cdict)(cc, pg);
+  }
+
+  /* A changed page discards the dead end */
+  return(BIT_get(cc->deadadm, is, ch));
+#else
+  return(1);
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+}
+
 /*----------------------------------------------------------------------------*/
 /* cmpsc_fetch_cce (compression character entry)                              */
 /*----------------------------------------------------------------------------*/
@@ -672,9 +788,7 @@ static BYTE *ARCH_DEP(cmpsc_fetch_cce)(struct cc *cc, unsigned index)
   unsigned cct;                        /* Child count                         */
 
   index *= 8;
-  if(unlikely(!cc->dict[index / 0x800]))
-    cc->dict[index / 0x800] = MADDR((cc->dictor + (index / 0x800) * 0x800) & ADDRESS_MAXWRAP(cc->regs), cc->r2, cc->regs, ACCTYPE_READ, cc->regs->psw.pkey);
-  cce = &cc->dict[index / 0x800][index % 0x800];
+  cce = &ARCH_DEP(cmpsc_cdict)(cc, index / 0x800)[index % 0x800];
   ITIMER_SYNC((cc->dictor + index) & ADDRESS_MAXWRAP(cc->regs), 8 - 1, cc->regs);
 
 #ifdef OPTION_CMPSC_DEBUG
@@ -741,6 +855,61 @@ static int ARCH_DEP(cmpsc_fetch_ch)(struct cc *cc)
   return(0);
 }
 
+#ifndef NO_2ND_COMPILE
+#ifdef OPTION_CMPSC_DICT_CACHE
+/*----------------------------------------------------------------------------*/
+/* cmpsc_flush_cdict (compression dictionary cache)                           */
+/*----------------------------------------------------------------------------*/
+static void cmpsc_flush_cdict(CMPSCDC *dc)
+{
+  memset(dc->deadadm, 0, sizeof(dc->deadadm));
+  dc->cpages = 0;
+}
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+#endif /* #ifndef NO_2ND_COMPILE */
+
+/*----------------------------------------------------------------------------*/
+/* cmpsc_map_cdict (compression dictionary page)                              */
+/*----------------------------------------------------------------------------*/
+static void ARCH_DEP(cmpsc_map_cdict)(struct cc *cc, int pg)
+{
+  VADR addr;                           /* Page address                        */
+  BYTE *page;                          /* Page MADDR address                  */
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  U64 bit;                             /* Page bit                            */
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+  if(pg < 32)
+    addr = cc->dictor + pg * 0x800;
+  else
+    addr = cc->dictor + cc->dctsz + (pg - 32) * 0x800;
+  page = MADDR(addr & ADDRESS_MAXWRAP(cc->regs), cc->r2, cc->regs, ACCTYPE_READ, cc->regs->psw.pkey);
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  /* Compare with the copy, a changed dictionary discards all dead ends */
+  bit = (U64) 1 << pg;
+  if(unlikely((cc->dc->cpages & bit) && memcmp(cc->dc->cpage[pg], page, 0x800)))
+  {
+    cmpsc_flush_cdict(cc->dc);
+    memset(cc->dict, 0, sizeof(cc->dict));
+    memset(cc->edict, 0, sizeof(cc->edict));
+    cc->valid = 0;
+  }
+  if(unlikely(!(cc->dc->cpages & bit)))
+  {
+    memcpy(cc->dc->cpage[pg], page, 0x800);
+    cc->dc->cpages |= bit;
+  }
+  cc->valid |= bit;
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+  if(pg < 32)
+    cc->dict[pg] = page;
+  else
+    cc->edict[pg - 32] = page;
+}
+
 #ifndef NO_2ND_COMPILE
 #ifdef OPTION_CMPSC_DEBUG
 /*----------------------------------------------------------------------------*/
@@ -891,6 +1060,12 @@ static int ARCH_DEP(cmpsc_search_cce)(struct cc *cc, U16 *is)
   /* Initialize values */
   ccs = CCE_ccs(cc->cce);
 
+#ifdef OPTION_CMPSC_DICT_CACHE
+  /* A dead end depends on the parent and its sibling descriptors only */
+  cc->dep = (U64) 1 << (*is * 8 / 0x800);
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+
   /* Get the next character when there are children */
   if(likely(ccs))
   {
@@ -976,6 +1151,11 @@ static int ARCH_DEP(cmpsc_search_cce)(struct cc *cc, U16 *is)
 #endif /* #ifdef OPTION_CMPSC_DEBUG */
 
       memset(&cc->deadadm[*is], 0xff, 0x100 / 8);
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+      cc->dc->deaddep[*is] = cc->dep;
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
     }
     cc->deadend = 0;
   }
@@ -1008,17 +1188,13 @@ static int ARCH_DEP(cmpsc_search_sd)(struct cc *cc, U16 *is)
   {
     /* Get the sibling descriptor */
     index = (CCE_cptr(cc->cce) + sd_ptr) * 8;
-    if(unlikely(!cc->dict[index / 0x800]))
-      cc->dict[index / 0x800] = MADDR((cc->dictor + (index / 0x800) * 0x800) & ADDRESS_MAXWRAP(cc->regs), cc->r2, cc->regs, ACCTYPE_READ, cc->regs->psw.pkey);
-    sd1 = &cc->dict[index / 0x800][index % 0x800];
+    sd1 = &ARCH_DEP(cmpsc_cdict)(cc, index / 0x800)[index % 0x800];
     ITIMER_SYNC((cc->dictor + index) & ADDRESS_MAXWRAP(cc->regs), 8 - 1, cc->regs);
 
     /* If format-1, get second half from the expansion dictionary */
     if(cc->f1)
     {
-      if(unlikely(!cc->edict[index / 0x800]))
-        cc->edict[index / 0x800] = MADDR((cc->dictor + cc->dctsz + (index / 0x800) * 0x800) & ADDRESS_MAXWRAP(cc->regs), cc->r2, cc->regs, ACCTYPE_READ, cc->regs->psw.pkey);
-      sd2 = &cc->edict[index / 0x800][index % 0x800];
+      sd2 = &ARCH_DEP(cmpsc_cdict)(cc, 32 + index / 0x800)[index % 0x800];
       ITIMER_SYNC((cc->dictor + cc->dctsz + index) & ADDRESS_MAXWRAP(cc->regs), 8 - 1, cc->regs);
 
 #ifdef OPTION_CMPSC_DEBUG
@@ -1409,6 +1585,40 @@ static int ARCH_DEP(cmpsc_test_ec)(struct cc *cc, BYTE *cce)
 #define ECE_pptr(ece)        ((((ece)[0] & 0x1f) << 8) | (ece)[1])
 #define ECE_psl(ece)         ((ece)[0] >> 5)
 
+#ifndef NO_2ND_COMPILE
+/*----------------------------------------------------------------------------*/
+/* cmpsc_alphabet (prefill expanded index symbol cache)                       */
+/*----------------------------------------------------------------------------*/
+static void cmpsc_alphabet(BYTE *ec, int *eci, int *ecl, int *ecwm)
+{
+  int i;                               /* Index                               */
+
+  memset(ecl, 0, 8192 * sizeof(int));
+  for(i = 0; i < 256; i++)             /* Alphabet entries                    */
+  {
+    ec[i] = i;
+    eci[i] = i;
+    ecl[i] = 1;
+  }
+  *ecwm = 256;                         /* Set watermark after alphabet part   */
+}
+#endif /* #ifndef NO_2ND_COMPILE */
+
+/*----------------------------------------------------------------------------*/
+/* cmpsc_edict (expansion dictionary page)                                    */
+/*----------------------------------------------------------------------------*/
+static BYTE *ARCH_DEP(cmpsc_edict)(struct ec *ec, int pg)
+{
+  if(unlikely(!ec->dict[pg]))
+    ARCH_DEP(cmpsc_map_edict)(ec, pg);
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  ec->dep |= (U32) 1 << pg;
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+  return(ec->dict[pg]);
+}
+
 /*----------------------------------------------------------------------------*/
 /* cmpsc_expand                                                               */
 /*----------------------------------------------------------------------------*/
@@ -1416,6 +1626,14 @@ static void ARCH_DEP(cmpsc_expand)(int r1, int r2, REGS *regs, REGS *iregs)
 {
   GREG destlen;                        /* Destination length                  */
   struct ec ec;                        /* Expand cache                        */
+
+#ifndef OPTION_CMPSC_DICT_CACHE
+  BYTE ecbuf[ECSIZE];                  /* Expanded index symbol cache         */
+  int eci[8192];                       /* Index within cache for is           */
+  int ecl[8192];                       /* Size of expanded is                 */
+  int ecwm;                            /* Water mark                          */
+#endif /* #ifndef OPTION_CMPSC_DICT_CACHE */
+
   int i;                               /* Index                               */
   U16 iss[8] = {0};                    /* Index symbols                       */
 
@@ -1427,15 +1645,29 @@ static void ARCH_DEP(cmpsc_expand)(int r1, int r2, REGS *regs, REGS *iregs)
   ec.dictor = GR1_dictor(iregs);
   memset(ec.dict, 0, sizeof(ec.dict));
 
-  /* Initialize expanded index symbol cache and prefill with alphabet entries */
-  memset(ec.ecl, 0, sizeof(ec.ecl));
-  for(i = 0; i < 256; i++)             /* Alphabet entries                    */
+#ifdef OPTION_CMPSC_DICT_CACHE
+  /* Keep the expanded index symbols of the previous instruction */
+  ec.dc = regs->cmpscdc;
+  if(unlikely(ec.dc->edictor != ec.dictor || ec.dc->egr0 != (regs->GR_L(0) & 0x0000F000)))
   {
-    ec.ec[i] = i;
-    ec.eci[i] = i;
-    ec.ecl[i] = 1;
+    cmpsc_flush_edict(ec.dc);
+    ec.dc->edictor = ec.dictor;
+    ec.dc->egr0 = regs->GR_L(0) & 0x0000F000;
   }
-  ec.ecwm = 256;                       /* Set watermark after alphabet part   */
+  ec.ec = ec.dc->ec;
+  ec.eci = ec.dc->eci;
+  ec.ecl = ec.dc->ecl;
+  ec.ecwm = &ec.dc->ecwm;
+  ec.dep = 0;
+  ec.valid = 0;
+#else
+  /* Initialize expanded index symbol cache and prefill with alphabet entries */
+  ec.ec = ecbuf;
+  ec.eci = eci;
+  ec.ecl = ecl;
+  ec.ecwm = &ecwm;
+  cmpsc_alphabet(ec.ec, ec.eci, ec.ecl, ec.ecwm);
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
 
   ec.iregs = iregs;
   ec.r1 = r1;
@@ -1474,7 +1706,7 @@ static void ARCH_DEP(cmpsc_expand)(int r1, int r2, REGS *regs, REGS *iregs)
       ec.dbgiss++;
 #endif /* #ifdef OPTION_CMPSC_DEBUG */
 
-      if(unlikely(!ec.ecl[iss[i]]))
+      if(unlikely(!ARCH_DEP(cmpsc_expanded)(&ec, iss[i])))
         ARCH_DEP(cmpsc_expand_is)(&ec, iss[i]);
       else
       {
@@ -1536,11 +1768,13 @@ static void ARCH_DEP(cmpsc_expand_is)(struct ec *ec, U16 is)
   /* Initialize values */
   cw = 0;
 
+#ifdef OPTION_CMPSC_DICT_CACHE
+  ec->dep = 0;
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
   /* Get expansion character entry */
   index = is * 8;
-  if(unlikely(!ec->dict[index / 0x800]))
-    ec->dict[index / 0x800] = MADDR((ec->dictor + (index / 0x800) * 0x800) & ADDRESS_MAXWRAP(ec->regs), ec->r2, ec->regs, ACCTYPE_READ, ec->regs->psw.pkey);
-  ece = &ec->dict[index / 0x800][index % 0x800];
+  ece = &ARCH_DEP(cmpsc_edict)(ec, index / 0x800)[index % 0x800];
   ITIMER_SYNC((ec->dictor + index) & ADDRESS_MAXWRAP(ec->regs), 8 - 1, ec->regs);
 
 #ifdef OPTION_CMPSC_DEBUG
@@ -1571,9 +1805,7 @@ static void ARCH_DEP(cmpsc_expand_is)(struct ec *ec, U16 is)
 
     /* Get preceding entry */
     index = ECE_pptr(ece) * 8;
-    if(unlikely(!ec->dict[index / 0x800]))
-      ec->dict[index / 0x800] = MADDR((ec->dictor + (index / 0x800) * 0x800) & ADDRESS_MAXWRAP(ec->regs), ec->r2, ec->regs, ACCTYPE_READ, ec->regs->psw.pkey);
-    ece = &ec->dict[index / 0x800][index % 0x800];
+    ece = &ARCH_DEP(cmpsc_edict)(ec, index / 0x800)[index % 0x800];
     ITIMER_SYNC((ec->dictor + index) & ADDRESS_MAXWRAP(ec->regs), 8 - 1, ec->regs);
 
 #ifdef OPTION_CMPSC_DEBUG
@@ -1603,11 +1835,17 @@ static void ARCH_DEP(cmpsc_expand_is)(struct ec *ec, U16 is)
   /* Process extension characters in unpreceded entry */
   memcpy(&ec->oc[ec->ocl], &ece[1], csl);
 
-  /* Place within cache */
-  memcpy(&ec->ec[ec->ecwm], &ec->oc[ec->ocl], cw);
-  ec->eci[is] = ec->ecwm;
+  /* Place within cache, start over when full */
+  if(unlikely(*ec->ecwm + cw > ECSIZE))
+    cmpsc_alphabet(ec->ec, ec->eci, ec->ecl, ec->ecwm);
+  memcpy(&ec->ec[*ec->ecwm], &ec->oc[ec->ocl], cw);
+  ec->eci[is] = *ec->ecwm;
   ec->ecl[is] = cw;
-  ec->ecwm += cw;
+  *ec->ecwm += cw;
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  ec->dc->ecdep[is] = ec->dep;
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
 
   /* Commit in output buffer */
   ec->ocl += cw;
@@ -1622,7 +1860,7 @@ static int ARCH_DEP(cmpsc_expand_single_is)(struct ec *ec)
 
   if(unlikely(ARCH_DEP(cmpsc_fetch_is)(ec, &is)))
     return(-1);
-  if(!ec->ecl[is])
+  if(!ARCH_DEP(cmpsc_expanded)(ec, is))
   {
     ec->ocl = 0;                       /* Initialize output cache             */
     ARCH_DEP(cmpsc_expand_is)(ec, is);
@@ -1640,6 +1878,36 @@ static int ARCH_DEP(cmpsc_expand_single_is)(struct ec *ec)
   return(0);
 }
 
+/*----------------------------------------------------------------------------*/
+/* cmpsc_expanded (index symbol in cache)                                     */
+/*----------------------------------------------------------------------------*/
+static int ARCH_DEP(cmpsc_expanded)(struct ec *ec, U16 is)
+{
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  int pg;                              /* Dictionary page                     */
+  U32 pages;                           /* Pages still to compare              */
+
+  if(!ec->ecl[is])
+    return(0);
+
+  /* Only trust an expansion when all its pages are held in the cache */
+  if(unlikely(ec->dc->ecdep[is] & ~ec->dc->epages))
+    return(0);
+
+  /* Compare the pages not yet used by this instruction */
+  pages = ec->dc->ecdep[is] & ~ec->valid;
+  for(pg = 0; unlikely(pages); pg++, pages >>= 1)
+  {
+    if(pages & 1)
+      ARCH_DEP(cmpsc_map_edict)(ec, pg);
+  }
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+  /* A changed page discards the expansion */
+  return(ec->ecl[is]);
+}
+
 /*----------------------------------------------------------------------------*/
 /* cmpsc_fetch_is (index symbol)                                              */
 /*----------------------------------------------------------------------------*/
@@ -1821,6 +2089,52 @@ static void ARCH_DEP(cmpsc_fetch_iss)(struct ec *ec, U16 is[8])
 #endif /* #ifdef OPTION_CMPSC_DEBUG */
 }
 
+#ifndef NO_2ND_COMPILE
+#ifdef OPTION_CMPSC_DICT_CACHE
+/*----------------------------------------------------------------------------*/
+/* cmpsc_flush_edict (expansion dictionary cache)                             */
+/*----------------------------------------------------------------------------*/
+static void cmpsc_flush_edict(CMPSCDC *dc)
+{
+  cmpsc_alphabet(dc->ec, dc->eci, dc->ecl, &dc->ecwm);
+  dc->epages = 0;
+}
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+#endif /* #ifndef NO_2ND_COMPILE */
+
+/*----------------------------------------------------------------------------*/
+/* cmpsc_map_edict (expansion dictionary page)                                */
+/*----------------------------------------------------------------------------*/
+static void ARCH_DEP(cmpsc_map_edict)(struct ec *ec, int pg)
+{
+  BYTE *page;                          /* Page MADDR address                  */
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  U32 bit;                             /* Page bit                            */
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+  page = MADDR((ec->dictor + pg * 0x800) & ADDRESS_MAXWRAP(ec->regs), ec->r2, ec->regs, ACCTYPE_READ, ec->regs->psw.pkey);
+
+#ifdef OPTION_CMPSC_DICT_CACHE
+  /* Compare with the copy, a changed dictionary discards all expansions */
+  bit = (U32) 1 << pg;
+  if(unlikely((ec->dc->epages & bit) && memcmp(ec->dc->epage[pg], page, 0x800)))
+  {
+    cmpsc_flush_edict(ec->dc);
+    memset(ec->dict, 0, sizeof(ec->dict));
+    ec->valid = 0;
+  }
+  if(unlikely(!(ec->dc->epages & bit)))
+  {
+    memcpy(ec->dc->epage[pg], page, 0x800);
+    ec->dc->epages |= bit;
+  }
+  ec->valid |= bit;
+#endif /* #ifdef OPTION_CMPSC_DICT_CACHE */
+
+  ec->dict[pg] = page;
+}
+
 #ifndef NO_2ND_COMPILE
 #ifdef OPTION_CMPSC_DEBUG
 /*----------------------------------------------------------------------------*/
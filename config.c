@@ -60,10 +60,7 @@ int     cpu;
 
 #if !defined(OPTION_FISHIO)
     /* Terminate device threads */
-    obtain_lock (&sysblk.ioqlock);
-    sysblk.devtwait=0;
-    broadcast_condition (&sysblk.ioqcond);
-    release_lock (&sysblk.ioqlock);
+    device_thread_wakeup();
 #endif
 
 } /* end function release_config */
@@ -167,6 +164,296 @@ int   i;
 } /* end function deconfigure_cpu */
 
 
+#if defined(OPTION_CPU_AFFINITY)
+static cpu_set_t host_cpus;             /* Host CPUs we may run on   */
+static cpu_set_t other_cpus;            /* Host CPUs for other thrds */
+static int       host_cpus_valid;       /* 1 = host_cpus obtained    */
+
+/*-------------------------------------------------------------------*/
+/* Host CPUs on which the process was started                        */
+/*-------------------------------------------------------------------*/
+static cpu_set_t *get_host_cpus(void)
+{
+long    n;                              /* Number of host CPUs       */
+
+    if (!host_cpus_valid)
+    {
+        if (sched_getaffinity(0, sizeof(host_cpus), &host_cpus) != 0)
+        {
+            CPU_ZERO(&host_cpus);
+            for (n = sysconf(_SC_NPROCESSORS_ONLN) - 1; n >= 0; n--)
+                if (n < CPU_SETSIZE)
+                    CPU_SET(n, &host_cpus);
+        }
+        CPU_ZERO(&other_cpus);
+        CPU_OR(&other_cpus, &other_cpus, &host_cpus);
+        host_cpus_valid = 1;
+    }
+    return &host_cpus;
+}
+
+/*-------------------------------------------------------------------*/
+/* Parse a host CPU list such as "4-7,2" in the order given          */
+/* Returns the number of CPUs in the list, or -1 if it is invalid    */
+/*-------------------------------------------------------------------*/
+static int parse_cpu_list(char *list, int *cpus, int max)
+{
+char   *p;                              /* -> Character after number */
+long    lo, hi;                         /* Host CPU range            */
+int     n = 0;                          /* Number of CPUs in list    */
+
+    for (;;)
+    {
+        lo = hi = strtol(list, &p, 10);
+        if (p == list || lo < 0)
+            return -1;
+        if (*p == '-')
+        {
+            list = p + 1;
+            hi = strtol(list, &p, 10);
+            if (p == list)
+                return -1;
+        }
+        if (lo > hi || hi >= CPU_SETSIZE)
+            return -1;
+        for (; lo <= hi; lo++)
+        {
+            if (n >= max)
+                return -1;
+            cpus[n++] = (int)lo;
+        }
+        if (*p != ',')
+            break;
+        list = p + 1;
+    }
+    return (*p == '\0' || *p == '\n') ? n : -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Format a host CPU set as a list such as "0-3,8"                   */
+/*-------------------------------------------------------------------*/
+char *format_cpu_set(cpu_set_t *set, char *buf, size_t bufl)
+{
+int     lo, hi;                         /* Host CPU range            */
+size_t  len = 0;                        /* Length of list so far     */
+
+    buf[0] = '\0';
+    for (lo = 0; lo < CPU_SETSIZE && len < bufl; lo = hi + 1)
+    {
+        hi = lo;
+        if (!CPU_ISSET(lo, set))
+            continue;
+        while (hi + 1 < CPU_SETSIZE && CPU_ISSET(hi + 1, set))
+            hi++;
+        len += snprintf(buf + len, bufl - len, hi > lo ? "%s%d-%d" : "%s%d",
+                        len ? "," : "", lo, hi);
+    }
+    return buf;
+}
+
+/*-------------------------------------------------------------------*/
+/* Choose host CPUs for the CPUAFFINITY AUTO policy                  */
+/*                                                                   */
+/* Each emulated CPU gets its own host CPU, taken from the top of    */
+/* the host CPUs we may run on, so that at least one host CPU is     */
+/* left for the device, timer and logger threads.  When NUMAPOLICY   */
+/* places storage on chosen nodes, only CPUs of those nodes are used */
+/*-------------------------------------------------------------------*/
+static int auto_cpu_list(int *cpus, int ncpu)
+{
+cpu_set_t cand;                         /* Candidate host CPUs       */
+int     i, n;                           /* Host CPU, candidate count */
+#if defined(OPTION_STORAGE_POLICY)
+FILE   *fp;                             /* Sysfs node cpulist file   */
+char    buf[1024];                      /* Node cpulist              */
+int     list[CPU_SETSIZE];              /* Node CPUs                 */
+int     node, k;                        /* Node number, list count   */
+#endif /*defined(OPTION_STORAGE_POLICY)*/
+
+    CPU_ZERO(&cand);
+    CPU_OR(&cand, &cand, get_host_cpus());
+
+#if defined(OPTION_STORAGE_POLICY)
+    if (sysblk.numapol != NUMAPOL_DEFAULT)
+    {
+        CPU_ZERO(&cand);
+        for (node = 0; node < 64; node++)
+        {
+            if (!(sysblk.numanodes & (1ULL << node)))
+                continue;
+            snprintf(buf, sizeof(buf),
+                     "/sys/devices/system/node/node%d/cpulist", node);
+            if ((fp = fopen(buf, "r")) == NULL)
+                continue;
+            if (fgets(buf, sizeof(buf), fp) != NULL
+             && (k = parse_cpu_list(buf, list, CPU_SETSIZE)) > 0)
+                for (i = 0; i < k; i++)
+                    if (CPU_ISSET(list[i], get_host_cpus()))
+                        CPU_SET(list[i], &cand);
+            fclose(fp);
+        }
+    }
+#endif /*defined(OPTION_STORAGE_POLICY)*/
+
+    if (CPU_COUNT(&cand) <= ncpu
+     || CPU_COUNT(get_host_cpus()) <= ncpu)
+        return 0;
+
+    for (i = CPU_SETSIZE - 1, n = ncpu; i >= 0 && n > 0; i--)
+        if (CPU_ISSET(i, &cand))
+            cpus[--n] = i;
+    return ncpu;
+}
+
+/*-------------------------------------------------------------------*/
+/* Bind the calling thread to its host CPUs                          */
+/* cpu is the emulated CPU number, or -1 for any other thread.  A    */
+/* CPU thread MUST own the intlock; any other thread must not.       */
+/* A CPU which has no host CPU of its own runs with the other        */
+/* threads.                                                          */
+/*-------------------------------------------------------------------*/
+void bind_thread_affinity(int cpu)
+{
+cpu_set_t set;                          /* Host CPUs for this thread */
+int     host = -1;                      /* Host CPU of this CPU      */
+int     bind;                           /* 1 = Affinity policy set   */
+int     rc;                             /* Return code               */
+
+    /* Nothing is bound without an affinity policy; device threads
+       come and go all the time, so check before taking the intlock */
+    if (sysblk.cpuaffinity == CPUAFF_NONE)
+        return;
+
+    /* Copy the host CPUs under the intlock, which set_cpu_affinity
+       holds while it changes them */
+    if (cpu < 0)
+        OBTAIN_INTLOCK(NULL);
+    bind = sysblk.cpuaffinity != CPUAFF_NONE && host_cpus_valid;
+    CPU_ZERO(&set);
+    if (cpu >= 0 && cpu < sysblk.cpuaffnum)
+    {
+        host = sysblk.cpuafflist[cpu];
+        CPU_SET(host, &set);
+    }
+    else
+        CPU_OR(&set, &set, &other_cpus);
+    if (cpu < 0)
+        RELEASE_INTLOCK(NULL);
+
+    if (!bind)
+        return;
+
+    rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0 && host >= 0)
+        logmsg(_("HHCCP091W CPU%4.4X thread set affinity to host CPU %d "
+                 "failed: %s\n"),
+               cpu, host, strerror(rc));
+}
+
+/*-------------------------------------------------------------------*/
+/* Apply the CPU affinity policy to all threads of the process       */
+/* Caller MUST own the intlock                                       */
+/*-------------------------------------------------------------------*/
+void apply_cpu_affinity(void)
+{
+DIR    *dir;                            /* /proc/self/task directory */
+struct dirent *ent;                     /* Thread directory entry    */
+int     ncpu;                           /* Emulated CPUs to bind     */
+int     cpu;                            /* Emulated CPU number       */
+
+    get_host_cpus();
+
+    /* Resolve the AUTO policy now that NUMCPU is known */
+    if (sysblk.cpuaffinity == CPUAFF_AUTO)
+    {
+        ncpu = sysblk.numcpu > 0 ? sysblk.numcpu : 1;
+        if (ncpu > MAX_CPU_ENGINES)
+            ncpu = MAX_CPU_ENGINES;
+        sysblk.cpuaffnum = auto_cpu_list(sysblk.cpuafflist, ncpu);
+        if (sysblk.cpuaffnum == 0)
+            logmsg(_("HHCCF093W CPUAFFINITY AUTO: not enough host CPUs "
+                     "for %d CPUs; CPU threads not bound\n"), ncpu);
+    }
+
+    /* The other threads run on the host CPUs not used by CPUs */
+    CPU_ZERO(&other_cpus);
+    CPU_OR(&other_cpus, &other_cpus, &host_cpus);
+    if (sysblk.cpuaffinity != CPUAFF_NONE)
+    {
+        for (cpu = 0; cpu < sysblk.cpuaffnum; cpu++)
+            CPU_CLR(sysblk.cpuafflist[cpu], &other_cpus);
+        if (CPU_COUNT(&other_cpus) == 0)
+            CPU_OR(&other_cpus, &other_cpus, &host_cpus);
+    }
+
+    if ((dir = opendir("/proc/self/task")) != NULL)
+    {
+        while ((ent = readdir(dir)) != NULL)
+            if (ent->d_name[0] != '.')
+                sched_setaffinity(atoi(ent->d_name),
+                                  sizeof(other_cpus), &other_cpus);
+        closedir(dir);
+    }
+
+    if (sysblk.cpuaffinity != CPUAFF_NONE && sysblk.cpuaffnum > 0)
+    {
+        cpu_set_t set;                  /* Host CPU for emulated CPU */
+
+        for (cpu = 0; cpu < MAX_CPU_ENGINES; cpu++)
+        {
+            if (!IS_CPU_ONLINE(cpu) || cpu >= sysblk.cpuaffnum)
+                continue;
+            CPU_ZERO(&set);
+            CPU_SET(sysblk.cpuafflist[cpu], &set);
+            pthread_setaffinity_np(sysblk.cputid[cpu], sizeof(set), &set);
+        }
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* Set the CPU affinity policy: NONE, AUTO or a host CPU list        */
+/* Caller MUST own the intlock                                       */
+/*-------------------------------------------------------------------*/
+int set_cpu_affinity(char *spec)
+{
+int     list[MAX_CPU_ENGINES];          /* Host CPU list             */
+int     n;                              /* Number of CPUs in list    */
+int     i;                              /* Index                     */
+
+    get_host_cpus();
+
+    if (strcasecmp(spec, "none") == 0)
+    {
+        sysblk.cpuaffinity = CPUAFF_NONE;
+        sysblk.cpuaffnum = 0;
+    }
+    else if (strcasecmp(spec, "auto") == 0)
+    {
+        sysblk.cpuaffinity = CPUAFF_AUTO;
+        sysblk.cpuaffnum = 0;
+    }
+    else
+    {
+        if ((n = parse_cpu_list(spec, list, MAX_CPU_ENGINES)) <= 0)
+            return -1;
+        for (i = 0; i < n; i++)
+            if (!CPU_ISSET(list[i], &host_cpus))
+                return -1;
+        memcpy(sysblk.cpuafflist, list, n * sizeof(int));
+        sysblk.cpuaffnum = n;
+        sysblk.cpuaffinity = CPUAFF_LIST;
+    }
+
+    /* Rebind running threads; at startup the CPUs are bound
+       when they are first configured */
+    if (sysblk.cpus)
+        apply_cpu_affinity();
+
+    return 0;
+}
+#endif /*defined(OPTION_CPU_AFFINITY)*/
+
+
 /* 4 next functions used for fast device lookup cache management */
 #if defined(OPTION_FAST_DEVLOOKUP)
 static void AddDevnumFastLookup(DEVBLK *dev,U16 lcss,U16 devnum)
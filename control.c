@@ -726,13 +726,13 @@ U32     old;                            /* old value                 */
     old = CSWAP32 (regs->GR_L(r1));
 
     /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
+    OBTAIN_MAINLOCK_CAS(regs);
 
     /* Attempt to exchange the values */
     regs->psw.cc = cmpxchg4 (&old, CSWAP32(regs->GR_L(r1+1)), main2);
 
     /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
+    RELEASE_MAINLOCK_CAS(regs);
 
     if (regs->psw.cc == 0)
     {
@@ -3368,7 +3368,8 @@ int     rc;                             /* return code from load_psw */
     memcpy( &newregs, regs, sysblk.regs_copy_len );
 
     /* Now INVALIDATE ALL TLB ENTRIES in our working copy.. */
-    memset( &newregs.tlb.vaddr, 0, TLBN * sizeof(DW) );
+    memset( &newregs.tlb.vaddr, 0, TLBE * sizeof(DW) );
+    PURGE_PWC(&newregs);
     newregs.tlbID = 1;
 
     /* Set the breaking event address register in the copy */
@@ -464,6 +464,23 @@ static char *pgmintname[] = {
     if (realregs->cpuad == sysblk.mainowner)
         RELEASE_MAINLOCK(realregs);
 
+#if defined(OPTION_PLO_LOCKS)
+    /* Unlock the PLO lock if held */
+    if (realregs->plolock)
+    {
+        release_lock(realregs->plolock);
+        realregs->plolock = NULL;
+    }
+#if defined(FEATURE_INTERPRETIVE_EXECUTION)
+    /* A host exception may occur while the guest holds a PLO lock */
+    if (realregs->sie_active && realregs->guestregs->plolock)
+    {
+        release_lock(realregs->guestregs->plolock);
+        realregs->guestregs->plolock = NULL;
+    }
+#endif /*defined(FEATURE_INTERPRETIVE_EXECUTION)*/
+#endif /*defined(OPTION_PLO_LOCKS)*/
+
     /* Remove PER indication from program interrupt code
        such that interrupt code specific tests may be done.
        The PER indication will be stored in the PER handling
@@ -1216,6 +1233,12 @@ int   cpu  = *ptr;
             return NULL;
         }
     }
+#if defined(OPTION_CPU_AFFINITY)
+    /* Bind to the host CPU before the REGS are first touched, so
+       that they are placed on the memory node of that CPU */
+    bind_thread_affinity(cpu);
+#endif /*defined(OPTION_CPU_AFFINITY)*/
+
     /* Set root mode in order to set priority */
     SETMODE(ROOT);
 
@@ -1293,8 +1316,42 @@ int i;
     regs->mainlim = sysblk.mainsize - 1;
     regs->tod_epoch = get_tod_epoch();
 
+#if defined(OPTION_DECODE_CACHE)
+    /* Allocate the pre-decoded instruction cache */
+    regs->dcache = calloc (1, sizeof(DCACHE));
+    if (regs->dcache == NULL)
+    {
+        logmsg (_("HHCCP082E CPU%4.4X calloc failed for decode cache: %s\n"),
+                cpu, strerror(errno));
+        release_lock (&sysblk.cpulock[cpu]);
+        return -1;
+    }
+    regs->dcache->arch = 0xFF;          /* Force rebuild on first use*/
+#endif /*defined(OPTION_DECODE_CACHE)*/
+
+#if defined(OPTION_CMPSC_DICT_CACHE)
+    /* Allocate the CMPSC dictionary cache; the zero cdss of the
+       cleared cache never matches a CMPSC instruction             */
+    regs->cmpscdc = calloc (1, sizeof(CMPSCDC));
+    if (regs->cmpscdc == NULL)
+    {
+        logmsg (_("HHCCP083E CPU%4.4X calloc failed for CMPSC dictionary cache: %s\n"),
+                cpu, strerror(errno));
+#if defined(OPTION_DECODE_CACHE)
+        free (regs->dcache);
+        regs->dcache = NULL;
+#endif /*defined(OPTION_DECODE_CACHE)*/
+        release_lock (&sysblk.cpulock[cpu]);
+        return -1;
+    }
+#endif /*defined(OPTION_CMPSC_DICT_CACHE)*/
+
     initialize_condition (&regs->intcond);
     regs->cpulock = &sysblk.cpulock[cpu];
+#if defined(OPTION_IDLE_WAIT)
+    initialize_lock (&regs->idlelock);
+    initialize_condition (&regs->idlecond);
+#endif /*defined(OPTION_IDLE_WAIT)*/
 
 #if defined(_FEATURE_VECTOR_FACILITY)
     regs->vf = &sysblk.vf[cpu];
@@ -1377,6 +1434,20 @@ void *cpu_uninit (int cpu, REGS *regs)
     }
 
     destroy_condition(&regs->intcond);
+#if defined(OPTION_IDLE_WAIT)
+    destroy_condition(&regs->idlecond);
+    destroy_lock(&regs->idlelock);
+#endif /*defined(OPTION_IDLE_WAIT)*/
+
+#if defined(OPTION_DECODE_CACHE)
+    free (regs->dcache);
+    regs->dcache = NULL;
+#endif /*defined(OPTION_DECODE_CACHE)*/
+
+#if defined(OPTION_CMPSC_DICT_CACHE)
+    free (regs->cmpscdc);
+    regs->cmpscdc = NULL;
+#endif /*defined(OPTION_CMPSC_DICT_CACHE)*/
 
     if (regs->host)
     {
@@ -1402,6 +1473,82 @@ void *cpu_uninit (int cpu, REGS *regs)
 }
 
 
+#if defined(OPTION_IDLE_WAIT)
+/*-------------------------------------------------------------------*/
+/* Wait for an interrupt in the enabled wait state                   */
+/*                                                                   */
+/* Called in place of wait_condition on intcond and intlock, with   */
+/* intlock held and the CPU in waiting_mask; returns with            */
+/* intlock held.  While waiting the CPU does not hold intlock and    */
+/* sleeps on its own idle wait object, which WAKEUP_CPU posts, so    */
+/* that waking it does not depend on intlock being free.             */
+/*                                                                   */
+/* With IDLESPIN set the CPU first polls its idle wait object for up */
+/* to its spin limit.  The limit adapts to the recent waits: it is   */
+/* doubled, up to IDLESPIN, when a wait ended soon after the CPU     */
+/* went to sleep, and halved when a wait lasted longer than IDLESPIN */
+/*-------------------------------------------------------------------*/
+static void cpu_idle_wait (REGS *regs)
+{
+U64     start;                          /* Time of day wait began    */
+U64     now;                            /* Current time of day       */
+U64     lat;                            /* Wakeup latency (us)       */
+int     spun = 0;                       /* 1=Woken while spinning    */
+int     i;
+
+    regs->idlepost = 0;
+    regs->idlewait = 1;
+    release_lock (&sysblk.intlock);
+
+    start = host_tod();
+
+    /* Spin for a wakeup which is expected soon */
+    if (regs->idlespin > sysblk.idlespin)
+        regs->idlespin = sysblk.idlespin;
+    if (regs->idlespin)
+    {
+        do
+        {
+            for (i = 0; i < 64; i++)
+            {
+                if (*(volatile int *)&regs->idlepost)
+                    break;
+                spin_pause();
+            }
+            now = host_tod();
+        } while (!*(volatile int *)&regs->idlepost
+              && now - start < (U64)regs->idlespin);
+        spun = *(volatile int *)&regs->idlepost;
+    }
+
+    /* Sleep until woken */
+    obtain_lock (&regs->idlelock);
+    while (!regs->idlepost)
+        wait_condition (&regs->idlecond, &regs->idlelock);
+    release_lock (&regs->idlelock);
+
+    obtain_lock (&sysblk.intlock);
+    regs->idlewait = 0;
+
+    now = host_tod();
+    lat = now > regs->idleposttod ? now - regs->idleposttod : 0;
+    regs->idlewakes++;
+    regs->idlelat += lat;
+    if (lat > regs->idlemaxlat)
+        regs->idlemaxlat = lat;
+
+    /* Adapt the spin limit to the length of this wait */
+    if (spun)
+        regs->idlespun++;
+    else if (now - start > (U64)sysblk.idlespin)
+        regs->idlespin /= 2;
+    else if (sysblk.idlespin)
+        regs->idlespin = regs->idlespin ? 2 * regs->idlespin : 10;
+
+} /* end function cpu_idle_wait */
+#endif /*defined(OPTION_IDLE_WAIT)*/
+
+
 #endif /*!defined(_GEN_ARCH)*/
 
 
@@ -1418,6 +1565,9 @@ void (ATTR_REGPARM(1) ARCH_DEP(process_interrupt))(REGS *regs)
     OBTAIN_INTLOCK(regs);
     OFF_IC_INTERRUPT(regs);
     regs->tracing = (sysblk.inststep || sysblk.insttrace);
+#if defined(OPTION_LOCKFREE_INTS)
+    regs->iopostseen = sysblk.iopost;
+#endif
 
     /* Ensure psw.IA is set and invalidate the aia */
     INVALIDATE_AIA(regs);
@@ -1455,7 +1605,7 @@ void (ATTR_REGPARM(1) ARCH_DEP(process_interrupt))(REGS *regs)
                 ARCH_DEP (perform_io_interrupt) (regs);
             }
             else
-                WAKEUP_CPU_MASK(sysblk.waiting_mask);
+                WAKEUP_ENABLED_CPU(BIT(IC_IO));
         }
     } /*CPU_STARTED*/
 
@@ -1533,7 +1683,18 @@ void (ATTR_REGPARM(1) ARCH_DEP(process_interrupt))(REGS *regs)
 
         sysblk.intowner = regs->cpuad;
         sysblk.started_mask |= regs->cpubit;
+        WAKEUP_TIMER();
+#if defined(OPTION_LOCKFREE_INTS)
+        /* I/O pending is posted under iointqlk rather than intlock,
+           so pick up the floating state while holding iointqlk and
+           drop any I/O pending bit posted after we stopped */
+        obtain_lock(&sysblk.iointqlk);
+        OFF_IC_IOPENDING_CPU(regs);
+        IC_STATE_ON(&regs->ints_state, sysblk.ints_state);
+        release_lock(&sysblk.iointqlk);
+#else
         regs->ints_state |= sysblk.ints_state;
+#endif
         set_cpu_timer(regs,saved_timer);
 
         ON_IC_INTERRUPT(regs);
@@ -1575,8 +1736,26 @@ void (ATTR_REGPARM(1) ARCH_DEP(process_interrupt))(REGS *regs)
         sysblk.intowner = LOCK_OWNER_NONE;
         sysblk.waiting_mask |= regs->cpubit;
 
+#if defined(OPTION_LOCKFREE_INTS)
+        /* An I/O interrupt may have been posted without intlock
+           since it was last checked; the poster only wakes CPUs
+           it sees in waiting_mask, so check again before waiting */
+        ic_fence();
+        if (sysblk.iopost != regs->iopostseen)
+        {
+            sysblk.waiting_mask ^= regs->cpubit;
+            sysblk.intowner = regs->cpuad;
+            RELEASE_INTLOCK(regs);
+            longjmp(regs->progjmp, SIE_NO_INTERCEPT);
+        }
+#endif /*defined(OPTION_LOCKFREE_INTS)*/
+
         /* Wait for interrupt */
+#if defined(OPTION_IDLE_WAIT)
+        cpu_idle_wait (regs);
+#else
         wait_condition (&regs->intcond, &sysblk.intlock);
+#endif
 
         /* Wait while SYNCHRONIZE_CPUS is in progress */
         while (sysblk.syncing)
@@ -1585,6 +1764,7 @@ void (ATTR_REGPARM(1) ARCH_DEP(process_interrupt))(REGS *regs)
         /* Indicate we now own intlock */
         sysblk.waiting_mask ^= regs->cpubit;
         sysblk.intowner = regs->cpuad;
+        WAKEUP_TIMER();
 
 #ifdef OPTION_MIPS_COUNTING
         /* Calculate the time we waited */
@@ -1685,6 +1865,8 @@ REGS    regs;
         if (INTERRUPT_PENDING(&regs))
             ARCH_DEP(process_interrupt)(&regs);
 
+        DCACHE_VALIDATE(&regs);
+
         ip = INSTRUCTION_FETCH(&regs, 0);
         regs.instcount++;
         EXECUTE_INSTRUCTION(ip, &regs);
@@ -1761,6 +1943,7 @@ int     shouldstep = 0;                 /* 1=Wait for start command  */
         sysblk.intowner = hostregs->cpuad;
         hostregs->stepwait = 0;
         sysblk.started_mask |= hostregs->cpubit;
+        WAKEUP_TIMER();
         set_cpu_timer(regs,saved_timer[0]);
         set_cpu_timer(hostregs,saved_timer[1]);
 #ifdef OPTION_MIPS_COUNTING
@@ -268,25 +268,56 @@
  * State bits indicate what interrupts are possibly pending
  * for a CPU.  These bits can be set by any thread and therefore
  * are serialized by the `intlock'.
+ * With OPTION_LOCKFREE_INTS every update to a state word is an
+ * atomic or/and, so that the floating I/O pending bit in sysblk
+ * can be posted while holding only `iointqlk'.  A compare-and-
+ * exchange that had to be retried is recorded in the `ptt ints'
+ * trace class.
  * For PER, the state bits are set when CR9 is loaded and the mask
  * bits are set when a PER event occurs
  */
 
+#if defined(OPTION_LOCKFREE_INTS)
+#define IC_STATE_ON(_p, _bits) \
+ do { \
+   int _retry = or_fw_atomic((_p), (_bits)); \
+   if (unlikely(_retry)) \
+     PTT(PTT_CL_INT, "*IC on", (_p), (_bits), _retry); \
+ } while (0)
+
+#define IC_STATE_OFF(_p, _bits) \
+ do { \
+   int _retry = and_fw_atomic((_p), ~(U32)(_bits)); \
+   if (unlikely(_retry)) \
+     PTT(PTT_CL_INT, "*IC off", (_p), (_bits), _retry); \
+ } while (0)
+#else
+#define IC_STATE_ON(_p, _bits) \
+ do { \
+   *(_p) |= (_bits); \
+ } while (0)
+
+#define IC_STATE_OFF(_p, _bits) \
+ do { \
+   *(_p) &= ~(_bits); \
+ } while (0)
+#endif
+
 #define SET_IC_TRACE \
  do { \
    int i; \
    CPU_BITMAP mask = sysblk.started_mask; \
    for (i = 0; mask; i++) { \
      if (mask & 1) \
-       sysblk.regs[i]->ints_state |= BIT(IC_INTERRUPT); \
+       IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_INTERRUPT)); \
      mask >>= 1; \
    } \
  } while (0)
 
 #define SET_IC_PER(_regs) \
  do { \
-  (_regs)->ints_state &= (~IC_PER_MASK); \
-  (_regs)->ints_state |= (((_regs)->CR(9) >> IC_CR9_SHIFT) & IC_PER_MASK); \
+  IC_STATE_OFF(&(_regs)->ints_state, IC_PER_MASK); \
+  IC_STATE_ON(&(_regs)->ints_state, ((_regs)->CR(9) >> IC_CR9_SHIFT) & IC_PER_MASK); \
   (_regs)->ints_mask  &= (~IC_PER_MASK | (_regs)->ints_state); \
  } while (0)
 
@@ -296,31 +327,31 @@
 
 #define ON_IC_INTERRUPT(_regs) \
  do { \
-   (_regs)->ints_state |=  BIT(IC_INTERRUPT); \
+   IC_STATE_ON(&(_regs)->ints_state, BIT(IC_INTERRUPT)); \
  } while (0)
 
 #define ON_IC_RESTART(_regs) \
  do { \
-   (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_RESTART); \
+   IC_STATE_ON(&(_regs)->ints_state, BIT(IC_INTERRUPT) | BIT(IC_RESTART)); \
  } while (0)
 
 #define ON_IC_STORSTAT(_regs) \
  do { \
-   (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_STORSTAT); \
+   IC_STATE_ON(&(_regs)->ints_state, BIT(IC_INTERRUPT) | BIT(IC_STORSTAT)); \
  } while (0)
 
 #define ON_IC_IOPENDING \
  do { \
    int i; CPU_BITMAP mask; \
    if ( !(sysblk.ints_state & BIT(IC_IO)) ) { \
-     sysblk.ints_state |= BIT(IC_IO); \
+     IC_STATE_ON(&sysblk.ints_state, BIT(IC_IO)); \
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) { \
          if ( sysblk.regs[i]->ints_mask & BIT(IC_IO) ) \
-           sysblk.regs[i]->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_IO); \
+           IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_INTERRUPT) | BIT(IC_IO)); \
          else \
-           sysblk.regs[i]->ints_state |= BIT(IC_IO); \
+           IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_IO)); \
        } \
        mask >>= 1; \
      } \
@@ -331,14 +362,14 @@
  do { \
    int i; CPU_BITMAP mask; \
    if ( !(sysblk.ints_state & BIT(IC_CHANRPT)) ) { \
-     sysblk.ints_state |=  BIT(IC_CHANRPT); \
+     IC_STATE_ON(&sysblk.ints_state, BIT(IC_CHANRPT)); \
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) { \
          if ( sysblk.regs[i]->ints_mask & BIT(IC_CHANRPT) ) \
-           sysblk.regs[i]->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_CHANRPT); \
+           IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_INTERRUPT) | BIT(IC_CHANRPT)); \
          else \
-           sysblk.regs[i]->ints_state |= BIT(IC_CHANRPT); \
+           IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_CHANRPT)); \
        } \
        mask >>= 1; \
      } \
@@ -349,14 +380,14 @@
  do { \
    int i; CPU_BITMAP mask; \
    if ( !(sysblk.ints_state & BIT(IC_INTKEY)) ) { \
-     sysblk.ints_state |= BIT(IC_INTKEY); \
+     IC_STATE_ON(&sysblk.ints_state, BIT(IC_INTKEY)); \
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) { \
          if ( sysblk.regs[i]->ints_mask & BIT(IC_INTKEY) ) \
-           sysblk.regs[i]->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_INTKEY); \
+           IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_INTERRUPT) | BIT(IC_INTKEY)); \
          else \
-           sysblk.regs[i]->ints_state |=  BIT(IC_INTKEY); \
+           IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_INTKEY)); \
        } \
        mask >>= 1; \
      } \
@@ -367,14 +398,14 @@
  do { \
    int i; CPU_BITMAP mask; \
    if ( !(sysblk.ints_state & BIT(IC_SERVSIG)) ) { \
-     sysblk.ints_state |= BIT(IC_SERVSIG); \
+     IC_STATE_ON(&sysblk.ints_state, BIT(IC_SERVSIG)); \
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) { \
          if ( sysblk.regs[i]->ints_mask & BIT(IC_SERVSIG) ) \
-           sysblk.regs[i]->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_SERVSIG); \
+           IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_INTERRUPT) | BIT(IC_SERVSIG)); \
          else \
-           sysblk.regs[i]->ints_state |= BIT(IC_SERVSIG); \
+           IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_SERVSIG)); \
          } \
        mask >>= 1; \
      } \
@@ -384,57 +415,57 @@
 #define ON_IC_ITIMER(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_ITIMER) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_ITIMER); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_INTERRUPT) | BIT(IC_ITIMER)); \
    else \
-     (_regs)->ints_state |= BIT(IC_ITIMER); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_ITIMER)); \
  } while (0)
 
 #define ON_IC_PTIMER(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_PTIMER) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_PTIMER); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_INTERRUPT) | BIT(IC_PTIMER)); \
    else \
-     (_regs)->ints_state |= BIT(IC_PTIMER); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_PTIMER)); \
  } while (0)
 
 #define ON_IC_ECPSVTIMER(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_ECPSVTIMER) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_ECPSVTIMER); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_INTERRUPT) | BIT(IC_ECPSVTIMER)); \
    else \
-     (_regs)->ints_state |= BIT(IC_ECPSVTIMER); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_ECPSVTIMER)); \
  } while (0)
 
 #define ON_IC_CLKC(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_CLKC) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_CLKC); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_INTERRUPT) | BIT(IC_CLKC)); \
    else \
-     (_regs)->ints_state |= BIT(IC_CLKC); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_CLKC)); \
  } while (0)
 
 #define ON_IC_EXTCALL(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_EXTCALL) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_EXTCALL); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_INTERRUPT) | BIT(IC_EXTCALL)); \
    else \
-     (_regs)->ints_state |= BIT(IC_EXTCALL); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_EXTCALL)); \
  } while (0)
 
 #define ON_IC_MALFALT(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_MALFALT) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_MALFALT); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_INTERRUPT) | BIT(IC_MALFALT)); \
    else \
-     (_regs)->ints_state |= BIT(IC_MALFALT); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_MALFALT)); \
  } while (0)
 
 #define ON_IC_EMERSIG(_regs) \
  do { \
    if ( (_regs)->ints_mask & BIT(IC_EMERSIG) ) \
-     (_regs)->ints_state |= BIT(IC_INTERRUPT) | BIT(IC_EMERSIG); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_INTERRUPT) | BIT(IC_EMERSIG)); \
    else \
-     (_regs)->ints_state |= BIT(IC_EMERSIG); \
+     IC_STATE_ON(&(_regs)->ints_state, BIT(IC_EMERSIG)); \
  } while (0)
 
     /*
@@ -480,42 +511,66 @@
 
 #define OFF_IC_INTERRUPT(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_INTERRUPT); \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_INTERRUPT)); \
  } while (0)
 
 #define OFF_IC_RESTART(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_RESTART); \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_RESTART)); \
  } while (0)
 
 #define OFF_IC_STORSTAT(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_STORSTAT); \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_STORSTAT)); \
  } while (0)
 
 #define OFF_IC_IOPENDING \
  do { \
    int i; CPU_BITMAP mask; \
    if ( sysblk.ints_state & BIT(IC_IO) ) { \
-     sysblk.ints_state &= ~BIT(IC_IO); \
+     IC_STATE_OFF(&sysblk.ints_state, BIT(IC_IO)); \
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) \
-         sysblk.regs[i]->ints_state &= ~BIT(IC_IO); \
+         IC_STATE_OFF(&sysblk.regs[i]->ints_state, BIT(IC_IO)); \
        mask >>= 1; \
      } \
    } \
  } while (0)
 
+#define OFF_IC_IOPENDING_CPU(_regs) \
+ do { \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_IO)); \
+ } while (0)
+
+/* Copy the floating I/O pending state, which POST_IC_IOPENDING sets
+   holding only iointqlk, to each started CPU; intlock must be held */
+#define SYNC_IC_IOPENDING \
+ do { \
+   int i; CPU_BITMAP mask; \
+   mask = sysblk.started_mask; \
+   for (i = 0; mask; i++) { \
+     if (mask & 1) { \
+       if ( !(sysblk.ints_state & BIT(IC_IO)) ) \
+         IC_STATE_OFF(&sysblk.regs[i]->ints_state, BIT(IC_IO)); \
+       else if ( sysblk.regs[i]->ints_mask & BIT(IC_IO) ) \
+         IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_INTERRUPT) | BIT(IC_IO)); \
+       else \
+         IC_STATE_ON(&sysblk.regs[i]->ints_state, BIT(IC_IO)); \
+     } \
+     mask >>= 1; \
+   } \
+ } while (0)
+
 #define OFF_IC_CHANRPT \
  do { \
    int i; CPU_BITMAP mask; \
    if ( sysblk.ints_state & BIT(IC_CHANRPT) ) { \
-     sysblk.ints_state &= ~BIT(IC_CHANRPT); \
+     IC_STATE_OFF(&sysblk.ints_state, BIT(IC_CHANRPT)); \
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) \
-         sysblk.regs[i]->ints_state &= ~BIT(IC_CHANRPT); \
+         IC_STATE_OFF(&sysblk.regs[i]->ints_state, BIT(IC_CHANRPT)); \
        mask >>= 1; \
      } \
    } \
@@ -525,11 +580,11 @@
  do { \
    int i; CPU_BITMAP mask; \
    if ( sysblk.ints_state & BIT(IC_INTKEY) ) { \
-     sysblk.ints_state &= ~BIT(IC_INTKEY); \
+     IC_STATE_OFF(&sysblk.ints_state, BIT(IC_INTKEY)); \
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) \
-         sysblk.regs[i]->ints_state &= ~BIT(IC_INTKEY); \
+         IC_STATE_OFF(&sysblk.regs[i]->ints_state, BIT(IC_INTKEY)); \
        mask >>= 1; \
      } \
    } \
@@ -539,11 +594,11 @@
  do { \
    int i; CPU_BITMAP mask; \
    if ( sysblk.ints_state & BIT(IC_SERVSIG) ) { \
-     sysblk.ints_state &= ~BIT(IC_SERVSIG); \
+     IC_STATE_OFF(&sysblk.ints_state, BIT(IC_SERVSIG)); \
      mask = sysblk.started_mask; \
      for (i = 0; mask; i++) { \
        if (mask & 1) \
-         sysblk.regs[i]->ints_state &= ~BIT(IC_SERVSIG); \
+         IC_STATE_OFF(&sysblk.regs[i]->ints_state, BIT(IC_SERVSIG)); \
        mask >>= 1; \
      } \
    } \
@@ -551,37 +606,37 @@
 
 #define OFF_IC_ITIMER(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_ITIMER); \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_ITIMER)); \
  } while (0)
 
 #define OFF_IC_PTIMER(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_PTIMER); \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_PTIMER)); \
  } while (0)
 
 #define OFF_IC_ECPSVTIMER(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_ECPSVTIMER); \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_ECPSVTIMER)); \
  } while (0)
 
 #define OFF_IC_CLKC(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_CLKC); \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_CLKC)); \
  } while (0)
 
 #define OFF_IC_EXTCALL(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_EXTCALL); \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_EXTCALL)); \
  } while (0)
 
 #define OFF_IC_MALFALT(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_MALFALT); \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_MALFALT)); \
  } while (0)
 
 #define OFF_IC_EMERSIG(_regs) \
  do { \
-   (_regs)->ints_state &= ~BIT(IC_EMERSIG); \
+   IC_STATE_OFF(&(_regs)->ints_state, BIT(IC_EMERSIG)); \
  } while (0)
 
 #define OFF_IC_PER(_regs) \
@@ -29,6 +29,7 @@
 #include "des.h"
 #include "sha1.h"
 #include "sha256.h"
+#include "hwcrypt.h"
 
 /*----------------------------------------------------------------------------*/
 /* Sanity compile check                                                       */
@@ -938,7 +939,6 @@ static BYTE exp_table[128][16] =
   { 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }
 };
 #endif /* #ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_4 */
-#endif /* #ifndef __STATIC_FUNCTIONS__ */
 
 /*----------------------------------------------------------------------------*/
 /* Needed functions from sha1.c and sha256.c.                                 */
@@ -948,6 +948,172 @@ void sha1_process(sha1_context *ctx, BYTE data[64]);
 void sha256_process(sha256_context *ctx, BYTE data[64]);
 void sha512_process(sha512_context *ctx, BYTE data[128]);
 
+/*----------------------------------------------------------------------------*/
+/* Multiple block functions                                                   */
+/*----------------------------------------------------------------------------*/
+/* These process a run of whole blocks held in main storage, using the host  */
+/* AES-NI, SHA and PCLMULQDQ instructions when hostinfo reports them and the */
+/* portable code otherwise. crypt_accel is only cleared by the cryptbench    */
+/* command to time the portable code on a host that has the instructions.   */
+static int crypt_accel = 1;
+
+typedef struct {
+  aes_context ctx;                     /* Portable key schedules             */
+#if defined(OPTION_HOST_SIMD)
+  aesni_key ni;                        /* Host instruction round keys        */
+  int use_ni;                          /* Use the host instructions          */
+#endif /* defined(OPTION_HOST_SIMD) */
+} crypt_aes_key;
+
+static void crypt_aes_set_key(crypt_aes_key *key, BYTE *k, int bits)
+{
+  aes_set_key(&key->ctx, k, bits);
+#if defined(OPTION_HOST_SIMD)
+  key->use_ni = crypt_accel && hostinfo.aes_avail;
+  if(key->use_ni)
+    aesni_set_key(&key->ni, &key->ctx);
+#endif /* defined(OPTION_HOST_SIMD) */
+}
+
+/* Electronic codebook, out may equal in */
+static void crypt_aes_ecb(crypt_aes_key *key, int decrypt, BYTE *out, BYTE *in, int len)
+{
+  int i;
+
+#if defined(OPTION_HOST_SIMD)
+  if(key->use_ni)
+  {
+    aesni_ecb(&key->ni, decrypt, out, in, len);
+    return;
+  }
+#endif /* defined(OPTION_HOST_SIMD) */
+  for(i = 0; i < len; i += 16)
+  {
+    if(decrypt)
+      aes_decrypt(&key->ctx, in + i, out + i);
+    else
+      aes_encrypt(&key->ctx, in + i, out + i);
+  }
+}
+
+/* Cipher block chaining, out may equal in, no output when out is NULL */
+static void crypt_aes_cbc(crypt_aes_key *key, int decrypt, BYTE cv[16], BYTE *out, BYTE *in, int len)
+{
+  BYTE block[16];
+  BYTE next[16];
+  int i;
+  int j;
+
+#if defined(OPTION_HOST_SIMD)
+  if(key->use_ni)
+  {
+    aesni_cbc(&key->ni, decrypt, cv, out, in, len);
+    return;
+  }
+#endif /* defined(OPTION_HOST_SIMD) */
+  for(i = 0; i < len; i += 16)
+  {
+    if(decrypt)
+    {
+      memcpy(next, in + i, 16);
+      aes_decrypt(&key->ctx, next, block);
+      for(j = 0; j < 16; j++)
+        out[i + j] = block[j] ^ cv[j];
+      memcpy(cv, next, 16);
+    }
+    else
+    {
+      for(j = 0; j < 16; j++)
+        block[j] = in[i + j] ^ cv[j];
+      aes_encrypt(&key->ctx, block, cv);
+      if(out)
+        memcpy(out + i, cv, 16);
+    }
+  }
+}
+
+static void crypt_sha1(sha1_context *ctx, BYTE *data, int len)
+{
+  BYTE block[64];
+
+#if defined(OPTION_HOST_SIMD)
+  if(crypt_accel && hostinfo.sha_avail)
+  {
+    shani_sha1(ctx->state, data, len);
+    return;
+  }
+#endif /* defined(OPTION_HOST_SIMD) */
+
+  /* sha1_process overwrites its input */
+  for(; len >= 64; len -= 64, data += 64)
+  {
+    memcpy(block, data, 64);
+    sha1_process(ctx, block);
+  }
+}
+
+#ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_1
+static void crypt_sha256(sha256_context *ctx, BYTE *data, int len)
+{
+#if defined(OPTION_HOST_SIMD)
+  if(crypt_accel && hostinfo.sha_avail)
+  {
+    shani_sha256(ctx->state, data, len);
+    return;
+  }
+#endif /* defined(OPTION_HOST_SIMD) */
+  for(; len >= 64; len -= 64, data += 64)
+    sha256_process(ctx, data);
+}
+#endif /* #ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_1 */
+
+#ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_4
+static void crypt_ghash(BYTE cv[16], BYTE h[16], BYTE *data, int len)
+{
+  int i;
+  int j;
+
+#if defined(OPTION_HOST_SIMD)
+  if(crypt_accel && hostinfo.pclmul_avail)
+  {
+    clmul_ghash(cv, h, data, len);
+    return;
+  }
+#endif /* defined(OPTION_HOST_SIMD) */
+  for(i = 0; i < len; i += 16)
+  {
+    for(j = 0; j < 16; j++)
+      cv[j] ^= data[i + j];
+    gcm_gf_mult(cv, h, cv);
+  }
+}
+#endif /* #ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_4 */
+#endif /* #ifndef __STATIC_FUNCTIONS__ */
+
+/*----------------------------------------------------------------------------*/
+/* Length of the run of blocks that can be processed in main storage          */
+/*----------------------------------------------------------------------------*/
+/* Returns the largest multiple of blocklen, not above max, that stays within */
+/* the current page of the second operand and, when r1 is not zero, of the    */
+/* first operand. Zero means the next block crosses a page boundary and must  */
+/* go through vfetchc and vstorec.                                            */
+static int ARCH_DEP(crypt_span)(int r1, int r2, int blocklen, int max, REGS *regs)
+{
+  int len;
+  int len1;
+
+  len = PAGEFRAME_PAGESIZE - (int)(GR_A(r2, regs) & ADDRESS_MAXWRAP(regs) & PAGEFRAME_BYTEMASK);
+  if(r1)
+  {
+    len1 = PAGEFRAME_PAGESIZE - (int)(GR_A(r1, regs) & ADDRESS_MAXWRAP(regs) & PAGEFRAME_BYTEMASK);
+    if(len1 < len)
+      len = len1;
+  }
+  if(len > max)
+    len = max;
+  return len - len % blocklen;
+}
+
 /*----------------------------------------------------------------------------*/
 /* Compute intermediate message digest (KIMD) FC 1-3                          */
 /*----------------------------------------------------------------------------*/
@@ -965,6 +1131,8 @@ static void ARCH_DEP(kimd_sha)(int r1, int r2, REGS *regs, int klmd)
 
   int crypted;
   int fc;
+  int len;
+  BYTE *message;
   BYTE message_block[128];
   int message_blocklen = 0;
   BYTE parameter_block[64];
@@ -1058,20 +1226,36 @@ static void ARCH_DEP(kimd_sha)(int r1, int r2, REGS *regs, int klmd)
   }
 
   /* Try to process the CPU-determined amount of data */
-  for(crypted = 0; crypted < PROCESS_MAX; crypted += message_blocklen)
+  for(crypted = 0; crypted < PROCESS_MAX; crypted += len)
   {
-    /* Fetch and process a block of data */
-    ARCH_DEP(vfetchc)(message_block, message_blocklen - 1, GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs);
+    /* Hash the blocks within the current page in place */
+    len = 0;
+    if(fc != 3)
+    {
+      len = PROCESS_MAX - crypted;
+      if(GR_A(r2 + 1, regs) < (VADR) len)
+        len = (int) GR_A(r2 + 1, regs);
+      len = ARCH_DEP(crypt_span)(0, r2, message_blocklen, len, regs);
+    }
+    if(likely(len))
+      message = MADDR(GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs, ACCTYPE_READ, regs->psw.pkey);
+    else
+    {
+      /* Fetch a block of data crossing a page boundary */
+      ARCH_DEP(vfetchc)(message_block, message_blocklen - 1, GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs);
+      message = message_block;
+      len = message_blocklen;
+    }
 
 #ifdef OPTION_KIMD_DEBUG
-    LOGBYTE2("input :", message_block, 16, message_blocklen / 16);
+    LOGBYTE2("input :", message, 16, len / 16);
 #endif /* #ifdef OPTION_KIMD_DEBUG */
 
     switch(fc)
     {
       case 1: /* sha-1 */
       {
-        sha1_process(&sha1_ctx, message_block);
+        crypt_sha1(&sha1_ctx, message, len);
         sha1_getcv(&sha1_ctx, parameter_block);
         break;
       }
@@ -1079,7 +1263,7 @@ static void ARCH_DEP(kimd_sha)(int r1, int r2, REGS *regs, int klmd)
 #ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_1
       case 2: /* sha-256 */
       {
-        sha256_process(&sha256_ctx, message_block);
+        crypt_sha256(&sha256_ctx, message, len);
         sha256_getcv(&sha256_ctx, parameter_block);
         break;
       }
@@ -1088,7 +1272,7 @@ static void ARCH_DEP(kimd_sha)(int r1, int r2, REGS *regs, int klmd)
 #ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_2
       case 3: /* sha-512 */
       {
-        sha512_process(&sha512_ctx, message_block);
+        sha512_process(&sha512_ctx, message);
         sha512_getcv(&sha512_ctx, parameter_block);
         break;
       }
@@ -1111,8 +1295,8 @@ static void ARCH_DEP(kimd_sha)(int r1, int r2, REGS *regs, int klmd)
 #endif /* #ifdef OPTION_KIMD_DEBUG */
 
     /* Update the registers */
-    SET_GR_A(r2, regs, GR_A(r2, regs) + message_blocklen);
-    SET_GR_A(r2 + 1, regs, GR_A(r2 + 1, regs) - message_blocklen);
+    SET_GR_A(r2, regs, GR_A(r2, regs) + len);
+    SET_GR_A(r2 + 1, regs, GR_A(r2 + 1, regs) - len);
 
 #ifdef OPTION_KIMD_DEBUG
     logmsg("  GR%02d  : " F_GREG "\n", r2, (regs)->GR(r2));
@@ -1140,7 +1324,8 @@ static void ARCH_DEP(kimd_sha)(int r1, int r2, REGS *regs, int klmd)
 static void ARCH_DEP(kimd_ghash)(int r1, int r2, REGS *regs)
 {
   int crypted;
-  int i;
+  int len;
+  BYTE *message;
   BYTE message_block[16];
   BYTE parameter_block[32];
 
@@ -1169,19 +1354,29 @@ static void ARCH_DEP(kimd_ghash)(int r1, int r2, REGS *regs)
 #endif /* #ifdef OPTION_KIMD_DEBUG */
 
   /* Try to process the CPU-determined amount of data */
-  for(crypted = 0; crypted < PROCESS_MAX; crypted += 16)
+  for(crypted = 0; crypted < PROCESS_MAX; crypted += len)
   {
-    /* Fetch and process a block of data */
-    ARCH_DEP(vfetchc)(message_block, 15, GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs);
+    /* Hash the blocks within the current page in place */
+    len = PROCESS_MAX - crypted;
+    if(GR_A(r2 + 1, regs) < (VADR) len)
+      len = (int) GR_A(r2 + 1, regs);
+    len = ARCH_DEP(crypt_span)(0, r2, 16, len, regs);
+    if(likely(len))
+      message = MADDR(GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs, ACCTYPE_READ, regs->psw.pkey);
+    else
+    {
+      /* Fetch a block of data crossing a page boundary */
+      ARCH_DEP(vfetchc)(message_block, 15, GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs);
+      message = message_block;
+      len = 16;
+    }
 
 #ifdef OPTION_KIMD_DEBUG
-    LOGBYTE("input :", message_block, 16);
+    LOGBYTE2("input :", message, 16, len / 16);
 #endif /* #ifdef OPTION_KIMD_DEBUG */
 
     /* XOR and multiply */
-    for(i = 0; i < 16; i++)
-      parameter_block[i] ^= message_block[i];
-    gcm_gf_mult(parameter_block, &parameter_block[16], parameter_block);
+    crypt_ghash(parameter_block, &parameter_block[16], message, len);
 
     /* Store the output chaining value */
     ARCH_DEP(vstorec)(parameter_block, 15, GR_A(1, regs) & ADDRESS_MAXWRAP(regs), 1, regs);
@@ -1191,8 +1386,8 @@ static void ARCH_DEP(kimd_ghash)(int r1, int r2, REGS *regs)
 #endif /* #ifdef OPTION_KIMD_DEBUG */
 
     /* Update the registers */
-    SET_GR_A(r2, regs, GR_A(r2, regs) + 16);
-    SET_GR_A(r2 + 1, regs, GR_A(r2 + 1, regs) - 16);
+    SET_GR_A(r2, regs, GR_A(r2, regs) + len);
+    SET_GR_A(r2 + 1, regs, GR_A(r2 + 1, regs) - len);
 
 #ifdef OPTION_KIMD_DEBUG
     logmsg("  GR%02d  : " F_GREG "\n", r2, (regs)->GR(r2));
@@ -1610,11 +1805,14 @@ static void ARCH_DEP(km_dea)(int r1, int r2, REGS *regs)
 /*----------------------------------------------------------------------------*/
 static void ARCH_DEP(km_aes)(int r1, int r2, REGS *regs)
 {
-  aes_context context;
+  crypt_aes_key context;
   int crypted;
+  BYTE *in;
   int keylen;
+  int len;
   BYTE message_block[16];
   int modifier_bit;
+  BYTE *out;
   BYTE parameter_block[64];
   int parameter_blocklen;
   int r1_is_not_r2;
@@ -1664,38 +1862,64 @@ static void ARCH_DEP(km_aes)(int r1, int r2, REGS *regs)
 #endif /* #ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_3 */
 
   /* Set the cryptographic keys */
-  aes_set_key(&context, parameter_block, keylen * 8);
+  crypt_aes_set_key(&context, parameter_block, keylen * 8);
 
   /* Try to process the CPU-determined amount of data */
   modifier_bit = GR0_m(regs);
   r1_is_not_r2 = r1 != r2;
-  for(crypted = 0; crypted < PROCESS_MAX; crypted += 16)
+  for(crypted = 0; crypted < PROCESS_MAX; crypted += len)
   {
-    /* Fetch a block of data */
-    ARCH_DEP(vfetchc)(message_block, 15, GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs);
+    /* Cipher the blocks within the current pages in place */
+    len = PROCESS_MAX - crypted;
+    if(GR_A(r2 + 1, regs) < (VADR) len)
+      len = (int) GR_A(r2 + 1, regs);
+    len = ARCH_DEP(crypt_span)(r1, r2, 16, len, regs);
+    if(likely(len))
+    {
+      in = MADDR(GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs, ACCTYPE_READ, regs->psw.pkey);
+      out = MADDR(GR_A(r1, regs) & ADDRESS_MAXWRAP(regs), r1, regs, ACCTYPE_WRITE, regs->psw.pkey);
+
+      /* Keep the block at a time result of overlapping operands */
+      if(unlikely(out > in && out < in + len))
+        len = 16;
 
 #ifdef OPTION_KM_DEBUG
-    LOGBYTE("input :", message_block, 16);
+      LOGBYTE2("input :", in, 16, len / 16);
 #endif /* #ifdef OPTION_KM_DEBUG */
 
-    /* Do the job */
-    if(modifier_bit)
-      aes_decrypt(&context, message_block, message_block);
+      /* Do the job */
+      crypt_aes_ecb(&context, modifier_bit, out, in, len);
+
+#ifdef OPTION_KM_DEBUG
+      LOGBYTE2("output:", out, 16, len / 16);
+#endif /* #ifdef OPTION_KM_DEBUG */
+    }
     else
-      aes_encrypt(&context, message_block, message_block);
+    {
+      /* Fetch a block of data crossing a page boundary */
+      ARCH_DEP(vfetchc)(message_block, 15, GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs);
+      len = 16;
 
-    /* Store the output */
-    ARCH_DEP(vstorec)(message_block, 15, GR_A(r1, regs) & ADDRESS_MAXWRAP(regs), r1, regs);
+#ifdef OPTION_KM_DEBUG
+      LOGBYTE("input :", message_block, 16);
+#endif /* #ifdef OPTION_KM_DEBUG */
+
+      /* Do the job */
+      crypt_aes_ecb(&context, modifier_bit, message_block, message_block, 16);
+
+      /* Store the output */
+      ARCH_DEP(vstorec)(message_block, 15, GR_A(r1, regs) & ADDRESS_MAXWRAP(regs), r1, regs);
 
 #ifdef OPTION_KM_DEBUG
-    LOGBYTE("output:", message_block, 16);
+      LOGBYTE("output:", message_block, 16);
 #endif /* #ifdef OPTION_KM_DEBUG */
+    }
 
     /* Update the registers */
-    SET_GR_A(r1, regs, GR_A(r1, regs) + 16);
+    SET_GR_A(r1, regs, GR_A(r1, regs) + len);
     if(likely(r1_is_not_r2))
-      SET_GR_A(r2, regs, GR_A(r2, regs) + 16);
-    SET_GR_A(r2 + 1, regs, GR_A(r2 + 1, regs) - 16);
+      SET_GR_A(r2, regs, GR_A(r2, regs) + len);
+    SET_GR_A(r2 + 1, regs, GR_A(r2 + 1, regs) - len);
 
 #ifdef OPTION_KM_DEBUG
     logmsg("  GR%02d  : " F_GREG "\n", r1, (regs)->GR(r1));
@@ -2022,10 +2246,11 @@ static void ARCH_DEP(kmac_dea)(int r1, int r2, REGS *regs)
 /*----------------------------------------------------------------------------*/
 static void ARCH_DEP(kmac_aes)(int r1, int r2, REGS *regs)
 {
-  aes_context context;
+  crypt_aes_key context;
   int crypted;
-  int i;
   int keylen;
+  int len;
+  BYTE *message;
   BYTE message_block[16];
   BYTE parameter_block[80];
   int parameter_blocklen;
@@ -2079,24 +2304,32 @@ static void ARCH_DEP(kmac_aes)(int r1, int r2, REGS *regs)
   }
 
   /* Set the cryptographic key */
-  aes_set_key(&context, &parameter_block[16], keylen * 8);
+  crypt_aes_set_key(&context, &parameter_block[16], keylen * 8);
   
   /* Try to process the CPU-determined amount of data */
-  for(crypted = 0; crypted < PROCESS_MAX; crypted += 16)
+  for(crypted = 0; crypted < PROCESS_MAX; crypted += len)
   {
-    /* Fetch a block of data */
-    ARCH_DEP(vfetchc)(message_block, 15, GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs);
+    /* Chain the blocks within the current page in place */
+    len = PROCESS_MAX - crypted;
+    if(GR_A(r2 + 1, regs) < (VADR) len)
+      len = (int) GR_A(r2 + 1, regs);
+    len = ARCH_DEP(crypt_span)(0, r2, 16, len, regs);
+    if(likely(len))
+      message = MADDR(GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs, ACCTYPE_READ, regs->psw.pkey);
+    else
+    {
+      /* Fetch a block of data crossing a page boundary */
+      ARCH_DEP(vfetchc)(message_block, 15, GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs);
+      message = message_block;
+      len = 16;
+    }
 
 #ifdef OPTION_KMAC_DEBUG
-    LOGBYTE("input :", message_block, 16);
+    LOGBYTE2("input :", message, 16, len / 16);
 #endif /* #ifdef OPTION_KMAC_DEBUG */
 
-    /* XOR the message with chaining value */
-    for(i = 0; i < 16; i++)
-      message_block[i] ^= parameter_block[i];
-
     /* Calculate the output chaining value */
-    aes_encrypt(&context, message_block, parameter_block);
+    crypt_aes_cbc(&context, 0, parameter_block, NULL, message, len);
 
     /* Store the output chaining value */
     ARCH_DEP(vstorec)(parameter_block, 15, GR_A(1, regs) & ADDRESS_MAXWRAP(regs), 1, regs);
@@ -2106,8 +2339,8 @@ static void ARCH_DEP(kmac_aes)(int r1, int r2, REGS *regs)
 #endif /* #ifdef OPTION_KMAC_DEBUG */
 
     /* Update the registers */
-    SET_GR_A(r2, regs, GR_A(r2, regs) + 16);
-    SET_GR_A(r2 + 1, regs, GR_A(r2 + 1, regs) - 16);
+    SET_GR_A(r2, regs, GR_A(r2, regs) + len);
+    SET_GR_A(r2 + 1, regs, GR_A(r2 + 1, regs) - len);
 
 #ifdef OPTION_KMAC_DEBUG
     logmsg("  GR%02d  : " F_GREG "\n", r2, (regs)->GR(r2));
@@ -2368,13 +2601,14 @@ static void ARCH_DEP(kmc_dea)(int r1, int r2, REGS *regs)
 /*----------------------------------------------------------------------------*/
 static void ARCH_DEP(kmc_aes)(int r1, int r2, REGS *regs)
 {
-  aes_context context;
+  crypt_aes_key context;
   int crypted;
-  int i;
+  BYTE *in;
   int keylen;
+  int len;
   BYTE message_block[16];
   int modifier_bit;
-  BYTE ocv[16];
+  BYTE *out;
   BYTE parameter_block[80];
   int parameter_blocklen;
   int r1_is_not_r2;
@@ -2428,58 +2662,71 @@ static void ARCH_DEP(kmc_aes)(int r1, int r2, REGS *regs)
 #endif /* #ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_3 */
 
   /* Set the cryptographic key */
-  aes_set_key(&context, &parameter_block[16], keylen * 8);
+  crypt_aes_set_key(&context, &parameter_block[16], keylen * 8);
 
   /* Try to process the CPU-determined amount of data */
   modifier_bit = GR0_m(regs);
   r1_is_not_r2 = r1 != r2;
-  for(crypted = 0; crypted < PROCESS_MAX; crypted += 16)
+  for(crypted = 0; crypted < PROCESS_MAX; crypted += len)
   {
-    /* Fetch a block of data */
-    ARCH_DEP(vfetchc)(message_block, 15, GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs);
+    /* Cipher the blocks within the current pages in place */
+    len = PROCESS_MAX - crypted;
+    if(GR_A(r2 + 1, regs) < (VADR) len)
+      len = (int) GR_A(r2 + 1, regs);
+    len = ARCH_DEP(crypt_span)(r1, r2, 16, len, regs);
+    if(likely(len))
+    {
+      in = MADDR(GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs, ACCTYPE_READ, regs->psw.pkey);
+      out = MADDR(GR_A(r1, regs) & ADDRESS_MAXWRAP(regs), r1, regs, ACCTYPE_WRITE, regs->psw.pkey);
+
+      /* Keep the block at a time result of overlapping operands */
+      if(unlikely(out > in && out < in + len))
+        len = 16;
 
 #ifdef OPTION_KMC_DEBUG
-    LOGBYTE("input :", message_block, 16);
+      LOGBYTE2("input :", in, 16, len / 16);
 #endif /* #ifdef OPTION_KMC_DEBUG */
 
-    /* Do the job */
-    if(modifier_bit)
-    {
+      /* Do the job */
+      crypt_aes_cbc(&context, modifier_bit, parameter_block, out, in, len);
 
-      /* Save, decrypt and XOR */
-      memcpy(ocv, message_block, 16);
-      aes_decrypt(&context, message_block, message_block);
-      for(i = 0; i < 16; i++)
-        message_block[i] ^= parameter_block[i];
+#ifdef OPTION_KMC_DEBUG
+      LOGBYTE2("output:", out, 16, len / 16);
+#endif /* #ifdef OPTION_KMC_DEBUG */
     }
     else
     {
-      /* XOR, encrypt and save */
-      for(i = 0; i < 16; i++)
-        message_block[i] ^= parameter_block[i];
-      aes_encrypt(&context, message_block, message_block);
-      memcpy(ocv, message_block, 16);
-    }
+      /* Fetch a block of data crossing a page boundary */
+      ARCH_DEP(vfetchc)(message_block, 15, GR_A(r2, regs) & ADDRESS_MAXWRAP(regs), r2, regs);
+      len = 16;
 
-    /* Store the output */
-    ARCH_DEP(vstorec)(message_block, 15, GR_A(r1, regs) & ADDRESS_MAXWRAP(regs), r1, regs);
+#ifdef OPTION_KMC_DEBUG
+      LOGBYTE("input :", message_block, 16);
+#endif /* #ifdef OPTION_KMC_DEBUG */
+
+      /* Do the job */
+      crypt_aes_cbc(&context, modifier_bit, parameter_block, message_block, message_block, 16);
+
+      /* Store the output */
+      ARCH_DEP(vstorec)(message_block, 15, GR_A(r1, regs) & ADDRESS_MAXWRAP(regs), r1, regs);
 
 #ifdef OPTION_KMC_DEBUG
-    LOGBYTE("output:", message_block, 16);
+      LOGBYTE("output:", message_block, 16);
 #endif /* #ifdef OPTION_KMC_DEBUG */
+    }
 
     /* Store the output chaining value */
-    ARCH_DEP(vstorec)(ocv, 15, GR_A(1, regs) & ADDRESS_MAXWRAP(regs), 1, regs);
+    ARCH_DEP(vstorec)(parameter_block, 15, GR_A(1, regs) & ADDRESS_MAXWRAP(regs), 1, regs);
 
 #ifdef OPTION_KMC_DEBUG
-    LOGBYTE("ocv   :", ocv, 16);
+    LOGBYTE("ocv   :", parameter_block, 16);
 #endif /* #ifdef OPTION_KMC_DEBUG */
 
     /* Update the registers */
-    SET_GR_A(r1, regs, GR_A(r1, regs) + 16);
+    SET_GR_A(r1, regs, GR_A(r1, regs) + len);
     if(likely(r1_is_not_r2))
-      SET_GR_A(r2, regs, GR_A(r2, regs) + 16);
-    SET_GR_A(r2 + 1, regs, GR_A(r2 + 1, regs) - 16);
+      SET_GR_A(r2, regs, GR_A(r2, regs) + len);
+    SET_GR_A(r2 + 1, regs, GR_A(r2 + 1, regs) - len);
 
 #ifdef OPTION_KMC_DEBUG
     logmsg("  GR%02d  : " F_GREG "\n", r1, (regs)->GR(r1));
@@ -2493,9 +2740,6 @@ static void ARCH_DEP(kmc_aes)(int r1, int r2, REGS *regs)
       regs->psw.cc = 0;
       return;
     }
-
-    /* Set cv for next 16 bytes */
-    memcpy(parameter_block, ocv, 16);
   }
 
   /* CPU-determined amount of data processed */
@@ -4920,6 +5164,175 @@ DEF_INST(perform_cryptographic_key_management_operation_d)
   #include "dyncrypt.c"
 #endif /* #ifdef _ARCHMODE3 */
 
+#if defined(OPTION_DYNAMIC_LOAD) && defined(_FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_4)
+/*----------------------------------------------------------------------------*/
+/* cryptbench panel command                                                   */
+/*----------------------------------------------------------------------------*/
+/* Times the multiple block functions with the portable code and with the     */
+/* host instructions and checks that both give the same result.               */
+#define CRYPT_BENCH_LEN    65536       /* Bytes per pass                     */
+#define CRYPT_BENCH_PASSES 64          /* Passes per measurement             */
+
+static struct
+{
+  char *name;                          /* Function code name                 */
+  int fn;                              /* Function                           */
+  int keylen;                          /* AES key length in bytes            */
+  int outlen;                          /* Result length                      */
+} crypt_bench_tab[] =
+{
+  { "KM-AES-128 encipher",  0, 16, CRYPT_BENCH_LEN },
+  { "KM-AES-128 decipher",  1, 16, CRYPT_BENCH_LEN },
+  { "KM-AES-192 encipher",  0, 24, CRYPT_BENCH_LEN },
+  { "KM-AES-256 encipher",  0, 32, CRYPT_BENCH_LEN },
+  { "KMC-AES-128 encipher", 2, 16, CRYPT_BENCH_LEN },
+  { "KMC-AES-128 decipher", 3, 16, CRYPT_BENCH_LEN },
+  { "KMC-AES-256 encipher", 2, 32, CRYPT_BENCH_LEN },
+  { "KMAC-AES-128",         4, 16, 16 },
+  { "KIMD-SHA-1",           5,  0, 20 },
+  { "KIMD-SHA-256",         6,  0, 32 },
+  { "KIMD-GHASH",           7,  0, 16 }
+};
+
+static void crypt_bench_pass(int fn, crypt_aes_key *key, BYTE *out, BYTE *in)
+{
+  BYTE cv[16];
+  sha1_context sha1_ctx;
+  sha256_context sha256_ctx;
+
+  memset(cv, 0, sizeof(cv));
+  switch(fn)
+  {
+    case 0:
+    case 1:
+      crypt_aes_ecb(key, fn, out, in, CRYPT_BENCH_LEN);
+      break;
+    case 2:
+    case 3:
+      crypt_aes_cbc(key, fn - 2, cv, out, in, CRYPT_BENCH_LEN);
+      break;
+    case 4:
+      crypt_aes_cbc(key, 0, cv, NULL, in, CRYPT_BENCH_LEN);
+      memcpy(out, cv, 16);
+      break;
+    case 5:
+      sha1_seticv(&sha1_ctx, in);
+      crypt_sha1(&sha1_ctx, in, CRYPT_BENCH_LEN);
+      sha1_getcv(&sha1_ctx, out);
+      break;
+    case 6:
+      sha256_seticv(&sha256_ctx, in);
+      crypt_sha256(&sha256_ctx, in, CRYPT_BENCH_LEN);
+      sha256_getcv(&sha256_ctx, out);
+      break;
+    case 7:
+      crypt_ghash(cv, in, in, CRYPT_BENCH_LEN);
+      memcpy(out, cv, 16);
+      break;
+  }
+}
+
+/* Returns the throughput in MB/s */
+static double crypt_bench_time(int i, BYTE *out, BYTE *in)
+{
+  crypt_aes_key key;
+  struct timeval beg, end;
+  double usecs;
+  int n;
+
+  if(crypt_bench_tab[i].keylen)
+    crypt_aes_set_key(&key, in, crypt_bench_tab[i].keylen * 8);
+  gettimeofday(&beg, NULL);
+  for(n = 0; n < CRYPT_BENCH_PASSES; n++)
+    crypt_bench_pass(crypt_bench_tab[i].fn, &key, out, in);
+  gettimeofday(&end, NULL);
+  usecs = (end.tv_sec - beg.tv_sec) * 1000000.0 + (end.tv_usec - beg.tv_usec);
+  if(usecs < 1)
+    usecs = 1;
+  return (double) CRYPT_BENCH_LEN * CRYPT_BENCH_PASSES / usecs;
+}
+
+static void crypt_bench(void)
+{
+  BYTE *in, *out1, *out2;
+  double rate1, rate2;
+  int avail;
+  int i;
+
+  in = malloc(CRYPT_BENCH_LEN);
+  out1 = malloc(CRYPT_BENCH_LEN);
+  out2 = malloc(CRYPT_BENCH_LEN);
+  if(!in || !out1 || !out2)
+  {
+    logmsg(_("HHCCY002E cryptbench: cannot obtain buffers: %s\n"), strerror(errno));
+    free(in);
+    free(out1);
+    free(out2);
+    return;
+  }
+  for(i = 0; i < CRYPT_BENCH_LEN; i++)
+    in[i] = (BYTE)(i * 167 + (i >> 8) * 13);
+
+  for(i = 0; i < (int)(sizeof(crypt_bench_tab) / sizeof(crypt_bench_tab[0])); i++)
+  {
+    avail = 0;
+#if defined(OPTION_HOST_SIMD)
+    switch(crypt_bench_tab[i].fn)
+    {
+      case 5:
+      case 6:
+        avail = hostinfo.sha_avail;
+        break;
+      case 7:
+        avail = hostinfo.pclmul_avail;
+        break;
+      default:
+        avail = hostinfo.aes_avail;
+    }
+#endif /* defined(OPTION_HOST_SIMD) */
+
+    crypt_accel = 0;
+    rate1 = crypt_bench_time(i, out1, in);
+    crypt_accel = 1;
+    if(!avail)
+    {
+      logmsg(_("HHCCY001I %-20s %8.1f MB/s portable, no host instructions\n"),
+        crypt_bench_tab[i].name, rate1);
+      continue;
+    }
+    rate2 = crypt_bench_time(i, out2, in);
+    if(memcmp(out1, out2, crypt_bench_tab[i].outlen))
+      logmsg(_("HHCCY003E %-20s host instruction result differs from portable result\n"),
+        crypt_bench_tab[i].name);
+    else
+      logmsg(_("HHCCY001I %-20s %8.1f MB/s portable, %8.1f MB/s host instructions\n"),
+        crypt_bench_tab[i].name, rate1, rate2);
+  }
+
+  free(in);
+  free(out1);
+  free(out2);
+}
+
+static void *crypt_panel_command(char *cmd)
+{
+  void *(*next_panel_command_handler)(char *cmd);
+
+  if(!strncasecmp(cmd, "cryptbench", 10) && (!cmd[10] || isspace((unsigned char) cmd[10])))
+  {
+    crypt_bench();
+    return NULL;
+  }
+
+  next_panel_command_handler = HDL_FINDNXT(crypt_panel_command);
+
+  if(!next_panel_command_handler)
+    return NULL;
+
+  return next_panel_command_handler(cmd);
+}
+#endif /* defined(OPTION_DYNAMIC_LOAD) && defined(_FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_4) */
+
 HDL_DEPENDENCY_SECTION;
 {
    HDL_DEPENDENCY(HERCULES);
@@ -4958,6 +5371,10 @@ HDL_REGISTER_SECTION;
   HDL_REGISTER(z900_perform_cryptographic_key_management_operation, z900_perform_cryptographic_key_management_operation_d);
 #endif /*defined(_900_FEATURE_MESSAGE_SECURITY_ASSIST)*/
 
+#if defined(OPTION_DYNAMIC_LOAD) && defined(_FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_4)
+  HDL_REGISTER(panel_command, crypt_panel_command);
+#endif /* defined(OPTION_DYNAMIC_LOAD) && defined(_FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_4) */
+
   logmsg("Crypto module loaded (c) Copyright Bernard van der Helm, 2003-2010\n");
   logmsg("  Active: Message Security Assist\n");
 #ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_1
@@ -4972,6 +5389,11 @@ HDL_REGISTER_SECTION;
 #ifdef FEATURE_MESSAGE_SECURITY_ASSIST_EXTENSION_4
   logmsg("          Message Security Assist Extension 4\n");
 #endif
+#if defined(OPTION_HOST_SIMD)
+  if(hostinfo.aes_avail || hostinfo.sha_avail || hostinfo.pclmul_avail)
+    logmsg("  Host:   %s%s%s\n", hostinfo.aes_avail ? "AES-NI " : "",
+      hostinfo.sha_avail ? "SHA " : "", hostinfo.pclmul_avail ? "PCLMULQDQ" : "");
+#endif /* defined(OPTION_HOST_SIMD) */
 }
 END_REGISTER_SECTION;
 
@@ -0,0 +1,401 @@
+/* HWCRYPT.C    Host crypto instruction kernels for dyncrypt         */
+
+/*   Released under the Q Public License                             */
+/*      (http://www.hercules-390.org/herclic.html)                   */
+/*   as modifications to Hercules.                                   */
+
+/*-------------------------------------------------------------------*/
+/* AES, SHA-1, SHA-256 and GHASH over a run of blocks using the      */
+/* AES-NI, SHA and PCLMULQDQ host instructions.  Each function is    */
+/* compiled with a target attribute so that the rest of the module   */
+/* is still built for the baseline instruction set; dyncrypt calls   */
+/* them only after checking hostinfo.                                */
+/*                                                                   */
+/* The AES functions use the key schedules computed by aes.c, which  */
+/* hold each round key as four big-endian words.  The decryption     */
+/* schedule is already in the equivalent inverse cipher form that    */
+/* AESDEC expects.  The SHA functions update the state words of the  */
+/* sha1.c and sha256.c contexts, and GHASH uses the bit-reflected    */
+/* multiplication of Gueron and Kounavis with the operands held in   */
+/* reversed byte order.                                              */
+/*-------------------------------------------------------------------*/
+
+#include "hstdinc.h"
+
+#if !defined(_HENGINE_DLL_)
+#define _HENGINE_DLL_
+#endif
+
+#include "hercules.h"
+#include "opcode.h" /* For store_fw */
+
+#include "aes.h"
+#include "hwcrypt.h"
+
+#if defined(OPTION_HOST_SIMD)
+
+#include <immintrin.h>
+
+/*-------------------------------------------------------------------*/
+/* Convert the aes.c key schedules to AES-NI round keys              */
+/*-------------------------------------------------------------------*/
+void aesni_set_key(aesni_key *key, aes_context *ctx)
+{
+int     r, w;                           /* Round and word numbers    */
+
+    key->nr = ctx->Nr;
+    for (r = 0; r <= ctx->Nr; r++)
+        for (w = 0; w < 4; w++)
+        {
+            store_fw(&key->ek[r][4*w], ctx->ek[4*r + w]);
+            store_fw(&key->dk[r][4*w], ctx->dk[4*r + w]);
+        }
+}
+
+/*-------------------------------------------------------------------*/
+/* Electronic codebook mode                                          */
+/*-------------------------------------------------------------------*/
+/* Four blocks are processed at a time to hide the latency of the    */
+/* AESENC and AESDEC instructions.  All four blocks are loaded       */
+/* before any is stored, so out may equal in but the caller must not */
+/* otherwise let the operands overlap.                               */
+__attribute__((target("aes")))
+void aesni_ecb(aesni_key *key, int decrypt, BYTE *out, BYTE *in, int len)
+{
+__m128i rk[MAXNR + 1];                  /* Round keys                */
+__m128i b0, b1, b2, b3;                 /* Blocks                    */
+int     nr = key->nr;                   /* Number of rounds          */
+int     i, r;                           /* Work variables            */
+
+    for (r = 0; r <= nr; r++)
+        rk[r] = _mm_loadu_si128((__m128i *)
+                    (decrypt ? key->dk[r] : key->ek[r]));
+
+    for (i = 0; i + 64 <= len; i += 64)
+    {
+        b0 = _mm_xor_si128(_mm_loadu_si128((__m128i *)(in + i)), rk[0]);
+        b1 = _mm_xor_si128(_mm_loadu_si128((__m128i *)(in + i + 16)), rk[0]);
+        b2 = _mm_xor_si128(_mm_loadu_si128((__m128i *)(in + i + 32)), rk[0]);
+        b3 = _mm_xor_si128(_mm_loadu_si128((__m128i *)(in + i + 48)), rk[0]);
+        if (decrypt)
+        {
+            for (r = 1; r < nr; r++)
+            {
+                b0 = _mm_aesdec_si128(b0, rk[r]);
+                b1 = _mm_aesdec_si128(b1, rk[r]);
+                b2 = _mm_aesdec_si128(b2, rk[r]);
+                b3 = _mm_aesdec_si128(b3, rk[r]);
+            }
+            b0 = _mm_aesdeclast_si128(b0, rk[nr]);
+            b1 = _mm_aesdeclast_si128(b1, rk[nr]);
+            b2 = _mm_aesdeclast_si128(b2, rk[nr]);
+            b3 = _mm_aesdeclast_si128(b3, rk[nr]);
+        }
+        else
+        {
+            for (r = 1; r < nr; r++)
+            {
+                b0 = _mm_aesenc_si128(b0, rk[r]);
+                b1 = _mm_aesenc_si128(b1, rk[r]);
+                b2 = _mm_aesenc_si128(b2, rk[r]);
+                b3 = _mm_aesenc_si128(b3, rk[r]);
+            }
+            b0 = _mm_aesenclast_si128(b0, rk[nr]);
+            b1 = _mm_aesenclast_si128(b1, rk[nr]);
+            b2 = _mm_aesenclast_si128(b2, rk[nr]);
+            b3 = _mm_aesenclast_si128(b3, rk[nr]);
+        }
+        _mm_storeu_si128((__m128i *)(out + i), b0);
+        _mm_storeu_si128((__m128i *)(out + i + 16), b1);
+        _mm_storeu_si128((__m128i *)(out + i + 32), b2);
+        _mm_storeu_si128((__m128i *)(out + i + 48), b3);
+    }
+
+    for ( ; i < len; i += 16)
+    {
+        b0 = _mm_xor_si128(_mm_loadu_si128((__m128i *)(in + i)), rk[0]);
+        if (decrypt)
+        {
+            for (r = 1; r < nr; r++)
+                b0 = _mm_aesdec_si128(b0, rk[r]);
+            b0 = _mm_aesdeclast_si128(b0, rk[nr]);
+        }
+        else
+        {
+            for (r = 1; r < nr; r++)
+                b0 = _mm_aesenc_si128(b0, rk[r]);
+            b0 = _mm_aesenclast_si128(b0, rk[nr]);
+        }
+        _mm_storeu_si128((__m128i *)(out + i), b0);
+    }
+}
+
+/*-------------------------------------------------------------------*/
+/* Cipher block chaining mode                                        */
+/*-------------------------------------------------------------------*/
+/* cv holds the chaining value on entry and the output chaining      */
+/* value on return.  When out is NULL only the chaining value of an  */
+/* encryption is computed, as for the CBC-MAC of KMAC.  Decryption   */
+/* is processed four blocks at a time with the same overlap rule as  */
+/* aesni_ecb; encryption is inherently one block at a time.          */
+__attribute__((target("aes")))
+void aesni_cbc(aesni_key *key, int decrypt, BYTE cv[16], BYTE *out, BYTE *in, int len)
+{
+__m128i rk[MAXNR + 1];                  /* Round keys                */
+__m128i c;                              /* Chaining value            */
+__m128i x0, x1, x2, x3;                 /* Input blocks              */
+__m128i b0, b1, b2, b3;                 /* Output blocks             */
+int     nr = key->nr;                   /* Number of rounds          */
+int     i, r;                           /* Work variables            */
+
+    for (r = 0; r <= nr; r++)
+        rk[r] = _mm_loadu_si128((__m128i *)
+                    (decrypt ? key->dk[r] : key->ek[r]));
+    c = _mm_loadu_si128((__m128i *)cv);
+
+    if (!decrypt)
+    {
+        for (i = 0; i < len; i += 16)
+        {
+            c = _mm_xor_si128(c, _mm_loadu_si128((__m128i *)(in + i)));
+            c = _mm_xor_si128(c, rk[0]);
+            for (r = 1; r < nr; r++)
+                c = _mm_aesenc_si128(c, rk[r]);
+            c = _mm_aesenclast_si128(c, rk[nr]);
+            if (out)
+                _mm_storeu_si128((__m128i *)(out + i), c);
+        }
+        _mm_storeu_si128((__m128i *)cv, c);
+        return;
+    }
+
+    for (i = 0; i + 64 <= len; i += 64)
+    {
+        x0 = _mm_loadu_si128((__m128i *)(in + i));
+        x1 = _mm_loadu_si128((__m128i *)(in + i + 16));
+        x2 = _mm_loadu_si128((__m128i *)(in + i + 32));
+        x3 = _mm_loadu_si128((__m128i *)(in + i + 48));
+        b0 = _mm_xor_si128(x0, rk[0]);
+        b1 = _mm_xor_si128(x1, rk[0]);
+        b2 = _mm_xor_si128(x2, rk[0]);
+        b3 = _mm_xor_si128(x3, rk[0]);
+        for (r = 1; r < nr; r++)
+        {
+            b0 = _mm_aesdec_si128(b0, rk[r]);
+            b1 = _mm_aesdec_si128(b1, rk[r]);
+            b2 = _mm_aesdec_si128(b2, rk[r]);
+            b3 = _mm_aesdec_si128(b3, rk[r]);
+        }
+        b0 = _mm_xor_si128(_mm_aesdeclast_si128(b0, rk[nr]), c);
+        b1 = _mm_xor_si128(_mm_aesdeclast_si128(b1, rk[nr]), x0);
+        b2 = _mm_xor_si128(_mm_aesdeclast_si128(b2, rk[nr]), x1);
+        b3 = _mm_xor_si128(_mm_aesdeclast_si128(b3, rk[nr]), x2);
+        _mm_storeu_si128((__m128i *)(out + i), b0);
+        _mm_storeu_si128((__m128i *)(out + i + 16), b1);
+        _mm_storeu_si128((__m128i *)(out + i + 32), b2);
+        _mm_storeu_si128((__m128i *)(out + i + 48), b3);
+        c = x3;
+    }
+
+    for ( ; i < len; i += 16)
+    {
+        x0 = _mm_loadu_si128((__m128i *)(in + i));
+        b0 = _mm_xor_si128(x0, rk[0]);
+        for (r = 1; r < nr; r++)
+            b0 = _mm_aesdec_si128(b0, rk[r]);
+        b0 = _mm_xor_si128(_mm_aesdeclast_si128(b0, rk[nr]), c);
+        _mm_storeu_si128((__m128i *)(out + i), b0);
+        c = x0;
+    }
+    _mm_storeu_si128((__m128i *)cv, c);
+}
+
+/*-------------------------------------------------------------------*/
+/* SHA-1 compression                                                 */
+/*-------------------------------------------------------------------*/
+/* Four rounds: w[i&3] becomes message schedule vector i, which is   */
+/* added into the E value derived from the A of four rounds ago      */
+#define SHA1_ROUNDS4(_i)                                              \
+do {                                                                  \
+    if ((_i) >= 4)                                                    \
+        w[(_i) & 3] = _mm_sha1msg2_epu32(_mm_xor_si128(               \
+                          _mm_sha1msg1_epu32(w[(_i) & 3],             \
+                                             w[((_i) + 1) & 3]),      \
+                          w[((_i) + 2) & 3]), w[((_i) + 3) & 3]);     \
+    e = _mm_sha1nexte_epu32(prev, w[(_i) & 3]);                       \
+    prev = abcd;                                                      \
+    abcd = _mm_sha1rnds4_epu32(abcd, e, (_i) / 5);                    \
+} while (0)
+
+__attribute__((target("sha,sse4.1")))
+void shani_sha1(u_int32_t state[5], BYTE *data, int len)
+{
+__m128i mask = _mm_set_epi64x(0x0001020304050607ULL,
+                              0x08090a0b0c0d0e0fULL);
+__m128i abcd, e0;                       /* State                     */
+__m128i abcd_save, e0_save;             /* State at start of block   */
+__m128i prev, e;                        /* Round inputs              */
+__m128i w[4];                           /* Message schedule          */
+int     i;                              /* Work variable             */
+
+    abcd = _mm_shuffle_epi32(_mm_loadu_si128((__m128i *)state), 0x1B);
+    e0 = _mm_set_epi32(state[4], 0, 0, 0);
+
+    for ( ; len >= 64; len -= 64, data += 64)
+    {
+        abcd_save = abcd;
+        e0_save = e0;
+        for (i = 0; i < 4; i++)
+            w[i] = _mm_shuffle_epi8(
+                       _mm_loadu_si128((__m128i *)(data + 16*i)), mask);
+
+        e = _mm_add_epi32(e0, w[0]);
+        prev = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e, 0);
+        SHA1_ROUNDS4(1);  SHA1_ROUNDS4(2);  SHA1_ROUNDS4(3);
+        SHA1_ROUNDS4(4);  SHA1_ROUNDS4(5);  SHA1_ROUNDS4(6);
+        SHA1_ROUNDS4(7);  SHA1_ROUNDS4(8);  SHA1_ROUNDS4(9);
+        SHA1_ROUNDS4(10); SHA1_ROUNDS4(11); SHA1_ROUNDS4(12);
+        SHA1_ROUNDS4(13); SHA1_ROUNDS4(14); SHA1_ROUNDS4(15);
+        SHA1_ROUNDS4(16); SHA1_ROUNDS4(17); SHA1_ROUNDS4(18);
+        SHA1_ROUNDS4(19);
+
+        e0 = _mm_sha1nexte_epu32(prev, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+
+    _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = _mm_extract_epi32(e0, 3);
+}
+
+/*-------------------------------------------------------------------*/
+/* SHA-256 compression                                               */
+/*-------------------------------------------------------------------*/
+static const u_int32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/* SHA256RNDS2 works on the state as ABEF and CDGH halves           */
+__attribute__((target("sha,sse4.1")))
+void shani_sha256(u_int32_t state[8], BYTE *data, int len)
+{
+__m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+                              0x0405060700010203ULL);
+__m128i s0, s1;                         /* ABEF and CDGH             */
+__m128i s0_save, s1_save;               /* State at start of block   */
+__m128i m, t;                           /* Work vectors              */
+__m128i w[4];                           /* Message schedule          */
+int     i;                              /* Work variable             */
+
+    t = _mm_shuffle_epi32(_mm_loadu_si128((__m128i *)state), 0xB1);
+    s1 = _mm_shuffle_epi32(_mm_loadu_si128((__m128i *)(state + 4)), 0x1B);
+    s0 = _mm_alignr_epi8(t, s1, 8);
+    s1 = _mm_blend_epi16(s1, t, 0xF0);
+
+    for ( ; len >= 64; len -= 64, data += 64)
+    {
+        s0_save = s0;
+        s1_save = s1;
+        for (i = 0; i < 16; i++)
+        {
+            if (i < 4)
+                w[i] = _mm_shuffle_epi8(
+                           _mm_loadu_si128((__m128i *)(data + 16*i)), mask);
+            else
+                w[i & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(
+                               _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]),
+                               _mm_alignr_epi8(w[(i + 3) & 3],
+                                               w[(i + 2) & 3], 4)),
+                               w[(i + 3) & 3]);
+            m = _mm_add_epi32(w[i & 3],
+                    _mm_loadu_si128((__m128i *)(sha256_k + 4*i)));
+            s1 = _mm_sha256rnds2_epu32(s1, s0, m);
+            s0 = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(m, 0x0E));
+        }
+        s0 = _mm_add_epi32(s0, s0_save);
+        s1 = _mm_add_epi32(s1, s1_save);
+    }
+
+    t = _mm_shuffle_epi32(s0, 0x1B);
+    s1 = _mm_shuffle_epi32(s1, 0xB1);
+    _mm_storeu_si128((__m128i *)state, _mm_blend_epi16(t, s1, 0xF0));
+    _mm_storeu_si128((__m128i *)(state + 4), _mm_alignr_epi8(s1, t, 8));
+}
+
+/*-------------------------------------------------------------------*/
+/* GHASH                                                             */
+/*-------------------------------------------------------------------*/
+/* Multiply a by b in GF(2^128), both in reversed byte order: a      */
+/* 256 bit carry-less product, shifted left one bit to account for   */
+/* the bit reflection, then reduced by x^128 + x^7 + x^2 + x + 1     */
+__attribute__((target("pclmul,sse4.1")))
+static __m128i clmul_gfmul(__m128i a, __m128i b)
+{
+__m128i lo, hi, mid, t, u, v;           /* Work vectors              */
+
+    lo  = _mm_clmulepi64_si128(a, b, 0x00);
+    hi  = _mm_clmulepi64_si128(a, b, 0x11);
+    mid = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10),
+                        _mm_clmulepi64_si128(a, b, 0x01));
+    lo  = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi  = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+    /* Shift the product hi:lo left one bit */
+    t = _mm_srli_epi32(lo, 31);
+    u = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    v = _mm_srli_si128(t, 12);
+    u = _mm_slli_si128(u, 4);
+    t = _mm_slli_si128(t, 4);
+    lo = _mm_or_si128(lo, t);
+    hi = _mm_or_si128(hi, _mm_or_si128(u, v));
+
+    /* Reduce modulo the field polynomial */
+    t = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31),
+                                    _mm_slli_epi32(lo, 30)),
+                      _mm_slli_epi32(lo, 25));
+    u = _mm_srli_si128(t, 4);
+    lo = _mm_xor_si128(lo, _mm_slli_si128(t, 12));
+    v = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1),
+                                    _mm_srli_epi32(lo, 2)),
+                      _mm_srli_epi32(lo, 7));
+    lo = _mm_xor_si128(lo, _mm_xor_si128(v, u));
+    return _mm_xor_si128(hi, lo);
+}
+
+__attribute__((target("pclmul,sse4.1")))
+void clmul_ghash(BYTE cv[16], BYTE h[16], BYTE *data, int len)
+{
+__m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                            8, 9, 10, 11, 12, 13, 14, 15);
+__m128i y, hk;                          /* Hash value and subkey     */
+int     i;                              /* Work variable             */
+
+    y  = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)cv), swap);
+    hk = _mm_shuffle_epi8(_mm_loadu_si128((__m128i *)h), swap);
+
+    for (i = 0; i < len; i += 16)
+        y = clmul_gfmul(_mm_xor_si128(y, _mm_shuffle_epi8(
+                            _mm_loadu_si128((__m128i *)(data + i)), swap)),
+                        hk);
+
+    _mm_storeu_si128((__m128i *)cv, _mm_shuffle_epi8(y, swap));
+}
+
+#endif /* defined(OPTION_HOST_SIMD) */
@@ -0,0 +1,38 @@
+/* HWCRYPT.H    Host crypto instruction kernels for dyncrypt         */
+
+/*   Released under the Q Public License                             */
+/*      (http://www.hercules-390.org/herclic.html)                   */
+/*   as modifications to Hercules.                                   */
+
+/*-------------------------------------------------------------------*/
+/* These functions process a run of whole blocks held in host        */
+/* storage with the AES-NI, SHA and PCLMULQDQ instructions of the    */
+/* host.  They are only compiled when OPTION_HOST_SIMD is defined,   */
+/* and may only be called when hostinfo reports the corresponding    */
+/* instructions as available.  The len arguments are byte counts     */
+/* which are a multiple of the block size.                           */
+/*-------------------------------------------------------------------*/
+
+#ifndef _HWCRYPT_H
+#define _HWCRYPT_H
+
+#if defined(OPTION_HOST_SIMD)
+
+/* AES round keys in the byte order used by AESENC and AESDEC       */
+typedef struct {
+        BYTE    ek[MAXNR + 1][16];      /* Encryption round keys     */
+        BYTE    dk[MAXNR + 1][16];      /* Equivalent inverse cipher
+                                           decryption round keys     */
+        int     nr;                     /* Number of rounds          */
+} aesni_key;
+
+void aesni_set_key(aesni_key *key, aes_context *ctx);
+void aesni_ecb(aesni_key *key, int decrypt, BYTE *out, BYTE *in, int len);
+void aesni_cbc(aesni_key *key, int decrypt, BYTE cv[16], BYTE *out, BYTE *in, int len);
+void shani_sha1(u_int32_t state[5], BYTE *data, int len);
+void shani_sha256(u_int32_t state[8], BYTE *data, int len);
+void clmul_ghash(BYTE cv[16], BYTE h[16], BYTE *data, int len);
+
+#endif /* defined(OPTION_HOST_SIMD) */
+
+#endif /* _HWCRYPT_H */
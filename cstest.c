@@ -0,0 +1,359 @@
+/* CSTEST.C     Interlocked update stress test                       */
+
+/*-------------------------------------------------------------------*/
+/* This program checks that CS, CDS and CDSG are interlocked when    */
+/* several CPUs update the same storage at the same time.  Each      */
+/* host thread runs a ghost CPU which increments a shared word with  */
+/* CS, a shared doubleword with CDS and a shared quadword with CDSG, */
+/* retrying each update with the value returned when the comparison  */
+/* fails, as a guest does.  The final counts must be exact.  Other   */
+/* CPUs meanwhile read the quadword with LPQ, and every value read   */
+/* must be one which CDSG stored.  An updater sometimes yields the   */
+/* host CPU between fetching an operand and updating it, so that the */
+/* retry is taken even when the host has fewer CPUs than the test.   */
+/*                                                                   */
+/* The test runs as the instructions are built for this host, which  */
+/* is without mainlock when the host compare and swap routines are   */
+/* atomic (CMPXCHG_LOCKFREE), and then again with the instructions   */
+/* taking mainlock, as they do on an amd64 host without CMPXCHG16B.  */
+/*                                                                   */
+/* Usage: cstest [count [cpus]]                                      */
+/*                                                                   */
+/* Any difference is displayed; the return code is the number of     */
+/* differences found, up to 255.                                     */
+/*-------------------------------------------------------------------*/
+
+#include "hstdinc.h"
+
+#define _GEN_ARCH 900                   /* z/Architecture only       */
+#define _ONE_ARCH_                      /* No other instfetch        */
+
+#include "hercules.h"
+
+#include "opcode.h"
+
+/*-------------------------------------------------------------------*/
+/* Test storage layout                                               */
+/*-------------------------------------------------------------------*/
+#define TEST_MAINSIZE   0x10000         /* Main storage size         */
+#define TEST_CS         0x800           /* CS word                   */
+#define TEST_CDS        0x808           /* CDS doubleword            */
+#define TEST_CDSG       0x810           /* CDSG and LPQ quadword     */
+
+#define TEST_READERS    2               /* CPUs doing LPQ            */
+
+typedef void (*INSTFN) (BYTE inst[], REGS *regs);
+
+typedef struct _TESTCPU {               /* Test CPU                  */
+        TID     tid;                    /* Host thread               */
+        REGS   *regs;                   /* -> CPU register context   */
+        int     reader;                 /* 1=LPQ reader, 0=updater   */
+        int     count;                  /* Updates to do             */
+        int     errors;                 /* Differences found         */
+        U64     reads;                  /* LPQ reads done            */
+        U64     retries;                /* Updates which had to retry*/
+    } TESTCPU;
+
+static BYTE cs_inst[]   = { 0xBA, 0x23, 0x08, 0x00 };
+static BYTE cds_inst[]  = { 0xBB, 0x24, 0x08, 0x08 };
+static BYTE cdsg_inst[] = { 0xEB, 0x24, 0x08, 0x10, 0x00, 0x3E };
+static BYTE lpq_inst[]  = { 0xE3, 0x20, 0x08, 0x10, 0x00, 0x8F };
+
+static LOCK test_lock;                  /* Start and end lock        */
+static COND test_cond;                  /* Start condition           */
+static int  test_go;                    /* 1=CPUs may start          */
+static volatile int test_running;       /* Updaters still running    */
+
+/*-------------------------------------------------------------------*/
+/* Initialize a ghost CPU running in z/Architecture real mode        */
+/*-------------------------------------------------------------------*/
+static REGS *test_regs (int cpu, BYTE *mainstor, BYTE *storkeys)
+{
+REGS   *regs;                           /* -> CPU register context   */
+
+    regs = calloc (1, sizeof(REGS));
+    if (regs == NULL) return NULL;
+    regs->mainstor = mainstor;
+    regs->storkeys = storkeys;
+    regs->mainlim = TEST_MAINSIZE - 1;
+    regs->psa = (PSA_3XX *)regs->mainstor;
+    regs->sysblk = &sysblk;
+    regs->arch_mode = ARCH_900;
+    regs->ghostregs = 1;
+    regs->hostregs = regs;
+    regs->cpuad = cpu;
+    regs->cpubit = CPU_BIT(cpu);
+    regs->tlbID = 1;
+    regs->psw.amode64 = regs->psw.amode = 1;
+    regs->psw.AMASK = AMASK64;
+    regs->program_interrupt = &z900_program_interrupt;
+    return regs;
+}
+
+/*-------------------------------------------------------------------*/
+/* Execute an instruction, returning the program interruption code   */
+/*-------------------------------------------------------------------*/
+static int test_exec (INSTFN fn, BYTE *inst, REGS *regs)
+{
+int     pcode;                          /* Program interruption code */
+
+    regs->ip = inst;
+    if ((pcode = setjmp (regs->progjmp)) == 0)
+        fn (inst, regs);
+    return pcode;
+}
+
+/*-------------------------------------------------------------------*/
+/* Let the other CPUs update the operand just fetched now and then   */
+/*-------------------------------------------------------------------*/
+static void test_yield (int i)
+{
+    if (i % 64 == 0)
+        sched_yield ();
+}
+
+/*-------------------------------------------------------------------*/
+/* Return 1 if an update must be retried because the comparison      */
+/* failed, counting the retry                                        */
+/*-------------------------------------------------------------------*/
+static int test_retry (TESTCPU *cpu, int pcode)
+{
+    if (pcode || cpu->regs->psw.cc != 1)
+        return 0;
+    cpu->retries++;
+    return 1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Increment the shared operands, or read the quadword with LPQ      */
+/*-------------------------------------------------------------------*/
+static void *test_cpu (TESTCPU *cpu)
+{
+REGS   *regs = cpu->regs;               /* -> CPU register context   */
+U64     prev = 0;                       /* Previous quadword count   */
+int     pcode = 0;                      /* Program interruption code */
+int     i;                              /* Update number             */
+
+    obtain_lock (&test_lock);
+    while (!test_go)
+        wait_condition (&test_cond, &test_lock);
+    release_lock (&test_lock);
+
+    /* Read the quadword until the updaters are done; the second
+       doubleword is always the complement of the first */
+    while (cpu->reader && test_running && !pcode)
+    {
+        if ((pcode = test_exec (z900_load_pair_from_quadword,
+                                lpq_inst, regs)) != 0)
+            break;
+        cpu->reads++;
+        if (regs->GR_G(3) != ~regs->GR_G(2) || regs->GR_G(2) < prev)
+        {
+            printf ("CPU%d: LPQ read %16.16" I64_FMT "X %16.16" I64_FMT "X"
+                    " after %16.16" I64_FMT "X\n",
+                    regs->cpuad, regs->GR_G(2), regs->GR_G(3), prev);
+            if (++cpu->errors >= 16) break;
+        }
+        prev = regs->GR_G(2);
+        test_yield ((int)cpu->reads);
+    }
+
+    for (i = 0; !cpu->reader && i < cpu->count && !pcode; i++)
+    {
+        /* CS: the word counts the updates */
+        regs->GR_L(2) = fetch_fw (regs->mainstor + TEST_CS);
+        test_yield (i);
+        do {
+            regs->GR_L(3) = regs->GR_L(2) + 1;
+            pcode = test_exec (z900_compare_and_swap, cs_inst, regs);
+        } while (test_retry (cpu, pcode));
+
+        /* CDS: the second word is the complement of the first */
+        regs->GR_L(2) = fetch_fw (regs->mainstor + TEST_CDS);
+        regs->GR_L(3) = fetch_fw (regs->mainstor + TEST_CDS + 4);
+        test_yield (i);
+        do {
+            regs->GR_L(4) = regs->GR_L(2) + 1;
+            regs->GR_L(5) = ~regs->GR_L(4);
+            pcode = test_exec (z900_compare_double_and_swap,
+                               cds_inst, regs);
+        } while (test_retry (cpu, pcode));
+
+        /* CDSG: the second doubleword is the complement of the first */
+        regs->GR_G(2) = fetch_dw (regs->mainstor + TEST_CDSG);
+        regs->GR_G(3) = fetch_dw (regs->mainstor + TEST_CDSG + 8);
+        test_yield (i);
+        do {
+            regs->GR_G(4) = regs->GR_G(2) + 1;
+            regs->GR_G(5) = ~regs->GR_G(4);
+            pcode = test_exec (z900_compare_double_and_swap_long,
+                               cdsg_inst, regs);
+        } while (test_retry (cpu, pcode));
+    }
+
+    if (pcode)
+    {
+        printf ("CPU%d: program check %4.4X\n", regs->cpuad, pcode);
+        cpu->errors++;
+    }
+
+    if (!cpu->reader)
+    {
+        obtain_lock (&test_lock);
+        test_running--;
+        release_lock (&test_lock);
+    }
+
+    return NULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* Run the updaters and readers, returning the differences found     */
+/*-------------------------------------------------------------------*/
+static int test_run (char *mode, TESTCPU *cpus, int ncpu, int count,
+                     BYTE *mainstor)
+{
+ATTR    attr;                           /* Joinable thread attribute */
+U32     total;                          /* Expected count            */
+U64     reads = 0;                      /* LPQ reads done            */
+U64     retries = 0;                    /* Updates which had to retry*/
+int     errors = 0;                     /* Number of differences     */
+int     i;                              /* CPU number                */
+
+    memset (mainstor, 0, TEST_MAINSIZE);
+    store_fw (mainstor + TEST_CDS + 4, 0xFFFFFFFF);
+    store_dw (mainstor + TEST_CDSG + 8, 0xFFFFFFFFFFFFFFFFULL);
+
+    /* Every test CPU is started, so that mainlock is taken
+       whenever the instructions need it */
+    sysblk.cpus = ncpu + TEST_READERS;
+    sysblk.started_mask = 0;
+    for (i = 0; i < ncpu + TEST_READERS; i++)
+        sysblk.started_mask |= cpus[i].regs->cpubit;
+
+    test_go = 0;
+    test_running = ncpu;
+    initialize_join_attr (&attr);
+    for (i = 0; i < ncpu + TEST_READERS; i++)
+    {
+        cpus[i].reader = i >= ncpu;
+        cpus[i].count = count;
+        cpus[i].errors = 0;
+        cpus[i].reads = 0;
+        cpus[i].retries = 0;
+        if (create_thread (&cpus[i].tid, &attr, test_cpu, &cpus[i],
+                           "cstest"))
+        {
+            fprintf (stderr, "cstest: create_thread failed\n");
+            exit (255);
+        }
+    }
+
+    obtain_lock (&test_lock);
+    test_go = 1;
+    broadcast_condition (&test_cond);
+    release_lock (&test_lock);
+
+    for (i = 0; i < ncpu + TEST_READERS; i++)
+    {
+        join_thread (cpus[i].tid, NULL);
+        errors += cpus[i].errors;
+        reads += cpus[i].reads;
+        retries += cpus[i].retries;
+    }
+
+    /* Every update must have been counted exactly once */
+    total = (U32)ncpu * count;
+    if (fetch_fw (mainstor + TEST_CS) != total)
+    {
+        printf ("CS count %8.8X, expected %8.8X\n",
+                fetch_fw (mainstor + TEST_CS), total);
+        errors++;
+    }
+    if (fetch_fw (mainstor + TEST_CDS) != total
+     || fetch_fw (mainstor + TEST_CDS + 4) != ~total)
+    {
+        printf ("CDS count %8.8X %8.8X, expected %8.8X %8.8X\n",
+                fetch_fw (mainstor + TEST_CDS),
+                fetch_fw (mainstor + TEST_CDS + 4), total, ~total);
+        errors++;
+    }
+    if (fetch_dw (mainstor + TEST_CDSG) != total
+     || fetch_dw (mainstor + TEST_CDSG + 8) != ~(U64)total)
+    {
+        printf ("CDSG count %16.16" I64_FMT "X %16.16" I64_FMT "X,"
+                " expected %16.16" I64_FMT "X\n",
+                fetch_dw (mainstor + TEST_CDSG),
+                fetch_dw (mainstor + TEST_CDSG + 8), (U64)total);
+        errors++;
+    }
+
+    printf ("cstest: %s, %d CPUs x %d updates, %" I64_FMT "u retries,"
+            " %" I64_FMT "u LPQ reads, %d differences\n",
+            mode, ncpu, count, retries, reads, errors);
+    return errors;
+}
+
+/*-------------------------------------------------------------------*/
+/* CSTEST main entry point                                           */
+/*-------------------------------------------------------------------*/
+int main (int argc, char *argv[])
+{
+TESTCPU *cpus;                          /* Test CPUs                 */
+BYTE   *mainstor;                       /* Main storage              */
+BYTE   *storkeys;                       /* Storage keys              */
+int     count = 100000;                 /* Updates per CPU           */
+int     ncpu = 4;                       /* Number of updating CPUs   */
+int     errors = 0;                     /* Number of differences     */
+int     i;                              /* CPU number                */
+
+    if (argc > 1) count = atoi (argv[1]);
+    if (argc > 2) ncpu = atoi (argv[2]);
+    if (ncpu < 1 || ncpu + TEST_READERS > MAX_CPU_ENGINES)
+    {
+        fprintf (stderr, "cstest: 1 to %d CPUs\n",
+                 MAX_CPU_ENGINES - TEST_READERS);
+        return 255;
+    }
+
+    init_hostinfo (NULL);
+    initialize_lock (&sysblk.mainlock);
+    sysblk.mainowner = LOCK_OWNER_NONE;
+    initialize_lock (&test_lock);
+    initialize_condition (&test_cond);
+
+    mainstor = calloc (1, TEST_MAINSIZE);
+    storkeys = calloc (1, TEST_MAINSIZE / STORAGE_KEY_UNITSIZE);
+    cpus = calloc (ncpu + TEST_READERS, sizeof(TESTCPU));
+    if (mainstor == NULL || storkeys == NULL || cpus == NULL)
+    {
+        fprintf (stderr, "cstest: calloc failed\n");
+        return 255;
+    }
+    for (i = 0; i < ncpu + TEST_READERS; i++)
+        if ((cpus[i].regs = test_regs (i, mainstor, storkeys)) == NULL)
+        {
+            fprintf (stderr, "cstest: calloc failed\n");
+            return 255;
+        }
+
+#if defined(OPTION_LOCKFREE_CS)
+    errors += test_run (CMPXCHG_LOCKFREE ? "without mainlock"
+                                         : "with mainlock",
+                        cpus, ncpu, count, mainstor);
+#else /*!defined(OPTION_LOCKFREE_CS)*/
+    errors += test_run ("with mainlock", cpus, ncpu, count, mainstor);
+#endif /*!defined(OPTION_LOCKFREE_CS)*/
+
+#if defined(OPTION_LOCKFREE_CS) && defined(CMPXCHG16_AVAIL)
+    /* Without CMPXCHG16B every instruction takes mainlock again */
+    if (CMPXCHG_LOCKFREE)
+    {
+        hostinfo.cmpxchg16_avail = 0;
+        errors += test_run ("with mainlock", cpus, ncpu, count, mainstor);
+    }
+#endif /*defined(OPTION_LOCKFREE_CS) && defined(CMPXCHG16_AVAIL)*/
+
+    printf ("cstest: %d differences\n", errors);
+    return errors > 255 ? 255 : errors;
+}
@@ -130,6 +130,20 @@ char            pgmpath[MAX_PATH];      /* prog path in host format  */
 #ifdef CCKD_COMPRESS_BZIP2
         else if (strcmp(argv[0], "-bz2") == 0)
             comp = CCKD_COMPRESS_BZIP2;
+#endif
+#ifdef CCKD_ZSTD
+        else if (strcmp(argv[0], "-zstd") == 0)
+            comp = CCKD_COMPRESS_ZSTD;
+        else if (strcmp(argv[0], "-zd") == 0)
+        {
+            if (argc < 2 || cckd_zstd_dict (argv[1]) < 0)
+                return syntax(pgm);
+            argc--; argv++;
+        }
+#endif
+#ifdef CCKD_LZ4
+        else if (strcmp(argv[0], "-lz4") == 0)
+            comp = CCKD_COMPRESS_LZ4;
 #endif
         else if (strcmp(argv[0], "-0") == 0)
             comp = CCKD_COMPRESS_NONE;
@@ -522,6 +536,8 @@ int syntax (char *pgm)
             "     -r                replace the output file if it exists\n"
             "%s"
             "%s"
+            "%s"
+            "%s"
             "     -0                don't compress track images\n"
             "     -cyls  n          size of output file\n"
             "     -a                output file will have alt cyls\n"
@@ -536,6 +552,21 @@ int syntax (char *pgm)
 #ifdef CCKD_COMPRESS_BZIP2
             _(
             "     -bz2              compress using bzip2\n"
+            ),
+#else
+            "",
+#endif
+#ifdef CCKD_ZSTD
+            _(
+            "     -zstd             compress using zstd\n"
+            "     -zd    dfile      zstd dictionary to load\n"
+            ),
+#else
+            "",
+#endif
+#ifdef CCKD_LZ4
+            _(
+            "     -lz4              compress using lz4\n"
             )
 #else
             ""
@@ -579,6 +610,8 @@ int syntax (char *pgm)
             "     -r                replace the output file if it exists\n"
             "%s"
             "%s"
+            "%s"
+            "%s"
             "     -0                don't compress track images\n"
             "     -blks  n          size of output file\n"
             ),
@@ -592,6 +625,21 @@ int syntax (char *pgm)
 #ifdef CCKD_COMPRESS_BZIP2
             _(
             "     -bz2              compress using bzip2\n"
+            ),
+#else
+            "",
+#endif
+#ifdef CCKD_ZSTD
+            _(
+            "     -zstd             compress using zstd\n"
+            "     -zd    dfile      zstd dictionary to load\n"
+            ),
+#else
+            "",
+#endif
+#ifdef CCKD_LZ4
+            _(
+            "     -lz4              compress using lz4\n"
             )
 #else
             ""
@@ -635,6 +683,8 @@ int syntax (char *pgm)
             "     -r                replace the output file if it exists\n"
             "%s"
             "%s"
+            "%s"
+            "%s"
             "     -0                don't compress output\n"
             "     -blks  n          size of output fba file\n"
             "     -cyls  n          size of output ckd file\n"
@@ -654,6 +704,21 @@ int syntax (char *pgm)
 #ifdef CCKD_COMPRESS_BZIP2
             _(
             "     -bz2              compress output using bzip2\n"
+            ),
+#else
+            "",
+#endif
+#ifdef CCKD_ZSTD
+            _(
+            "     -zstd             compress using zstd\n"
+            "     -zd    dfile      zstd dictionary to load\n"
+            ),
+#else
+            "",
+#endif
+#ifdef CCKD_LZ4
+            _(
+            "     -lz4              compress using lz4\n"
             )
 #else
             ""
@@ -724,6 +724,77 @@ U16     eax;                            /* Authorization index       */
 } /* end function load_address_space_designator */
 
 
+/*-------------------------------------------------------------------*/
+/* Make the second way of a TLB set the first way                    */
+/*                                                                   */
+/* Input:                                                            */
+/*      regs    Pointer to the CPU register context                  */
+/*      ix      TLB set index                                        */
+/*                                                                   */
+/*      Entries ix and ix+TLBN are exchanged so that the entry just  */
+/*      found by translate_addr() is the one used by the accelerated */
+/*      lookup.  Always returns 1 so it may be used in a condition.  */
+/*-------------------------------------------------------------------*/
+_DAT_C_STATIC int ARCH_DEP(promote_tlbe) (REGS *regs, int ix)
+{
+int     ix2 = ix + TLBN;                /* Second way of the set     */
+DW      dw;                             /* Work doubleword           */
+BYTE   *p;                              /* Work pointer              */
+BYTE    b;                              /* Work byte                 */
+
+    dw = regs->tlb.asd[ix];   regs->tlb.asd[ix]   = regs->tlb.asd[ix2];   regs->tlb.asd[ix2]   = dw;
+    dw = regs->tlb.vaddr[ix]; regs->tlb.vaddr[ix] = regs->tlb.vaddr[ix2]; regs->tlb.vaddr[ix2] = dw;
+    dw = regs->tlb.pte[ix];   regs->tlb.pte[ix]   = regs->tlb.pte[ix2];   regs->tlb.pte[ix2]   = dw;
+    p = regs->tlb.main[ix];    regs->tlb.main[ix]    = regs->tlb.main[ix2];    regs->tlb.main[ix2]    = p;
+    p = regs->tlb.storkey[ix]; regs->tlb.storkey[ix] = regs->tlb.storkey[ix2]; regs->tlb.storkey[ix2] = p;
+    b = regs->tlb.skey[ix];    regs->tlb.skey[ix]    = regs->tlb.skey[ix2];    regs->tlb.skey[ix2]    = b;
+    b = regs->tlb.common[ix];  regs->tlb.common[ix]  = regs->tlb.common[ix2];  regs->tlb.common[ix2]  = b;
+    b = regs->tlb.protect[ix]; regs->tlb.protect[ix] = regs->tlb.protect[ix2]; regs->tlb.protect[ix2] = b;
+    b = regs->tlb.acc[ix];     regs->tlb.acc[ix]     = regs->tlb.acc[ix2];     regs->tlb.acc[ix2]     = b;
+
+    regs->tlbhit2++;
+    return 1;
+
+} /* end function promote_tlbe */
+
+
+/*-------------------------------------------------------------------*/
+/* Move the first way of a TLB set into the second way               */
+/*                                                                   */
+/* Input:                                                            */
+/*      regs    Pointer to the CPU register context                  */
+/*      ix      TLB set index                                        */
+/*      vaddr   Virtual address about to be placed in entry ix       */
+/*      asd     Address space designator of the new entry            */
+/*                                                                   */
+/*      Called before a new translation is placed in entry ix.  The  */
+/*      current entry is kept in the second way, replacing whatever  */
+/*      was there, unless it is no longer valid or is about to be    */
+/*      overwritten by an entry for the same page.                   */
+/*-------------------------------------------------------------------*/
+_DAT_C_STATIC void ARCH_DEP(demote_tlbe) (REGS *regs, int ix,
+                                          VADR vaddr, RADR asd)
+{
+int     ix2 = ix + TLBN;                /* Second way of the set     */
+
+    if ((regs->tlb.TLB_VADDR(ix) & TLBID_BYTEMASK) != regs->tlbID
+     || (regs->tlb.TLB_VADDR(ix) == ((vaddr & TLBID_PAGEMASK) | regs->tlbID)
+      && regs->tlb.TLB_ASD(ix) == asd))
+        return;
+
+    regs->tlb.asd[ix2]     = regs->tlb.asd[ix];
+    regs->tlb.vaddr[ix2]   = regs->tlb.vaddr[ix];
+    regs->tlb.pte[ix2]     = regs->tlb.pte[ix];
+    regs->tlb.main[ix2]    = regs->tlb.main[ix];
+    regs->tlb.storkey[ix2] = regs->tlb.storkey[ix];
+    regs->tlb.skey[ix2]    = regs->tlb.skey[ix];
+    regs->tlb.common[ix2]  = regs->tlb.common[ix];
+    regs->tlb.protect[ix2] = regs->tlb.protect[ix];
+    regs->tlb.acc[ix2]     = regs->tlb.acc[ix];
+
+} /* end function demote_tlbe */
+
+
 /*-------------------------------------------------------------------*/
 /* Translate a virtual address to a real address                     */
 /*                                                                   */
@@ -844,11 +915,12 @@ U32     ptl;                            /* Page table length         */
        goto tran_spec_excp;
 
     /* Look up the address in the TLB */
-    if (   ((vaddr & TLBID_PAGEMASK) | regs->tlbID) == regs->tlb.TLB_VADDR(tlbix)
-        && (regs->tlb.common[tlbix] || regs->dat.asd == regs->tlb.TLB_ASD(tlbix))
-        && !(regs->tlb.common[tlbix] && regs->dat.private) 
-        && !(acctype & ACC_NOTLB) )
+    if (!(acctype & ACC_NOTLB)
+     && (TLB_MATCH(regs, vaddr, tlbix)
+      || (TLB_MATCH(regs, vaddr, tlbix + TLBN)
+       && ARCH_DEP(promote_tlbe) (regs, tlbix))))
     {
+        regs->tlbhit++;
         pte = regs->tlb.TLB_PTE(tlbix);
 
         #ifdef FEATURE_SEGMENT_PROTECTION
@@ -859,6 +931,8 @@ U32     ptl;                            /* Page table length         */
     }
     else
     {
+        regs->tlbmiss++;
+
         /* S/370 segment table lookup */
 
         /* Calculate the real address of the segment table entry */
@@ -942,6 +1016,10 @@ U32     ptl;                            /* Page table length         */
         /* Place the translated address in the TLB */
         if (!(acctype & ACC_NOTLB))
         {
+            ARCH_DEP(demote_tlbe) (regs, tlbix, vaddr, regs->dat.asd);
+            if ((regs->CR(0) & CR0_PAGE_SIZE) == CR0_PAGE_SZ_4K)
+                ARCH_DEP(demote_tlbe) (regs, tlbix^1, vaddr, regs->dat.asd);
+
             regs->tlb.TLB_ASD(tlbix)   = regs->dat.asd;
             regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
             regs->tlb.TLB_PTE(tlbix)   = pte;
@@ -999,17 +1077,20 @@ U32     ptl;                            /* Page table length         */
     regs->dat.private = ((regs->dat.asd & STD_PRIVATE) != 0);
 
     /* [3.11.4] Look up the address in the TLB */
-    if (   ((vaddr & TLBID_PAGEMASK) | regs->tlbID) == regs->tlb.TLB_VADDR(tlbix)
-        && (regs->tlb.common[tlbix] || regs->dat.asd == regs->tlb.TLB_ASD(tlbix))
-        && !(regs->tlb.common[tlbix] && regs->dat.private) 
-        && !(acctype & ACC_NOTLB) )
+    if (!(acctype & ACC_NOTLB)
+     && (TLB_MATCH(regs, vaddr, tlbix)
+      || (TLB_MATCH(regs, vaddr, tlbix + TLBN)
+       && ARCH_DEP(promote_tlbe) (regs, tlbix))))
     {
+        regs->tlbhit++;
         pte = regs->tlb.TLB_PTE(tlbix);
         if (regs->tlb.protect[tlbix])
             regs->dat.protect = regs->tlb.protect[tlbix];
     }
     else
     {
+        regs->tlbmiss++;
+
         /* [3.11.3.3] Segment table lookup */
 
         /* Calculate the real address of the segment table entry */
@@ -1080,6 +1161,7 @@ U32     ptl;                            /* Page table length         */
         /* [3.11.4.2] Place the translated address in the TLB */
         if (!(acctype & ACC_NOTLB))
         {
+            ARCH_DEP(demote_tlbe) (regs, tlbix, vaddr, regs->dat.asd);
             regs->tlb.TLB_ASD(tlbix)   = regs->dat.asd;
             regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
             regs->tlb.TLB_PTE(tlbix)   = pte;
@@ -1119,6 +1201,9 @@ U16     rfx, rsx, rtx;                  /* Region first/second/third
                                            index + 3 low-order zeros */
 U16     sx, px;                         /* Segment and page index,
                                            + 3 low-order zero bits   */
+#if defined(OPTION_PAGE_WALK_CACHE)
+PWCE   *pwce;                           /* Page-walk cache entry     */
+#endif /*defined(OPTION_PAGE_WALK_CACHE)*/
 
     regs->dat.private = regs->dat.protect = 0;
 
@@ -1132,17 +1217,20 @@ U16     sx, px;                         /* Segment and page index,
 //  logmsg("asce=%16.16" I64_FMT "X\n",regs->dat.asd);
 
     /* [3.11.4] Look up the address in the TLB */
-    if (   ((vaddr & TLBID_PAGEMASK) | regs->tlbID) == regs->tlb.TLB_VADDR(tlbix)
-        && (regs->tlb.common[tlbix] || regs->dat.asd == regs->tlb.TLB_ASD(tlbix))
-        && !(regs->tlb.common[tlbix] && regs->dat.private) 
-        && !(acctype & ACC_NOTLB) )
+    if (!(acctype & ACC_NOTLB)
+     && (TLB_MATCH(regs, vaddr, tlbix)
+      || (TLB_MATCH(regs, vaddr, tlbix + TLBN)
+       && ARCH_DEP(promote_tlbe) (regs, tlbix))))
     {
+        regs->tlbhit++;
         pte = regs->tlb.TLB_PTE(tlbix);
         if (regs->tlb.protect[tlbix])
             regs->dat.protect = regs->tlb.protect[tlbix];
     }
     else
     {
+        regs->tlbmiss++;
+
         /* If ASCE indicates a real-space then real addr = virtual addr */
         if (regs->dat.asd & ASCE_R)
         {
@@ -1193,6 +1281,35 @@ U16     sx, px;                         /* Segment and page index,
                 || (rtx != 0 && tt < TT_R3TABL))
                 goto asce_type_excp;
 
+#if defined(OPTION_PAGE_WALK_CACHE)
+            /* Look up the segment table entry in the page-walk cache,
+               and failing that the segment table designation found by
+               region translation, so as to skip the table fetches */
+            if (!(acctype & ACC_NOTLB))
+            {
+                pwce = &regs->pwc.seg[PWC_SEGIX(vaddr, regs->dat.asd)];
+                if (PWC_MATCH(regs, pwce, vaddr & PWC_SEGMASK))
+                {
+                    regs->pwcseghit++;
+                    sto = pwce->eaddr;
+                    ste = pwce->ent;
+                    regs->dat.protect |= pwce->protect;
+                    goto pwc_seg_hit;
+                }
+                pwce = &regs->pwc.reg[PWC_REGIX(vaddr, regs->dat.asd)];
+                if (tt != TT_SEGTAB
+                 && PWC_MATCH(regs, pwce, vaddr & PWC_REGMASK))
+                {
+                    regs->pwcreghit++;
+                    sto = pwce->ent;
+                    tf = pwce->tf;
+                    tl = pwce->tl;
+                    regs->dat.protect |= pwce->protect;
+                    goto pwc_reg_hit;
+                }
+            }
+#endif /*defined(OPTION_PAGE_WALK_CACHE)*/
+
             /* Perform region translation */
             switch (tt) {
 
@@ -1378,6 +1495,7 @@ U16     sx, px;                         /* Segment and page index,
                     /* [3.11.4.2] Place the translated address in the TLB */
                     if (!(acctype & ACC_NOTLB))
                     {
+                        ARCH_DEP(demote_tlbe) (regs, tlbix, vaddr, regs->dat.asd);
                         regs->tlb.TLB_ASD(tlbix) = regs->dat.asd;
                         regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
                         /* Fake 4K PTE for TLB purposes */
@@ -1400,9 +1518,28 @@ U16     sx, px;                         /* Segment and page index,
                 tf = (rte & REGTAB_TF) >> 6;
                 tl = rte & REGTAB_TL;
 
+#if defined(OPTION_PAGE_WALK_CACHE)
+                /* Place the segment table designation in the
+                   region part of the page-walk cache */
+                if (!(acctype & ACC_NOTLB))
+                {
+                    pwce = &regs->pwc.reg[PWC_REGIX(vaddr, regs->dat.asd)];
+                    pwce->asd     = regs->dat.asd;
+                    pwce->vaddr   = vaddr & PWC_REGMASK;
+                    pwce->ent     = sto;
+                    pwce->tf      = tf;
+                    pwce->tl      = tl;
+                    pwce->protect = regs->dat.protect;
+                    pwce->id      = regs->tlbID;
+                }
+#endif /*defined(OPTION_PAGE_WALK_CACHE)*/
+
                 /* Fall through to perform segment translation */
             } /* end switch(tt) */
 
+#if defined(OPTION_PAGE_WALK_CACHE)
+pwc_reg_hit:
+#endif /*defined(OPTION_PAGE_WALK_CACHE)*/
             /* Perform ESAME segment translation */
 
             /* Add the segment index (with three low-order zeroes)
@@ -1444,6 +1581,23 @@ U16     sx, px;                         /* Segment and page index,
             if (regs->dat.private && (ste & ZSEGTAB_C))
                 goto tran_spec_excp;
 
+#if defined(OPTION_PAGE_WALK_CACHE)
+            /* Place the segment table entry in the segment part
+               of the page-walk cache */
+            if (!(acctype & ACC_NOTLB))
+            {
+                pwce = &regs->pwc.seg[PWC_SEGIX(vaddr, regs->dat.asd)];
+                pwce->asd     = regs->dat.asd;
+                pwce->vaddr   = vaddr & PWC_SEGMASK;
+                pwce->ent     = ste;
+                pwce->eaddr   = sto;
+                pwce->protect = regs->dat.protect;
+                pwce->id      = regs->tlbID;
+            }
+
+pwc_seg_hit:
+#endif /*defined(OPTION_PAGE_WALK_CACHE)*/
+
 #if defined(FEATURE_ENHANCED_DAT_FACILITY)
             if ((regs->CR_L(0) & CR0_ED)
               && (ste & ZSEGTAB_FC))
@@ -1474,6 +1628,7 @@ U16     sx, px;                         /* Segment and page index,
                 /* [3.11.4.2] Place the translated address in the TLB */
                 if (!(acctype & ACC_NOTLB))
                 {
+                    ARCH_DEP(demote_tlbe) (regs, tlbix, vaddr, regs->dat.asd);
                     regs->tlb.TLB_ASD(tlbix)   = regs->dat.asd;
                     regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
                     /* Fake 4K PTE for TLB purposes */
@@ -1541,6 +1696,7 @@ U16     sx, px;                         /* Segment and page index,
         /* [3.11.4.2] Place the translated address in the TLB */
         if (!(acctype & ACC_NOTLB))
         {
+            ARCH_DEP(demote_tlbe) (regs, tlbix, vaddr, regs->dat.asd);
             regs->tlb.TLB_ASD(tlbix)   = regs->dat.asd;
             regs->tlb.TLB_VADDR(tlbix) = (vaddr & TLBID_PAGEMASK) | regs->tlbID;
             regs->tlb.TLB_PTE(tlbix)   = pte;
@@ -1781,9 +1937,11 @@ tran_excp_addr:
 _DAT_C_STATIC void ARCH_DEP(purge_tlb) (REGS *regs)
 {
     INVALIDATE_AIA(regs);
+    regs->tlbpurge++;
     if (((++regs->tlbID) & TLBID_BYTEMASK) == 0)
     {
-        memset (&regs->tlb.vaddr, 0, TLBN * sizeof(DW));
+        memset (&regs->tlb.vaddr, 0, TLBE * sizeof(DW));
+        PURGE_PWC(regs);
         regs->tlbID = 1;
     }
 #if defined(_FEATURE_SIE)
@@ -1793,7 +1951,8 @@ _DAT_C_STATIC void ARCH_DEP(purge_tlb) (REGS *regs)
         INVALIDATE_AIA(regs->guestregs);
         if (((++regs->guestregs->tlbID) & TLBID_BYTEMASK) == 0)
         {
-            memset (&regs->guestregs->tlb.vaddr, 0, TLBN * sizeof(DW));
+            memset (&regs->guestregs->tlb.vaddr, 0, TLBE * sizeof(DW));
+            PURGE_PWC(regs->guestregs);
             regs->guestregs->tlbID = 1;
         }
     }
@@ -1842,7 +2001,8 @@ RADR ptemask;
 #endif /* defined(FEATURE_ESAME) */
 
     INVALIDATE_AIA(regs);
-    for (i = 0; i < TLBN; i++)
+    regs->tlbpurgesel++;
+    for (i = 0; i < TLBE; i++)
         if ((regs->tlb.TLB_PTE(i) & ptemask) == pte)
             regs->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
 
@@ -1851,7 +2011,7 @@ RADR ptemask;
     if (regs->host && regs->guestregs)
     {
         INVALIDATE_AIA(regs->guestregs);
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLBE; i++)
 /************************************************************************** @PJJ */
 /* The guest registers in the SIE copy TLB PTE entries for DAT-OFF guests * @PJJ */
 /* like CMS do NOT actually contain the PTE (but rather the host primary  * @PJJ */
@@ -1866,8 +2026,11 @@ RADR ptemask;
 /*                                                                        * @PJJ */
 /*                                        (Peter J. Jansen, 26-Jul-2016)  * @PJJ */
 /************************************************************************** @PJJ */
+/* Both ways of the host TLB set are checked since the host entry     */
+/* need not be in the same way as the guest entry.                    */
             if ((regs->guestregs->tlb.TLB_PTE(i) & ptemask) == pte ||    /* @PJJ */
-                 (regs->hostregs->tlb.TLB_PTE(i) & ptemask) == pte)      /* @PJJ */
+                 (regs->hostregs->tlb.TLB_PTE(i) & ptemask) == pte ||    /* @PJJ */
+                 (regs->hostregs->tlb.TLB_PTE(i ^ TLBN) & ptemask) == pte)
                 regs->guestregs->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
     }
     else
@@ -1875,7 +2038,7 @@ RADR ptemask;
     if (regs->guest)
     {
         INVALIDATE_AIA(regs->hostregs);
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLBE; i++)
             if ((regs->hostregs->tlb.TLB_PTE(i) & ptemask) == pte)
                 regs->hostregs->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
     }
@@ -1899,6 +2062,95 @@ int i;
 } /* end function purge_tlbe_all */
 
 
+/*-------------------------------------------------------------------*/
+/* Purge translation lookaside buffer entries for an address space   */
+/*                                                                   */
+/* Input:                                                            */
+/*      regs    Pointer to the CPU register context                  */
+/*      asd     Address space designator (STD or ASCE) whose         */
+/*              entries are to be cleared                            */
+/*                                                                   */
+/*      Entries formed from the given table origin are cleared,      */
+/*      as are common segment entries since these may have been      */
+/*      formed using any address space.  Other entries remain.       */
+/*      Page-walk cache entries for the table origin are cleared,    */
+/*      and so are cached common segment table entries.              */
+/*-------------------------------------------------------------------*/
+_DAT_C_STATIC void ARCH_DEP(purge_tlb_asce) (REGS *regs, RADR asd)
+{
+int  i;
+RADR asdmask;
+
+#if !defined(FEATURE_S390_DAT) && !defined(FEATURE_ESAME)
+    asdmask = STD_370_STO;
+#endif
+
+#if defined(FEATURE_S390_DAT)
+    asdmask = STD_STO;
+#endif /* defined(FEATURE_S390_DAT) */
+
+#if defined(FEATURE_ESAME)
+    asdmask = (RADR)(ASCE_TO | ASCE_DT | ASCE_R);
+#endif /* defined(FEATURE_ESAME) */
+
+    INVALIDATE_AIA(regs);
+    regs->tlbpurgesel++;
+    for (i = 0; i < TLBE; i++)
+        if ((regs->tlb.TLB_VADDR(i) & TLBID_BYTEMASK) == regs->tlbID
+         && (regs->tlb.common[i]
+          || ((regs->tlb.TLB_ASD(i) ^ asd) & asdmask) == 0))
+            regs->tlb.TLB_VADDR(i) &= TLBID_PAGEMASK;
+
+#if defined(OPTION_PAGE_WALK_CACHE)
+    for (i = 0; i < PWC_SEGN; i++)
+    {
+        if (((regs->pwc.seg[i].asd ^ asd) & asdmask) == 0)
+            regs->pwc.seg[i].id = 0;
+#if defined(FEATURE_ESAME)
+        if (regs->pwc.seg[i].ent & ZSEGTAB_C)
+            regs->pwc.seg[i].id = 0;
+#endif /*defined(FEATURE_ESAME)*/
+    }
+    for (i = 0; i < PWC_REGN; i++)
+        if (((regs->pwc.reg[i].asd ^ asd) & asdmask) == 0)
+            regs->pwc.reg[i].id = 0;
+#endif /*defined(OPTION_PAGE_WALK_CACHE)*/
+
+#if defined(_FEATURE_SIE)
+    /* Guest entries also depend on the host translation tables,
+       so the SIE copy is purged in full */
+    if(regs->host && regs->guestregs)
+    {
+        INVALIDATE_AIA(regs->guestregs);
+        regs->guestregs->tlbpurge++;
+        if (((++regs->guestregs->tlbID) & TLBID_BYTEMASK) == 0)
+        {
+            memset (&regs->guestregs->tlb.vaddr, 0, TLBE * sizeof(DW));
+            PURGE_PWC(regs->guestregs);
+            regs->guestregs->tlbID = 1;
+        }
+    }
+#endif /*defined(_FEATURE_SIE)*/
+
+} /* end function purge_tlb_asce */
+
+
+/*-------------------------------------------------------------------*/
+/* Purge translation lookaside buffer entries for an address space   */
+/* for all CPUs                                                      */
+/*-------------------------------------------------------------------*/
+_DAT_C_STATIC void ARCH_DEP(purge_tlb_asce_all) (RADR asd)
+{
+int i;
+
+    for (i = 0; i < MAX_CPU; i++)
+        if (IS_CPU_ONLINE(i)
+         && (sysblk.regs[i]->cpubit & sysblk.started_mask))
+            ARCH_DEP(purge_tlb_asce) (sysblk.regs[i], asd);
+
+} /* end function purge_tlb_asce_all */
+
+
 /*-------------------------------------------------------------------*/
 /* Invalidate all translation lookaside buffer entries               */
 /*-------------------------------------------------------------------*/
@@ -1908,9 +2160,9 @@ int  i;
 
     INVALIDATE_AIA(regs);
     if (mask == 0)
-        memset(&regs->tlb.acc, 0, TLBN);
+        memset(&regs->tlb.acc, 0, TLBE);
     else
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLBE; i++)
             if ((regs->tlb.TLB_VADDR(i) & TLBID_BYTEMASK) == regs->tlbID)
                 regs->tlb.acc[i] &= mask;
 
@@ -1920,9 +2172,9 @@ int  i;
     {
         INVALIDATE_AIA(regs->guestregs);
         if (mask == 0)
-            memset(&regs->guestregs->tlb.acc, 0, TLBN);
+            memset(&regs->guestregs->tlb.acc, 0, TLBE);
         else
-            for (i = 0; i < TLBN; i++)
+            for (i = 0; i < TLBE; i++)
                 if ((regs->guestregs->tlb.TLB_VADDR(i) & TLBID_BYTEMASK) == regs->guestregs->tlbID)
                     regs->guestregs->tlb.acc[i] &= mask;
     }
@@ -1932,9 +2184,9 @@ int  i;
     {
         INVALIDATE_AIA(regs->hostregs);
         if (mask == 0)
-            memset(&regs->hostregs->tlb.acc, 0, TLBN);
+            memset(&regs->hostregs->tlb.acc, 0, TLBE);
         else
-            for (i = 0; i < TLBN; i++)
+            for (i = 0; i < TLBE; i++)
                 if ((regs->hostregs->tlb.TLB_VADDR(i) & TLBID_BYTEMASK) == regs->hostregs->tlbID)
                     regs->hostregs->tlb.acc[i] &= mask;
     }
@@ -1960,6 +2212,8 @@ int  i;
 /* NOTES:                                                            */
 /*   TLB_VADDR does not contain all the effective address bits and   */
 /*   must be created on-the-fly using the tlb index (i << shift).    */
+/*   Both ways of a TLB set are searched; for S/370 4K pages the     */
+/*   companion 2K entry is cleared in either way of its set.         */
 /*   TLB_VADDR also contains the tlbid, so the regs->tlbid is merged */
 /*   with the main input variable before the search is begun.        */
 /*-------------------------------------------------------------------*/
@@ -1979,15 +2233,15 @@ _DAT_C_STATIC void ARCH_DEP(invalidate_tlbe) (REGS *regs, BYTE *main)
 
     INVALIDATE_AIA_MAIN(regs, main);
     shift = regs->arch_mode == ARCH_370 ? 11 : 12;
-    for (i = 0; i < TLBN; i++)
+    for (i = 0; i < TLBE; i++)
         if (MAINADDR(regs->tlb.main[i],
-                     (regs->tlb.TLB_VADDR(i) | (i << shift)))
+                     (regs->tlb.TLB_VADDR(i) | ((i & TLB_MASK) << shift)))
                      == mainwid)
         {
             regs->tlb.acc[i] = 0;
 #if !defined(FEATURE_S390_DAT) && !defined(FEATURE_ESAME)
             if ((regs->CR(0) & CR0_PAGE_SIZE) == CR0_PAGE_SZ_4K)
-                regs->tlb.acc[i^1] = 0;
+                regs->tlb.acc[i^1] = regs->tlb.acc[(i^1)^TLBN] = 0;
 #endif
         }
 
@@ -1997,15 +2251,15 @@ _DAT_C_STATIC void ARCH_DEP(invalidate_tlbe) (REGS *regs, BYTE *main)
     {
         INVALIDATE_AIA_MAIN(regs->guestregs, main);
         shift = regs->guestregs->arch_mode == ARCH_370 ? 11 : 12;
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLBE; i++)
             if (MAINADDR(regs->guestregs->tlb.main[i],
-                         (regs->guestregs->tlb.TLB_VADDR(i) | (i << shift)))
+                         (regs->guestregs->tlb.TLB_VADDR(i) | ((i & TLB_MASK) << shift)))
                          == mainwid)
             {
                 regs->guestregs->tlb.acc[i] = 0;
 #if !defined(FEATURE_S390_DAT) && !defined(FEATURE_ESAME)
                 if ((regs->guestregs->CR(0) & CR0_PAGE_SIZE) == CR0_PAGE_SZ_4K)
-                    regs->guestregs->tlb.acc[i^1] = 0;
+                    regs->guestregs->tlb.acc[i^1] = regs->guestregs->tlb.acc[(i^1)^TLBN] = 0;
 #endif
             }
     }
@@ -2015,15 +2269,15 @@ _DAT_C_STATIC void ARCH_DEP(invalidate_tlbe) (REGS *regs, BYTE *main)
     {
         INVALIDATE_AIA_MAIN(regs->hostregs, main);
         shift = regs->hostregs->arch_mode == ARCH_370 ? 11 : 12;
-        for (i = 0; i < TLBN; i++)
+        for (i = 0; i < TLBE; i++)
             if (MAINADDR(regs->hostregs->tlb.main[i],
-                         (regs->hostregs->tlb.TLB_VADDR(i) | (i << shift)))
+                         (regs->hostregs->tlb.TLB_VADDR(i) | ((i & TLB_MASK) << shift)))
                          == mainwid)
             {
                 regs->hostregs->tlb.acc[i] = 0;
 #if !defined(FEATURE_S390_DAT) && !defined(FEATURE_ESAME)
                 if ((regs->hostregs->CR(0) & CR0_PAGE_SIZE) == CR0_PAGE_SZ_4K)
-                    regs->hostregs->tlb.acc[i^1] = 0;
+                    regs->hostregs->tlb.acc[i^1] = regs->hostregs->tlb.acc[(i^1)^TLBN] = 0;
 #endif
             }
     }
@@ -2251,6 +2505,7 @@ int     ix = TLBIX(addr);               /* TLB index                 */
         regs->dat.rpfra = addr & PAGEFRAME_PAGEMASK;
 
         /* Setup `real' TLB entry (for MADDR) */
+        ARCH_DEP(demote_tlbe) (regs, ix, addr, TLB_REAL_ASD);
         regs->tlb.TLB_ASD(ix)   = TLB_REAL_ASD;
         regs->tlb.TLB_VADDR(ix) = (addr & TLBID_PAGEMASK) | regs->tlbID;
         regs->tlb.TLB_PTE(ix)   = addr & TLBID_PAGEMASK;
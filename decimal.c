@@ -48,6 +48,12 @@
 #define MAX_DECIMAL_LENGTH      16
 #define MAX_DECIMAL_DIGITS      (((MAX_DECIMAL_LENGTH)*2)-1)
 
+#if defined(OPTION_DECIMAL_BINARY)
+#define DECIMAL_OPERAND(_dec)   (&(_dec))
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
+#define DECIMAL_OPERAND(_dec)   (_dec)
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
+
 /*-------------------------------------------------------------------*/
 /* Convert packed decimal number to binary                           */
 /*                                                                   */
@@ -257,6 +263,7 @@ int     d;                              /* Decimal digit or sign     */
 
 } /* end function(binary_to_packed) */
 
+#if !defined(OPTION_DECIMAL_BINARY)
 /*-------------------------------------------------------------------*/
 /* Add two decimal byte strings as unsigned decimal numbers          */
 /*                                                                   */
@@ -563,9 +570,314 @@ int     temp3, temp4, temp5, qtest;     /* Work areas for algorithm  */
     } /* end for(index2) */
 
 } /* end function divide_decimal */
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
+
+#if defined(OPTION_DECIMAL_BINARY)
+/*-------------------------------------------------------------------*/
+/* Packed decimal arithmetic in binary integers                      */
+/*                                                                   */
+/* The operand of a decimal instruction holds at most 31 digits.     */
+/* It is converted into two 64-bit binary integers, each holding 16  */
+/* decimal digits, so that the arithmetic is done by the host in a   */
+/* few integer operations instead of digit by digit.  The packed     */
+/* digits are validated and converted 16 at a time without a branch  */
+/* per digit.  Results are converted back to packed decimal before   */
+/* being stored.  Condition codes, overflow and the data and decimal */
+/* divide exceptions are recognized exactly as for the digit string  */
+/* routines above, which remain in use when OPTION_DECIMAL_BINARY is */
+/* not defined.                                                      */
+/*-------------------------------------------------------------------*/
+#define DECIMAL_HALF    10000000000000000ULL    /* 10**16            */
+
+typedef struct _DECNUM {                /* Decimal operand value     */
+        U64     hi;                     /* Digits 16-31 (10**16s)    */
+        U64     lo;                     /* Digits 0-15  (units)      */
+    } DECNUM;
+
+static const U64 decimal_pow10[17] = {  /* Powers of ten 0-16        */
+        1ULL,                   10ULL,
+        100ULL,                 1000ULL,
+        10000ULL,               100000ULL,
+        1000000ULL,             10000000ULL,
+        100000000ULL,           1000000000ULL,
+        10000000000ULL,         100000000000ULL,
+        1000000000000ULL,       10000000000000ULL,
+        100000000000000ULL,     1000000000000000ULL,
+        10000000000000000ULL };
+
+/*-------------------------------------------------------------------*/
+/* Return nonzero if any of the 16 digits of a BCD doubleword is     */
+/* invalid (X'A' to X'F'); a digit is invalid if its 8 bit is on     */
+/* together with its 4 or its 2 bit                                  */
+/*-------------------------------------------------------------------*/
+static inline U64 bcd_invalid (U64 bcd)
+{
+    return (bcd >> 3) & ((bcd >> 2) | (bcd >> 1))
+         & 0x1111111111111111ULL;
+}
+
+/*-------------------------------------------------------------------*/
+/* Convert the 16 digits of a valid BCD doubleword to binary         */
+/* by combining adjacent digits, pairs, quads and octets in place    */
+/*-------------------------------------------------------------------*/
+static inline U64 bcd_to_u64 (U64 bcd)
+{
+    bcd = ((bcd >>  4) & 0x0F0F0F0F0F0F0F0FULL) * 10
+        +  (bcd        & 0x0F0F0F0F0F0F0F0FULL);
+    bcd = ((bcd >>  8) & 0x00FF00FF00FF00FFULL) * 100
+        +  (bcd        & 0x00FF00FF00FF00FFULL);
+    bcd = ((bcd >> 16) & 0x0000FFFF0000FFFFULL) * 10000
+        +  (bcd        & 0x0000FFFF0000FFFFULL);
+    return (bcd >> 32) * 100000000 + (bcd & 0xFFFFFFFFULL);
+}
+
+/*-------------------------------------------------------------------*/
+/* Convert a binary number less than 10**16 to 16 BCD digits         */
+/*-------------------------------------------------------------------*/
+static inline U64 u64_to_bcd (U64 bin)
+{
+U64     bcd;                            /* BCD result                */
+U32     lo8, hi8;                       /* Low and high 8 digits     */
+U32     d;                              /* Pair of decimal digits    */
+int     i;                              /* Shift count               */
+
+    hi8 = (U32)(bin / 100000000);
+    lo8 = (U32)(bin % 100000000);
+    for (bcd = 0, i = 0; i < 32; i += 8)
+    {
+        d = lo8 % 100;
+        lo8 /= 100;
+        bcd |= (U64)(((d / 10) << 4) | (d % 10)) << i;
+        d = hi8 % 100;
+        hi8 /= 100;
+        bcd |= (U64)(((d / 10) << 4) | (d % 10)) << (i + 32);
+    }
+    return bcd;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the number of significant digits of a binary number        */
+/*-------------------------------------------------------------------*/
+static inline int u64_digits (U64 bin)
+{
+int     n;                              /* Significant digit counter */
+
+    for (n = 0; bin != 0; n++)
+        bin /= 10;
+    return n;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the number of significant digits of a decimal operand;     */
+/* zero if the value is zero and 32 if it exceeds 31 digits          */
+/*-------------------------------------------------------------------*/
+static int decnum_digits (DECNUM *dec)
+{
+    if (dec->hi != 0)
+        return 16 + u64_digits (dec->hi);
+    return u64_digits (dec->lo);
+}
+
+/*-------------------------------------------------------------------*/
+/* Compare two decimal operands, returning -1, 0 or +1               */
+/*-------------------------------------------------------------------*/
+static int decnum_compare (DECNUM *dec1, DECNUM *dec2)
+{
+    if (dec1->hi != dec2->hi)
+        return dec1->hi < dec2->hi ? -1 : 1;
+    if (dec1->lo != dec2->lo)
+        return dec1->lo < dec2->lo ? -1 : 1;
+    return 0;
+}
+
+/*-------------------------------------------------------------------*/
+/* Add or subtract two signed decimal operands                       */
+/*                                                                   */
+/* Input:                                                            */
+/*      dec1    First operand value                                  */
+/*      sign1   Sign of first operand (-1 or +1)                     */
+/*      dec2    Second operand value                                 */
+/*      sign2   Sign of second operand, inverted for a subtraction   */
+/* Output:                                                           */
+/*      result  Value of the result, which may exceed 31 digits      */
+/*      sign    Sign of the result, +1 if the result is zero         */
+/*-------------------------------------------------------------------*/
+static void decnum_add (DECNUM *dec1, int sign1, DECNUM *dec2,
+                        int sign2, DECNUM *result, int *sign)
+{
+DECNUM *higher;                         /* -> Higher value operand   */
+DECNUM *lower;                          /* -> Lower value operand    */
+int     rc;                             /* Comparison result         */
+
+    if (sign1 == sign2)
+    {
+        /* Equal signs: add the values, the sign is unchanged */
+        result->lo = dec1->lo + dec2->lo;
+        result->hi = dec1->hi + dec2->hi;
+        if (result->lo >= DECIMAL_HALF)
+        {
+            result->lo -= DECIMAL_HALF;
+            result->hi++;
+        }
+        *sign = sign1;
+    }
+    else
+    {
+        /* Opposite signs: subtract the lower from the higher value,
+           the result has the sign of the higher value */
+        rc = decnum_compare (dec1, dec2);
+        if (rc == 0)
+        {
+            result->hi = result->lo = 0;
+            *sign = 1;
+            return;
+        }
+        higher = rc > 0 ? dec1 : dec2;
+        lower  = rc > 0 ? dec2 : dec1;
+        result->hi = higher->hi - lower->hi;
+        if (higher->lo >= lower->lo)
+            result->lo = higher->lo - lower->lo;
+        else
+        {
+            result->lo = higher->lo + DECIMAL_HALF - lower->lo;
+            result->hi--;
+        }
+        *sign = rc > 0 ? sign1 : sign2;
+    }
+
+    /* A zero result is positive */
+    if (result->hi == 0 && result->lo == 0)
+        *sign = 1;
+
+} /* end function decnum_add */
+
+/*-------------------------------------------------------------------*/
+/* Shift a decimal operand left, discarding digits beyond the 31st   */
+/*                                                                   */
+/* Input:                                                            */
+/*      dec     Value to be shifted (31 digits or less)              */
+/*      n       Number of digits (0-31) to shift left                */
+/*-------------------------------------------------------------------*/
+static void decnum_shift_left (DECNUM *dec, int n)
+{
+U64     carry;                          /* Digits moving to hi part  */
+
+    if (n >= 16)
+    {
+        dec->hi = (dec->lo % decimal_pow10[31-n]) * decimal_pow10[n-16];
+        dec->lo = 0;
+    }
+    else
+    {
+        carry = dec->lo / decimal_pow10[16-n];
+        dec->lo = (dec->lo % decimal_pow10[16-n]) * decimal_pow10[n];
+        dec->hi = (dec->hi % decimal_pow10[15-n]) * decimal_pow10[n]
+                + carry;
+    }
+
+} /* end function decnum_shift_left */
+
+/*-------------------------------------------------------------------*/
+/* Shift a decimal operand right                                     */
+/*                                                                   */
+/* Input:                                                            */
+/*      dec     Value to be shifted (31 digits or less)              */
+/*      n       Number of digits (1-32) to shift right               */
+/* Returns:                                                          */
+/*      The leftmost of the digits shifted out                       */
+/*-------------------------------------------------------------------*/
+static int decnum_shift_right (DECNUM *dec, int n)
+{
+int     d;                              /* Leftmost digit shifted out*/
+
+    if (n >= 16)
+    {
+        n -= 16;
+        d = (n == 0) ? (int)(dec->lo / decimal_pow10[15])
+                     : (int)((dec->hi / decimal_pow10[n-1]) % 10);
+        dec->lo = dec->hi / decimal_pow10[n];
+        dec->hi = 0;
+    }
+    else
+    {
+        d = (int)((dec->lo / decimal_pow10[n-1]) % 10);
+        dec->lo = dec->lo / decimal_pow10[n]
+                + (dec->hi % decimal_pow10[n]) * decimal_pow10[16-n];
+        dec->hi /= decimal_pow10[n];
+    }
+    return d;
+
+} /* end function decnum_shift_right */
+
+/*-------------------------------------------------------------------*/
+/* Multiply a decimal operand by a binary number less than 10**16    */
+/*                                                                   */
+/* The product is formed in 8-digit columns so that no partial       */
+/* product exceeds 64 bits.  Digits beyond the 32nd are discarded;   */
+/* the caller has already ensured that the product fits.             */
+/*-------------------------------------------------------------------*/
+static void decnum_multiply (DECNUM *dec1, U64 mult, DECNUM *result)
+{
+U64     a[4];                           /* Multiplicand 8-digit parts*/
+U64     b[2];                           /* Multiplier 8-digit parts  */
+U64     c[4];                           /* Product 8-digit columns   */
+int     i;                              /* Array subscript           */
+
+    a[0] = dec1->lo % 100000000;
+    a[1] = dec1->lo / 100000000;
+    a[2] = dec1->hi % 100000000;
+    a[3] = (dec1->hi / 100000000) % 100000000;
+    b[0] = mult % 100000000;
+    b[1] = mult / 100000000;
+
+    c[0] = a[0]*b[0];
+    c[1] = a[1]*b[0] + a[0]*b[1];
+    c[2] = a[2]*b[0] + a[1]*b[1];
+    c[3] = a[3]*b[0] + a[2]*b[1];
+
+    /* Propagate the carries from right to left */
+    for (i = 0; i < 3; i++)
+    {
+        c[i+1] += c[i] / 100000000;
+        c[i] %= 100000000;
+    }
+    c[3] %= 100000000;
+
+    result->lo = c[1] * 100000000 + c[0];
+    result->hi = c[3] * 100000000 + c[2];
+
+} /* end function decnum_multiply */
+
+/*-------------------------------------------------------------------*/
+/* Divide a decimal operand by a binary number less than 10**15      */
+/*                                                                   */
+/* The low-order half of the dividend is brought down four digits    */
+/* at a time, so that the partial remainder never exceeds 64 bits.   */
+/*-------------------------------------------------------------------*/
+static void decnum_divide (DECNUM *dec1, U64 div,
+                        DECNUM *quot, U64 *rem)
+{
+U64     r;                              /* Partial remainder         */
+U64     q;                              /* Low-order quotient        */
+U64     scale;                          /* Power of ten of next part */
+
+    quot->hi = dec1->hi / div;
+    r = dec1->hi % div;
+    for (q = 0, scale = 1000000000000ULL; scale != 0; scale /= 10000)
+    {
+        r = r * 10000 + (dec1->lo / scale) % 10000;
+        q = q * 10000 + r / div;
+        r %= div;
+    }
+    quot->lo = q;
+    *rem = r;
+
+} /* end function decnum_divide */
+#endif /*defined(OPTION_DECIMAL_BINARY)*/
 
 #endif /*!defined(_DECIMAL_C)*/
 
+#if !defined(OPTION_DECIMAL_BINARY)
 /*-------------------------------------------------------------------*/
 /* Load a packed decimal storage operand into a decimal byte string  */
 /*                                                                   */
@@ -692,6 +1004,96 @@ BYTE    pack[MAX_DECIMAL_LENGTH];       /* Packed decimal work area  */
 
 } /* end function ARCH_DEP(store_decimal) */
 
+#else /*defined(OPTION_DECIMAL_BINARY)*/
+/*-------------------------------------------------------------------*/
+/* Load a packed decimal storage operand into a binary value         */
+/*                                                                   */
+/* Input:                                                            */
+/*      addr    Logical address of packed decimal storage operand    */
+/*      len     Length minus one of storage operand (range 0-15)     */
+/*      arn     Access register number associated with operand       */
+/*      regs    CPU register context                                 */
+/* Output:                                                           */
+/*      result  Points to the value of the operand                   */
+/*      sign    Points to an integer which will be set to -1 if a    */
+/*              negative sign was loaded from the operand, or +1 if  */
+/*              a positive sign was loaded from the operand.         */
+/*                                                                   */
+/*      A program check may be generated if the logical address      */
+/*      causes an addressing, translation, or fetch protection       */
+/*      exception, or if the operand causes a data exception         */
+/*      because of invalid decimal digits or sign.                   */
+/*-------------------------------------------------------------------*/
+static void ARCH_DEP(load_decimal) (VADR addr, int len, int arn, REGS *regs,
+                        DECNUM *result, int *sign)
+{
+BYTE    pack[MAX_DECIMAL_LENGTH];       /* Packed decimal work area  */
+U64     hi, lo;                         /* Packed digits and sign    */
+int     h;                              /* Sign                      */
+
+    /* Fetch the packed decimal operand into work area */
+    memset (pack, 0, sizeof(pack));
+    ARCH_DEP(vfetchc) (pack+sizeof(pack)-len-1, len, addr, arn, regs);
+    hi = fetch_dw (pack);
+    lo = fetch_dw (pack+8);
+
+    /* Check for valid digits and sign */
+    h = lo & 0x0F;
+    if (bcd_invalid (hi) | bcd_invalid (lo & ~0x0FULL) | (h < 0x0A))
+    {
+        regs->dxc = DXC_DECIMAL;
+        ARCH_DEP(program_interrupt) (regs, PGM_DATA_EXCEPTION);
+        return;
+    }
+
+    /* Convert the 31 digits to binary */
+    result->hi = bcd_to_u64 (hi >> 4);
+    result->lo = bcd_to_u64 ((hi << 60) | (lo >> 4));
+
+    /* Set sign of operand */
+    *sign = (h == 0x0B || h == 0x0D) ? -1 : 1;
+
+} /* end function ARCH_DEP(load_decimal) */
+
+/*-------------------------------------------------------------------*/
+/* Store a binary value into packed decimal storage operand          */
+/*                                                                   */
+/* Input:                                                            */
+/*      addr    Logical address of packed decimal storage operand    */
+/*      len     Length minus one of storage operand (range 0-15)     */
+/*      arn     Access register number associated with operand       */
+/*      regs    CPU register context                                 */
+/*      dec     The value to be stored; digits which do not fit in   */
+/*              the operand are discarded.                           */
+/*      sign    -1 if a negative sign is to be stored, or +1 if a    */
+/*              positive sign is to be stored.                       */
+/*                                                                   */
+/*      A program check may be generated if the logical address      */
+/*      causes an addressing, translation, or protection exception.  */
+/*-------------------------------------------------------------------*/
+static void ARCH_DEP(store_decimal) (VADR addr, int len, int arn, REGS *regs,
+                        DECNUM *dec, int sign)
+{
+BYTE    pack[MAX_DECIMAL_LENGTH];       /* Packed decimal work area  */
+U64     hi, lo;                         /* Packed digits             */
+
+    /* if operand crosses page, make sure both pages are accessable */
+    if((addr & PAGEFRAME_PAGEMASK) !=
+        ((addr + len) & PAGEFRAME_PAGEMASK))
+        ARCH_DEP(validate_operand) (addr, arn, len, ACCTYPE_WRITE_SKP, regs);
+
+    /* Convert to packed digits, shifted left to make room for sign */
+    hi = u64_to_bcd (dec->hi % DECIMAL_HALF);
+    lo = u64_to_bcd (dec->lo);
+    store_dw (pack, (hi << 4) | (lo >> 60));
+    store_dw (pack+8, (lo << 4) | (sign < 0 ? 0x0D : 0x0C));
+
+    /* Store the result at the operand location */
+    ARCH_DEP(vstorec) (pack+sizeof(pack)-len-1, len, addr, arn, regs);
+
+} /* end function ARCH_DEP(store_decimal) */
+#endif /*defined(OPTION_DECIMAL_BINARY)*/
+
 
 /*-------------------------------------------------------------------*/
 /* FA   AP    - Add Decimal                                     [SS] */
@@ -703,15 +1105,29 @@ int     b1, b2;                         /* Base register numbers     */
 VADR    effective_addr1,
         effective_addr2;                /* Effective addresses       */
 int     cc;                             /* Condition code            */
+#if defined(OPTION_DECIMAL_BINARY)
+DECNUM  dec1, dec2, dec3;               /* Operand and result values */
+int     count3;                         /* Significant digit counter */
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
 BYTE    dec1[MAX_DECIMAL_DIGITS];       /* Work area for operand 1   */
 BYTE    dec2[MAX_DECIMAL_DIGITS];       /* Work area for operand 2   */
 BYTE    dec3[MAX_DECIMAL_DIGITS];       /* Work area for result      */
 int     count1, count2, count3;         /* Significant digit counters*/
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 int     sign1, sign2, sign3;            /* Sign of operands & result */
 
     SS(inst, regs, l1, l2, b1, effective_addr1,
                                      b2, effective_addr2);
 
+#if defined(OPTION_DECIMAL_BINARY)
+    /* Load operand values */
+    ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, &dec1, &sign1);
+    ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, &dec2, &sign2);
+
+    /* Add operand values */
+    decnum_add (&dec1, sign1, &dec2, sign2, &dec3, &sign3);
+    count3 = decnum_digits (&dec3);
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
     /* Load operands into work areas */
     ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, dec1, &count1, &sign1);
     ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, dec2, &count2, &sign2);
@@ -743,6 +1159,7 @@ int     sign1, sign2, sign3;            /* Sign of operands & result */
         subtract_decimal (dec1, dec2, dec3, &count3, &sign3);
         if (sign1 < 0) sign3 = -sign3;
     }
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 
     /* Set condition code */
     cc = (count3 == 0) ? 0 : (sign3 < 1) ? 1 : 2;
@@ -756,7 +1173,7 @@ int     sign1, sign2, sign3;            /* Sign of operands & result */
         sign3 = 1;
 
     /* Store result into first operand location */
-    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, dec3, sign3);
+    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, DECIMAL_OPERAND(dec3), sign3);
 
     /* Set condition code */
     regs->psw.cc = cc;
@@ -777,8 +1194,12 @@ int     l1, l2;                         /* Length values             */
 int     b1, b2;                         /* Base register numbers     */
 VADR    effective_addr1,
         effective_addr2;                /* Effective addresses       */
+#if defined(OPTION_DECIMAL_BINARY)
+DECNUM  dec1, dec2;                     /* Operand values            */
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
 BYTE    dec1[MAX_DECIMAL_DIGITS];       /* Work area for operand 1   */
 BYTE    dec2[MAX_DECIMAL_DIGITS];       /* Work area for operand 2   */
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 int     count1, count2;                 /* Significant digit counters*/
 int     sign1, sign2;                   /* Sign of each operand      */
 int     rc;                             /* Return code               */
@@ -786,9 +1207,17 @@ int     rc;                             /* Return code               */
     SS(inst, regs, l1, l2, b1, effective_addr1,
                                      b2, effective_addr2);
 
+#if defined(OPTION_DECIMAL_BINARY)
+    /* Load operand values */
+    ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, &dec1, &sign1);
+    ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, &dec2, &sign2);
+    count1 = (dec1.hi | dec1.lo) != 0;
+    count2 = (dec2.hi | dec2.lo) != 0;
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
     /* Load operands into work areas */
     ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, dec1, &count1, &sign1);
     ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, dec2, &count2, &sign2);
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 
     /* Result is equal if both operands are zero */
     if (count1 == 0 && count2 == 0)
@@ -812,7 +1241,11 @@ int     rc;                             /* Return code               */
     }
 
     /* If signs are equal then compare the digits */
+#if defined(OPTION_DECIMAL_BINARY)
+    rc = decnum_compare (&dec1, &dec2);
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
     rc = memcmp (dec1, dec2, MAX_DECIMAL_DIGITS);
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 
     /* Return low or high (depending on sign) if digits are unequal */
     if (rc < 0)
@@ -835,11 +1268,18 @@ int     l1, l2;                         /* Length values             */
 int     b1, b2;                         /* Base register numbers     */
 VADR    effective_addr1,
         effective_addr2;                /* Effective addresses       */
+#if defined(OPTION_DECIMAL_BINARY)
+DECNUM  dec1;                           /* Operand 1 (dividend)      */
+DECNUM  dec2;                           /* Operand 2 (divisor)       */
+DECNUM  quot;                           /* Quotient                  */
+DECNUM  rem;                            /* Remainder                 */
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
 BYTE    dec1[MAX_DECIMAL_DIGITS];       /* Operand 1 (dividend)      */
 BYTE    dec2[MAX_DECIMAL_DIGITS];       /* Operand 2 (divisor)       */
 BYTE    quot[MAX_DECIMAL_DIGITS];       /* Quotient                  */
 BYTE    rem[MAX_DECIMAL_DIGITS];        /* Remainder                 */
 int     count1, count2;                 /* Significant digit counters*/
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 int     sign1, sign2;                   /* Sign of operands          */
 int     signq, signr;                   /* Sign of quotient/remainder*/
 
@@ -851,6 +1291,26 @@ int     signq, signr;                   /* Sign of quotient/remainder*/
     if (l2 > 7 || l2 >= l1)
         ARCH_DEP(program_interrupt) (regs, PGM_SPECIFICATION_EXCEPTION);
 
+#if defined(OPTION_DECIMAL_BINARY)
+    /* Load operand values */
+    ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, &dec1, &sign1);
+    ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, &dec2, &sign2);
+
+    /* Program check if second operand value is zero */
+    if (dec2.lo == 0)
+        ARCH_DEP(program_interrupt) (regs, PGM_DECIMAL_DIVIDE_EXCEPTION);
+
+    /* Perform binary division; the divisor has at most 15 digits */
+    decnum_divide (&dec1, dec2.lo, &quot, &rem.lo);
+    rem.hi = 0;
+
+    /* Program check if the quotient does not fit in the leftmost
+       l1-l2 bytes of the first operand.  This is the same condition
+       as the trial comparison of the aligned divisor with the
+       leftmost digits of the dividend */
+    if (decnum_digits (&quot) > (l1 - l2) * 2 - 1)
+        ARCH_DEP(program_interrupt) (regs, PGM_DECIMAL_DIVIDE_EXCEPTION);
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
     /* Load operands into work areas */
     ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, dec1, &count1, &sign1);
     ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, dec2, &count2, &sign2);
@@ -873,6 +1333,7 @@ int     signq, signr;                   /* Sign of quotient/remainder*/
 
     /* Perform decimal division */
     divide_decimal (dec1, count1, dec2, count2, quot, rem);
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 
     /* Quotient is positive if operand signs are equal, and negative
        if operand signs are opposite, even if quotient is zero */
@@ -885,10 +1346,10 @@ int     signq, signr;                   /* Sign of quotient/remainder*/
        field will be filled in order to check for store protection.
        Subsequently the quotient will be stored in the leftmost bytes
        of the first operand location, overwriting high order zeroes */
-    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, rem, signr);
+    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, DECIMAL_OPERAND(rem), signr);
 
     /* Store quotient in leftmost bytes of first operand location */
-    ARCH_DEP(store_decimal) (effective_addr1, l1-l2-1, b1, regs, quot, signq);
+    ARCH_DEP(store_decimal) (effective_addr1, l1-l2-1, b1, regs, DECIMAL_OPERAND(quot), signq);
 
 } /* end DEF_INST(divide_decimal) */
 
@@ -1089,14 +1550,19 @@ int     l1, l2;                         /* Length values             */
 int     b1, b2;                         /* Base register numbers     */
 VADR    effective_addr1,
         effective_addr2;                /* Effective addresses       */
+#if defined(OPTION_DECIMAL_BINARY)
+DECNUM  dec1, dec2, dec3;               /* Operand and result values */
+int     count1;                         /* Significant digit counter */
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
 BYTE    dec1[MAX_DECIMAL_DIGITS];       /* Work area for operand 1   */
 BYTE    dec2[MAX_DECIMAL_DIGITS];       /* Work area for operand 2   */
 BYTE    dec3[MAX_DECIMAL_DIGITS];       /* Work area for result      */
 int     count1, count2;                 /* Significant digit counters*/
-int     sign1, sign2, sign3;            /* Sign of operands & result */
 int     d;                              /* Decimal digit             */
 int     i1, i2, i3;                     /* Array subscripts          */
 int     carry;                          /* Carry indicator           */
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
+int     sign1, sign2, sign3;            /* Sign of operands & result */
 
     SS(inst, regs, l1, l2, b1, effective_addr1,
                                      b2, effective_addr2);
@@ -1106,9 +1572,16 @@ int     carry;                          /* Carry indicator           */
     if (l2 > 7 || l2 >= l1)
         ARCH_DEP(program_interrupt) (regs, PGM_SPECIFICATION_EXCEPTION);
 
+#if defined(OPTION_DECIMAL_BINARY)
+    /* Load operand values */
+    ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, &dec1, &sign1);
+    ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, &dec2, &sign2);
+    count1 = decnum_digits (&dec1);
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
     /* Load operands into work areas */
     ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, dec1, &count1, &sign1);
     ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, dec2, &count2, &sign2);
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 
     /* Program check if the number of bytes in the second operand
        is less than the number of bytes of high-order zeroes in the
@@ -1119,6 +1592,11 @@ int     carry;                          /* Carry indicator           */
         ARCH_DEP(program_interrupt) (regs, PGM_DATA_EXCEPTION);
     }
 
+#if defined(OPTION_DECIMAL_BINARY)
+    /* Perform binary multiplication; the multiplier has at most
+       15 digits */
+    decnum_multiply (&dec1, dec2.lo, &dec3);
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
     /* Clear the result field */
     memset (dec3, 0, MAX_DECIMAL_DIGITS);
 
@@ -1136,13 +1614,14 @@ int     carry;                          /* Carry indicator           */
             }
         }
     } /* end for(i2) */
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 
     /* Result is positive if operand signs are equal, and negative
        if operand signs are opposite, even if result is zero */
     sign3 = (sign1 == sign2) ? 1 : -1;
 
     /* Store result into first operand location */
-    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, dec3, sign3);
+    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, DECIMAL_OPERAND(dec3), sign3);
 
 } /* end DEF_INST(multiply_decimal) */
 
@@ -1161,18 +1640,28 @@ int     b1, b2;                         /* Base register numbers     */
 VADR    effective_addr1,
         effective_addr2;                /* Effective addresses       */
 int     cc;                             /* Condition code            */
+#if defined(OPTION_DECIMAL_BINARY)
+DECNUM  dec;                            /* Operand value             */
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
 BYTE    dec[MAX_DECIMAL_DIGITS];        /* Work area for operand     */
+int     i, j;                           /* Array subscripts          */
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 int     count;                          /* Significant digit counter */
 int     sign;                           /* Sign of operand/result    */
-int     i, j;                           /* Array subscripts          */
 int     d;                              /* Decimal digit             */
 int     carry;                          /* Carry indicator           */
 
     SS(inst, regs, l1, i3, b1, effective_addr1,
                                      b2, effective_addr2);
 
+#if defined(OPTION_DECIMAL_BINARY)
+    /* Load operand value */
+    ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, &dec, &sign);
+    count = decnum_digits (&dec);
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
     /* Load operand into work area */
     ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, dec, &count, &sign);
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 
     /* Program check if rounding digit is invalid */
     if (i3 > 9)
@@ -1195,14 +1684,31 @@ int     carry;                          /* Carry indicator           */
             cc = 3;
 
         /* Shift operand left */
+#if defined(OPTION_DECIMAL_BINARY)
+        decnum_shift_left (&dec, (int)effective_addr2);
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
         for (i=0, j=effective_addr2; i < MAX_DECIMAL_DIGITS; i++, j++)
             dec[i] = (j < MAX_DECIMAL_DIGITS) ? dec[j] : 0;
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
     }
     else
     {
         /* Calculate number of digits (1-32) to shift right */
         effective_addr2 = 64 - effective_addr2;
 
+#if defined(OPTION_DECIMAL_BINARY)
+        /* Shift operand right, then add the carry from adding the
+           rounding digit to the leftmost of the digits shifted out */
+        d = decnum_shift_right (&dec, (int)effective_addr2);
+        carry = (d + i3) / 10;
+        dec.lo += carry;
+        if (dec.lo == DECIMAL_HALF)
+        {
+            dec.lo = 0;
+            dec.hi++;
+        }
+        count = decnum_digits (&dec);
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
         /* Add the rounding digit to the leftmost of the digits
            to be shifted out and propagate the carry to the left */
         carry = (effective_addr2 > MAX_DECIMAL_DIGITS) ? 0 :
@@ -1221,6 +1727,7 @@ int     carry;                          /* Carry indicator           */
             if (d != 0)
                 count = MAX_DECIMAL_DIGITS - i;
         }
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 
         /* Set condition code according to operand sign */
         cc = (count == 0) ? 0 : (sign < 0) ? 1 : 2;
@@ -1231,7 +1738,7 @@ int     carry;                          /* Carry indicator           */
         sign = +1;
 
     /* Store result into operand location */
-    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, dec, sign);
+    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, DECIMAL_OPERAND(dec), sign);
 
     /* Set condition code */
     regs->psw.cc = cc;
@@ -1257,15 +1764,29 @@ int     b1, b2;                         /* Base register numbers     */
 VADR    effective_addr1,
         effective_addr2;                /* Effective addresses       */
 int     cc;                             /* Condition code            */
+#if defined(OPTION_DECIMAL_BINARY)
+DECNUM  dec1, dec2, dec3;               /* Operand and result values */
+int     count3;                         /* Significant digit counter */
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
 BYTE    dec1[MAX_DECIMAL_DIGITS];       /* Work area for operand 1   */
 BYTE    dec2[MAX_DECIMAL_DIGITS];       /* Work area for operand 2   */
 BYTE    dec3[MAX_DECIMAL_DIGITS];       /* Work area for result      */
 int     count1, count2, count3;         /* Significant digit counters*/
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 int     sign1, sign2, sign3;            /* Sign of operands & result */
 
     SS(inst, regs, l1, l2, b1, effective_addr1,
                                      b2, effective_addr2);
 
+#if defined(OPTION_DECIMAL_BINARY)
+    /* Load operand values */
+    ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, &dec1, &sign1);
+    ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, &dec2, &sign2);
+
+    /* Add the first operand and the negated second operand */
+    decnum_add (&dec1, sign1, &dec2, -sign2, &dec3, &sign3);
+    count3 = decnum_digits (&dec3);
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
     /* Load operands into work areas */
     ARCH_DEP(load_decimal) (effective_addr1, l1, b1, regs, dec1, &count1, &sign1);
     ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, dec2, &count2, &sign2);
@@ -1297,6 +1818,7 @@ int     sign1, sign2, sign3;            /* Sign of operands & result */
         subtract_decimal (dec1, dec2, dec3, &count3, &sign3);
         if (sign1 < 0) sign3 = -sign3;
     }
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 
     /* Set condition code */
     cc = (count3 == 0) ? 0 : (sign3 < 1) ? 1 : 2;
@@ -1310,7 +1832,7 @@ int     sign1, sign2, sign3;            /* Sign of operands & result */
         sign3 = 1;
 
     /* Store result into first operand location */
-    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, dec3, sign3);
+    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, DECIMAL_OPERAND(dec3), sign3);
 
     /* Return condition code */
     regs->psw.cc = cc;
@@ -1332,15 +1854,25 @@ int     b1, b2;                         /* Base register numbers     */
 VADR    effective_addr1,
         effective_addr2;                /* Effective addresses       */
 int     cc;                             /* Condition code            */
+#if defined(OPTION_DECIMAL_BINARY)
+DECNUM  dec;                            /* Operand value             */
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
 BYTE    dec[MAX_DECIMAL_DIGITS];        /* Work area for operand     */
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 int     count;                          /* Significant digit counter */
 int     sign;                           /* Sign                      */
 
     SS(inst, regs, l1, l2, b1, effective_addr1,
                                      b2, effective_addr2);
 
+#if defined(OPTION_DECIMAL_BINARY)
+    /* Load second operand value */
+    ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, &dec, &sign);
+    count = decnum_digits (&dec);
+#else /*!defined(OPTION_DECIMAL_BINARY)*/
     /* Load second operand into work area */
     ARCH_DEP(load_decimal) (effective_addr2, l2, b2, regs, dec, &count, &sign);
+#endif /*!defined(OPTION_DECIMAL_BINARY)*/
 
     /* Set condition code */
     cc = (count == 0) ? 0 : (sign < 1) ? 1 : 2;
@@ -1354,7 +1886,7 @@ int     sign;                           /* Sign                      */
         sign = +1;
 
     /* Store result into first operand location */
-    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, dec, sign);
+    ARCH_DEP(store_decimal) (effective_addr1, l1, b1, regs, DECIMAL_OPERAND(dec), sign);
 
     /* Return condition code */
     regs->psw.cc = cc;
@@ -0,0 +1,275 @@
+/* DECTEST.C    Packed decimal differential test                     */
+
+/*-------------------------------------------------------------------*/
+/* This program checks the packed decimal instructions built with    */
+/* OPTION_DECIMAL_BINARY against the digit string routines they      */
+/* replace.  The z/Architecture instructions in the Hercules engine  */
+/* are executed side by side with a second copy of decimal.c that is */
+/* compiled below with OPTION_DECIMAL_BINARY undefined, on random    */
+/* operands with random lengths, signs, invalid digits and overlap.  */
+/* The stored result, condition code, program interruption code and  */
+/* data exception code must be identical.                            */
+/*                                                                   */
+/* Usage: dectest [count [seed]]                                     */
+/*                                                                   */
+/* Any difference is displayed; the return code is the number of     */
+/* differences found, up to 255.                                     */
+/*-------------------------------------------------------------------*/
+
+#include "hstdinc.h"
+
+#define _GEN_ARCH 900                   /* z/Architecture only       */
+#define _ONE_ARCH_                      /* No other instfetch        */
+
+#include "hercules.h"
+
+#include "opcode.h"
+
+/*-------------------------------------------------------------------*/
+/* Reference copy of the packed decimal instructions                 */
+/*-------------------------------------------------------------------*/
+#define NO_DECIMAL_BINARY               /* Digit string routines     */
+#define z900_add_decimal                  ref_add_decimal
+#define z900_compare_decimal              ref_compare_decimal
+#define z900_divide_decimal               ref_divide_decimal
+#define z900_edit_x_edit_and_mark         ref_edit_x_edit_and_mark
+#define z900_multiply_decimal             ref_multiply_decimal
+#define z900_shift_and_round_decimal      ref_shift_and_round_decimal
+#define z900_subtract_decimal             ref_subtract_decimal
+#define z900_test_decimal                 ref_test_decimal
+#define z900_zero_and_add                 ref_zero_and_add
+#define packed_to_binary                  ref_packed_to_binary
+#define binary_to_packed                  ref_binary_to_packed
+
+#include "decimal.c"
+
+#undef  z900_add_decimal
+#undef  z900_compare_decimal
+#undef  z900_divide_decimal
+#undef  z900_edit_x_edit_and_mark
+#undef  z900_multiply_decimal
+#undef  z900_shift_and_round_decimal
+#undef  z900_subtract_decimal
+#undef  z900_test_decimal
+#undef  z900_zero_and_add
+#undef  packed_to_binary
+#undef  binary_to_packed
+
+/*-------------------------------------------------------------------*/
+/* Test storage layout                                               */
+/*-------------------------------------------------------------------*/
+#define TEST_MAINSIZE   0x10000         /* Main storage size         */
+#define TEST_AREA       0x1000          /* Start of operand area     */
+#define TEST_AREALEN    0x2000          /* Length of operand area    */
+
+typedef void (*INSTFN) (BYTE inst[], REGS *regs);
+
+typedef struct _DECTEST {               /* Instruction under test    */
+        char   *name;                   /* Mnemonic                  */
+        BYTE    opcode;                 /* Operation code            */
+        INSTFN  binary;                 /* Hercules engine routine   */
+        INSTFN  digits;                 /* Reference routine         */
+    } DECTEST;
+
+static DECTEST dectests[] = {
+        { "AP",  0xFA, z900_add_decimal,          ref_add_decimal          },
+        { "SP",  0xFB, z900_subtract_decimal,     ref_subtract_decimal     },
+        { "ZAP", 0xF8, z900_zero_and_add,         ref_zero_and_add         },
+        { "CP",  0xF9, z900_compare_decimal,      ref_compare_decimal      },
+        { "MP",  0xFC, z900_multiply_decimal,     ref_multiply_decimal     },
+        { "DP",  0xFD, z900_divide_decimal,       ref_divide_decimal       },
+        { "SRP", 0xF0, z900_shift_and_round_decimal,
+                                          ref_shift_and_round_decimal      },
+    };
+
+#define DECTESTS (int)(sizeof(dectests) / sizeof(dectests[0]))
+
+/*-------------------------------------------------------------------*/
+/* Initialize a ghost CPU running in z/Architecture real mode        */
+/*-------------------------------------------------------------------*/
+static REGS *test_regs (void)
+{
+REGS   *regs;                           /* -> CPU register context   */
+
+    regs = calloc (1, sizeof(REGS));
+    if (regs == NULL) return NULL;
+    regs->mainstor = calloc (1, TEST_MAINSIZE);
+    regs->storkeys = calloc (1, TEST_MAINSIZE / STORAGE_KEY_UNITSIZE);
+    if (regs->mainstor == NULL || regs->storkeys == NULL) return NULL;
+    regs->mainlim = TEST_MAINSIZE - 1;
+    regs->psa = (PSA_3XX *)regs->mainstor;
+    regs->sysblk = &sysblk;
+    regs->arch_mode = ARCH_900;
+    regs->ghostregs = 1;
+    regs->hostregs = regs;
+    regs->tlbID = 1;
+    regs->psw.amode64 = regs->psw.amode = 1;
+    regs->psw.AMASK = AMASK64;
+    regs->program_interrupt = &z900_program_interrupt;
+    return regs;
+}
+
+/*-------------------------------------------------------------------*/
+/* Execute an instruction, returning the program interruption code   */
+/*-------------------------------------------------------------------*/
+static int test_exec (INSTFN fn, BYTE *inst, REGS *regs)
+{
+int     pcode;                          /* Program interruption code */
+
+    regs->dxc = 0;
+    regs->ip = inst;
+    if ((pcode = setjmp (regs->progjmp)) == 0)
+        fn (inst, regs);
+    return pcode;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return a random packed decimal operand of length len+1 bytes      */
+/*-------------------------------------------------------------------*/
+static void test_packed (BYTE *dec, int len)
+{
+static const BYTE signs[] = { 0x0C, 0x0D, 0x0A, 0x0B, 0x0E, 0x0F };
+int     n;                              /* Number of digits          */
+int     i, d;                           /* Digit index and value     */
+
+    /* Choose the number of significant digits, favouring operands
+       that are zero, short, or that fill the field */
+    switch (rand() % 4) {
+    case 0:  n = 0; break;
+    case 1:  n = rand() % 4; break;
+    case 2:  n = 2 * len + 1; break;
+    default: n = rand() % (2 * len + 2); break;
+    }
+
+    memset (dec, 0, len + 1);
+    for (i = 0; i < n; i++)
+    {
+        /* Mostly random digits, sometimes runs of nines */
+        d = (rand() % 3 == 0) ? 9 : rand() % 10;
+        if (rand() % 500 == 0)
+            d = 0x0A + rand() % 6;
+        if (i & 1)
+            dec[len - (i + 1) / 2] |= d;
+        else
+            dec[len - i / 2] |= d << 4;
+    }
+
+    /* Mostly preferred signs, sometimes any sign or an invalid one */
+    d = rand() % 16;
+    dec[len] |= (d < 12) ? signs[d & 1]
+              : (d < 15) ? signs[rand() % 6]
+              : rand() % 10;
+}
+
+/*-------------------------------------------------------------------*/
+/* Display a storage operand                                         */
+/*-------------------------------------------------------------------*/
+static void test_dump (char *label, BYTE *p, int len)
+{
+int     i;                              /* Array subscript           */
+
+    printf ("  %-8s", label);
+    for (i = 0; i < len; i++)
+        printf ("%2.2X", p[i]);
+    printf ("\n");
+}
+
+/*-------------------------------------------------------------------*/
+/* DECTEST main entry point                                          */
+/*-------------------------------------------------------------------*/
+int main (int argc, char *argv[])
+{
+REGS   *regs1, *regs2;                  /* Binary and reference CPUs */
+DECTEST *t;                             /* -> Instruction under test */
+BYTE    inst[6];                        /* Instruction               */
+BYTE    init[TEST_AREALEN];             /* Initial operand area      */
+int     count = 1000000;                /* Number of tests           */
+int     seed = 1;                       /* Random number seed        */
+int     errors = 0;                     /* Number of differences     */
+int     pcode1, pcode2;                 /* Program interruption codes*/
+int     l1, l2, i3;                     /* Instruction fields        */
+U32     addr1, addr2;                   /* Operand addresses         */
+int     i;                              /* Test number               */
+
+    if (argc > 1) count = atoi (argv[1]);
+    if (argc > 2) seed = atoi (argv[2]);
+    srand (seed);
+
+    regs1 = test_regs ();
+    regs2 = test_regs ();
+    if (regs1 == NULL || regs2 == NULL)
+    {
+        fprintf (stderr, "dectest: calloc failed\n");
+        return 255;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        t = &dectests[rand() % DECTESTS];
+
+        /* Choose the operand lengths and addresses; the operands
+           may cross a page boundary and may overlap */
+        l1 = rand() % 16;
+        l2 = rand() % 16;
+        addr1 = TEST_AREA + 0x800 - 8 + rand() % 16;
+        switch (rand() % 8) {
+        case 0:  addr2 = addr1; break;
+        case 1:  addr2 = addr1 + l1 - rand() % 3; break;
+        default: addr2 = TEST_AREA + 0x1000 - 8 + rand() % 16; break;
+        }
+
+        /* Build the operands */
+        memset (regs1->mainstor + TEST_AREA, 0xEE, TEST_AREALEN);
+        test_packed (regs1->mainstor + addr2, l2);
+        test_packed (regs1->mainstor + addr1, l1);
+
+        /* Build the instruction; SRP has a shift amount as the
+           second operand address and a rounding digit */
+        inst[0] = t->opcode;
+        if (t->opcode == 0xF0)
+        {
+            i3 = rand() % 16;
+            if (rand() % 8 == 0) i3 = 10 + rand() % 6;
+            inst[1] = (l1 << 4) | i3;
+            addr2 = rand() % 64;
+        }
+        else
+            inst[1] = (l1 << 4) | l2;
+        inst[2] = 0x10; inst[3] = 0x00;
+        inst[4] = 0x20; inst[5] = 0x00;
+
+        memcpy (init, regs1->mainstor + TEST_AREA, TEST_AREALEN);
+        memcpy (regs2->mainstor + TEST_AREA, init, TEST_AREALEN);
+
+        regs1->GR_G(1) = regs2->GR_G(1) = addr1;
+        regs1->GR_G(2) = regs2->GR_G(2) = addr2;
+        regs1->psw.progmask = regs2->psw.progmask =
+            (rand() & 1) ? BIT(PSW_DOBIT) : 0;
+        regs1->psw.cc = regs2->psw.cc = 0;
+
+        pcode1 = test_exec (t->binary, inst, regs1);
+        pcode2 = test_exec (t->digits, inst, regs2);
+
+        if (pcode1 == pcode2
+         && regs1->psw.cc == regs2->psw.cc
+         && regs1->dxc == regs2->dxc
+         && memcmp (regs1->mainstor + TEST_AREA,
+                    regs2->mainstor + TEST_AREA, TEST_AREALEN) == 0)
+            continue;
+
+        printf ("Test %d: %s L1=%d L2=%d op1=%4.4X op2=%4.4X\n",
+                i, t->name, l1, l2, addr1, addr2);
+        test_dump ("op1", init + addr1 - TEST_AREA, l1 + 1);
+        if (t->opcode != 0xF0)
+            test_dump ("op2", init + addr2 - TEST_AREA, l2 + 1);
+        test_dump ("binary", regs1->mainstor + addr1, l1 + 1);
+        test_dump ("digits", regs2->mainstor + addr1, l1 + 1);
+        printf ("  cc=%d/%d pgm=%4.4X/%4.4X dxc=%2.2X/%2.2X\n",
+                regs1->psw.cc, regs2->psw.cc, pcode1, pcode2,
+                regs1->dxc, regs2->dxc);
+        if (++errors >= 255) break;
+    }
+
+    printf ("dectest: %d tests, %d differences\n", i, errors);
+    return errors;
+}
@@ -156,27 +156,29 @@ typedef struct  _PSW {
 #define SGMASK(p)             ( (p)->progmask & BIT(PSW_SGBIT) )
 
 /* Structure definition for translation-lookaside buffer entry */
-#define TLBN            1024            /* Number TLB entries        */
-#define TLB_MASK        0x3FF           /* Mask for 1024 entries     */
+#define TLBN            1024            /* Number TLB sets           */
+#define TLB_MASK        0x3FF           /* Mask for 1024 sets        */
+#define TLB_WAYS        2               /* Entries per TLB set       */
+#define TLBE            (TLBN*TLB_WAYS) /* Number TLB entries        */
 #define TLB_REAL_ASD_L  0xFFFFFFFF      /* ASD values for real mode  */
 #define TLB_REAL_ASD_G  0xFFFFFFFFFFFFFFFFULL
 #define TLB_HOST_ASD    0x800           /* Host entry for XC guest   */
 typedef struct _TLB  {
-        DW              asd[TLBN];      /* Address space designator  */
+        DW              asd[TLBE];      /* Address space designator  */
 #define TLB_ASD_G(_n)   asd[(_n)].D
 #define TLB_ASD_L(_n)   asd[(_n)].F.L.F
-        DW              vaddr[TLBN];    /* Virtual page address      */
+        DW              vaddr[TLBE];    /* Virtual page address      */
 #define TLB_VADDR_G(_n) vaddr[(_n)].D
 #define TLB_VADDR_L(_n) vaddr[(_n)].F.L.F
-        DW              pte[TLBN];      /* Copy of page table entry  */
+        DW              pte[TLBE];      /* Copy of page table entry  */
 #define TLB_PTE_G(_n)   pte[(_n)].D
 #define TLB_PTE_L(_n)   pte[(_n)].F.L.F
-        BYTE           *main[TLBN];     /* Mainstor address          */
-        BYTE           *storkey[TLBN];  /* -> Storage key            */
-        BYTE            skey[TLBN];     /* Storage key key-value     */
-        BYTE            common[TLBN];   /* 1=Page in common segment  */
-        BYTE            protect[TLBN];  /* 1=Page in protected segmnt*/
-        BYTE            acc[TLBN];      /* Access type flags         */
+        BYTE           *main[TLBE];     /* Mainstor address          */
+        BYTE           *storkey[TLBE];  /* -> Storage key            */
+        BYTE            skey[TLBE];     /* Storage key key-value     */
+        BYTE            common[TLBE];   /* 1=Page in common segment  */
+        BYTE            protect[TLBE];  /* 1=Page in protected segmnt*/
+        BYTE            acc[TLBE];      /* Access type flags         */
     } TLB;
 
 /* TLB Notes -
@@ -184,8 +186,50 @@ typedef struct _TLB  {
  * protect.
  * Fields set by logical_to_main() are main, storkey, skey, read and
  * write and are used for accelerated address lookup (formerly AEA).
+ * The TLB is 2-way set associative.  Entry ix (0 to TLBN-1) is the
+ * most recently used way of set ix and is the only way examined by
+ * the accelerated lookup; entry ix+TLBN is the second way.  A hit on
+ * the second way in translate_addr() swaps the two entries, and a
+ * new translation demotes the current first way into the second.
  */
 
+#if defined(OPTION_PAGE_WALK_CACHE)
+/* Structure definition for page-walk cache entry */
+#define PWC_SEGN        64              /* Number segment entries    */
+#define PWC_REGN        16              /* Number region entries     */
+typedef struct _PWCE {
+        U64             asd;            /* Address space designator  */
+        U64             vaddr;          /* Segment or region address */
+        U64             ent;            /* Segment table entry, or
+                                           segment table origin      */
+        U64             eaddr;          /* Segment table entry addr  */
+        U32             id;             /* tlbID when formed, 0=none */
+        BYTE            tf;             /* Segment table offset      */
+        BYTE            tl;             /* Segment table length      */
+        BYTE            protect;        /* Region protection         */
+    } PWCE;
+
+typedef struct _PWC {
+        PWCE            seg[PWC_SEGN];  /* Segment table entries     */
+        PWCE            reg[PWC_REGN];  /* Segment tables reached
+                                           through region tables     */
+    } PWC;
+
+/* PWC Notes -
+ * The page-walk cache holds the results of the ESAME region and
+ * segment table lookups of recent TLB misses, so that a miss on
+ * another page of a cached segment fetches only the page table
+ * entry, and a miss on another segment of a cached region fetches
+ * only the segment and page table entries.  Both parts are direct
+ * mapped, indexed by address and ASCE, and tagged with the ASCE and
+ * the tlbID.  Anything which purges the TLB therefore purges the
+ * page-walk cache too; purge_tlb_asce() also clears the entries of
+ * the designated address space and the common segment entries of
+ * any address space.  Page table entries are never cached, so IPTE
+ * has nothing to clear here.
+ */
+#endif /*defined(OPTION_PAGE_WALK_CACHE)*/
+
 /* Structure for Dynamic Address Translation */
 typedef struct _DAT {
         RADR    raddr;                  /* Real address              */
@@ -1300,6 +1344,7 @@ typedef struct _MBK {
 #define PLO_CSTSTG              21      /* C/S and triple store      */
 #define PLO_CSTSTGR             22      /* C/S/TS              ESAME */
 #define PLO_CSTSTX              23      /* C/S/TS              ESAME */
+#define PLO_FUNCS               24      /* Number of function codes  */
 
 /* Perform Frame Management Function definitions */
 #define PFMF_FMFI            0x000f0000 /* Frame mgmt function indic */
@@ -38,6 +38,7 @@ BYTE * get_stfl_data(int, int *);
 #include "crypto.h"
 
 #include "clock.h"
+#include "hsimd.h"
 
 
 #if defined(FEATURE_BINARY_FLOATING_POINT)
@@ -971,13 +972,13 @@ U64     old;                            /* Old value                 */
     old = CSWAP64 (regs->GR_G(r1));
 
     /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
+    OBTAIN_MAINLOCK_CAS(regs);
 
     /* Attempt to exchange the values */
     regs->psw.cc = cmpxchg8 (&old, CSWAP64(regs->GR_G(r1+1)), main2);
 
     /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
+    RELEASE_MAINLOCK_CAS(regs);
 
     if (regs->psw.cc == 0)
     {
@@ -1117,14 +1118,11 @@ BYTE   *mn;                             /* Mainstor address of ASCE  */
     {
         /* Perform clearing-by-ASCE operation */
 
-        /* Clear the TLB and signal all other CPUs to clear their TLB */
-        /* Note: Currently we clear all entries regardless of the
-           clearing ASCE passed in the r3 register. This conforms
-           to the POP which only specifies the minimum set of entries
-           which must be cleared from the TLB. */
+        /* Clear the TLB entries formed using the clearing ASCE in
+           the r3 register and signal all other CPUs to do the same */
         OBTAIN_INTLOCK(regs);
         SYNCHRONIZE_CPUS(regs);
-        ARCH_DEP(purge_tlb_all)();
+        ARCH_DEP(purge_tlb_asce_all)(regs->GR_G(r3));
         RELEASE_INTLOCK(regs);
 
     } /* end else(clearing-by-ASCE) */
@@ -1644,7 +1642,8 @@ DEF_INST(store_pair_to_quadword)
 int     r1;                             /* Value of R field          */
 int     b2;                             /* Base of effective addr    */
 VADR    effective_addr2;                /* Effective address         */
-QWORD   qwork;                          /* Quadword work area        */
+BYTE   *main2;                          /* mainstor address          */
+U64     old1, old2;                     /* Current operand value     */
 
     RXY(inst, regs, r1, b2, effective_addr2);
 
@@ -1652,16 +1651,20 @@ QWORD   qwork;                          /* Quadword work area        */
 
     QW_CHECK(effective_addr2, regs);
 
-    /* Store regs in workarea */
-    STORE_DW(qwork, regs->GR_G(r1));
-    STORE_DW(qwork+8, regs->GR_G(r1+1));
+    /* Get operand mainstor address */
+    main2 = MADDR (effective_addr2, b2, regs, ACCTYPE_WRITE, regs->psw.pkey);
 
     /* Store R1 and R1+1 registers to second operand
-       Provide storage consistancy by means of obtaining
-       the main storage access lock */
-    OBTAIN_MAINLOCK(regs);
-    ARCH_DEP(vstorec) ( qwork, 16-1, effective_addr2, b2, regs );
-    RELEASE_MAINLOCK(regs);
+       Provide quadword consistency by exchanging the whole
+       operand, holding the main storage access lock only
+       if the host cmpxchg16 is not atomic */
+    old1 = ((U64 *)main2)[0];
+    old2 = ((U64 *)main2)[1];
+    OBTAIN_MAINLOCK_CAS(regs);
+    while (cmpxchg16 (&old1, &old2,
+                      CSWAP64(regs->GR_G(r1)), CSWAP64(regs->GR_G(r1+1)),
+                      main2));
+    RELEASE_MAINLOCK_CAS(regs);
 
 } /* end DEF_INST(store_pair_to_quadword) */
 #endif /*defined(FEATURE_ESAME)*/
@@ -1676,7 +1679,8 @@ DEF_INST(load_pair_from_quadword)
 int     r1;                             /* Value of R field          */
 int     b2;                             /* Base of effective addr    */
 VADR    effective_addr2;                /* Effective address         */
-QWORD   qwork;                          /* Quadword work area        */
+BYTE   *main2;                          /* mainstor address          */
+U64     old1, old2;                     /* Operand value             */
 
     RXY(inst, regs, r1, b2, effective_addr2);
 
@@ -1684,16 +1688,22 @@ QWORD   qwork;                          /* Quadword work area        */
 
     QW_CHECK(effective_addr2, regs);
 
-    /* Load R1 and R1+1 registers contents from second operand
-       Provide storage consistancy by means of obtaining
-       the main storage access lock */
-    OBTAIN_MAINLOCK(regs);
-    ARCH_DEP(vfetchc) ( qwork, 16-1, effective_addr2, b2, regs );
-    RELEASE_MAINLOCK(regs);
+    /* Get operand mainstor address */
+    main2 = MADDR (effective_addr2, b2, regs, ACCTYPE_READ, regs->psw.pkey);
 
-    /* Load regs from workarea */
-    FETCH_DW(regs->GR_G(r1), qwork);
-    FETCH_DW(regs->GR_G(r1+1), qwork+8);
+    /* Load R1 and R1+1 registers contents from second operand
+       Provide quadword consistency by a compare and exchange
+       which stores zero only if the operand is already zero,
+       holding the main storage access lock only if the host
+       cmpxchg16 is not atomic */
+    old1 = old2 = 0;
+    OBTAIN_MAINLOCK_CAS(regs);
+    cmpxchg16 (&old1, &old2, 0, 0, main2);
+    RELEASE_MAINLOCK_CAS(regs);
+
+    /* Load regs from operand value */
+    regs->GR_G(r1) = CSWAP64(old1);
+    regs->GR_G(r1+1) = CSWAP64(old2);
 
 } /* end DEF_INST(load_pair_from_quadword) */
 #endif /*defined(FEATURE_ESAME)*/
@@ -2521,13 +2531,13 @@ U64     old;                            /* old value                 */
     old = CSWAP64(regs->GR_G(r1));
 
     /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
+    OBTAIN_MAINLOCK_CAS(regs);
 
     /* Attempt to exchange the values */
     regs->psw.cc = cmpxchg8 (&old, CSWAP64(regs->GR_G(r3)), main2);
 
     /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
+    RELEASE_MAINLOCK_CAS(regs);
 
     /* Perform serialization after completing operation */
     PERFORM_SERIALIZATION (regs);
@@ -2582,7 +2592,7 @@ U64     old1, old2;                     /* old value                 */
     old2 = CSWAP64(regs->GR_G(r1+1));
 
     /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
+    OBTAIN_MAINLOCK_CAS(regs);
 
     /* Attempt to exchange the values */
     regs->psw.cc = cmpxchg16 (&old1, &old2,
@@ -2590,7 +2600,7 @@ U64     old1, old2;                     /* old value                 */
                               main2);
 
     /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
+    RELEASE_MAINLOCK_CAS(regs);
 
     /* Perform serialization after completing operation */
     PERFORM_SERIALIZATION (regs);
@@ -6370,8 +6380,13 @@ int     r1, r2;                         /* Values of R fields        */
 VADR    addr1, addr2, trtab;            /* Effective addresses       */
 GREG    len;
 BYTE    svalue, dvalue, tvalue;
+BYTE   *src, *dst, *tab, *q;            /* Mainstor pointers         */
+BYTE    work[0x800];                    /* Translated block          */
+int     n;                              /* Bytes in this block       */
 #ifdef FEATURE_ETF2_ENHANCEMENT
 int     tccc;                   /* Test-Character-Comparison Control */
+#else
+int     tccc = 0;
 #endif
 
 // NOTE: it's faster to decode with RRE format
@@ -6405,6 +6420,70 @@ int     tccc;                   /* Test-Character-Comparison Control */
     if(!len)
         regs->psw.cc = 0;
 
+    /* Fast path if the translation table does not cross a boundary:
+       translate up to the next 2K boundary of either operand at once */
+    if(len && NOCROSS2K(trtab, 255))
+    {
+        tab = NULL;
+        while(len)
+        {
+            n = 0x800 - (addr1 & 0x7FF);
+            if(n > 0x800 - (int)(addr2 & 0x7FF))
+                n = 0x800 - (addr2 & 0x7FF);
+            if((GREG)n > len)
+                n = len;
+
+            src = MADDR(addr2, r2, regs, ACCTYPE_READ, regs->psw.pkey);
+            if(tab == NULL)
+                tab = MADDR(trtab, 1, regs, ACCTYPE_READ, regs->psw.pkey);
+            hsimd_tr(work, src, n, tab);
+
+            /* If the testvalue is found, stop in front of it */
+            q = tccc ? NULL : memchr(work, tvalue, n);
+            if(q)
+                n = q - work;
+
+            if(n)
+            {
+                dst = MADDR(addr1, r1, regs, ACCTYPE_WRITE, regs->psw.pkey);
+
+                /* A destination just above the source must see the
+                   bytes it stores, so stop where they would be read */
+                if(dst > src && dst < src + n)
+                {
+                    n = dst - src;
+                    q = NULL;
+                }
+                memcpy(dst, work, n);
+
+                /* Adjust source addr, destination addr and length */
+                addr1 += n; addr1 &= ADDRESS_MAXWRAP(regs);
+                addr2 += n; addr2 &= ADDRESS_MAXWRAP(regs);
+                len -= n;
+
+                /* Update the registers */
+                SET_GR_A(r1, regs, addr1);
+                SET_GR_A(r1 + 1, regs, len);
+                SET_GR_A(r2, regs, addr2);
+
+                /* Set cc0 when all values have been processed */
+                regs->psw.cc = len ? 3 : 0;
+            }
+
+            /* If the testvalue was found then exit with cc1 */
+            if(q)
+            {
+                regs->psw.cc = 1;
+                break;
+            }
+
+            /* exit on the cpu determined number of bytes */
+            if((len != 0) && (!(addr1 & 0xfff) || !(addr2 & 0xfff)))
+                break;
+        }
+        return;
+    }
+
     while(len)
     {
         svalue = ARCH_DEP(vfetchb) (addr2, r2, regs);
@@ -7266,13 +7345,13 @@ U32     old;                            /* old value                 */
     old = CSWAP32(regs->GR_L(r1));
 
     /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
+    OBTAIN_MAINLOCK_CAS(regs);
 
     /* Attempt to exchange the values */
     regs->psw.cc = cmpxchg4 (&old, CSWAP32(regs->GR_L(r3)), main2);
 
     /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
+    RELEASE_MAINLOCK_CAS(regs);
 
     /* Perform serialization after completing operation */
     PERFORM_SERIALIZATION (regs);
@@ -7327,13 +7406,13 @@ U64     old, new;                       /* old, new values           */
     new = CSWAP64(((U64)(regs->GR_L(r3)) << 32) | regs->GR_L(r3+1));
 
     /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
+    OBTAIN_MAINLOCK_CAS(regs);
 
     /* Attempt to exchange the values */
     regs->psw.cc = cmpxchg8 (&old, new, main2);
 
     /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
+    RELEASE_MAINLOCK_CAS(regs);
 
     /* Perform serialization after completing operation */
     PERFORM_SERIALIZATION (regs);
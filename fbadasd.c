@@ -50,6 +50,58 @@
 
 #define FBA_BLKGRP_SIZE  (120 * 512)    /* Size of block group       */
 
+#if defined(OPTION_DASD_MMAP)
+/*-------------------------------------------------------------------*/
+/* Map the FBA image file                                            */
+/*                                                                   */
+/* With the mmap option block groups are accessed in place in the    */
+/* host page cache instead of being read into a device cache buffer. */
+/* If the file cannot be mapped the device uses read and write.      */
+/*-------------------------------------------------------------------*/
+static int fbadasd_mmap (DEVBLK *dev)
+{
+int     prot;                           /* Protection                */
+
+    /* Map read only if the file is not open for writing */
+    dev->dasdmapro = (fcntl (dev->fd, F_GETFL) & O_ACCMODE) == O_RDONLY;
+    prot = dev->dasdmapro ? PROT_READ : PROT_READ | PROT_WRITE;
+
+    if ((off_t)(size_t)dev->fbaend != dev->fbaend)
+    {
+        logmsg (_("HHCDA089W %s too large to map\n"), dev->filename);
+        return -1;
+    }
+    dev->dasdmap[0] = mmap (NULL, (size_t)dev->fbaend, prot, MAP_SHARED,
+                            dev->fd, 0);
+    if (dev->dasdmap[0] == MAP_FAILED)
+    {
+        logmsg (_("HHCDA090W %s mmap error: %s\n"),
+                dev->filename, strerror(errno));
+        dev->dasdmap[0] = NULL;
+        return -1;
+    }
+    dev->dasdmaplen[0] = (size_t)dev->fbaend;
+
+    dev->dasdmmap = 1;
+    logmsg (_("HHCDA091I %s mapped%s\n"), dev->filename,
+            dev->dasdmapro ? " readonly" : "");
+    return 0;
+} /* end function fbadasd_mmap */
+
+/*-------------------------------------------------------------------*/
+/* Unmap the FBA image file                                          */
+/*-------------------------------------------------------------------*/
+static void fbadasd_munmap (DEVBLK *dev)
+{
+    if (!dev->dasdmapro)
+        msync (dev->dasdmap[0], dev->dasdmaplen[0], MS_SYNC);
+    munmap (dev->dasdmap[0], dev->dasdmaplen[0]);
+    dev->dasdmap[0] = NULL;
+    dev->dasdmaplen[0] = 0;
+    dev->dasdmmap = 0;
+} /* end function fbadasd_munmap */
+#endif /*defined(OPTION_DASD_MMAP)*/
+
 /*-------------------------------------------------------------------*/
 /* Initialize the device handler                                     */
 /*-------------------------------------------------------------------*/
@@ -81,6 +133,11 @@ char    pathname[MAX_PATH];             /* file path in host format  */
     /* Save the file name in the device block */
     strcpy (dev->filename, argv[0]);
 
+#if defined(OPTION_DASD_MMAP)
+    /* Image file is not mapped unless requested */
+    dev->dasdmmap = 0;
+#endif /*defined(OPTION_DASD_MMAP)*/
+
     /* Device is shareable */
     dev->shared = 1;
 
@@ -203,6 +260,14 @@ char    pathname[MAX_PATH];             /* file path in host format  */
                 dev->syncio = 1;
                 continue;
             }
+#if defined(OPTION_DASD_MMAP)
+            if (strcasecmp ("mmap", argv[i]) == 0)
+            {
+                logmsg (_("HHCDA088W %s mmap ignored for compressed dasd\n"),
+                        dev->filename);
+                continue;
+            }
+#endif /*defined(OPTION_DASD_MMAP)*/
 
             logmsg (_("HHCDA063E parameter %d is invalid: %s\n"),
                     i + 1, argv[i]);
@@ -249,6 +314,15 @@ char    pathname[MAX_PATH];             /* file path in host format  */
             dev->fbanumblk = statbuf.st_size / dev->fbablksiz;
         }
 
+#if defined(OPTION_DASD_MMAP)
+        /* The mmap option follows the origin and block count */
+        if (argc >= 2 && strcasecmp ("mmap", argv[argc-1]) == 0)
+        {
+            dev->dasdmmap = 1;
+            argc--;
+        }
+#endif /*defined(OPTION_DASD_MMAP)*/
+
         /* The second argument is the device origin block number */
         if (argc >= 2)
         {
@@ -309,6 +383,15 @@ char    pathname[MAX_PATH];             /* file path in host format  */
     /* Initialize current blkgrp and cache entry */
     dev->bufcur = dev->cache = -1;
 
+#if defined(OPTION_DASD_MMAP)
+    /* Map the image file if requested */
+    if (dev->dasdmmap)
+    {
+        dev->dasdmmap = 0;
+        fbadasd_mmap (dev);
+    }
+#endif /*defined(OPTION_DASD_MMAP)*/
+
     /* Activate I/O tracing */
 //  dev->ccwtrace = 1;
 
@@ -485,6 +568,61 @@ int     copylen;                        /* Length left to copy       */
     return len;
 } /* end function fba_write */
 
+#if defined(OPTION_DASD_MMAP)
+/*-------------------------------------------------------------------*/
+/* Read a block group from the mapped FBA image file                 */
+/*-------------------------------------------------------------------*/
+static
+int fbadasd_read_mapped_blkgrp (DEVBLK *dev, int blkgrp, BYTE *unitstat)
+{
+BYTE   *addr;                           /* -> Modified data          */
+BYTE   *page;                           /* -> Containing page        */
+
+    /* Write back the previous block group if modified */
+    if (dev->bufupd)
+    {
+        dev->bufupd = 0;
+
+        addr = dev->buf + dev->bufupdlo;
+        page = (BYTE *)((uintptr_t)addr & ~((uintptr_t)getpagesize() - 1));
+        if (msync (page, (dev->bufupdhi - dev->bufupdlo) + (addr - page),
+                   MS_ASYNC) < 0)
+        {
+            logmsg (_("HHCDA092E error writing blkgrp %d: msync error: %s\n"),
+                    dev->bufcur, strerror(errno));
+            dev->sense[0] = SENSE_EC;
+            *unitstat = CSW_CE | CSW_DE | CSW_UC;
+            dev->bufupdlo = dev->bufupdhi = 0;
+            dev->bufcur = -1;
+            return -1;
+        }
+
+        dev->bufupdlo = dev->bufupdhi = 0;
+    }
+
+    dev->bufcur = -1;
+
+    /* Return on special case when called by the close handler */
+    if (blkgrp < 0)
+        return 0;
+
+    logdevtr (dev, _("HHCDA074I read blkgrp %d offset %" I64_FMT "d len %d\n"),
+              blkgrp, (long long)((S64)blkgrp * FBA_BLKGRP_SIZE),
+              fba_blkgrp_len(dev, blkgrp));
+
+    /* The block group is used where it is mapped */
+    dev->buf = dev->dasdmap[0] + (size_t)blkgrp * FBA_BLKGRP_SIZE;
+    dev->bufcur = blkgrp;
+    dev->bufoff = 0;
+    dev->bufoffhi = fba_blkgrp_len (dev, blkgrp);
+    dev->buflen = fba_blkgrp_len (dev, blkgrp);
+    dev->bufsize = fba_blkgrp_len (dev, blkgrp);
+
+    return 0;
+
+} /* end function fbadasd_read_mapped_blkgrp */
+#endif /*defined(OPTION_DASD_MMAP)*/
+
 /*-------------------------------------------------------------------*/
 /* FBA read block group exit                                         */
 /*-------------------------------------------------------------------*/
@@ -500,6 +638,12 @@ off_t           offset;                 /* File offsets              */
     if (blkgrp >= 0 && blkgrp == dev->bufcur)
         return 0;
 
+#if defined(OPTION_DASD_MMAP)
+    /* Mapped block groups need no cache buffer */
+    if (dev->dasdmmap)
+        return fbadasd_read_mapped_blkgrp (dev, blkgrp, unitstat);
+#endif /*defined(OPTION_DASD_MMAP)*/
+
     /* Write the previous block group if modified */
     if (dev->bufupd)
     {
@@ -691,6 +835,16 @@ int             rc;                     /* Return code               */
         }
     }
 
+#if defined(OPTION_DASD_MMAP)
+    /* Error if the file is mapped read-only */
+    if (dev->dasdmmap && dev->dasdmapro)
+    {
+        dev->sense[0] = SENSE_EC;
+        *unitstat = CSW_CE | CSW_DE | CSW_UC;
+        return -1;
+    }
+#endif /*defined(OPTION_DASD_MMAP)*/
+
     /* Copy to the device buffer */
     if (buf) memcpy (dev->buf + off, buf, len);
 
@@ -753,6 +907,12 @@ BYTE            unitstat;
     cache_scan(CACHE_DEVBUF, fbadasd_purge_cache, dev);
     cache_unlock(CACHE_DEVBUF);
 
+#if defined(OPTION_DASD_MMAP)
+    /* Unmap the device file */
+    if (dev->dasdmmap)
+        fbadasd_munmap (dev);
+#endif /*defined(OPTION_DASD_MMAP)*/
+
     /* Close the device file */
     close (dev->fd);
     dev->fd = -1;
@@ -19,13 +19,36 @@
 #define PANEL_REFRESH_RATE_SLOW     500 /* Slow refresh rate         */
 #define DEFAULT_TIMER_REFRESH_USECS  50 /* Default timer refresh int */
 #define MAX_DEVICE_THREAD_IDLE_SECS 300 /* 5 Minute thread timeout   */
+#define MAX_DEVICE_THREAD_QUEUES      8 /* Device thread I/O queues  */
 #undef  OPTION_NO_INLINE_DAT            /* Performance option        */
 #undef  OPTION_NO_INLINE_LOGICAL        /* Performance option        */
 #undef  OPTION_NO_INLINE_VSTORE         /* Performance option        */
 #undef  OPTION_NO_INLINE_IFETCH         /* Performance option        */
 #define OPTION_MULTI_BYTE_ASSIST        /* Performance option        */
 #define OPTION_SINGLE_CPU_DW            /* Performance option (ia32) */
+#define OPTION_DECODE_CACHE        4096 /* Pre-decoded instruction
+                                           cache entries per CPU;
+                                           size must be a power of 2 */
+#define OPTION_INSTRUCTION_FUSION       /* Fused instruction pairs   */
 #define OPTION_FAST_DEVLOOKUP           /* Fast devnum/subchan lookup*/
+#define OPTION_LOCKFREE_INTS            /* Post interrupt state bits
+                                           with atomic cmpxchg4      */
+#define OPTION_LOCKFREE_CS              /* CS, CDS, TS etc. without
+                                           mainlock if host cmpxchg
+                                           is atomic                 */
+#define OPTION_PLO_LOCKS             64 /* PLO locks selected by the
+                                           program lock token;
+                                           must be a power of 2      */
+#define OPTION_CMPSC_DICT_CACHE         /* Keep CMPSC dictionary work
+                                           between instructions      */
+#define OPTION_DECIMAL_BINARY           /* Packed decimal arithmetic
+                                           in binary integers        */
+#define OPTION_IDLE_WAIT                /* Per-CPU idle wait object
+                                           and IDLESPIN              */
+#define OPTION_TIMER_LATENCY            /* Timer interrupt latency
+                                           histogram (timerlat cmd)  */
+#define OPTION_PAGE_WALK_CACHE          /* Cache region and segment
+                                           table entries for DAT     */
 #define OPTION_IODELAY_KLUDGE           /* IODELAY kludge for linux  */
 #undef  OPTION_FOOTPRINT_BUFFER /* 2048 ** Size must be a power of 2 */
 #undef  OPTION_INSTRUCTION_COUNTING     /* First use trace and count */
@@ -58,6 +81,10 @@
   #error OPTION_MSGHLD requires OPTION_MSGCLR
 #endif // defined(OPTION_MSGHLD) && !defined(OPTION_MSGCLR)
 
+#if defined(OPTION_INSTRUCTION_FUSION) && !defined(OPTION_DECODE_CACHE)
+  #error OPTION_INSTRUCTION_FUSION requires OPTION_DECODE_CACHE
+#endif
+
 #if (CKD_MAXFILES > 35)
   #error CKD_MAXFILES can not exceed design limit of 35
 #endif
@@ -85,6 +112,9 @@
 #if defined(OPTION_900_MODE) && defined(NO_900_MODE)
   #undef    OPTION_900_MODE
 #endif
+#if defined(OPTION_DECIMAL_BINARY) && defined(NO_DECIMAL_BINARY)
+  #undef    OPTION_DECIMAL_BINARY
+#endif
 
 #undef FEATURE_4K_STORAGE_KEYS
 #undef FEATURE_2K_STORAGE_KEYS
@@ -402,6 +402,92 @@ typedef struct _EXTENDED_FLOAT {
 } EXTENDED_FLOAT;
 
 
+#if defined(OPTION_HFP_UINT128)
+/*-------------------------------------------------------------------*/
+/* 128 bit unsigned integer for fraction arithmetic                  */
+/*-------------------------------------------------------------------*/
+typedef __uint128_t U128;
+
+#define U128_OF(ms, ls) \
+    (((U128)(ms) << 64) | (ls))
+
+/*-------------------------------------------------------------------*/
+/* Divide a 192 bit window by a normalized 128 bit divisor giving    */
+/* one 64 bit quotient digit (Knuth, Algorithm D, step D3 - D6)      */
+/*                                                                   */
+/* Input:                                                            */
+/*      u       most significant 128 bit of window (less than d)     */
+/*      u0      least significant 64 bit of window                   */
+/*      d       divisor with the leftmost bit set                    */
+/*      rem     remainder                                            */
+/* Value:                                                            */
+/*              quotient digit                                       */
+/*-------------------------------------------------------------------*/
+static inline U64 div_digit_U192( U128 u, U64 u0, U128 d, U128 *rem )
+{
+U64     d1 = (U64)(d >> 64);
+U64     d0 = (U64)d;
+U64     qhat;
+U64     pl;
+U128    ph;
+U128    p;
+
+    /* estimate from the leading digits, at most 2 too large */
+    if ((U64)(u >> 64) >= d1)
+        qhat = 0xFFFFFFFFFFFFFFFFULL;
+    else
+        qhat = (U64)(u / d1);
+
+    /* qhat * d as 192 bits */
+    p = (U128)qhat * d0;
+    pl = (U64)p;
+    ph = (U128)qhat * d1 + (p >> 64);
+
+    /* correct the estimate */
+    while (ph > u || (ph == u && pl > u0)) {
+        qhat--;
+        ph -= (U128)d1 + (pl < d0);
+        pl -= d0;
+    }
+
+    /* the remainder fits in 128 bits */
+    *rem = U128_OF((U64)u - (U64)ph - (u0 < pl), u0 - pl);
+    return qhat;
+
+} /* end function div_digit_U192 */
+
+/*-------------------------------------------------------------------*/
+/* Divide 256 bit integer by 128 bit integer                         */
+/*                                                                   */
+/* Input:                                                            */
+/*      a       most significant 128 bit of dividend (less than d)   */
+/*      b       least significant 128 bit of dividend                */
+/*      d       divisor                                              */
+/* Value:                                                            */
+/*              128 bit quotient                                     */
+/*-------------------------------------------------------------------*/
+static inline U128 div_U256_U128( U128 a, U128 b, U128 d )
+{
+int     s;
+U128    r;
+U64     q1;
+
+    /* normalize the divisor */
+    s = (d >> 64) ? __builtin_clzll((U64)(d >> 64))
+                  : 64 + __builtin_clzll((U64)d);
+    if (s) {
+        a = (a << s) | (b >> (128 - s));
+        b <<= s;
+        d <<= s;
+    }
+
+    q1 = div_digit_U192(a, (U64)(b >> 64), d, &r);
+    return U128_OF(q1, div_digit_U192(r, (U64)b, d, &r));
+
+} /* end function div_U256_U128 */
+#endif /*defined(OPTION_HFP_UINT128)*/
+
+
 #endif /*!defined(_FLOAT_C)*/
 
 
@@ -659,6 +745,18 @@ U64     value;                          /* Operand value             */
 /*-------------------------------------------------------------------*/
 static inline void normal_sf( SHORT_FLOAT *fl )
 {
+#if defined(OPTION_HFP_UINT128)
+    if (fl->short_fract) {
+        /* count leading zero hex digits of the 24 bit fraction */
+        int n = (__builtin_clz(fl->short_fract) - 8) >> 2;
+
+        fl->short_fract <<= n * 4;
+        fl->expo -= n;
+    } else {
+        fl->sign = POS;
+        fl->expo = 0;
+    }
+#else /*!defined(OPTION_HFP_UINT128)*/
     if (fl->short_fract) {
         if ((fl->short_fract & 0x00FFFF00) == 0) {
             fl->short_fract <<= 16;
@@ -676,6 +774,7 @@ static inline void normal_sf( SHORT_FLOAT *fl )
         fl->sign = POS;
         fl->expo = 0;
     }
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
 } /* end function normal_sf */
 
@@ -688,6 +787,18 @@ static inline void normal_sf( SHORT_FLOAT *fl )
 /*-------------------------------------------------------------------*/
 static inline void normal_lf( LONG_FLOAT *fl )
 {
+#if defined(OPTION_HFP_UINT128)
+    if (fl->long_fract) {
+        /* count leading zero hex digits of the 56 bit fraction */
+        int n = (__builtin_clzll(fl->long_fract) - 8) >> 2;
+
+        fl->long_fract <<= n * 4;
+        fl->expo -= n;
+    } else {
+        fl->sign = POS;
+        fl->expo = 0;
+    }
+#else /*!defined(OPTION_HFP_UINT128)*/
     if (fl->long_fract) {
         if ((fl->long_fract & 0x00FFFFFFFF000000ULL) == 0) {
             fl->long_fract <<= 32;
@@ -709,6 +820,7 @@ static inline void normal_lf( LONG_FLOAT *fl )
         fl->sign = POS;
         fl->expo = 0;
     }
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
 } /* end function normal_lf */
 
@@ -721,6 +833,21 @@ static inline void normal_lf( LONG_FLOAT *fl )
 /*-------------------------------------------------------------------*/
 static inline void normal_ef( EXTENDED_FLOAT *fl )
 {
+#if defined(OPTION_HFP_UINT128)
+    if (fl->ms_fract || fl->ls_fract) {
+        /* count leading zero hex digits of the 112 bit fraction */
+        int n = fl->ms_fract ? (__builtin_clzll(fl->ms_fract) - 16) >> 2
+                             : (__builtin_clzll(fl->ls_fract) + 48) >> 2;
+        U128 f = U128_OF(fl->ms_fract, fl->ls_fract) << (n * 4);
+
+        fl->ms_fract = (U64)(f >> 64);
+        fl->ls_fract = (U64)f;
+        fl->expo -= n;
+    } else {
+        fl->sign = POS;
+        fl->expo = 0;
+    }
+#else /*!defined(OPTION_HFP_UINT128)*/
     if (fl->ms_fract || fl->ls_fract) {
         if (fl->ms_fract == 0) {
             fl->ms_fract = fl->ls_fract >> 16;
@@ -771,6 +898,7 @@ static inline void normal_ef( EXTENDED_FLOAT *fl )
         fl->sign = POS;
         fl->expo = 0;
     }
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
 } /* end function normal_ef */
 
@@ -2102,13 +2230,23 @@ static int mul_sf_to_lf( SHORT_FLOAT *fl, SHORT_FLOAT *mul_fl,
 static int mul_lf_to_ef( LONG_FLOAT *fl, LONG_FLOAT *mul_fl,
     EXTENDED_FLOAT *result_fl, REGS *regs )
 {
+#if defined(OPTION_HFP_UINT128)
+U128    p;
+#else /*!defined(OPTION_HFP_UINT128)*/
 U64     wk;
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
     if (fl->long_fract && mul_fl->long_fract) {
         /* normalize operands */
         normal_lf( fl );
         normal_lf( mul_fl );
 
+#if defined(OPTION_HFP_UINT128)
+        /* multiply fracts */
+        p = (U128)fl->long_fract * mul_fl->long_fract;
+        result_fl->ms_fract = (U64)(p >> 64);
+        result_fl->ls_fract = (U64)p;
+#else /*!defined(OPTION_HFP_UINT128)*/
         /* multiply fracts by sum of partial multiplications */
         wk = (fl->long_fract & 0x00000000FFFFFFFFULL) * (mul_fl->long_fract & 0x00000000FFFFFFFFULL);
         result_fl->ls_fract = wk & 0x00000000FFFFFFFFULL;
@@ -2119,6 +2257,7 @@ U64     wk;
         result_fl->ls_fract |= wk << 32;
 
         result_fl->ms_fract = (wk >> 32) + ((fl->long_fract >> 32) * (mul_fl->long_fract >> 32));
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
         /* normalize result and compute expo */
         if (result_fl->ms_fract & 0x0000F00000000000ULL) {
@@ -2219,14 +2358,31 @@ U64     wk;
 static int mul_lf( LONG_FLOAT *fl, LONG_FLOAT *mul_fl,
     BYTE ovunf, REGS *regs )
 {
+#if defined(OPTION_HFP_UINT128)
+U128    p;
+#else /*!defined(OPTION_HFP_UINT128)*/
 U64     wk;
 U32     v;
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
     if (fl->long_fract && mul_fl->long_fract) {
         /* normalize operands */
         normal_lf( fl );
         normal_lf( mul_fl );
 
+#if defined(OPTION_HFP_UINT128)
+        /* multiply fracts */
+        p = (U128)fl->long_fract * mul_fl->long_fract;
+
+        /* normalize result and compute expo */
+        if (p >> 108) {
+            fl->long_fract = (U64)(p >> 56);
+            fl->expo = fl->expo + mul_fl->expo - 64;
+        } else {
+            fl->long_fract = (U64)(p >> 52);
+            fl->expo = fl->expo + mul_fl->expo - 65;
+        }
+#else /*!defined(OPTION_HFP_UINT128)*/
         /* multiply fracts by sum of partial multiplications */
         wk = ((fl->long_fract & 0x00000000FFFFFFFFULL) * (mul_fl->long_fract & 0x00000000FFFFFFFFULL)) >> 32;
 
@@ -2246,6 +2402,7 @@ U32     v;
                            | (v >> 20);
             fl->expo = fl->expo + mul_fl->expo - 65;
         }
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
         /* determine sign */
         fl->sign = (fl->sign == mul_fl->sign) ? POS : NEG;
@@ -2281,6 +2438,11 @@ U32     v;
 static int mul_ef( EXTENDED_FLOAT *fl, EXTENDED_FLOAT *mul_fl,
     REGS *regs )
 {
+#if defined(OPTION_HFP_UINT128)
+U128 ll, lh, hl, hh;
+U128 t;
+U64  w1, w2, w3;
+#else /*!defined(OPTION_HFP_UINT128)*/
 U64 wk1;
 U64 wk2;
 U64 wk3;
@@ -2288,6 +2450,7 @@ U64 wk4;
 U64 wk;
 U32 wk0;
 U32 v;
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
     if ((fl->ms_fract || fl->ls_fract)
     && (mul_fl->ms_fract || mul_fl->ls_fract)) {
@@ -2295,6 +2458,31 @@ U32 v;
         normal_ef ( fl );
         normal_ef ( mul_fl );
 
+#if defined(OPTION_HFP_UINT128)
+        /* multiply fracts by sum of 64 bit partial multiplications, */
+        /* the low 64 bits of the 224 bit product are only carry     */
+        ll = (U128)fl->ls_fract * mul_fl->ls_fract;
+        lh = (U128)fl->ls_fract * mul_fl->ms_fract;
+        hl = (U128)fl->ms_fract * mul_fl->ls_fract;
+        hh = (U128)fl->ms_fract * mul_fl->ms_fract;
+
+        t  = (ll >> 64) + (U64)lh + (U64)hl;
+        w1 = (U64)t;
+        t  = (t >> 64) + (lh >> 64) + (hl >> 64) + (U64)hh;
+        w2 = (U64)t;
+        w3 = (U64)((t >> 64) + (hh >> 64));
+
+        /* normalize result and compute expo */
+        if (w3 & 0xF0000000UL) {
+            fl->ms_fract = (w3 << 16) | (w2 >> 48);
+            fl->ls_fract = (w2 << 16) | (w1 >> 48);
+            fl->expo = fl->expo + mul_fl->expo - 64;
+        } else {
+            fl->ms_fract = (w3 << 20) | (w2 >> 44);
+            fl->ls_fract = (w2 << 20) | (w1 >> 44);
+            fl->expo = fl->expo + mul_fl->expo - 65;
+        }
+#else /*!defined(OPTION_HFP_UINT128)*/
         /* multiply fracts by sum of partial multiplications */
         wk0 = ((fl->ls_fract & 0x00000000FFFFFFFFULL) * (mul_fl->ls_fract & 0x00000000FFFFFFFFULL)) >> 32;
 
@@ -2347,6 +2535,7 @@ U32 v;
                          | (v >> 12);
             fl->expo = fl->expo + mul_fl->expo - 65;
         }
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
         /* determine sign */
         fl->sign = (fl->sign == mul_fl->sign) ? POS : NEG;
@@ -2431,9 +2620,11 @@ U64     wk;
 /*-------------------------------------------------------------------*/
 static int div_lf( LONG_FLOAT *fl, LONG_FLOAT *div_fl, REGS *regs )
 {
+#if !defined(OPTION_HFP_UINT128)
 U64     wk;
 U64     wk2;
 int     i;
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
     if (div_fl->long_fract) {
         if (fl->long_fract) {
@@ -2449,6 +2640,11 @@ int     i;
                 div_fl->long_fract <<= 4;
             }
 
+#if defined(OPTION_HFP_UINT128)
+            /* divide fractions giving 14 hex digits */
+            fl->long_fract = (U64)(((U128)fl->long_fract << 56)
+                                   / div_fl->long_fract);
+#else /*!defined(OPTION_HFP_UINT128)*/
             /* partial divide first hex digit */
             wk2 = fl->long_fract / div_fl->long_fract;
             wk = (fl->long_fract % div_fl->long_fract) << 4;
@@ -2464,6 +2660,7 @@ int     i;
             /* partial divide last hex digit */
             fl->long_fract = (wk2 << 4)
                            | (wk / div_fl->long_fract);
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
             /* determine sign */
             fl->sign = (fl->sign == div_fl->sign) ? POS : NEG;
@@ -2500,9 +2697,13 @@ int     i;
 static int div_ef( EXTENDED_FLOAT *fl, EXTENDED_FLOAT *div_fl,
     REGS *regs )
 {
+#if defined(OPTION_HFP_UINT128)
+U128    a, d, q;
+#else /*!defined(OPTION_HFP_UINT128)*/
 U64     wkm;
 U64     wkl;
 int     i;
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
     if (div_fl->ms_fract || div_fl->ls_fract) {
         if (fl->ms_fract || fl->ls_fract) {
@@ -2522,6 +2723,14 @@ int     i;
                 div_fl->ls_fract <<= 4;
             }
 
+#if defined(OPTION_HFP_UINT128)
+            /* divide fractions giving 112 binary digits */
+            a = U128_OF(fl->ms_fract, fl->ls_fract);
+            d = U128_OF(div_fl->ms_fract, div_fl->ls_fract);
+            q = div_U256_U128(a, 0, d) >> 16;
+            fl->ms_fract = (U64)(q >> 64);
+            fl->ls_fract = (U64)q;
+#else /*!defined(OPTION_HFP_UINT128)*/
             /* divide fractions */
 
             /* the first binary digit */
@@ -2565,6 +2774,7 @@ int     i;
             if (((S64)wkm) >= 0) {
                 fl->ls_fract |= 1;
             }
+#endif /*!defined(OPTION_HFP_UINT128)*/
 
             /* determine sign */
             fl->sign = (fl->sign == div_fl->sign) ? POS : NEG;
@@ -2900,6 +3110,14 @@ static U64 div_U128( U64 msa, U64 lsa, U64 div )
 U64     q;
 int     i;
 
+#if defined(OPTION_HFP_UINT128)
+    /* The quotient fits in 64 bits unless a square root iteration  */
+    /* has not converged; the bitwise division handles that case    */
+    /* without a host divide exception                              */
+    if (msa < div)
+        return (U64)(U128_OF(msa, lsa) / div);
+#endif /*defined(OPTION_HFP_UINT128)*/
+
     /* the first binary digit */
     msa -= div;
     shift_left_U128(msa, lsa);
@@ -3089,6 +3307,19 @@ static void div_U256( U64 mmsa, U64 msa, U64 lsa, U64 llsa, U64 msd,
     U64 lsd, U64 *msq, U64 *lsq )
 {
 int     i;
+#if defined(OPTION_HFP_UINT128)
+U128    q;
+
+    /* The quotient fits in 128 bits unless a square root iteration */
+    /* has not converged; the bitwise division handles that case    */
+    if (U128_OF(mmsa, msa) < U128_OF(msd, lsd)) {
+        q = div_U256_U128(U128_OF(mmsa, msa), U128_OF(lsa, llsa),
+                          U128_OF(msd, lsd));
+        *msq = (U64)(q >> 64);
+        *lsq = (U64)q;
+        return;
+    }
+#endif /*defined(OPTION_HFP_UINT128)*/
 
     /* the first binary digit */
     sub_U128(mmsa, msa, msd, lsd);
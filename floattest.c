@@ -0,0 +1,384 @@
+/* FLOATTEST.C  Hexadecimal floating point differential test         */
+
+/*-------------------------------------------------------------------*/
+/* This program checks the hexadecimal floating point instructions   */
+/* built with OPTION_HFP_UINT128 against the 64 bit fraction         */
+/* arithmetic they replace.  The z/Architecture register to register */
+/* instructions in the Hercules engine are executed side by side     */
+/* with a second copy of float.c that is compiled below without      */
+/* OPTION_HFP_UINT128, on random operands with random register       */
+/* numbers and program masks.  The floating point registers,         */
+/* condition code, program interruption code and data exception code */
+/* must be identical.                                                */
+/*                                                                   */
+/* Usage: floattest [count [seed]]                                   */
+/*                                                                   */
+/* Any difference is displayed; the return code is the number of     */
+/* differences found, up to 255.                                     */
+/*-------------------------------------------------------------------*/
+
+#include "hstdinc.h"
+
+#define _GEN_ARCH 900                   /* z/Architecture only       */
+#define _ONE_ARCH_                      /* No other instfetch        */
+
+#include "hercules.h"
+
+#include "opcode.h"
+
+#if defined(OPTION_HFP_UINT128)
+
+/*-------------------------------------------------------------------*/
+/* Reference copy of the hexadecimal floating point instructions     */
+/*-------------------------------------------------------------------*/
+/* hostopts.h is not included again, so the option stays undefined   */
+/* for the copy of float.c below.  The instructions which are not    */
+/* tested keep their z900_ names; nothing in this program calls them.*/
+#undef  OPTION_HFP_UINT128
+#define z900_add_float_ext_reg                 ref_add_float_ext_reg
+#define z900_add_float_long_reg                ref_add_float_long_reg
+#define z900_add_float_short_reg               ref_add_float_short_reg
+#define z900_add_unnormal_float_long_reg       ref_add_unnormal_float_long_reg
+#define z900_add_unnormal_float_short_reg      ref_add_unnormal_float_short_reg
+#define z900_compare_float_ext_reg             ref_compare_float_ext_reg
+#define z900_compare_float_long_reg            ref_compare_float_long_reg
+#define z900_compare_float_short_reg           ref_compare_float_short_reg
+#define z900_divide_float_ext_reg              ref_divide_float_ext_reg
+#define z900_divide_float_long_reg             ref_divide_float_long_reg
+#define z900_divide_float_short_reg            ref_divide_float_short_reg
+#define z900_halve_float_long_reg              ref_halve_float_long_reg
+#define z900_halve_float_short_reg             ref_halve_float_short_reg
+#define z900_load_rounded_float_long_reg       ref_load_rounded_float_long_reg
+#define z900_load_rounded_float_short_reg      ref_load_rounded_float_short_reg
+#define z900_multiply_add_float_long_reg       ref_multiply_add_float_long_reg
+#define z900_multiply_add_float_short_reg      ref_multiply_add_float_short_reg
+#define z900_multiply_float_ext_reg            ref_multiply_float_ext_reg
+#define z900_multiply_float_long_reg           ref_multiply_float_long_reg
+#define z900_multiply_float_long_to_ext_reg    ref_multiply_float_long_to_ext_reg
+#define z900_multiply_float_short_reg          ref_multiply_float_short_reg
+#define z900_multiply_float_short_to_long_reg  ref_multiply_float_short_to_long_reg
+#define z900_multiply_subtract_float_long_reg  ref_multiply_subtract_float_long_reg
+#define z900_multiply_subtract_float_short_reg ref_multiply_subtract_float_short_reg
+#define z900_squareroot_float_ext_reg          ref_squareroot_float_ext_reg
+#define z900_squareroot_float_long_reg         ref_squareroot_float_long_reg
+#define z900_squareroot_float_short_reg        ref_squareroot_float_short_reg
+#define z900_subtract_float_ext_reg            ref_subtract_float_ext_reg
+#define z900_subtract_float_long_reg           ref_subtract_float_long_reg
+#define z900_subtract_float_short_reg          ref_subtract_float_short_reg
+#define z900_subtract_unnormal_float_long_reg  ref_subtract_unnormal_float_long_reg
+#define z900_subtract_unnormal_float_short_reg ref_subtract_unnormal_float_short_reg
+
+#include "float.c"
+
+#undef  z900_add_float_ext_reg
+#undef  z900_add_float_long_reg
+#undef  z900_add_float_short_reg
+#undef  z900_add_unnormal_float_long_reg
+#undef  z900_add_unnormal_float_short_reg
+#undef  z900_compare_float_ext_reg
+#undef  z900_compare_float_long_reg
+#undef  z900_compare_float_short_reg
+#undef  z900_divide_float_ext_reg
+#undef  z900_divide_float_long_reg
+#undef  z900_divide_float_short_reg
+#undef  z900_halve_float_long_reg
+#undef  z900_halve_float_short_reg
+#undef  z900_load_rounded_float_long_reg
+#undef  z900_load_rounded_float_short_reg
+#undef  z900_multiply_add_float_long_reg
+#undef  z900_multiply_add_float_short_reg
+#undef  z900_multiply_float_ext_reg
+#undef  z900_multiply_float_long_reg
+#undef  z900_multiply_float_long_to_ext_reg
+#undef  z900_multiply_float_short_reg
+#undef  z900_multiply_float_short_to_long_reg
+#undef  z900_multiply_subtract_float_long_reg
+#undef  z900_multiply_subtract_float_short_reg
+#undef  z900_squareroot_float_ext_reg
+#undef  z900_squareroot_float_long_reg
+#undef  z900_squareroot_float_short_reg
+#undef  z900_subtract_float_ext_reg
+#undef  z900_subtract_float_long_reg
+#undef  z900_subtract_float_short_reg
+#undef  z900_subtract_unnormal_float_long_reg
+#undef  z900_subtract_unnormal_float_short_reg
+
+/*-------------------------------------------------------------------*/
+/* Instructions under test                                           */
+/*-------------------------------------------------------------------*/
+#define FMT_RR          0               /* R1,R2 in second byte      */
+#define FMT_RRE         1               /* R1,R2 in fourth byte      */
+#define FMT_RRF         2               /* R1 in third byte, R3,R2   */
+
+typedef void (*INSTFN) (BYTE inst[], REGS *regs);
+
+typedef struct _FLOATTEST {             /* Instruction under test    */
+        char   *name;                   /* Mnemonic                  */
+        BYTE    opcode[2];              /* Operation code            */
+        int     format;                 /* Instruction format        */
+        int     ext;                    /* 1=Extended operands       */
+        INSTFN  uint128;                /* Hercules engine routine   */
+        INSTFN  uint64;                 /* Reference routine         */
+    } FLOATTEST;
+
+#define FLOATTEST(_name, _op0, _op1, _fmt, _ext, _inst) \
+        { _name, { _op0, _op1 }, _fmt, _ext, z900_ ## _inst, ref_ ## _inst }
+
+static FLOATTEST floattests[] = {
+    FLOATTEST("HDR",  0x24, 0x00, FMT_RR,  0, halve_float_long_reg),
+    FLOATTEST("LDXR", 0x25, 0x00, FMT_RR,  1, load_rounded_float_long_reg),
+    FLOATTEST("MXR",  0x26, 0x00, FMT_RR,  1, multiply_float_ext_reg),
+    FLOATTEST("MXDR", 0x27, 0x00, FMT_RR,  1, multiply_float_long_to_ext_reg),
+    FLOATTEST("CDR",  0x29, 0x00, FMT_RR,  0, compare_float_long_reg),
+    FLOATTEST("ADR",  0x2A, 0x00, FMT_RR,  0, add_float_long_reg),
+    FLOATTEST("SDR",  0x2B, 0x00, FMT_RR,  0, subtract_float_long_reg),
+    FLOATTEST("MDR",  0x2C, 0x00, FMT_RR,  0, multiply_float_long_reg),
+    FLOATTEST("DDR",  0x2D, 0x00, FMT_RR,  0, divide_float_long_reg),
+    FLOATTEST("AWR",  0x2E, 0x00, FMT_RR,  0, add_unnormal_float_long_reg),
+    FLOATTEST("SWR",  0x2F, 0x00, FMT_RR,  0, subtract_unnormal_float_long_reg),
+    FLOATTEST("HER",  0x34, 0x00, FMT_RR,  0, halve_float_short_reg),
+    FLOATTEST("LEDR", 0x35, 0x00, FMT_RR,  0, load_rounded_float_short_reg),
+    FLOATTEST("AXR",  0x36, 0x00, FMT_RR,  1, add_float_ext_reg),
+    FLOATTEST("SXR",  0x37, 0x00, FMT_RR,  1, subtract_float_ext_reg),
+    FLOATTEST("CER",  0x39, 0x00, FMT_RR,  0, compare_float_short_reg),
+    FLOATTEST("AER",  0x3A, 0x00, FMT_RR,  0, add_float_short_reg),
+    FLOATTEST("SER",  0x3B, 0x00, FMT_RR,  0, subtract_float_short_reg),
+    FLOATTEST("MDER", 0x3C, 0x00, FMT_RR,  0, multiply_float_short_to_long_reg),
+    FLOATTEST("DER",  0x3D, 0x00, FMT_RR,  0, divide_float_short_reg),
+    FLOATTEST("AUR",  0x3E, 0x00, FMT_RR,  0, add_unnormal_float_short_reg),
+    FLOATTEST("SUR",  0x3F, 0x00, FMT_RR,  0, subtract_unnormal_float_short_reg),
+    FLOATTEST("DXR",  0xB2, 0x2D, FMT_RRE, 1, divide_float_ext_reg),
+    FLOATTEST("SQDR", 0xB2, 0x44, FMT_RRE, 0, squareroot_float_long_reg),
+    FLOATTEST("SQER", 0xB2, 0x45, FMT_RRE, 0, squareroot_float_short_reg),
+    FLOATTEST("MAER", 0xB3, 0x2E, FMT_RRF, 0, multiply_add_float_short_reg),
+    FLOATTEST("MSER", 0xB3, 0x2F, FMT_RRF, 0, multiply_subtract_float_short_reg),
+    FLOATTEST("SQXR", 0xB3, 0x36, FMT_RRE, 1, squareroot_float_ext_reg),
+    FLOATTEST("MEER", 0xB3, 0x37, FMT_RRE, 0, multiply_float_short_reg),
+    FLOATTEST("MADR", 0xB3, 0x3E, FMT_RRF, 0, multiply_add_float_long_reg),
+    FLOATTEST("MSDR", 0xB3, 0x3F, FMT_RRF, 0, multiply_subtract_float_long_reg),
+    FLOATTEST("CXR",  0xB3, 0x69, FMT_RRE, 1, compare_float_ext_reg),
+    };
+
+#define FLOATTESTS (int)(sizeof(floattests) / sizeof(floattests[0]))
+
+/* Register numbers of the extended floating point register pairs    */
+static const int extreg[] = { 0, 1, 4, 5, 8, 9, 12, 13 };
+
+/*-------------------------------------------------------------------*/
+/* Initialize a ghost CPU with the AFP registers enabled             */
+/*-------------------------------------------------------------------*/
+static REGS *test_regs (void)
+{
+REGS   *regs;                           /* -> CPU register context   */
+
+    regs = calloc (1, sizeof(REGS));
+    if (regs == NULL) return NULL;
+    regs->sysblk = &sysblk;
+    regs->arch_mode = ARCH_900;
+    regs->ghostregs = 1;
+    regs->hostregs = regs;
+    regs->CR(0) = CR0_AFP;
+    regs->psw.amode64 = regs->psw.amode = 1;
+    regs->psw.AMASK = AMASK64;
+    regs->program_interrupt = &z900_program_interrupt;
+    return regs;
+}
+
+/*-------------------------------------------------------------------*/
+/* Execute an instruction, returning the program interruption code   */
+/*-------------------------------------------------------------------*/
+static int test_exec (INSTFN fn, BYTE *inst, REGS *regs)
+{
+int     pcode;                          /* Program interruption code */
+
+    regs->dxc = 0;
+    regs->ip = inst;
+    if ((pcode = setjmp (regs->progjmp)) == 0)
+        fn (inst, regs);
+    return pcode;
+}
+
+/*-------------------------------------------------------------------*/
+/* Random numbers                                                    */
+/*-------------------------------------------------------------------*/
+static U32 rand32 (void)
+{
+    return ((U32)rand() << 16) ^ (U32)rand();
+}
+
+static U64 rand64 (void)
+{
+    return ((U64)rand32() << 32) | rand32();
+}
+
+/*-------------------------------------------------------------------*/
+/* Return a random long HFP operand                                  */
+/*-------------------------------------------------------------------*/
+static U64 test_hfp (void)
+{
+U64     sign;                           /* Sign bit                  */
+U64     exp;                            /* Characteristic            */
+U64     frac;                           /* Fraction                  */
+
+    sign = rand64() & 0x8000000000000000ULL;
+    frac = rand64() & 0x00FFFFFFFFFFFFFFULL;
+
+    /* Favour characteristics which overflow or underflow */
+    switch (rand() % 8) {
+    case 0:  exp = rand() % 4; break;
+    case 1:  exp = 0x7C + rand() % 4; break;
+    default: exp = 0x40 - 8 + rand() % 17; break;
+    }
+
+    /* Mostly normalized fractions, sometimes unnormalized, short,
+       or zero fractions, or a true zero */
+    switch (rand() % 16) {
+    case 0:  frac = 0; break;
+    case 1:  return sign;
+    case 2:  frac >>= 4 * (1 + rand() % 13); break;
+    case 3:  frac &= 0x00FFFFFF00000000ULL; break;
+    case 4:  frac |= 0x00FFFFFFFFFFFF00ULL; break;
+    default: if ((frac >> 52) == 0) frac |= 0x0010000000000000ULL;
+             break;
+    }
+    return sign | (exp << 56) | frac;
+}
+
+/*-------------------------------------------------------------------*/
+/* Load a floating point register from a 64 bit value                */
+/*-------------------------------------------------------------------*/
+static void test_setfpr (REGS *regs, int r, U64 v)
+{
+    regs->fpr[FPR2I(r)] = (U32)(v >> 32);
+    regs->fpr[FPR2I(r) + 1] = (U32)v;
+}
+
+/*-------------------------------------------------------------------*/
+/* Display the floating point registers                              */
+/*-------------------------------------------------------------------*/
+static void test_dump (char *label, U32 *fpr)
+{
+int     r;                              /* Register number           */
+
+    printf ("  %-8s", label);
+    for (r = 0; r < 16; r++)
+    {
+        if (r == 8) printf ("\n          ");
+        printf ("%8.8X%8.8X ", fpr[FPR2I(r)], fpr[FPR2I(r) + 1]);
+    }
+    printf ("\n");
+}
+
+/*-------------------------------------------------------------------*/
+/* FLOATTEST main entry point                                        */
+/*-------------------------------------------------------------------*/
+int main (int argc, char *argv[])
+{
+REGS   *regs1, *regs2;                  /* 128 bit and reference CPUs*/
+FLOATTEST *t;                           /* -> Instruction under test */
+BYTE    inst[4];                        /* Instruction               */
+U32     init[32];                       /* Initial FP registers      */
+int     count = 1000000;                /* Number of tests           */
+int     seed = 1;                       /* Random number seed        */
+int     errors = 0;                     /* Number of differences     */
+int     pcode1, pcode2;                 /* Program interruption codes*/
+int     r1, r2, r3;                     /* Register numbers          */
+int     r;                              /* Register number           */
+int     i;                              /* Test number               */
+
+    if (argc > 1) count = atoi (argv[1]);
+    if (argc > 2) seed = atoi (argv[2]);
+    srand (seed);
+
+    regs1 = test_regs ();
+    regs2 = test_regs ();
+    if (regs1 == NULL || regs2 == NULL)
+    {
+        fprintf (stderr, "floattest: calloc failed\n");
+        return 255;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        t = &floattests[rand() % FLOATTESTS];
+
+        /* Choose the registers; extended operands are mostly in
+           valid register pairs */
+        if (t->ext && rand() % 32)
+        {
+            r1 = extreg[rand() % 8];
+            r2 = extreg[rand() % 8];
+        }
+        else
+        {
+            r1 = rand() % 16;
+            r2 = rand() % 16;
+        }
+        r3 = rand() % 16;
+
+        /* Load the registers; the second operand is sometimes close
+           to the first one, to exercise cancellation */
+        for (r = 0; r < 16; r++)
+            test_setfpr (regs1, r, test_hfp());
+        if (rand() % 4 == 0)
+            test_setfpr (regs1, r2,
+                (((U64)regs1->fpr[FPR2I(r1)] << 32)
+                  | regs1->fpr[FPR2I(r1) + 1])
+                  ^ (rand64() & 0x80000000000000FFULL));
+        memcpy (init, regs1->fpr, sizeof(init));
+        memcpy (regs2->fpr, init, sizeof(init));
+
+        /* Build the instruction */
+        inst[0] = t->opcode[0];
+        inst[1] = t->opcode[1];
+        switch (t->format) {
+        case FMT_RR:
+            inst[1] = (r1 << 4) | r2;
+            break;
+        case FMT_RRE:
+            inst[2] = 0;
+            inst[3] = (r1 << 4) | r2;
+            break;
+        default:
+            inst[2] = r1 << 4;
+            inst[3] = (r3 << 4) | r2;
+            break;
+        }
+
+        regs1->psw.progmask = regs2->psw.progmask = rand() & PSW_PROGMASK;
+        regs1->psw.cc = regs2->psw.cc = 0;
+
+        pcode1 = test_exec (t->uint128, inst, regs1);
+        pcode2 = test_exec (t->uint64, inst, regs2);
+
+        if (pcode1 == pcode2
+         && regs1->psw.cc == regs2->psw.cc
+         && regs1->dxc == regs2->dxc
+         && memcmp (regs1->fpr, regs2->fpr, sizeof(init)) == 0)
+            continue;
+
+        printf ("Test %d: %s R1=%d R2=%d R3=%d\n", i, t->name, r1, r2, r3);
+        test_dump ("before", init);
+        test_dump ("uint128", regs1->fpr);
+        test_dump ("uint64", regs2->fpr);
+        printf ("  cc=%d/%d pgm=%4.4X/%4.4X dxc=%2.2X/%2.2X\n",
+                regs1->psw.cc, regs2->psw.cc, pcode1, pcode2,
+                regs1->dxc, regs2->dxc);
+        if (++errors >= 255) break;
+    }
+
+    printf ("floattest: %d tests, %d differences\n", i, errors);
+    return errors;
+}
+
+#else /*!defined(OPTION_HFP_UINT128)*/
+
+int main (int argc, char *argv[])
+{
+    UNREFERENCED(argc);
+    UNREFERENCED(argv);
+    printf ("floattest: OPTION_HFP_UINT128 is not defined\n");
+    return 0;
+}
+
+#endif /*!defined(OPTION_HFP_UINT128)*/
@@ -43,6 +43,11 @@
 #include "opcode.h"
 #include "inline.h"
 #include "clock.h"
+#include "hsimd.h"
+
+/* Number of bytes that MVCLE, CLCLE and CKSM process before they end
+   with condition code 3 for the program to branch back to them      */
+#define LONG_CPU_DETERMINED     65536
 
 
 /*-------------------------------------------------------------------*/
@@ -955,9 +960,11 @@ int     r1, r2;                         /* Values of R fields        */
 VADR    addr2;                          /* Address of second operand */
 GREG    len;                            /* Operand length            */
 int     i, j;                           /* Loop counters             */
+int     n;                              /* Bytes summed in this unit */
 int     cc = 0;                         /* Condition code            */
-U32     n;                              /* Word loaded from operand  */
+U32     w;                              /* Word loaded from operand  */
 U64     dreg;                           /* Checksum accumulator      */
+BYTE   *main2;                          /* Second operand mainstor   */
 
     RRE(inst, regs, r1, r2);
 
@@ -970,49 +977,66 @@ U64     dreg;                           /* Checksum accumulator      */
     /* Initialize the checksum from the first operand register */
     dreg = regs->GR_L(r1);
 
-    /* Process each fullword of second operand */
-    for ( i = 0; len > 0 ; i++ )
+    /* Process the second operand a page at a time until the CPU
+       determined number of bytes have been summed or an interrupt
+       is pending */
+    for (i = 0; len > 0 ; i += n)
     {
-        /* If 1024 words have been processed, exit with cc=3 */
-        if ( i >= 1024 )
+        if (i >= LONG_CPU_DETERMINED || (i > 0 && INTERRUPT_PENDING(regs)))
         {
             cc = 3;
             break;
         }
 
-        /* Fetch fullword from second operand */
-        if (len >= 4)
+        /* Sum the fullwords which lie within the current page */
+        n = PAGEFRAME_PAGESIZE - (addr2 & PAGEFRAME_BYTEMASK);
+        if ((GREG)n > len)
+            n = len;
+        n &= ~3;
+
+        if (n > 0)
         {
-            n = ARCH_DEP(vfetch4) ( addr2, r2, regs );
-            addr2 += 4;
+            main2 = MADDR (addr2, r2, regs, ACCTYPE_READ, regs->psw.pkey);
+            dreg += hsimd_cksm (main2, n / 4);
+            addr2 += n;
             addr2 &= ADDRESS_MAXWRAP(regs);
-            len -= 4;
+            len -= n;
         }
         else
         {
-            /* Fetch final 1, 2, or 3 bytes and pad with zeroes */
-            for (j = 0, n = 0; j < 4; j++)
+            /* Fetch a fullword which crosses a page boundary */
+            if (len >= 4)
+            {
+                dreg += ARCH_DEP(vfetch4) ( addr2, r2, regs );
+                addr2 += 4;
+                addr2 &= ADDRESS_MAXWRAP(regs);
+                len -= 4;
+            }
+            else
             {
-                n <<= 8;
-                if (len > 0)
+                /* Fetch final 1, 2, or 3 bytes and pad with zeroes */
+                for (j = 0, w = 0; j < 4; j++)
                 {
-                    n |= ARCH_DEP(vfetchb) ( addr2, r2, regs );
-                    addr2++;
-                    addr2 &= ADDRESS_MAXWRAP(regs);
-                    len--;
-                }
-            } /* end for(j) */
+                    w <<= 8;
+                    if (len > 0)
+                    {
+                        w |= ARCH_DEP(vfetchb) ( addr2, r2, regs );
+                        addr2++;
+                        addr2 &= ADDRESS_MAXWRAP(regs);
+                        len--;
+                    }
+                } /* end for(j) */
+                dreg += w;
+            }
+            n = 4;
         }
 
-        /* Accumulate the fullword into the checksum */
-        dreg += n;
+        /* Carry 32 bit overflow into bit 31.  The end around carry
+           of a sum of fullwords is the same whether it is added
+           after each fullword or folded in afterwards */
+        while (dreg > 0xFFFFFFFFULL)
+            dreg = (dreg & 0xFFFFFFFFULL) + (dreg >> 32);
 
-        /* Carry 32 bit overflow into bit 31 */
-        if (dreg > 0xFFFFFFFFULL)
-        {
-            dreg &= 0xFFFFFFFFULL;
-            dreg++;
-        }
     } /* end for(i) */
 
     /* Load the updated checksum into the R1 register */
@@ -1250,13 +1274,13 @@ U32     old;                            /* old value                 */
     old = CSWAP32(regs->GR_L(r1));
 
     /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
+    OBTAIN_MAINLOCK_CAS(regs);
 
     /* Attempt to exchange the values */
     regs->psw.cc = cmpxchg4 (&old, CSWAP32(regs->GR_L(r3)), main2);
 
     /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
+    RELEASE_MAINLOCK_CAS(regs);
 
     /* Perform serialization after completing operation */
     PERFORM_SERIALIZATION (regs);
@@ -1314,13 +1338,13 @@ U64     old, new;                       /* old, new values           */
     new = CSWAP64(((U64)(regs->GR_L(r3)) << 32) | regs->GR_L(r3+1));
 
     /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
+    OBTAIN_MAINLOCK_CAS(regs);
 
     /* Attempt to exchange the values */
     regs->psw.cc = cmpxchg8 (&old, new, main2);
 
     /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
+    RELEASE_MAINLOCK_CAS(regs);
 
     /* Perform serialization after completing operation */
     PERFORM_SERIALIZATION (regs);
@@ -1910,7 +1934,7 @@ int     r1, r2;                         /* Values of R fields        */
 int     cc = 0;                         /* Condition code            */
 VADR    addr1, addr2;                   /* Operand addresses         */
 U32     len1, len2;                     /* Operand lengths           */
-BYTE    byte1, byte2;                   /* Operand bytes             */
+int     len;                            /* Equal bytes in this unit  */
 BYTE    pad;                            /* Padding byte              */
 
     RR(inst, regs, r1, r2);
@@ -1928,52 +1952,47 @@ BYTE    pad;                            /* Padding byte              */
     len1 = regs->GR_LA24(r1+1);
     len2 = regs->GR_LA24(r2+1);
 
-    /* Process operands from left to right */
+    /* Process operands from left to right, a page at a time */
     while (len1 > 0 || len2 > 0)
     {
-        /* Fetch a byte from each operand, or use padding byte */
-        byte1 = (len1 > 0) ? ARCH_DEP(vfetchb) (addr1, r1, regs) : pad;
-        byte2 = (len2 > 0) ? ARCH_DEP(vfetchb) (addr2, r2, regs) : pad;
-
-        /* Compare operand bytes, set condition code if unequal */
-        if (byte1 != byte2)
-        {
-            cc = (byte1 < byte2) ? 1 : 2;
-            break;
-        } /* end if */
+        /* Compare up to the next page boundary of either operand */
+        len = ARCH_DEP(compare_long_unit) (addr1, r1, len1,
+                                           addr2, r2, len2,
+                                           pad, &cc, regs);
 
         /* Update the first operand address and length */
         if (len1 > 0)
         {
-            addr1++;
+            addr1 += len;
             addr1 &= ADDRESS_MAXWRAP(regs);
-            len1--;
+            len1 -= len;
         }
 
         /* Update the second operand address and length */
         if (len2 > 0)
         {
-            addr2++;
+            addr2 += len;
             addr2 &= ADDRESS_MAXWRAP(regs);
-            len2--;
+            len2 -= len;
         }
 
-        /* Update Regs if cross half page - may get access rupt */
-        if ((addr1 & 0x7ff) == 0 || (addr2 & 0x7ff) == 0)
-        {
-            SET_GR_A(r1, regs, addr1);
-            SET_GR_A(r2, regs, addr2);
+        /* Update Regs at the end of the unit - may get access rupt */
+        SET_GR_A(r1, regs, addr1);
+        SET_GR_A(r2, regs, addr2);
 
-            regs->GR_LA24(r1+1) = len1;
-            regs->GR_LA24(r2+1) = len2;
-        }
+        regs->GR_LA24(r1+1) = len1;
+        regs->GR_LA24(r2+1) = len2;
+
+        /* Exit if an unequal byte was found */
+        if (cc)
+            break;
 
         /* The instruction can be interrupted when a CPU determined
            number of bytes have been processed.  The instruction
            address will be backed up, and the instruction will
            be re-executed.  This is consistent with operation
            under a hypervisor such as LPAR or VM.                *JJ */
-        if ((len1 + len2 > 255) && !((addr1 - len2) & 0xFFF))
+        if ((len1 + len2 > 255) && INTERRUPT_PENDING(regs))
         {
             UPD_PSW_IA (regs, PSW_IA(regs, -REAL_ILC(regs)));
             break;
@@ -2002,11 +2021,11 @@ DEF_INST(compare_logical_long_extended)
 int     r1, r3;                         /* Register numbers          */
 int     b2;                             /* effective address base    */
 VADR    effective_addr2;                /* effective address         */
-int     i;                              /* Loop counter              */
+int     i;                              /* Bytes compared            */
+int     len;                            /* Equal bytes in this unit  */
 int     cc = 0;                         /* Condition code            */
 VADR    addr1, addr2;                   /* Operand addresses         */
 GREG    len1, len2;                     /* Operand lengths           */
-BYTE    byte1, byte2;                   /* Operand bytes             */
 BYTE    pad;                            /* Padding byte              */
 
     RS(inst, regs, r1, r3, b2, effective_addr2);
@@ -2024,43 +2043,42 @@ BYTE    pad;                            /* Padding byte              */
     len1 = GR_A(r1+1, regs);
     len2 = GR_A(r3+1, regs);
 
-    /* Process operands from left to right */
-    for (i = 0; len1 > 0 || len2 > 0 ; i++)
+    /* Process operands from left to right, a page at a time */
+    for (i = 0; len1 > 0 || len2 > 0; i += len)
     {
-        /* If 4096 bytes have been compared, exit with cc=3 */
-        if (i >= 4096)
+        /* If the CPU determined number of bytes have been compared,
+           or an interrupt is pending, exit with cc=3 */
+        if (i >= LONG_CPU_DETERMINED || (i > 0 && INTERRUPT_PENDING(regs)))
         {
             cc = 3;
             break;
         }
 
-        /* Fetch a byte from each operand, or use padding byte */
-        byte1 = (len1 > 0) ? ARCH_DEP(vfetchb) (addr1, r1, regs) : pad;
-        byte2 = (len2 > 0) ? ARCH_DEP(vfetchb) (addr2, r3, regs) : pad;
-
-        /* Compare operand bytes, set condition code if unequal */
-        if (byte1 != byte2)
-        {
-            cc = (byte1 < byte2) ? 1 : 2;
-            break;
-        } /* end if */
+        /* Compare up to the next page boundary of either operand */
+        len = ARCH_DEP(compare_long_unit) (addr1, r1, len1,
+                                           addr2, r3, len2,
+                                           pad, &cc, regs);
 
         /* Update the first operand address and length */
         if (len1 > 0)
         {
-            addr1++;
+            addr1 += len;
             addr1 &= ADDRESS_MAXWRAP(regs);
-            len1--;
+            len1 -= len;
         }
 
         /* Update the second operand address and length */
         if (len2 > 0)
         {
-            addr2++;
+            addr2 += len;
             addr2 &= ADDRESS_MAXWRAP(regs);
-            len2--;
+            len2 -= len;
         }
 
+        /* Exit if an unequal byte was found */
+        if (cc)
+            break;
+
     } /* end for(i) */
 
     /* Update the registers */
@@ -2165,8 +2183,10 @@ DEF_INST(compare_until_substring_equal)
 {
 int     r1, r2;                         /* Values of R fields        */
 int     i;                              /* Loop counter              */
+int     j, k, m, n;                     /* Unit offsets and lengths  */
 int     cc = 0;                         /* Condition code            */
 VADR    addr1, addr2;                   /* Operand addresses         */
+BYTE   *main1, *main2;                  /* Operand mainstor addresses*/
 BYTE    byte1, byte2;                   /* Operand bytes             */
 BYTE    pad;                            /* Padding byte              */
 BYTE    sublen;                         /* Substring length          */
@@ -2238,7 +2258,7 @@ S32     remlen1, remlen2;               /* Lengths remaining         */
     }
 
     /* Process operands from left to right */
-    for (i = 0; len1 > 0 || len2 > 0 ; i++)
+    for (i = 0; len1 > 0 || len2 > 0 ; )
     {
 
         /* If 4096 bytes have been compared, and the last bytes
@@ -2249,60 +2269,136 @@ S32     remlen1, remlen2;               /* Lengths remaining         */
             break;
         }
 
-        /* Fetch byte from first operand, or use padding byte */
-        if (len1 > 0)
-            byte1 = ARCH_DEP(vfetchb) ( addr1, r1, regs );
-        else
-            byte1 = pad;
-
-        /* Fetch byte from second operand, or use padding byte */
-        if (len2 > 0)
-            byte2 = ARCH_DEP(vfetchb) ( addr2, r2, regs );
-        else
-            byte2 = pad;
-
-        /* Test if bytes compare equal */
-        if (byte1 == byte2)
+        /* While neither operand is exhausted, compare the bytes up to
+           the next half page boundary of either operand in storage,
+           skipping unequal bytes and measuring runs of equal bytes */
+        if (len1 > 0 && len2 > 0)
         {
-            /* If this is the first equal byte, save the start of
-               substring addresses and remaining lengths */
-            if (equlen == 0)
+            n = 0x800 - (addr1 & 0x7FF);
+            if (n > 0x800 - (int)(addr2 & 0x7FF))
+                n = 0x800 - (addr2 & 0x7FF);
+            if (n > len1)
+                n = len1;
+            if (n > len2)
+                n = len2;
+
+            main1 = MADDR (addr1, r1, regs, ACCTYPE_READ, regs->psw.pkey);
+            main2 = MADDR (addr2, r2, regs, ACCTYPE_READ, regs->psw.pkey);
+
+            for (k = 0; k < n; )
             {
-                eqaddr1 = addr1;
-                eqaddr2 = addr2;
-                remlen1 = len1;
-                remlen2 = len2;
-            }
+                if (equlen == 0)
+                {
+                    /* Find the next equal byte within the 4096 bytes */
+                    if (i + k >= 4096)
+                        break;
+                    m = n - k;
+                    if (m > 4096 - (i + k))
+                        m = 4096 - (i + k);
+                    j = hsimd_match (main1 + k, main2 + k, m);
+                    if (j > 0)
+                        cc = 2;
+                    k += j;
+                    if (j == m)
+                        continue;
+
+                    /* Save the start of substring addresses and
+                       remaining lengths */
+                    eqaddr1 = (addr1 + k) & ADDRESS_MAXWRAP(regs);
+                    eqaddr2 = (addr2 + k) & ADDRESS_MAXWRAP(regs);
+                    remlen1 = len1 - k;
+                    remlen2 = len2 - k;
+                }
 
-            /* Count the number of equal bytes */
-            equlen++;
+                /* Count the equal bytes up to the substring length */
+                m = n - k;
+                if (m > sublen - equlen)
+                    m = sublen - equlen;
+                j = hsimd_cmp (main1 + k, main2 + k, m);
+                if (j > 0)
+                    cc = 1;
+                equlen += j;
+                k += j;
+
+                if (equlen == sublen)
+                    break;
+
+                /* Reset the equal byte count at an unequal byte */
+                if (k < n)
+                {
+                    equlen = 0;
+                    cc = 2;
+                    k++;
+                }
+            }
 
-            /* Set condition code 1 */
-            cc = 1;
+            /* Update the operand addresses and lengths */
+            addr1 += k;
+            addr1 &= ADDRESS_MAXWRAP(regs);
+            len1 -= k;
+            addr2 += k;
+            addr2 &= ADDRESS_MAXWRAP(regs);
+            len2 -= k;
+            i += k;
         }
         else
         {
-            /* Reset equal byte count and set condition code 2 */
-            equlen = 0;
-            cc = 2;
-        }
+            /* Fetch byte from first operand, or use padding byte */
+            if (len1 > 0)
+                byte1 = ARCH_DEP(vfetchb) ( addr1, r1, regs );
+            else
+                byte1 = pad;
 
-        /* Update the first operand address and length */
-        if (len1 > 0)
-        {
-            addr1++;
-            addr1 &= ADDRESS_MAXWRAP(regs);
-            len1--;
-        }
+            /* Fetch byte from second operand, or use padding byte */
+            if (len2 > 0)
+                byte2 = ARCH_DEP(vfetchb) ( addr2, r2, regs );
+            else
+                byte2 = pad;
 
-        /* Update the second operand address and length */
-        if (len2 > 0)
-        {
-            addr2++;
-            addr2 &= ADDRESS_MAXWRAP(regs);
-            len2--;
-        }
+            /* Test if bytes compare equal */
+            if (byte1 == byte2)
+            {
+                /* If this is the first equal byte, save the start of
+                   substring addresses and remaining lengths */
+                if (equlen == 0)
+                {
+                    eqaddr1 = addr1;
+                    eqaddr2 = addr2;
+                    remlen1 = len1;
+                    remlen2 = len2;
+                }
 
+                /* Count the number of equal bytes */
+                equlen++;
+
+                /* Set condition code 1 */
+                cc = 1;
+            }
+            else
+            {
+                /* Reset equal byte count and set condition code 2 */
+                equlen = 0;
+                cc = 2;
+            }
+
+            /* Update the first operand address and length */
+            if (len1 > 0)
+            {
+                addr1++;
+                addr1 &= ADDRESS_MAXWRAP(regs);
+                len1--;
+            }
+
+            /* Update the second operand address and length */
+            if (len2 > 0)
+            {
+                addr2++;
+                addr2 &= ADDRESS_MAXWRAP(regs);
+                len2--;
+            }
+
+            i++;
+        }
 
         /* update GPRs if we just crossed half page - could get rupt */
         if ((addr1 & 0x7FF) == 0 || (addr2 & 0x7FF) == 0)
@@ -3917,9 +4013,8 @@ DEF_INST(move_long)
 int     r1, r2;                         /* Values of R fields        */
 VADR    addr1, addr2;                   /* Operand addresses         */
 int     len1, len2;                     /* Operand lengths           */
-int     len, len3, len4;                /* Work lengths              */
+int     len;                            /* Bytes moved in this unit  */
 VADR    n;                              /* Work area                 */
-BYTE   *dest, *source;                  /* Mainstor addresses        */
 BYTE    pad;                            /* Padding byte              */
 #if defined(FEATURE_INTERVAL_TIMER)
 int     orglen1;                        /* Original dest length      */
@@ -3971,67 +4066,23 @@ int     orglen1;                        /* Original dest length      */
         }
     }
 
-    /* Initialize source and dest addresses */
-    if (len1)
-    {
-        if (len2)
-        {
-            source = MADDR (addr2, r2, regs, ACCTYPE_READ, regs->psw.pkey);
-        }
-        else
-        {
-            source=NULL;
-        }
-        dest = MADDRL (addr1, len1, r1, regs, ACCTYPE_WRITE, regs->psw.pkey);
-    }
-    else
-    {
-        /* FIXME : We shouldn't have to do that - just to prevent potentially
-           uninitialized variable warning in GCC.. Can't see where it is getting
-           this diagnostic from. ISW 2009/02/04 */
-        source=NULL;
-        dest=NULL;
-    }
-
     /* Set the condition code according to the lengths */
     regs->psw.cc = (len1 < len2) ? 1 : (len1 > len2) ? 2 : 0;
 
-    /* Set the registers *after* translating - so that the instruction is properly
-       nullified when there is an access exception on the 1st unit of operation */
-    SET_GR_A(r1, regs,addr1);
-    SET_GR_A(r2, regs,addr2);
+    /* The registers are set only after the first unit has been
+       translated, so that the instruction is properly nullified
+       when there is an access exception on the 1st unit of operation */
+    if (len1 == 0)
+    {
+        SET_GR_A(r1, regs,addr1);
+        SET_GR_A(r2, regs,addr2);
+    }
 
     while (len1)
     {
-        /* Clear or copy memory */
-        if (len2 == 0)
-        {
-            len = NOCROSS2KL(addr1,len1) ? len1 : (int)(0x800 - (addr1 & 0x7FF));
-            memset (dest, pad, len);
-        }
-        else
-        {
-            len3 = NOCROSS2KL(addr1,len1) ? len1 : (int)(0x800 - (addr1 & 0x7FF));
-            len4 = NOCROSS2KL(addr2,len2) ? len2 : (int)(0x800 - (addr2 & 0x7FF));
-            len = len3 < len4 ? len3 : len4;
-            /* Use concpy to ensure Concurrent block update consistency */
-            concpy (regs, dest, source, len);
-        }
-
-/* No longer required because it is handled during MADDRL */
-#if 0
-        /* Check for storage alteration PER event */
-#if defined(FEATURE_PER)
-        if ( EN_IC_PER_SA(regs)
-#if defined(FEATURE_PER2)
-         && ( REAL_MODE(&regs->psw)
-          ||  ARCH_DEP(check_sa_per2) (r1, ACCTYPE_WRITE, regs)
-            )
-#endif /*defined(FEATURE_PER2)*/
-         && PER_RANGE_CHECK2(addr1, addr1+len, regs->CR(10), regs->CR(11)) )
-            ON_IC_PER_SA(regs);
-#endif /*defined(FEATURE_PER)*/
-#endif
+        /* Clear or copy memory up to the next page boundary */
+        len = ARCH_DEP(move_long_unit) (addr1, r1, len1,
+                                        addr2, r2, len2, pad, regs);
 
         /* Adjust lengths and virtual addresses */
         len1 -= len;
@@ -4056,22 +4107,6 @@ int     orglen1;                        /* Original dest length      */
             break;
         }
 
-        /* Translate next source and dest addresses */
-        if (len1)
-        {
-            if (len2)
-            {
-                if (addr2 & 0x7FF)
-                    source += len;
-                else
-                    source = MADDR (addr2, r2, regs, ACCTYPE_READ, regs->psw.pkey);
-            }
-            if (addr1 & 0x7FF)
-                dest += len;
-            else
-                dest = MADDRL (addr1, len1, r1, regs, ACCTYPE_WRITE, regs->psw.pkey);
-        }
-
     } /* while (len1) */
 
     ITIMER_UPDATE(addr1,orglen1,regs);
@@ -4096,10 +4131,8 @@ int     cc;                             /* Condition code            */
 VADR    addr1, addr2;                   /* Operand addresses         */
 GREG    len1, len2;                     /* Operand lengths           */
 BYTE    pad;                            /* Padding byte              */
-size_t  cpu_length;                     /* cpu determined length     */
-size_t  copylen;                        /* Length to copy            */
-BYTE    *dest;                          /* Maint storage pointers    */
-size_t  dstlen,srclen;                  /* Page wide src/dst lengths */
+int     i;                              /* Bytes moved               */
+int     len;                            /* Bytes moved in this unit  */
 
     RS(inst, regs, r1, r3, b2, effective_addr2);
 
@@ -4116,61 +4149,35 @@ size_t  dstlen,srclen;                  /* Page wide src/dst lengths */
     len1 = GR_A(r1+1, regs);
     len2 = GR_A(r3+1, regs);
 
-    /* set cpu_length as shortest distance to new page */
-    if ((addr1 & 0xFFF) > (addr2 & 0xFFF))
-        cpu_length = 0x1000 - (addr1 & 0xFFF);
-    else
-        cpu_length = 0x1000 - (addr2 & 0xFFF);
-
-    dstlen=MIN(cpu_length,len1);
-    srclen=MIN(cpu_length,len2);
-    copylen=MIN(dstlen,srclen);
-
     /* Set the condition code according to the lengths */
     cc = (len1 < len2) ? 1 : (len1 > len2) ? 2 : 0;
 
-    /* Obtain destination pointer */
-    if(len1==0)
+    /* Move or pad a page at a time, until the CPU determined number
+       of bytes have been moved or an interrupt is pending */
+    for (i = 0; len1 > 0; i += len)
     {
-        /* bail out if nothing to do */
-        regs->psw.cc = cc;
-        return;
-    }
+        if (i >= LONG_CPU_DETERMINED || (i > 0 && INTERRUPT_PENDING(regs)))
+            break;
+
+        len = ARCH_DEP(move_long_unit) (addr1, r1, len1,
+                                        addr2, r3, len2, pad, regs);
 
-    dest = MADDRL (addr1, len1, r1, regs, ACCTYPE_WRITE, regs->psw.pkey);
-    if(copylen!=0)
-    {
-        /* here if we need to copy data */
-        BYTE *source;
-        /* get source frame and copy concurrently */
-        source = MADDR (addr2, r3, regs, ACCTYPE_READ, regs->psw.pkey);
-        concpy(regs,dest,source,copylen);
         /* Adjust operands */
-        addr2+=copylen;
-        len2-=copylen;
-        addr1+=copylen;
-        len1-=copylen;
-
-        /* Adjust length & pointers for this cycle */
-        dest+=copylen;
-        dstlen-=copylen;
-        srclen-=copylen;
-    }
-    if(srclen==0 && dstlen!=0)
-    {
-        /* here if we need to pad the destination */
-        memset(dest,pad,dstlen);
+        addr1 = (addr1 + len) & ADDRESS_MAXWRAP(regs);
+        len1 -= len;
+        if (len2)
+        {
+            addr2 = (addr2 + len) & ADDRESS_MAXWRAP(regs);
+            len2 -= len;
+        }
 
-        /* Adjust destination operands */
-        addr1+=dstlen;
-        len1-=dstlen;
+        /* Update the registers */
+        SET_GR_A(r1, regs,addr1);
+        SET_GR_A(r1+1, regs,len1);
+        SET_GR_A(r3, regs,addr2);
+        SET_GR_A(r3+1, regs,len2);
     }
 
-    /* Update the registers */
-    SET_GR_A(r1, regs,addr1);
-    SET_GR_A(r1+1, regs,len1);
-    SET_GR_A(r3, regs,addr2);
-    SET_GR_A(r3+1, regs,len2);
     /* if len1 != 0 then set CC to 3 to indicate
        we have reached end of CPU dependent length */
     if(len1>0) cc=3;
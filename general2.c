@@ -43,6 +43,7 @@
 #include "opcode.h"
 #include "inline.h"
 #include "clock.h"
+#include "hsimd.h"
 
 
 /*-------------------------------------------------------------------*/
@@ -313,6 +314,10 @@ int     r1, r3;                         /* Lenght values             */
 int     b2, b4;                         /* Values of base registers  */
 VADR    effective_addr2,
         effective_addr4;                /* Effective addresses       */
+#if defined(OPTION_PLO_LOCKS)
+LOCK   *plolock;                        /* Selected PLO lock         */
+int     fc;                             /* Function code             */
+#endif /*defined(OPTION_PLO_LOCKS)*/
 
     SS(inst, regs, r1, r3, b2, effective_addr2,
                                      b4, effective_addr4);
@@ -362,12 +367,35 @@ VADR    effective_addr2,
     }
     else
     {
+#if defined(OPTION_PLO_LOCKS)
+        /* gpr1/ar1 identify the program lock token, which is used
+           to select a lock from the model dependent number of locks
+           in the configuration.  Only the offset of the PLT within
+           its page is used, so that every virtual alias of the same
+           storage selects the same lock without translating the PLT,
+           and PLO operations with different PLTs can run at once   */
+        plolock = &sysblk.plolock[(regs->GR_L(1) >> 3)
+                                  & (OPTION_PLO_LOCKS - 1)];
+
+        /* Count the operation and whether the lock was busy */
+        fc = regs->GR_L(0) & PLO_GPR0_FC;
+        if (fc >= PLO_FUNCS)
+            regs->program_interrupt(regs, PGM_SPECIFICATION_EXCEPTION);
+        regs->plocount[fc]++;
+        if (try_obtain_lock(plolock))
+        {
+            regs->plowait[fc]++;
+            obtain_lock(plolock);
+        }
+        regs->plolock = plolock;
+#else /*!defined(OPTION_PLO_LOCKS)*/
         /* gpr1/ar1 indentify the program lock token, which is used
            to select a lock from the model dependent number of locks
            in the configuration.  We simply use 1 lock which is the
            main storage access lock which is also used by CS, CDS
            and TS.                                               *JJ */
         OBTAIN_MAINLOCK(regs);
+#endif /*!defined(OPTION_PLO_LOCKS)*/
 
         switch(regs->GR_L(0) & PLO_GPR0_FC)
         {
@@ -476,8 +504,14 @@ VADR    effective_addr2,
 
         }
 
+#if defined(OPTION_PLO_LOCKS)
+        /* Release the PLO lock */
+        regs->plolock = NULL;
+        release_lock(plolock);
+#else /*!defined(OPTION_PLO_LOCKS)*/
         /* Release main-storage access lock */
         RELEASE_MAINLOCK(regs);
+#endif /*!defined(OPTION_PLO_LOCKS)*/
 
         if(regs->psw.cc && sysblk.cpus > 1)
         {
@@ -498,8 +532,10 @@ DEF_INST(search_string)
 {
 int     r1, r2;                         /* Values of R fields        */
 int     i;                              /* Loop counter              */
+int     n;                              /* Bytes searched in page    */
 VADR    addr1, addr2;                   /* End/start addresses       */
-BYTE    sbyte;                          /* String character          */
+BYTE   *main2;                          /* Operand mainstor address  */
+BYTE   *found;                          /* Address of character found*/
 BYTE    termchar;                       /* Terminating character     */
 
     RRE(inst, regs, r1, r2);
@@ -515,8 +551,9 @@ BYTE    termchar;                       /* Terminating character     */
     addr1 = regs->GR(r1) & ADDRESS_MAXWRAP(regs);
     addr2 = regs->GR(r2) & ADDRESS_MAXWRAP(regs);
 
-    /* Search up to 256 bytes or until end of operand */
-    for (i = 0; i < 0x100; i++)
+    /* Search up to 4096 bytes or until end of operand, processing
+       the bytes within each page at once */
+    for (i = 0; i < 0x1000; i += n)
     {
         /* If operand end address has been reached, return condition
            code 2 and leave the R1 and R2 registers unchanged */
@@ -526,20 +563,28 @@ BYTE    termchar;                       /* Terminating character     */
             return;
         }
 
-        /* Fetch a byte from the operand */
-        sbyte = ARCH_DEP(vfetchb) ( addr2, r2, regs );
+        /* Stop at the end of the page or of the operand */
+        n = PAGEFRAME_PAGESIZE - (addr2 & PAGEFRAME_BYTEMASK);
+        if (n > 0x1000 - i)
+            n = 0x1000 - i;
+        if ((VADR)n > ((addr1 - addr2) & ADDRESS_MAXWRAP(regs)))
+            n = (addr1 - addr2) & ADDRESS_MAXWRAP(regs);
+
+        /* Search the bytes for the terminating character */
+        main2 = MADDR (addr2, r2, regs, ACCTYPE_READ, regs->psw.pkey);
+        found = memchr (main2, termchar, n);
 
         /* If the terminating character was found, return condition
            code 1 and load the address of the character into R1 */
-        if (sbyte == termchar)
+        if (found != NULL)
         {
-            SET_GR_A(r1, regs, addr2);
+            SET_GR_A(r1, regs, addr2 + (found - main2));
             regs->psw.cc = 1;
             return;
         }
 
         /* Increment operand address */
-        addr2++;
+        addr2 += n;
         addr2 &= ADDRESS_MAXWRAP(regs);
 
     } /* end for(i) */
@@ -1405,7 +1450,7 @@ BYTE    old;                            /* Old value                 */
     main2 = MADDR (effective_addr2, b2, regs, ACCTYPE_WRITE, regs->psw.pkey);
 
     /* Obtain main-storage access lock */
-    OBTAIN_MAINLOCK(regs);
+    OBTAIN_MAINLOCK_CAS(regs);
 
     /* Get old value */
     old = *main2;
@@ -1432,7 +1477,7 @@ BYTE    old;                            /* Old value                 */
     regs->psw.cc = old >> 7;
 
     /* Release main-storage access lock */
-    RELEASE_MAINLOCK(regs);
+    RELEASE_MAINLOCK_CAS(regs);
 
     /* Perform serialization after completing operation */
     PERFORM_SERIALIZATION (regs);
@@ -1575,10 +1620,9 @@ BYTE   *dest, *dest2 = NULL, *tab, *tab2; /* Mainstor pointers       */
     {
         tab = MADDR (addr2, b2, regs, ACCTYPE_READ, regs->psw.pkey);
         /* Perform translate function */
-        for (i = 0; i <= len; i++)
-            dest[i] = tab[dest[i]];
-        for (i = 0; i <= len2; i++)
-            dest2[i] = tab[dest2[i]];
+        hsimd_tr (dest, dest, len + 1, tab);
+        if (dest2)
+            hsimd_tr (dest2, dest2, len2 + 1, tab);
     }
     else
     {
@@ -1633,51 +1677,87 @@ int     cc = 0;                         /* Condition code            */
 BYTE    sbyte;                          /* Byte work areas           */
 BYTE    dbyte;                          /* Byte work areas           */
 int     i;                              /* Integer work areas        */
+int     k, n;                           /* Integer work areas        */
+BYTE   *op1, *tab = NULL;               /* Mainstor pointers         */
 
     SS_L(inst, regs, l, b1, effective_addr1,
                                   b2, effective_addr2);
 
-    /* Process first operand from left to right */
-    for ( i = 0; i <= l; i++ )
+    /* Fast path if table does not cross a boundary */
+    if (NOCROSS2K (effective_addr2, 255))
     {
-        /* Fetch argument byte from first operand */
-        dbyte = ARCH_DEP(vfetchb) ( effective_addr1, b1, regs );
+        /* Scan the first operand one 2K block at a time */
+        for ( i = 0; i <= l; i += n )
+        {
+            n = 0x800 - (effective_addr1 & 0x7FF);
+            if (n > l + 1 - i)
+                n = l + 1 - i;
 
-        /* Fetch function byte from second operand */
-        sbyte = ARCH_DEP(vfetchb) ( (effective_addr2 + dbyte)
-                                   & ADDRESS_MAXWRAP(regs), b2, regs );
+            op1 = MADDR (effective_addr1, b1, regs,
+                         ACCTYPE_READ, regs->psw.pkey);
+            if (tab == NULL)
+                tab = MADDR (effective_addr2, b2, regs,
+                             ACCTYPE_READ, regs->psw.pkey);
 
-        /* Test for non-zero function byte */
-        if (sbyte != 0) {
+            if ((k = hsimd_trt (op1, n, tab)) >= 0)
+            {
+                effective_addr1 += k;
+                sbyte = tab[op1[k]];
+                cc = (i + k == l) ? 2 : 1;
+                break;
+            }
 
-            /* Store address of argument byte in register 1 */
-#if defined(FEATURE_ESAME)
-            if(regs->psw.amode64)
-                regs->GR_G(1) = effective_addr1;
-            else
-#endif
-            if ( regs->psw.amode )
-                regs->GR_L(1) = effective_addr1;
-            else
-                regs->GR_LA24(1) = effective_addr1;
+            effective_addr1 += n;
+            effective_addr1 &= ADDRESS_MAXWRAP(regs);
+        }
+    }
+    else
+    {
+        /* Process first operand from left to right */
+        for ( i = 0; i <= l; i++ )
+        {
+            /* Fetch argument byte from first operand */
+            dbyte = ARCH_DEP(vfetchb) ( effective_addr1, b1, regs );
 
-            /* Store function byte in low-order byte of reg.2 */
-            regs->GR_LHLCL(2) = sbyte;
+            /* Fetch function byte from second operand */
+            sbyte = ARCH_DEP(vfetchb) ( (effective_addr2 + dbyte)
+                                       & ADDRESS_MAXWRAP(regs), b2, regs );
 
-            /* Set condition code 2 if argument byte was last byte
-               of first operand, otherwise set condition code 1 */
-            cc = (i == l) ? 2 : 1;
+            /* Test for non-zero function byte */
+            if (sbyte != 0) {
 
-            /* Terminate the operation at this point */
-            break;
+                /* Set condition code 2 if argument byte was last byte
+                   of first operand, otherwise set condition code 1 */
+                cc = (i == l) ? 2 : 1;
 
-        } /* end if(sbyte) */
+                /* Terminate the operation at this point */
+                break;
 
-        /* Increment first operand address */
-        effective_addr1++;
-        effective_addr1 &= ADDRESS_MAXWRAP(regs);
+            } /* end if(sbyte) */
 
-    } /* end for(i) */
+            /* Increment first operand address */
+            effective_addr1++;
+            effective_addr1 &= ADDRESS_MAXWRAP(regs);
+
+        } /* end for(i) */
+    }
+
+    if (cc)
+    {
+        /* Store address of argument byte in register 1 */
+#if defined(FEATURE_ESAME)
+        if(regs->psw.amode64)
+            regs->GR_G(1) = effective_addr1;
+        else
+#endif
+        if ( regs->psw.amode )
+            regs->GR_L(1) = effective_addr1;
+        else
+            regs->GR_LA24(1) = effective_addr1;
+
+        /* Store function byte in low-order byte of reg.2 */
+        regs->GR_LHLCL(2) = sbyte;
+    }
 
     /* Update the condition code */
     regs->psw.cc = cc;
@@ -1691,11 +1771,11 @@ int     i;                              /* Integer work areas        */
 DEF_INST(translate_extended)
 {
 int     r1, r2;                         /* Values of R fields        */
-int     i;                              /* Loop counter              */
+int     i, n;                           /* Loop counters             */
 int     cc = 0;                         /* Condition code            */
 VADR    addr1, addr2;                   /* Operand addresses         */
 GREG    len1;                           /* Operand length            */
-BYTE    byte1, byte2;                   /* Operand bytes             */
+BYTE   *p, *q;                          /* Mainstor pointers         */
 BYTE    tbyte;                          /* Test byte                 */
 BYTE    trtab[256];                     /* Translate table           */
 
@@ -1719,8 +1799,8 @@ BYTE    trtab[256];                     /* Translate table           */
        operand may be recognized, even if not all bytes are used */
     ARCH_DEP(vfetchc) ( trtab, 255, addr2, r2, regs );
 
-    /* Process first operand from left to right */
-    for (i = 0; len1 > 0; i++)
+    /* Process first operand from left to right, one 2K block at a time */
+    for (i = 0; len1 > 0; i += n)
     {
         /* If 4096 bytes have been compared, exit with condition code 3 */
         if (i >= 4096)
@@ -1729,29 +1809,39 @@ BYTE    trtab[256];                     /* Translate table           */
             break;
         }
 
-        /* Fetch byte from first operand */
-        byte1 = ARCH_DEP(vfetchb) ( addr1, r1, regs );
+        n = 0x800 - (addr1 & 0x7FF);
+        if (n > 4096 - i)
+            n = 4096 - i;
+        if ((GREG)n > len1)
+            n = len1;
+
+        /* Locate the test byte, if any, in this block */
+        p = MADDR (addr1, r1, regs, ACCTYPE_READ, regs->psw.pkey);
+        q = memchr (p, tbyte, n);
+        if (q)
+            n = q - p;
+
+        /* Translate the bytes that precede the test byte */
+        if (n)
+        {
+            p = MADDR (addr1, r1, regs, ACCTYPE_WRITE, regs->psw.pkey);
+            hsimd_tr (p, p, n, trtab);
+            addr1 += n;
+            addr1 &= ADDRESS_MAXWRAP(regs);
+            len1 -= n;
+
+            /* Update the registers */
+            SET_GR_A(r1, regs, addr1);
+            SET_GR_A(r1+1, regs, len1);
+        }
 
         /* If equal to test byte, exit with condition code 1 */
-        if (byte1 == tbyte)
+        if (q)
         {
             cc = 1;
             break;
         }
 
-        /* Load indicated byte from translate table */
-        byte2 = trtab[byte1];
-
-        /* Store result at first operand address */
-        ARCH_DEP(vstoreb) ( byte2, addr1, r1, regs );
-        addr1++;
-        addr1 &= ADDRESS_MAXWRAP(regs);
-        len1--;
-
-        /* Update the registers */
-        SET_GR_A(r1, regs, addr1);
-        SET_GR_A(r1+1, regs, len1);
-
     } /* end for(i) */
 
     /* Set condition code */
@@ -2576,7 +2666,10 @@ DEF_INST(convert_utf32_to_utf16)
 DEF_INST(search_string_unicode)
 {
   VADR addr1, addr2;                    /* End/start addresses       */
+  VADR dist;                            /* Bytes to end of operand   */
+  BYTE *main2;                          /* Operand mainstor address  */
   int i;                                /* Loop counter              */
+  int j, n;                             /* Characters searched       */
   int r1, r2;                           /* Values of R fields        */
   U16 sbyte;                            /* String character          */
   U16 termchar;                         /* Terminating character     */
@@ -2594,8 +2687,9 @@ DEF_INST(search_string_unicode)
   addr1 = regs->GR(r1) & ADDRESS_MAXWRAP(regs);
   addr2 = regs->GR(r2) & ADDRESS_MAXWRAP(regs);
 
-  /* Search up to 256 bytes or until end of operand */
-  for(i = 0; i < 0x100; i++)
+  /* Search up to 2048 characters or until end of operand, processing
+     the characters within each page at once */
+  for(i = 0; i < 0x800; i += n)
   {
     /* If operand end address has been reached, return condition
        code 2 and leave the R1 and R2 registers unchanged */
@@ -2605,20 +2699,40 @@ DEF_INST(search_string_unicode)
       return;
     }
 
-    /* Fetch 2 bytes from the operand */
-    sbyte = ARCH_DEP(vfetch2)(addr2, r2, regs );
+    /* Stop at the end of the page or of the operand.  The end is
+       never reached if it is an odd number of bytes away */
+    n = (PAGEFRAME_PAGESIZE - (addr2 & PAGEFRAME_BYTEMASK)) / 2;
+    if(n > 0x800 - i)
+      n = 0x800 - i;
+    dist = (addr1 - addr2) & ADDRESS_MAXWRAP(regs);
+    if(!(dist & 1) && (VADR)n > dist / 2)
+      n = dist / 2;
+
+    if(n == 0)
+    {
+      /* Fetch a character which crosses a page boundary */
+      sbyte = ARCH_DEP(vfetch2)(addr2, r2, regs );
+      n = 1;
+      j = (sbyte == termchar) ? 0 : 1;
+    }
+    else
+    {
+      /* Search the characters for the terminating character */
+      main2 = MADDR(addr2, r2, regs, ACCTYPE_READ, regs->psw.pkey);
+      j = hsimd_srchu(main2, termchar, n);
+    }
 
     /* If the terminating character was found, return condition
        code 1 and load the address of the character into R1 */
-    if(sbyte == termchar)
+    if(j < n)
     {
-      SET_GR_A(r1, regs, addr2);
+      SET_GR_A(r1, regs, addr2 + 2*j);
       regs->psw.cc = 1;
       return;
     }
 
     /* Increment operand address */
-    addr2 += 2;
+    addr2 += 2*n;
     addr2 &= ADDRESS_MAXWRAP(regs);
 
   } /* end for(i) */
@@ -2641,56 +2755,90 @@ DEF_INST(translate_and_test_reverse)
   VADR effective_addr1;
   VADR effective_addr2;                 /* Effective addresses       */
   int i;                                /* Integer work areas        */
+  int k, n;                             /* Integer work areas        */
   int l;                                /* Lenght byte               */
   BYTE sbyte;                           /* Byte work areas           */
+  BYTE *op1, *tab = NULL;               /* Mainstor pointers         */
 
   SS_L(inst, regs, l, b1, effective_addr1, b2, effective_addr2);
 
-  /* Process first operand from right to left*/
-  for(i = 0; i <= l; i++)
+  /* Fast path if table does not cross a boundary */
+  if(NOCROSS2K(effective_addr2, 255))
   {
-    /* Fetch argument byte from first operand */
-    dbyte = ARCH_DEP(vfetchb)(effective_addr1, b1, regs);
+    /* Scan the first operand one 2K block at a time, right to left */
+    for(i = 0; i <= l; i += n)
+    {
+      n = (effective_addr1 & 0x7FF) + 1;
+      if(n > l + 1 - i)
+        n = l + 1 - i;
 
-    /* Fetch function byte from second operand */
-    sbyte = ARCH_DEP(vfetchb)((effective_addr2 + dbyte) & ADDRESS_MAXWRAP(regs), b2, regs);
+      op1 = MADDR(effective_addr1 - (n - 1), b1, regs, ACCTYPE_READ, regs->psw.pkey);
+      if(tab == NULL)
+        tab = MADDR(effective_addr2, b2, regs, ACCTYPE_READ, regs->psw.pkey);
 
-    /* Test for non-zero function byte */
-    if(sbyte != 0)
-    {
-      /* Store address of argument byte in register 1 */
-#if defined(FEATURE_ESAME)
-      if(regs->psw.amode64)
-        regs->GR_G(1) = effective_addr1;
-      else
-#endif
-      if(regs->psw.amode)
+      if((k = hsimd_trtr(op1, n, tab)) >= 0)
       {
-        /* Note: TRTR differs from TRT in 31 bit mode.
-           TRTR leaves bit 32 unchanged, TRT clears bit 32 */
-        regs->GR_L(1) &= 0x80000000;
-        regs->GR_L(1) |= effective_addr1;
+        effective_addr1 -= (n - 1) - k;
+        sbyte = tab[op1[k]];
+        cc = (i + (n - 1) - k == l) ? 2 : 1;
+        break;
       }
-      else
-        regs->GR_LA24(1) = effective_addr1;
 
-      /* Store function byte in low-order byte of reg.2 */
-      regs->GR_LHLCL(2) = sbyte;
+      effective_addr1 -= n;
+      effective_addr1 &= ADDRESS_MAXWRAP(regs);
+    }
+  }
+  else
+  {
+    /* Process first operand from right to left*/
+    for(i = 0; i <= l; i++)
+    {
+      /* Fetch argument byte from first operand */
+      dbyte = ARCH_DEP(vfetchb)(effective_addr1, b1, regs);
 
-      /* Set condition code 2 if argument byte was last byte
-         of first operand, otherwise set condition code 1 */
-      cc = (i == l) ? 2 : 1;
+      /* Fetch function byte from second operand */
+      sbyte = ARCH_DEP(vfetchb)((effective_addr2 + dbyte) & ADDRESS_MAXWRAP(regs), b2, regs);
 
-      /* Terminate the operation at this point */
-      break;
+      /* Test for non-zero function byte */
+      if(sbyte != 0)
+      {
+        /* Set condition code 2 if argument byte was last byte
+           of first operand, otherwise set condition code 1 */
+        cc = (i == l) ? 2 : 1;
 
-    } /* end if(sbyte) */
+        /* Terminate the operation at this point */
+        break;
 
-    /* Decrement first operand address */
-    effective_addr1--; /* Another difference with TRT */
-    effective_addr1 &= ADDRESS_MAXWRAP(regs);
+      } /* end if(sbyte) */
 
-  } /* end for(i) */
+      /* Decrement first operand address */
+      effective_addr1--; /* Another difference with TRT */
+      effective_addr1 &= ADDRESS_MAXWRAP(regs);
+
+    } /* end for(i) */
+  }
+
+  if(cc)
+  {
+    /* Store address of argument byte in register 1 */
+#if defined(FEATURE_ESAME)
+    if(regs->psw.amode64)
+      regs->GR_G(1) = effective_addr1;
+    else
+#endif
+    if(regs->psw.amode)
+    {
+      /* Note: TRTR differs from TRT in 31 bit mode.
+         TRTR leaves bit 32 unchanged, TRT clears bit 32 */
+      regs->GR_L(1) &= 0x80000000;
+      regs->GR_L(1) |= effective_addr1;
+    }
+    else
+      regs->GR_LA24(1) = effective_addr1;
+
+    /* Store function byte in low-order byte of reg.2 */
+    regs->GR_LHLCL(2) = sbyte;
+  }
 
   /* Update the condition code */
   regs->psw.cc = cc;
@@ -2713,6 +2861,8 @@ DEF_INST(translate_and_test_extended)
   int l_bit;                  /* Argument-Character Limit (L)        */
   int m3;
   int processed;              /* # bytes processed                   */
+  int k, n;                   /* Work variables                      */
+  BYTE *buf, *fct = NULL;     /* Mainstor pointers                   */
   int r1;
   int r2;
 
@@ -2732,6 +2882,37 @@ DEF_INST(translate_and_test_extended)
 
   fc = 0;
   processed = 0;
+
+  /* Fast path for one byte arguments and function codes if the
+     function-code table does not cross a boundary; the loop below
+     then only handles the case where the fast path does not apply */
+  if(!a_bit && !f_bit && NOCROSS2K(fct_addr, 255))
+  {
+    /* Scan the first operand one 2K block at a time */
+    while(buf_len && !fc && processed < 16384)
+    {
+      n = 0x800 - (buf_addr & 0x7FF);
+      if(n > 16384 - processed)
+        n = 16384 - processed;
+      if((GREG) n > buf_len)
+        n = buf_len;
+
+      buf = MADDR(buf_addr, r1, regs, ACCTYPE_READ, regs->psw.pkey);
+      if(fct == NULL)
+        fct = MADDR(fct_addr, 1, regs, ACCTYPE_READ, regs->psw.pkey);
+
+      if((k = hsimd_trt(buf, n, fct)) >= 0)
+      {
+        fc = fct[buf[k]];
+        n = k;
+      }
+
+      buf_len -= n;
+      processed += n;
+      buf_addr = (buf_addr + n) & ADDRESS_MAXWRAP(regs);
+    }
+  }
+
   while(buf_len && !fc && processed < 16384)
   {
     if(a_bit)
@@ -2807,6 +2988,8 @@ DEF_INST(translate_and_test_reverse_extended)
   int l_bit;                  /* Argument-Character Limit (L)        */
   int m3;
   int processed;              /* # bytes processed                   */
+  int k, n;                   /* Work variables                      */
+  BYTE *buf, *fct = NULL;     /* Mainstor pointers                   */
   int r1;
   int r2;
 
@@ -2826,6 +3009,37 @@ DEF_INST(translate_and_test_reverse_extended)
 
   fc = 0;
   processed = 0;
+
+  /* Fast path for one byte arguments and function codes if the
+     function-code table does not cross a boundary; the loop below
+     then only handles the case where the fast path does not apply */
+  if(!a_bit && !f_bit && NOCROSS2K(fct_addr, 255))
+  {
+    /* Scan the first operand one 2K block at a time, right to left */
+    while(buf_len && !fc && processed < 16384)
+    {
+      n = (buf_addr & 0x7FF) + 1;
+      if(n > 16384 - processed)
+        n = 16384 - processed;
+      if((GREG) n > buf_len)
+        n = buf_len;
+
+      buf = MADDR(buf_addr - (n - 1), r1, regs, ACCTYPE_READ, regs->psw.pkey);
+      if(fct == NULL)
+        fct = MADDR(fct_addr, 1, regs, ACCTYPE_READ, regs->psw.pkey);
+
+      if((k = hsimd_trtr(buf, n, fct)) >= 0)
+      {
+        fc = fct[buf[k]];
+        n = (n - 1) - k;
+      }
+
+      buf_len -= n;
+      processed += n;
+      buf_addr = (buf_addr - n) & ADDRESS_MAXWRAP(regs);
+    }
+  }
+
   while(buf_len && !fc && processed < 16384)
   {
     if(a_bit)
@@ -230,6 +230,21 @@
 #define PGM_PRD_OS_RESTRICTED 4                 /* Restricted        */
 #define PGM_PRD_OS_LICENSED   0                 /* Licensed          */
 
+/* Host page backing of main and expanded storage (HUGEPAGES)       */
+#define STORPAGE_NORMAL    0               /* Host default pages     */
+#define STORPAGE_THP       1               /* Transparent huge pages */
+#define STORPAGE_2M        2               /* 2M hugetlb pages       */
+#define STORPAGE_1G        3               /* 1G hugetlb pages       */
+
+/* Host NUMA placement of main and expanded storage (NUMAPOLICY)     */
+#define NUMAPOL_DEFAULT    0               /* Host default (local)   */
+#define NUMAPOL_INTERLEAVE 1               /* Interleave over nodes  */
+#define NUMAPOL_BIND       2               /* Bind to nodes          */
+
+/* Timer interrupt latency histogram: bucket n counts latencies of
+   2**(n-1) up to 2**n microseconds, the last bucket all longer ones */
+#define TIMER_LAT_BUCKETS  16              /* Latency buckets        */
+
 /* Storage access bits used by logical_to_main */
 #define ACC_CHECK          0x0001          /* Possible storage update*/
 #define ACC_WRITE          0x0002          /* Storage update         */
@@ -187,6 +187,12 @@ int  define_device (U16 lcss, U16 olddev, U16 newdev);
 CONF_DLL_IMPORT int  group_device(DEVBLK *dev, int members);
 int  configure_cpu (int cpu);
 int  deconfigure_cpu (int cpu);
+#if defined(OPTION_CPU_AFFINITY)
+int  set_cpu_affinity (char *spec);
+void apply_cpu_affinity (void);
+void bind_thread_affinity (int cpu);
+char *format_cpu_set (cpu_set_t *set, char *buf, size_t bufl);
+#endif /*defined(OPTION_CPU_AFFINITY)*/
 BLDC_DLL_IMPORT int parse_args (char* p, int maxargc, char** pargv, int* pargc);
 #define MAX_ARGS  128                   /* Max argv[] array size     */
 int parse_and_attach_devices(const char *devnums,const char *devtype,int ac,char **av);
@@ -368,6 +374,9 @@ CCKD_DLL_IMPORT void   *cckd_sf_comp (void *);
 CCKD_DLL_IMPORT void   *cckd_sf_chk (void *);
 CCKD_DLL_IMPORT int     cckd_command(char *, int);
 CCKD_DLL_IMPORT void    cckd_print_itrace ();
+CCKD_DLL_IMPORT int     cckd_compress (DEVBLK *, BYTE **, BYTE *, int, int, int);
+CCKD_DLL_IMPORT int     cckd_uncompress_trkimg (DEVBLK *, BYTE *, BYTE *, int, int);
+CCKD_DLL_IMPORT int     cckd_zstd_dict (char *);
 
 /* Functions in module cckdutil.c */
 CCDU_DLL_IMPORT int     cckd_swapend (DEVBLK *);
@@ -379,6 +388,7 @@ CCDU_DLL_IMPORT void    cckd_swapend4 (char *);
 CCDU_DLL_IMPORT void    cckd_swapend2 (char *);
 CCDU_DLL_IMPORT int     cckd_endian ();
 CCDU_DLL_IMPORT int     cckd_comp (DEVBLK *);
+CCDU_DLL_IMPORT int     cckd_recomp (DEVBLK *, int, int);
 CCDU_DLL_IMPORT int     cckd_chkdsk (DEVBLK *, int);
 CCDU_DLL_IMPORT void    cckdumsg (DEVBLK *, int, char *, ...);
 
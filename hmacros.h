@@ -336,6 +336,29 @@ typedef U64  (*z900_trace_br_func) (int amode,  U64 ia, REGS *regs);
    } \
  } while (0)
 
+/*-------------------------------------------------------------------*/
+/* Obtain/Release mainlock around an interlocked update (CS, CDS,    */
+/* TS, etc).  The lock is not needed when the host cmpxchg routines  */
+/* are atomic (CMPXCHG_LOCKFREE in machdep.h)                        */
+/*-------------------------------------------------------------------*/
+
+#if defined(OPTION_LOCKFREE_CS)
+#define OBTAIN_MAINLOCK_CAS(_regs) \
+ do { \
+  if (!CMPXCHG_LOCKFREE) \
+   OBTAIN_MAINLOCK(_regs); \
+ } while (0)
+
+#define RELEASE_MAINLOCK_CAS(_regs) \
+ do { \
+  if (!CMPXCHG_LOCKFREE) \
+   RELEASE_MAINLOCK(_regs); \
+ } while (0)
+#else /*!defined(OPTION_LOCKFREE_CS)*/
+#define OBTAIN_MAINLOCK_CAS(_regs)  OBTAIN_MAINLOCK(_regs)
+#define RELEASE_MAINLOCK_CAS(_regs) RELEASE_MAINLOCK(_regs)
+#endif /*!defined(OPTION_LOCKFREE_CS)*/
+
 /*-------------------------------------------------------------------*/
 /* Obtain/Release intlock.                                           */
 /* intlock can be obtained by any thread                             */
@@ -348,7 +371,11 @@ typedef U64  (*z900_trace_br_func) (int amode,  U64 ia, REGS *regs);
    REGS *_regs = (_iregs); \
    if ((_regs)) \
      (_regs)->hostregs->intwait = 1; \
-   obtain_lock (&sysblk.intlock); \
+   if (try_obtain_lock (&sysblk.intlock)) { \
+     PTT(PTT_CL_INT, "*intlock", (_regs) ? (_regs)->cpuad : LOCK_OWNER_OTHER, \
+         sysblk.intowner, 0); \
+     obtain_lock (&sysblk.intlock); \
+   } \
    if ((_regs)) { \
      while (sysblk.syncing) { \
        sysblk.sync_mask &= ~(_regs)->hostregs->cpubit; \
@@ -417,10 +444,29 @@ typedef U64  (*z900_trace_br_func) (int amode,  U64 ia, REGS *regs);
 /* Macros to signal interrupt condition to a CPU[s]...               */
 /*-------------------------------------------------------------------*/
 
+#if defined(OPTION_IDLE_WAIT)
+/* A CPU in the enabled wait state sleeps on its own idle wait object
+   rather than on intcond; intlock must be held                      */
+#define WAKEUP_CPU(_regs) \
+ do { \
+   REGS *_wregs = (_regs); \
+   signal_condition(&_wregs->intcond); \
+   if (_wregs->idlewait) { \
+     obtain_lock(&_wregs->idlelock); \
+     if (!_wregs->idlepost) { \
+       _wregs->idlepost = 1; \
+       _wregs->idleposttod = host_tod(); \
+       signal_condition(&_wregs->idlecond); \
+     } \
+     release_lock(&_wregs->idlelock); \
+   } \
+ } while (0)
+#else
 #define WAKEUP_CPU(_regs) \
  do { \
    signal_condition(&(_regs)->intcond); \
  } while (0)
+#endif
 
 #define WAKEUP_CPU_MASK(_mask) \
  do { \
@@ -429,7 +475,7 @@ typedef U64  (*z900_trace_br_func) (int amode,  U64 ia, REGS *regs);
    for (i = 0; mask; i++) { \
      if (mask & 1) \
      { \
-       signal_condition(&sysblk.regs[i]->intcond); \
+       WAKEUP_CPU(sysblk.regs[i]); \
        break; \
      } \
      mask >>= 1; \
@@ -442,9 +488,48 @@ typedef U64  (*z900_trace_br_func) (int amode,  U64 ia, REGS *regs);
    CPU_BITMAP mask = (_mask); \
    for (i = 0; mask; i++) { \
      if (mask & 1) \
-       signal_condition(&sysblk.regs[i]->intcond); \
+       WAKEUP_CPU(sysblk.regs[i]); \
+     mask >>= 1; \
+   } \
+ } while (0)
+
+/* Wake only the first waiting CPU which is enabled for the floating
+   interrupt class _bits, instead of every waiting CPU, which would
+   all contend for intlock while just one of them can take it.  The
+   host mask of a CPU waiting under SIE does not tell whether the
+   guest is enabled, so such a CPU is only woken when no other
+   waiting CPU is enabled.                                           */
+#define WAKEUP_ENABLED_CPU(_bits) \
+ do { \
+   int i; \
+   REGS *_eregs = NULL; \
+   REGS *_sregs = NULL; \
+   CPU_BITMAP mask = sysblk.waiting_mask; \
+   for (i = 0; mask; i++) { \
+     if (mask & 1) { \
+       _eregs = sysblk.regs[i]; \
+       if (_eregs->ints_state & _eregs->ints_mask & (_bits)) \
+         break; \
+       if (_eregs->sie_active && _sregs == NULL) \
+         _sregs = _eregs; \
+     } \
      mask >>= 1; \
    } \
+   if (mask) \
+     WAKEUP_CPU(_eregs); \
+   else if (_sregs) \
+     WAKEUP_CPU(_sregs); \
+ } while (0)
+
+/* A CPU leaving the wait or stopped state wakes the timer thread if
+   it is sleeping until the next timer event; intlock must be held  */
+#define WAKEUP_TIMER() \
+ do { \
+   sysblk.timerstale = 1; \
+   if (sysblk.timeridle) { \
+     sysblk.timeridle = 0; \
+     signal_condition(&sysblk.timercond); \
+   } \
  } while (0)
 
 /*-------------------------------------------------------------------*/
@@ -513,10 +598,54 @@ typedef U64  (*z900_trace_br_func) (int amode,  U64 ia, REGS *regs);
      OFF_IC_IOPENDING; \
    else { \
      ON_IC_IOPENDING; \
-     WAKEUP_CPU_MASK (sysblk.waiting_mask); \
+     WAKEUP_ENABLED_CPU (BIT(IC_IO)); \
    } \
  } while (0)
 
+/*-------------------------------------------------------------------*/
+/* Post I/O interrupt pending state after an I/O interrupt has been  */
+/* queued or dequeued.  With OPTION_LOCKFREE_INTS only the floating */
+/* state in sysblk.ints_state is updated under iointqlk alone; the   */
+/* started CPUs' state words are brought into line with it under     */
+/* intlock, which is taken only when the floating state changed or  */
+/* a CPU is waiting and must be woken.  Each post bumps iopost; a   */
+/* CPU about to wait compares it against the count it saw when it    */
+/* last checked for I/O interrupts, once it is in waiting_mask, so   */
+/* that the wakeup cannot be missed.                                 */
+/*-------------------------------------------------------------------*/
+
+#if defined(OPTION_LOCKFREE_INTS)
+#define POST_IC_IOPENDING(_regs) \
+ do { \
+   int _pending, _changed; \
+   obtain_lock(&sysblk.iointqlk); \
+   _pending = (sysblk.iointq != NULL); \
+   _changed = (_pending != ((sysblk.ints_state & BIT(IC_IO)) != 0)); \
+   if (_pending) { \
+     if (_changed) \
+       IC_STATE_ON(&sysblk.ints_state, BIT(IC_IO)); \
+     sysblk.iopost++; \
+   } else if (_changed) \
+     IC_STATE_OFF(&sysblk.ints_state, BIT(IC_IO)); \
+   release_lock(&sysblk.iointqlk); \
+   ic_fence(); \
+   if (_changed || (_pending && sysblk.waiting_mask)) { \
+     OBTAIN_INTLOCK((_regs)); \
+     SYNC_IC_IOPENDING; \
+     if (_pending) \
+       WAKEUP_ENABLED_CPU (BIT(IC_IO)); \
+     RELEASE_INTLOCK((_regs)); \
+   } \
+ } while (0)
+#else
+#define POST_IC_IOPENDING(_regs) \
+ do { \
+   OBTAIN_INTLOCK((_regs)); \
+   UPDATE_IC_IOPENDING(); \
+   RELEASE_INTLOCK((_regs)); \
+ } while (0)
+#endif
+
 /*-------------------------------------------------------------------*/
 /* Handy utility macro for channel.c                                 */
 /*-------------------------------------------------------------------*/
@@ -16,6 +16,10 @@
 
 #include "hercules.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(OPTION_HOST_SIMD))
+#include <cpuid.h>
+#endif
+
 DLL_EXPORT HOST_INFO  hostinfo;     /* Host system information       */
 
 /*-------------------------------------------------------------------*/
@@ -55,6 +59,48 @@ DLL_EXPORT void init_hostinfo ( HOST_INFO* pHostInfo )
     pHostInfo->num_procs = 1;
   #endif
 #endif
+
+    /* Test for the instruction used by the amd64 cmpxchg16 */
+#if defined(__GNUC__) && defined(__x86_64__)
+    {
+        unsigned int eax, ebx, ecx, edx;
+        pHostInfo->cmpxchg16_avail =
+            __get_cpuid( 1, &eax, &ebx, &ecx, &edx )
+            && (ecx & bit_CMPXCHG16B) ? 1 : 0;
+    }
+#else
+    pHostInfo->cmpxchg16_avail = 0;
+#endif
+
+    /* Test for the vector extensions used by the translate kernels  */
+#if defined(OPTION_HOST_SIMD)
+    __builtin_cpu_init();
+    pHostInfo->ssse3_avail = __builtin_cpu_supports("ssse3") ? 1 : 0;
+    pHostInfo->avx2_avail  = __builtin_cpu_supports("avx2")  ? 1 : 0;
+#else
+    pHostInfo->ssse3_avail = 0;
+    pHostInfo->avx2_avail  = 0;
+#endif
+
+    /* Test for the instructions used by the dyncrypt kernels        */
+    pHostInfo->aes_avail    = 0;
+    pHostInfo->pclmul_avail = 0;
+    pHostInfo->sha_avail    = 0;
+#if defined(OPTION_HOST_SIMD)
+    {
+        unsigned int eax, ebx, ecx, edx;
+        if (__get_cpuid( 1, &eax, &ebx, &ecx, &edx ))
+        {
+            pHostInfo->aes_avail    = (ecx & (1 << 25)) ? 1 : 0;
+            pHostInfo->pclmul_avail = (ecx & (1 <<  1)) ? 1 : 0;
+        }
+        if (__get_cpuid_max( 0, NULL ) >= 7)
+        {
+            __cpuid_count( 7, 0, eax, ebx, ecx, edx );
+            pHostInfo->sha_avail    = (ebx & (1 << 29)) ? 1 : 0;
+        }
+    }
+#endif
 }
 
 /*-------------------------------------------------------------------*/
@@ -33,6 +33,12 @@ typedef struct HOST_INFO
     char  machine[20];
     int   trycritsec_avail;             /* 1=TryEnterCriticalSection */
     int   num_procs;                    /* #of processors            */
+    int   cmpxchg16_avail;              /* 1=CMPXCHG16B instruction  */
+    int   ssse3_avail;                  /* 1=SSSE3 instructions      */
+    int   avx2_avail;                   /* 1=AVX2 instructions       */
+    int   aes_avail;                    /* 1=AES-NI instructions     */
+    int   pclmul_avail;                 /* 1=PCLMULQDQ instruction   */
+    int   sha_avail;                    /* 1=SHA instructions        */
 } HOST_INFO;
 
 HI_DLL_IMPORT HOST_INFO     hostinfo;
@@ -178,6 +178,7 @@
 #undef  OPTION_SCSI_ERASE_GAP           /* (NOT supported!)          */
 #endif
 #undef  OPTION_FBA_BLKDEVICE            /* (no FBA BLKDEVICE support)*/
+#undef  OPTION_DASD_MMAP                /* (no mapped dasd images)   */
 
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #undef  MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" same as "fOo"!!)   */
@@ -228,6 +229,7 @@
 #undef  OPTION_SCSI_TAPE                /* No SCSI tape support      */
 #undef  OPTION_SCSI_ERASE_TAPE          /* (NOT supported)           */
 #undef  OPTION_SCSI_ERASE_GAP           /* (NOT supported)           */
+#define OPTION_DASD_MMAP                /* Mapped dasd image files   */
 #define DLL_IMPORT   extern
 #define DLL_EXPORT
 /* #undef  OPTION_PTTRACE maybe not, after all */
@@ -259,6 +261,7 @@
 #undef  OPTION_SCSI_ERASE_TAPE          /* (NOT supported)           */
 #undef  OPTION_SCSI_ERASE_GAP           /* (NOT supported)           */
 #undef  OPTION_FBA_BLKDEVICE            /* (no FBA BLKDEVICE support)*/
+#define OPTION_DASD_MMAP                /* Mapped dasd image files   */
 
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #define MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" and "fOo" unique)  */
@@ -285,6 +288,7 @@
 
 #undef  OPTION_SCSI_ERASE_TAPE          /* (NOT supported)           */
 #undef  OPTION_SCSI_ERASE_GAP           /* (NOT supported)           */
+#define OPTION_DASD_MMAP                /* Mapped dasd image files   */
 
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #define MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" and "fOo" unique)  */
@@ -313,6 +317,7 @@
 #undef  OPTION_SCSI_ERASE_TAPE          /* (NOT supported)           */
 #undef  OPTION_SCSI_ERASE_GAP           /* (NOT supported)           */
 #define OPTION_FBA_BLKDEVICE            /* FBA block device support  */
+#define OPTION_DASD_MMAP                /* Mapped dasd image files   */
 
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #define MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" and "fOo" unique)  */
@@ -346,6 +351,7 @@
 #undef  OPTION_SCSI_ERASE_TAPE          /* (NOT supported)           */
 #undef  OPTION_SCSI_ERASE_GAP           /* (NOT supported)           */
 #undef  OPTION_FBA_BLKDEVICE            /* (no FBA BLKDEVICE support)*/
+#undef  OPTION_DASD_MMAP                /* (no mapped dasd images)   */
 
 #define MAX_DEVICE_THREADS          0   /* (0 == unlimited)          */
 #define MIXEDCASE_FILENAMES_ARE_UNIQUE  /* ("Foo" and "fOo" unique)  */
@@ -366,4 +372,44 @@
 
 #endif // (host-specific tests)
 
+#if defined(OPTION_DASD_MMAP) && !defined(HAVE_SYS_MMAN_H)
+  #undef  OPTION_DASD_MMAP              /* (requires <sys/mman.h>)   */
+#endif
+
+/* HUGEPAGES and NUMAPOLICY use mmap, madvise and the mbind syscall  */
+#if defined(__linux__) && defined(HAVE_SYS_MMAN_H)
+  #define OPTION_STORAGE_POLICY         /* Hugepage/NUMA storage     */
+#endif
+
+/* CPUAFFINITY binds threads with the glibc CPU affinity functions  */
+#if defined(__linux__) && defined(HAVE_SCHED_H)
+  #define OPTION_CPU_AFFINITY           /* CPU thread affinity       */
+#endif
+
+/* The TOD clock is based on the vDSO clock_gettime(CLOCK_MONOTONIC) */
+#if defined(__linux__)
+  #define OPTION_MONOTONIC_TOD          /* Monotonic host TOD base   */
+#endif
+
+/* The hsimd.h vector kernels need function target attributes (gcc  */
+/* 4.9 or clang) and an x86 host; other hosts use the plain C loops */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+ && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) \
+     || defined(__clang__))
+  #define OPTION_HOST_SIMD              /* SSSE3/AVX2 kernels        */
+#endif
+
+/* The host BFP fast path in ieee.c needs float and double results */
+/* rounded exactly once, to IEEE single and double format           */
+#if defined(__GNUC__) && defined(HAVE_MATH_H) \
+ && defined(__FLT_EVAL_METHOD__) && __FLT_EVAL_METHOD__ == 0 \
+ && !defined(__FAST_MATH__)
+  #define OPTION_BFP_HOST_FPU           /* Host BFP arithmetic       */
+#endif
+
+/* The float.c HFP fraction arithmetic uses the 128 bit integer type */
+#if defined(__SIZEOF_INT128__)
+  #define OPTION_HFP_UINT128            /* 128 bit HFP fractions     */
+#endif
+
 #endif // _HOSTOPTS_H
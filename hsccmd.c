@@ -1049,7 +1049,7 @@ int startall_cmd(int argc, char *argv[], char *cmdline)
             REGS *regs = sysblk.regs[i];
             regs->opinterv = 0;
             regs->cpustate = CPUSTATE_STARTED;
-            signal_condition(&regs->intcond);
+            WAKEUP_CPU(regs);
         }
         mask >>= 1;
     }
@@ -1083,7 +1083,7 @@ DLL_EXPORT int stopall_cmd(int argc, char *argv[], char *cmdline)
             regs->opinterv = 1;
             regs->cpustate = CPUSTATE_STOPPING;
             ON_IC_INTERRUPT(regs);
-            signal_condition(&regs->intcond);
+            WAKEUP_CPU(regs);
         }
         mask >>= 1;
     }
@@ -1288,6 +1288,39 @@ int timerint_cmd(int argc, char *argv[], char *cmdline)
 }
 
 
+#if defined(OPTION_IDLE_WAIT)
+/*-------------------------------------------------------------------*/
+/* idlespin - display or set the idle wait spin limit                */
+/*-------------------------------------------------------------------*/
+int idlespin_cmd(int argc, char *argv[], char *cmdline)
+{
+    UNREFERENCED(cmdline);
+
+    if (argc > 1)
+    {
+        int idlespin = 0; BYTE c;
+
+        if (1
+            && sscanf(argv[1], "%d%c", &idlespin, &c) == 1
+            && idlespin >= 0
+            && idlespin <= 1000000
+        )
+            sysblk.idlespin = idlespin;
+        else
+        {
+            logmsg( _("HHCPN232E Invalid idle spin limit %s\n"), argv[1] );
+            return -1;
+        }
+    }
+    else
+        logmsg( _("HHCPN233I Idle spin limit = %d microsecond(s)\n"),
+              sysblk.idlespin );
+
+    return 0;
+}
+
+
+#endif /*defined(OPTION_IDLE_WAIT)*/
 /*-------------------------------------------------------------------*/
 /* clocks command - display tod clkc and cpu timer                   */
 /*-------------------------------------------------------------------*/
@@ -3377,8 +3410,8 @@ int ext_cmd(int argc, char *argv[], char *cmdline)
 
     logmsg( _("HHCPN050I Interrupt key depressed\n") );
 
-    /* Signal waiting CPUs that an interrupt is pending */
-    WAKEUP_CPUS_MASK (sysblk.waiting_mask);
+    /* Signal a waiting CPU that an interrupt is pending */
+    WAKEUP_ENABLED_CPU (BIT(IC_INTKEY));
 
     RELEASE_INTLOCK(NULL);
 
@@ -3679,6 +3712,59 @@ BYTE    c;
 }
 
 
+#if defined(OPTION_CPU_AFFINITY)
+/*-------------------------------------------------------------------*/
+/* cpuaffinity command - set or display CPU thread affinity          */
+/*-------------------------------------------------------------------*/
+int cpuaffinity_cmd(int argc, char *argv[], char *cmdline)
+{
+cpu_set_t set;                          /* Host CPUs of a thread     */
+char    buf[256];                       /* Host CPU list             */
+int     cpu;                            /* Emulated CPU number       */
+int     rc;                             /* Return code               */
+
+    UNREFERENCED(cmdline);
+
+    /* Update CPU affinity policy if operand is specified */
+    if (argc > 1)
+    {
+        OBTAIN_INTLOCK(NULL);
+        rc = set_cpu_affinity(argv[1]);
+        RELEASE_INTLOCK(NULL);
+        if (rc != 0)
+        {
+            logmsg( _("HHCPN226E Invalid CPUAFFINITY operand %s\n"),
+                    argv[1]);
+            return -1;
+        }
+        return 0;
+    }
+
+    logmsg( _("HHCPN227I CPU affinity %s\n"),
+            sysblk.cpuaffinity == CPUAFF_AUTO ? "AUTO" :
+            sysblk.cpuaffinity == CPUAFF_LIST ? "host CPU list" : "NONE");
+
+    /* Display the host CPUs each CPU thread may actually run on */
+    OBTAIN_INTLOCK(NULL);
+    for (cpu = 0; cpu < MAX_CPU_ENGINES; cpu++)
+    {
+        if (!IS_CPU_ONLINE(cpu))
+            continue;
+        if (pthread_getaffinity_np(sysblk.cputid[cpu], sizeof(set), &set) == 0)
+            logmsg( _("HHCPN228I CPU%4.4X thread runs on host CPUs %s\n"),
+                    cpu, format_cpu_set(&set, buf, sizeof(buf)));
+    }
+    RELEASE_INTLOCK(NULL);
+
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        logmsg( _("HHCPN229I Other threads run on host CPUs %s\n"),
+                format_cpu_set(&set, buf, sizeof(buf)));
+
+    return 0;
+}
+#endif /*defined(OPTION_CPU_AFFINITY)*/
+
+
 /*-------------------------------------------------------------------*/
 /* loadparm - set or display IPL parameter                           */
 /*-------------------------------------------------------------------*/
@@ -4617,10 +4703,6 @@ int syncio_cmd(int argc, char *argv[], char *cmdline)
 }
 
 
-#if !defined(OPTION_FISHIO)
-void *device_thread(void *arg);
-#endif /* !defined(OPTION_FISHIO) */
-
 /*-------------------------------------------------------------------*/
 /* devtmax command - display or set max device threads               */
 /*-------------------------------------------------------------------*/
@@ -4663,6 +4745,13 @@ int devtmax_cmd(int argc, char *argv[], char *cmdline)
 #else /* !defined(OPTION_FISHIO) */
 
     TID tid;
+    DEVTQ *q;
+    int i, devtwait, depth;
+    U64 queued, stolen;
+    static U64 lastqueued;
+    static struct timeval lasttime;
+    struct timeval now, diff;
+    U64 usecs;
 
     UNREFERENCED(cmdline);
 
@@ -4679,25 +4768,67 @@ int devtmax_cmd(int argc, char *argv[], char *cmdline)
             return -1;
         }
 
-        /* Create a new device thread if the I/O queue is not NULL
+        /* Create a new device thread if an I/O queue is not NULL
            and more threads can be created */
-
-        /* the IOQ lock is obtained in order to write to sysblk.devtwait */
         obtain_lock(&sysblk.ioqlock);
-        if (sysblk.ioq && (!sysblk.devtmax || sysblk.devtnbr < sysblk.devtmax))
+        for (i = 0; i < MAX_DEVICE_THREAD_QUEUES; i++)
+            if (sysblk.devtq[i].ioq)
+                break;
+        if (i < MAX_DEVICE_THREAD_QUEUES
+         && (!sysblk.devtmax || sysblk.devtnbr < sysblk.devtmax))
             create_thread(&tid, DETACHED, device_thread, NULL, "idle device thread");
+        release_lock(&sysblk.ioqlock);
 
         /* Wakeup threads in case they need to terminate */
-        sysblk.devtwait=0;
-        broadcast_condition (&sysblk.ioqcond);
-        release_lock(&sysblk.ioqlock);
+        device_thread_wakeup();
     }
     else
+    {
+        devtwait = depth = 0;
+        queued = stolen = 0;
+        for (i = 0; i < MAX_DEVICE_THREAD_QUEUES; i++)
+        {
+            q = &sysblk.devtq[i];
+            devtwait += q->idle;
+            depth    += q->depth;
+            queued   += q->queued;
+            stolen   += q->stolen;
+        }
+
         logmsg( _("HHCPN078E Max device threads %d current %d most %d "
             "waiting %d total I/Os queued %d\n"),
             sysblk.devtmax, sysblk.devtnbr, sysblk.devthwm,
-            sysblk.devtwait, sysblk.devtunavail
+            devtwait, sysblk.devtunavail
+        );
+
+        /* I/O rate since the previous display */
+        gettimeofday(&now, NULL);
+        timeval_subtract(&lasttime, &now, &diff);
+        usecs = (U64)diff.tv_sec * 1000000 + diff.tv_usec;
+        logmsg( _("HHCPN079I Start I/Os %" I64_FMT "u (%" I64_FMT "u/sec), "
+            "now queued %d, stolen %" I64_FMT "u\n"),
+            queued,
+            lasttime.tv_sec && usecs
+              ? ((queued - lastqueued) * 1000000) / usecs : 0,
+            depth, stolen
         );
+        lastqueued = queued;
+        lasttime = now;
+
+        logmsg( _("HHCPN079I Queue Depth   HWM  Idle       Queued     Executed"
+            "       Stolen\n") );
+        for (i = 0; i < MAX_DEVICE_THREAD_QUEUES; i++)
+        {
+            q = &sysblk.devtq[i];
+            if (!q->queued && !q->idle)
+                continue;
+            logmsg( _("HHCPN079I %5d %5d %5d %5d %12" I64_FMT "u %12" I64_FMT "u"
+                " %12" I64_FMT "u\n"),
+                i, q->depth, q->hwm, q->idle,
+                q->queued, q->executed, q->stolen
+            );
+        }
+    }
 
 #endif /* defined(OPTION_FISHIO) */
 
@@ -5629,11 +5760,275 @@ int ipending_cmd(int argc, char *argv[], char *cmdline)
 }
 
 
+#if defined(OPTION_INSTRUCTION_FUSION)
+/*-------------------------------------------------------------------*/
+/* fusion command - display or set instruction pair fusion           */
+/*-------------------------------------------------------------------*/
+int fusion_cmd(int argc, char *argv[], char *cmdline)
+{
+    UNREFERENCED(cmdline);
+
+    if (argc > 1)
+    {
+        if (strcasecmp(argv[1], "on") == 0)
+            sysblk.fusion = 1;
+        else if (strcasecmp(argv[1], "off") == 0)
+            sysblk.fusion = 0;
+        else
+        {
+            logmsg( _("HHCPN220E Invalid fusion operand %s\n"), argv[1] );
+            return -1;
+        }
+
+        /* Have each CPU rebuild its pre-decoded instructions */
+        sysblk.dcachegen++;
+    }
+    else
+        logmsg( _("HHCPN221I Instruction pair fusion is %s\n"),
+                sysblk.fusion ? "on" : "off" );
+
+    return 0;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Display or reset the instruction pair counters of all CPUs        */
+/*-------------------------------------------------------------------*/
+static void icount_fusion(int clear)
+{
+static const char *pairname[FUSED_PAIRS] = {
+    "L+LTR", "LA+BCT", "CLI+BC", "ICM+BC", "LR+AR" };
+U64     pairs[FUSED_PAIRS];             /* Adjacent pairs decoded    */
+U64     fused[FUSED_PAIRS];             /* Fused pairs executed      */
+REGS   *ctx[2];                         /* Host and guest contexts   */
+int     cpu, i, j;
+
+    memset (pairs, 0, sizeof(pairs));
+    memset (fused, 0, sizeof(fused));
+
+    for (cpu = 0; cpu < MAX_CPU; cpu++)
+    {
+        obtain_lock (&sysblk.cpulock[cpu]);
+
+        /* Include the counters of the SIE guest context */
+        ctx[0] = sysblk.regs[cpu];
+        ctx[1] = ctx[0] ? ctx[0]->guestregs : NULL;
+
+        for (j = 0; j < 2; j++)
+        {
+            if (ctx[j] == NULL || ctx[j]->dcache == NULL)
+                continue;
+            for (i = 0; i < FUSED_PAIRS; i++)
+            {
+                if (clear)
+                    ctx[j]->dcache->pairs[i] = ctx[j]->dcache->fused[i] = 0;
+                pairs[i] += ctx[j]->dcache->pairs[i];
+                fused[i] += ctx[j]->dcache->fused[i];
+            }
+        }
+
+        release_lock (&sysblk.cpulock[cpu]);
+    }
+
+    if (clear)
+    {
+        logmsg( _("HHCPN222I Instruction pair counts reset to zero.\n") );
+        return;
+    }
+
+    logmsg( _("HHCPN223I Instruction pair counts, fusion is %s:\n"),
+            sysblk.fusion ? "on" : "off" );
+    for (i = 0; i < FUSED_PAIRS; i++)
+        logmsg("          PAIR=%-6s\tDECODED=%12" I64_FMT "u"
+               "\tFUSED=%12" I64_FMT "u\n",
+               pairname[i], pairs[i], fused[i]);
+}
+#endif /*defined(OPTION_INSTRUCTION_FUSION)*/
+
+
+#if defined(OPTION_PLO_LOCKS)
+/*-------------------------------------------------------------------*/
+/* plostat command - display perform locked operation counts         */
+/*-------------------------------------------------------------------*/
+int plostat_cmd(int argc, char *argv[], char *cmdline)
+{
+static const char *fcname[PLO_FUNCS] = {
+    "CL",     "CLG",    "CLGR",    "CLX",
+    "CS",     "CSG",    "CSGR",    "CSX",
+    "DCS",    "DCSG",   "DCSGR",   "DCSX",
+    "CSST",   "CSSTG",  "CSSTGR",  "CSSTX",
+    "CSDST",  "CSDSTG", "CSDSTGR", "CSDSTX",
+    "CSTST",  "CSTSTG", "CSTSTGR", "CSTSTX" };
+U64     count[PLO_FUNCS];               /* Operations performed      */
+U64     wait[PLO_FUNCS];                /* Lock was busy             */
+REGS   *ctx[2];                         /* Host and guest contexts   */
+int     clear;                          /* 1=Reset the counts        */
+int     cpu, i, j, n;
+
+    UNREFERENCED(cmdline);
+
+    clear = argc > 1 && !strcasecmp(argv[1], "clear");
+
+    memset (count, 0, sizeof(count));
+    memset (wait, 0, sizeof(wait));
+
+    for (cpu = 0; cpu < MAX_CPU; cpu++)
+    {
+        obtain_lock (&sysblk.cpulock[cpu]);
+
+        /* Include the counters of the SIE guest context */
+        ctx[0] = sysblk.regs[cpu];
+        ctx[1] = ctx[0] ? ctx[0]->guestregs : NULL;
+
+        for (j = 0; j < 2; j++)
+        {
+            if (ctx[j] == NULL)
+                continue;
+            for (i = 0; i < PLO_FUNCS; i++)
+            {
+                if (clear)
+                    ctx[j]->plocount[i] = ctx[j]->plowait[i] = 0;
+                count[i] += ctx[j]->plocount[i];
+                wait[i] += ctx[j]->plowait[i];
+            }
+        }
+
+        release_lock (&sysblk.cpulock[cpu]);
+    }
+
+    if (clear)
+    {
+        logmsg( _("HHCPN224I PLO counts reset to zero.\n") );
+        return 0;
+    }
+
+    logmsg( _("HHCPN225I PLO counts, %d locks:\n"), OPTION_PLO_LOCKS );
+    for (i = n = 0; i < PLO_FUNCS; i++)
+    {
+        if (count[i] == 0)
+            continue;
+        logmsg("          FC=%2d %-8s\tCOUNT=%12" I64_FMT "u"
+               "\tBUSY=%12" I64_FMT "u\n",
+               i, fcname[i], count[i], wait[i]);
+        n++;
+    }
+    if (n == 0)
+        logmsg("          (none)\n");
+
+    return 0;
+}
+#endif /*defined(OPTION_PLO_LOCKS)*/
+
+
+#if defined(OPTION_TIMER_LATENCY)
+/*-------------------------------------------------------------------*/
+/* timerlat command - display timer interrupt latency histogram      */
+/*-------------------------------------------------------------------*/
+int timerlat_cmd(int argc, char *argv[], char *cmdline)
+{
+U64     count[TIMER_LAT_BUCKETS];       /* Latency histogram         */
+U64     wakes;                          /* Timer thread wakeups      */
+int     clear;                          /* 1=Reset the counts        */
+int     i, n;
+
+    UNREFERENCED(cmdline);
+
+    clear = argc > 1 && !strcasecmp(argv[1], "clear");
+
+    /* The latency counts are updated with the intlock held; the
+       timer thread counts its wakeups while CPUs run without it */
+    OBTAIN_INTLOCK(NULL);
+    memcpy (count, sysblk.timerlat, sizeof(count));
+    wakes = sysblk.timerwake;
+    if (clear)
+    {
+        memset (sysblk.timerlat, 0, sizeof(sysblk.timerlat));
+        sysblk.timerwake = 0;
+    }
+    RELEASE_INTLOCK(NULL);
+
+    if (clear)
+    {
+        logmsg( _("HHCPN230I Timer latency counts reset to zero.\n") );
+        return 0;
+    }
+
+    logmsg( _("HHCPN231I Timer interrupt latency, %" I64_FMT "u timer "
+              "thread wakeups:\n"), wakes );
+    for (i = n = 0; i < TIMER_LAT_BUCKETS; i++)
+    {
+        if (count[i] == 0)
+            continue;
+        if (i < TIMER_LAT_BUCKETS - 1)
+            logmsg("          < %6dus\tCOUNT=%12" I64_FMT "u\n",
+                   1 << i, count[i]);
+        else
+            logmsg("          >=%6dus\tCOUNT=%12" I64_FMT "u\n",
+                   1 << (i - 1), count[i]);
+        n++;
+    }
+    if (n == 0)
+        logmsg("          (none)\n");
+
+    return 0;
+}
+#endif /*defined(OPTION_TIMER_LATENCY)*/
+
+
+#if defined(OPTION_IDLE_WAIT)
+/*-------------------------------------------------------------------*/
+/* idlestat command - display CPU idle wait statistics               */
+/*-------------------------------------------------------------------*/
+int idlestat_cmd(int argc, char *argv[], char *cmdline)
+{
+REGS   *regs;                           /* CPU register context      */
+int     clear;                          /* 1=Reset the counts        */
+int     cpu;
+
+    UNREFERENCED(cmdline);
+
+    clear = argc > 1 && !strcasecmp(argv[1], "clear");
+
+    if (!clear)
+        logmsg( _("HHCPN235I CPU idle wait statistics, spin limit "
+                  "%d microsecond(s):\n"), sysblk.idlespin );
+
+    /* The counts are updated by the CPU with intlock held, and
+       cpu_uninit removes the CPU from sysblk.regs under intlock */
+    OBTAIN_INTLOCK(NULL);
+
+    for (cpu = 0; cpu < MAX_CPU; cpu++)
+    {
+        if ((regs = sysblk.regs[cpu]) == NULL)
+            continue;
+
+        if (clear)
+            regs->idlewakes = regs->idlespun =
+            regs->idlelat = regs->idlemaxlat = 0;
+        else
+            logmsg("          CPU%4.4X WAKES=%12" I64_FMT "u"
+                   " SPUN=%12" I64_FMT "u AVG=%6" I64_FMT "uus"
+                   " MAX=%8" I64_FMT "uus SPIN=%6dus\n",
+                   cpu, regs->idlewakes, regs->idlespun,
+                   regs->idlewakes ? regs->idlelat / regs->idlewakes : 0,
+                   regs->idlemaxlat, regs->idlespin);
+    }
+
+    RELEASE_INTLOCK(NULL);
+
+    if (clear)
+        logmsg( _("HHCPN234I CPU idle wait counts reset to zero.\n") );
+
+    return 0;
+}
+#endif /*defined(OPTION_IDLE_WAIT)*/
+
+
 #if defined(OPTION_INSTRUCTION_COUNTING)
 /*-------------------------------------------------------------------*/
-/* icount command - display instruction counts                       */
+/* Display or reset the individual instruction counts                */
 /*-------------------------------------------------------------------*/
-int icount_cmd(int argc, char *argv[], char *cmdline)
+static int icount_inst(int argc, char *argv[])
 {
     int i, i1, i2, i3;
     unsigned char *opcode1;
@@ -5641,8 +6036,6 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
     U64 *count;
     U64 total;
 
-    UNREFERENCED(cmdline);
-
     obtain_lock( &sysblk.icount_lock );
 
     if (argc > 1 && !strcasecmp(argv[1], "clear"))
@@ -6423,9 +6816,29 @@ int icount_cmd(int argc, char *argv[], char *cmdline)
     release_lock( &sysblk.icount_lock );
     return 0;
 }
+#endif /*defined(OPTION_INSTRUCTION_COUNTING)*/
+
 
+#if defined(OPTION_INSTRUCTION_COUNTING) || defined(OPTION_INSTRUCTION_FUSION)
+/*-------------------------------------------------------------------*/
+/* icount command - display instruction counts                       */
+/*-------------------------------------------------------------------*/
+int icount_cmd(int argc, char *argv[], char *cmdline)
+{
+    UNREFERENCED(cmdline);
+
+#if defined(OPTION_INSTRUCTION_COUNTING)
+    icount_inst(argc, argv);
 #endif /*defined(OPTION_INSTRUCTION_COUNTING)*/
 
+#if defined(OPTION_INSTRUCTION_FUSION)
+    icount_fusion(argc > 1 && !strcasecmp(argv[1], "clear"));
+#endif /*defined(OPTION_INSTRUCTION_FUSION)*/
+
+    return 0;
+}
+#endif /*defined(OPTION_INSTRUCTION_COUNTING) || defined(OPTION_INSTRUCTION_FUSION)*/
+
 
 #if defined(OPTION_CONFIG_SYMBOLS)
 /*-------------------------------------------------------------------*/
@@ -6839,6 +7252,9 @@ DLL_EXPORT int aia_cmd(int argc, char *argv[], char *cmdline)
 /*   with (i << shift) The "main" field of the tlb contains an XOR   */
 /*   hash of effective address. So MAINADDR() macro is used to remove*/
 /*   the hash before it's displayed.                                 */
+/*   Entries 000-3FF are the first way of each TLB set and entries   */
+/*   400-7FF are the second way, so the index within the set is      */
+/*   (i & TLB_MASK).                                                 */
 /*                                                                   */
 int tlb_cmd(int argc, char *argv[], char *cmdline)
 {
@@ -6870,22 +7286,30 @@ int tlb_cmd(int argc, char *argv[], char *cmdline)
 
     logmsg ("tlbID 0x%6.6x mainstor %p\n",regs->tlbID,regs->mainstor);
     logmsg ("  ix              asd            vaddr              pte   id c p r w ky       main\n");
-    for (i = 0; i < TLBN; i++)
+    for (i = 0; i < TLBE; i++)
     {
         logmsg("%s%3.3x %16.16" I64_FMT "x %16.16" I64_FMT "x %16.16" I64_FMT "x %4.4x %1d %1d %1d %1d %2.2x %8.8x\n",
          ((regs->tlb.TLB_VADDR_G(i) & bytemask) == regs->tlbID ? "*" : " "),
          i,regs->tlb.TLB_ASD_G(i),
-         ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (i << shift)),
+         ((regs->tlb.TLB_VADDR_G(i) & pagemask) | ((i & TLB_MASK) << shift)),
          regs->tlb.TLB_PTE_G(i),(int)(regs->tlb.TLB_VADDR_G(i) & bytemask),
          regs->tlb.common[i],regs->tlb.protect[i],
          (regs->tlb.acc[i] & ACC_READ) != 0,(regs->tlb.acc[i] & ACC_WRITE) != 0,
          regs->tlb.skey[i],
          MAINADDR(regs->tlb.main[i],
-                  ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (i << shift)))
+                  ((regs->tlb.TLB_VADDR_G(i) & pagemask) | ((i & TLB_MASK) << shift)))
                   - regs->mainstor);
         matches += ((regs->tlb.TLB_VADDR(i) & bytemask) == regs->tlbID);
     }
     logmsg("%d tlbID matches\n", matches);
+    logmsg("hits %" I64_FMT "u (second way %" I64_FMT "u) misses %" I64_FMT "u"
+           " purges %" I64_FMT "u selective %" I64_FMT "u\n",
+           regs->tlbhit, regs->tlbhit2, regs->tlbmiss,
+           regs->tlbpurge, regs->tlbpurgesel);
+#if defined(OPTION_PAGE_WALK_CACHE)
+    logmsg("page-walk cache segment hits %" I64_FMT "u region hits %" I64_FMT "u\n",
+           regs->pwcseghit, regs->pwcreghit);
+#endif /*defined(OPTION_PAGE_WALK_CACHE)*/
 
     if (regs->sie_active)
     {
@@ -6898,22 +7322,30 @@ int tlb_cmd(int argc, char *argv[], char *cmdline)
 
         logmsg ("\nSIE: tlbID 0x%4.4x mainstor %p\n",regs->tlbID,regs->mainstor);
         logmsg ("  ix              asd            vaddr              pte   id c p r w ky       main\n");
-        for (i = matches = 0; i < TLBN; i++)
+        for (i = matches = 0; i < TLBE; i++)
         {
             logmsg("%s%3.3x %16.16" I64_FMT "x %16.16" I64_FMT "x %16.16" I64_FMT "x %4.4x %1d %1d %1d %1d %2.2x %p\n",
              ((regs->tlb.TLB_VADDR_G(i) & bytemask) == regs->tlbID ? "*" : " "),
              i,regs->tlb.TLB_ASD_G(i),
-             ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (i << shift)),
+             ((regs->tlb.TLB_VADDR_G(i) & pagemask) | ((i & TLB_MASK) << shift)),
              regs->tlb.TLB_PTE_G(i),(int)(regs->tlb.TLB_VADDR_G(i) & bytemask),
              regs->tlb.common[i],regs->tlb.protect[i],
              (regs->tlb.acc[i] & ACC_READ) != 0,(regs->tlb.acc[i] & ACC_WRITE) != 0,
              regs->tlb.skey[i],
              MAINADDR(regs->tlb.main[i],
-                     ((regs->tlb.TLB_VADDR_G(i) & pagemask) | (i << shift)))
+                     ((regs->tlb.TLB_VADDR_G(i) & pagemask) | ((i & TLB_MASK) << shift)))
                     - regs->mainstor);
             matches += ((regs->tlb.TLB_VADDR(i) & bytemask) == regs->tlbID);
         }
         logmsg("SIE: %d tlbID matches\n", matches);
+        logmsg("SIE: hits %" I64_FMT "u (second way %" I64_FMT "u) misses %" I64_FMT "u"
+               " purges %" I64_FMT "u selective %" I64_FMT "u\n",
+               regs->tlbhit, regs->tlbhit2, regs->tlbmiss,
+               regs->tlbpurge, regs->tlbpurgesel);
+#if defined(OPTION_PAGE_WALK_CACHE)
+        logmsg("SIE: page-walk cache segment hits %" I64_FMT "u region hits %" I64_FMT "u\n",
+               regs->pwcseghit, regs->pwcreghit);
+#endif /*defined(OPTION_PAGE_WALK_CACHE)*/
     }
 
     release_lock (&sysblk.cpulock[sysblk.pcpu]);
@@ -7162,7 +7594,7 @@ int sizeof_cmd(int argc, char *argv[], char *cmdline)
     logmsg(_("HHCPN161I REGS (copy len) ...%7d\n"),sysblk.regs_copy_len);
     logmsg(_("HHCPN161I PSW ...............%7d\n"),sizeof(PSW));
     logmsg(_("HHCPN161I DEVBLK ............%7d\n"),sizeof(DEVBLK));
-    logmsg(_("HHCPN161I TLB entry .........%7d\n"),sizeof(TLB)/TLBN);
+    logmsg(_("HHCPN161I TLB entry .........%7d\n"),sizeof(TLB)/TLBE);
     logmsg(_("HHCPN161I TLB table .........%7d\n"),sizeof(TLB));
     logmsg(_("HHCPN161I FILENAME_MAX ......%7d\n"),FILENAME_MAX);
     logmsg(_("HHCPN161I PATH_MAX ..........%7d\n"),PATH_MAX);
@@ -655,7 +655,8 @@ static REGS  *copy_regs (REGS *regs)
 
     /* Perform partial copy and clear the TLB */
     memcpy(newregs, regs, sysblk.regs_copy_len);
-    memset(&newregs->tlb.vaddr, 0, TLBN * sizeof(DW));
+    memset(&newregs->tlb.vaddr, 0, TLBE * sizeof(DW));
+    PURGE_PWC(newregs);
     newregs->tlbID = 1;
     newregs->ghostregs = 1;
     newregs->hostregs = newregs;
@@ -668,7 +669,8 @@ static REGS  *copy_regs (REGS *regs)
     {
         hostregs = newregs + 1;
         memcpy(hostregs, regs->hostregs, sysblk.regs_copy_len);
-        memset(&hostregs->tlb.vaddr, 0, TLBN * sizeof(DW));
+        memset(&hostregs->tlb.vaddr, 0, TLBE * sizeof(DW));
+        PURGE_PWC(hostregs);
         hostregs->tlbID = 1;
         hostregs->ghostregs = 1;
         hostregs->hostregs = hostregs;
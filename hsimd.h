@@ -0,0 +1,598 @@
+/* HSIMD.H      Host vector kernels for storage operand loops        */
+
+/*   Released under the Q Public License                             */
+/*      (http://www.hercules-390.org/herclic.html)                   */
+/*   as modifications to Hercules.                                   */
+
+/*-------------------------------------------------------------------*/
+/*                                                                   */
+/* This header file contains the inner loops of instructions that    */
+/* process long storage operands, once the operands have been        */
+/* resolved to mainstor pointers:                                    */
+/*                                                                   */
+/*   hsimd_tr     dst[i] = tab[src[i]] for i = 0 .. len-1            */
+/*   hsimd_trt    index of the first src[i] with tab[src[i]] != 0    */
+/*   hsimd_trtr   index of the last src[i] with tab[src[i]] != 0     */
+/*   hsimd_cmp    index of the first a[i] != b[i]                    */
+/*   hsimd_cmp_pad  index of the first a[i] != pad                   */
+/*   hsimd_match  index of the first a[i] == b[i]                    */
+/*   hsimd_srchu  index of the first halfword equal to c             */
+/*   hsimd_cksm   sum of big-endian fullwords, without carry folding */
+/*   hsimd_copy_avx2  doubleword concurrent copy, used by concpy     */
+/*                                                                   */
+/* The translate-and-test scans return -1 if no byte selects a       */
+/* non-zero function byte, and the compares and searches return      */
+/* len if no byte qualifies.  The caller must ensure that a          */
+/* translate table is addressable as a single 256 byte block.        */
+/*                                                                   */
+/* When OPTION_HOST_SIMD is defined the vector loops are compiled    */
+/* with a function target attribute, so the rest of Hercules is      */
+/* still built for the baseline instruction set.  The loop is chosen */
+/* at run time from the host cpu features recorded in hostinfo, and  */
+/* the plain C loop is used for short operands and on other hosts.   */
+/*                                                                   */
+/* A 256 byte table cannot be held in one vector register, so TR     */
+/* does sixteen 16-byte VPSHUFB lookups per vector, one for each     */
+/* high order nibble, arranged so that all but one return zero.      */
+/* That only beats the byte loop with 32 byte AVX2 vectors and       */
+/* longer operands, so there is no SSSE3 version of TR.  TRT only    */
+/* needs to know whether a function byte is zero, so the table is    */
+/* first reduced to a 256 bit map held in two registers and each     */
+/* argument byte is tested with three PSHUFB lookups; it has SSSE3   */
+/* and AVX2 versions.  The compares, searches, checksum and copy     */
+/* have AVX2 versions only.  SRST has no kernel here as the C        */
+/* library memchr is already vectorized for the host.                */
+/*                                                                   */
+/*-------------------------------------------------------------------*/
+
+#ifndef _HSIMD_H
+#define _HSIMD_H
+
+#if defined(OPTION_HOST_SIMD)
+#include <immintrin.h>
+#endif
+
+/* Operands shorter than these are handled by the plain C loops      */
+#define HSIMD_TR_MINLEN     128
+#define HSIMD_TRT_MINLEN    32
+#define HSIMD_CMP_MINLEN    32
+#define HSIMD_COPY_MINLEN   256
+
+#if defined(OPTION_HOST_SIMD)
+
+/*-------------------------------------------------------------------*/
+/* SSSE3 kernels                                                     */
+/*-------------------------------------------------------------------*/
+/* Reduce the table to a bit map: bit h of lo[l] (h < 8) or of hi[l] */
+/* (h >= 8) is one if tab[16*h+l] is non-zero                        */
+static __inline__ __attribute__((target("ssse3")))
+void hsimd_trt_map_ssse3 (const BYTE *tab, __m128i *lo, __m128i *hi)
+{
+__m128i z = _mm_setzero_si128();        /* Zero vector               */
+__m128i m[2];                           /* Bit map halves            */
+__m128i c;                              /* Table slice               */
+int     h;                              /* High order nibble         */
+
+    m[0] = m[1] = z;
+    for (h = 0; h < 16; h++)
+    {
+        c = _mm_loadu_si128((const __m128i *)(tab + 16*h));
+        c = _mm_andnot_si128(_mm_cmpeq_epi8(c, z),
+                             _mm_set1_epi8(1 << (h & 7)));
+        m[h >> 3] = _mm_or_si128(m[h >> 3], c);
+    }
+    *lo = m[0];
+    *hi = m[1];
+}
+
+/* Return a mask with one bit set for each byte of x that selects a  */
+/* non-zero function byte                                            */
+static __inline__ __attribute__((target("ssse3")))
+int hsimd_trt_test_ssse3 (__m128i x, __m128i mlo, __m128i mhi)
+{
+__m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128,
+                             1, 2, 4, 8, 16, 32, 64, (char)128);
+__m128i row, bit, idx;                  /* Work vectors              */
+
+    /* PSHUFB returns zero for indexes with bit 0x80 set, so masking */
+    /* with 0x8F selects the low map for bytes 00-7F and flipping    */
+    /* bit 0x80 selects the high map for bytes 80-FF                 */
+    idx = _mm_and_si128(x, _mm_set1_epi8((char)0x8F));
+    row = _mm_or_si128(_mm_shuffle_epi8(mlo, idx),
+              _mm_shuffle_epi8(mhi,
+                  _mm_xor_si128(idx, _mm_set1_epi8((char)0x80))));
+    bit = _mm_shuffle_epi8(bits,
+              _mm_and_si128(_mm_srli_epi16(x, 4), _mm_set1_epi8(0x07)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit),
+                                            _mm_setzero_si128())) ^ 0xFFFF;
+}
+
+static __inline__ __attribute__((target("ssse3")))
+int hsimd_trt_ssse3 (const BYTE *src, int len, const BYTE *tab)
+{
+__m128i mlo, mhi;                       /* Function byte bit map     */
+int     i, m;                           /* Work variables            */
+
+    hsimd_trt_map_ssse3(tab, &mlo, &mhi);
+
+    for (i = 0; i + 16 <= len; i += 16)
+    {
+        m = hsimd_trt_test_ssse3(
+                _mm_loadu_si128((const __m128i *)(src + i)), mlo, mhi);
+        if (m)
+            return i + __builtin_ctz(m);
+    }
+
+    for ( ; i < len; i++)
+        if (tab[src[i]])
+            return i;
+
+    return -1;
+}
+
+static __inline__ __attribute__((target("ssse3")))
+int hsimd_trtr_ssse3 (const BYTE *src, int len, const BYTE *tab)
+{
+__m128i mlo, mhi;                       /* Function byte bit map     */
+int     i, m;                           /* Work variables            */
+
+    hsimd_trt_map_ssse3(tab, &mlo, &mhi);
+
+    for (i = len; i >= 16; i -= 16)
+    {
+        m = hsimd_trt_test_ssse3(
+                _mm_loadu_si128((const __m128i *)(src + i - 16)), mlo, mhi);
+        if (m)
+            return i - 16 + 31 - __builtin_clz(m);
+    }
+
+    while (i-- > 0)
+        if (tab[src[i]])
+            return i;
+
+    return -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* AVX2 kernels                                                      */
+/*-------------------------------------------------------------------*/
+static __inline__ __attribute__((target("avx2")))
+void hsimd_tr_avx2 (BYTE *dst, const BYTE *src, int len, const BYTE *tab)
+{
+__m256i t[16];                          /* Table in 16 byte slices   */
+__m256i c70 = _mm256_set1_epi8(0x70);   /* Index saturation bias     */
+__m256i c16 = _mm256_set1_epi8(16);     /* Slice decrement           */
+__m256i x, r;                           /* Work vectors              */
+int     i, j;                           /* Work variables            */
+
+    /* VPSHUFB looks up within each 128 bit lane, so each slice of   */
+    /* the table is loaded into both lanes                           */
+    for (j = 0; j < 16; j++)
+        t[j] = _mm256_broadcastsi128_si256(
+                   _mm_loadu_si128((const __m128i *)(tab + 16*j)));
+
+    for (i = 0; i + 32 <= len; i += 32)
+    {
+        x = _mm256_loadu_si256((const __m256i *)(src + i));
+        r = _mm256_setzero_si256();
+        for (j = 0; j < 16; j++)
+        {
+            /* x holds the argument less 16*j, whose high order   */
+            /* nibble is zero only for arguments in slice j.      */
+            /* Adding 0x70 with unsigned saturation sets bit 0x80 */
+            /* for every other argument, so VPSHUFB returns zero  */
+            r = _mm256_or_si256(r,
+                    _mm256_shuffle_epi8(t[j], _mm256_adds_epu8(x, c70)));
+            x = _mm256_sub_epi8(x, c16);
+        }
+        _mm256_storeu_si256((__m256i *)(dst + i), r);
+    }
+
+    for ( ; i < len; i++)
+        dst[i] = tab[src[i]];
+}
+
+static __inline__ __attribute__((target("avx2")))
+void hsimd_trt_map_avx2 (const BYTE *tab, __m256i *lo, __m256i *hi)
+{
+__m128i z = _mm_setzero_si128();        /* Zero vector               */
+__m128i m[2];                           /* Bit map halves            */
+__m128i c;                              /* Table slice               */
+int     h;                              /* High order nibble         */
+
+    m[0] = m[1] = z;
+    for (h = 0; h < 16; h++)
+    {
+        c = _mm_loadu_si128((const __m128i *)(tab + 16*h));
+        c = _mm_andnot_si128(_mm_cmpeq_epi8(c, z),
+                             _mm_set1_epi8(1 << (h & 7)));
+        m[h >> 3] = _mm_or_si128(m[h >> 3], c);
+    }
+    *lo = _mm256_broadcastsi128_si256(m[0]);
+    *hi = _mm256_broadcastsi128_si256(m[1]);
+}
+
+static __inline__ __attribute__((target("avx2")))
+U32 hsimd_trt_test_avx2 (__m256i x, __m256i mlo, __m256i mhi)
+{
+__m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128,
+                                1, 2, 4, 8, 16, 32, 64, (char)128,
+                                1, 2, 4, 8, 16, 32, 64, (char)128,
+                                1, 2, 4, 8, 16, 32, 64, (char)128);
+__m256i row, bit, idx;                  /* Work vectors              */
+
+    idx = _mm256_and_si256(x, _mm256_set1_epi8((char)0x8F));
+    row = _mm256_or_si256(_mm256_shuffle_epi8(mlo, idx),
+              _mm256_shuffle_epi8(mhi,
+                  _mm256_xor_si256(idx, _mm256_set1_epi8((char)0x80))));
+    bit = _mm256_shuffle_epi8(bits,
+              _mm256_and_si256(_mm256_srli_epi16(x, 4),
+                               _mm256_set1_epi8(0x07)));
+    return ~(U32)_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(_mm256_and_si256(row, bit),
+                                  _mm256_setzero_si256()));
+}
+
+static __inline__ __attribute__((target("avx2")))
+int hsimd_trt_avx2 (const BYTE *src, int len, const BYTE *tab)
+{
+__m256i mlo, mhi;                       /* Function byte bit map     */
+U32     m;                              /* Hit mask                  */
+int     i;                              /* Work variable             */
+
+    hsimd_trt_map_avx2(tab, &mlo, &mhi);
+
+    for (i = 0; i + 32 <= len; i += 32)
+    {
+        m = hsimd_trt_test_avx2(
+                _mm256_loadu_si256((const __m256i *)(src + i)), mlo, mhi);
+        if (m)
+            return i + __builtin_ctz(m);
+    }
+
+    for ( ; i < len; i++)
+        if (tab[src[i]])
+            return i;
+
+    return -1;
+}
+
+static __inline__ __attribute__((target("avx2")))
+int hsimd_trtr_avx2 (const BYTE *src, int len, const BYTE *tab)
+{
+__m256i mlo, mhi;                       /* Function byte bit map     */
+U32     m;                              /* Hit mask                  */
+int     i;                              /* Work variable             */
+
+    hsimd_trt_map_avx2(tab, &mlo, &mhi);
+
+    for (i = len; i >= 32; i -= 32)
+    {
+        m = hsimd_trt_test_avx2(
+                _mm256_loadu_si256((const __m256i *)(src + i - 32)), mlo, mhi);
+        if (m)
+            return i - 32 + 31 - __builtin_clz(m);
+    }
+
+    while (i-- > 0)
+        if (tab[src[i]])
+            return i;
+
+    return -1;
+}
+
+static __inline__ __attribute__((target("avx2")))
+int hsimd_cmp_avx2 (const BYTE *a, const BYTE *b, int len)
+{
+U32     m;                              /* Unequal byte mask         */
+int     i;                              /* Work variable             */
+
+    for (i = 0; i + 32 <= len; i += 32)
+    {
+        m = ~(U32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i *)(a + i)),
+                _mm256_loadu_si256((const __m256i *)(b + i))));
+        if (m)
+            return i + __builtin_ctz(m);
+    }
+
+    for ( ; i < len && a[i] == b[i]; i++);
+
+    return i;
+}
+
+static __inline__ __attribute__((target("avx2")))
+int hsimd_cmp_pad_avx2 (const BYTE *a, BYTE pad, int len)
+{
+__m256i p = _mm256_set1_epi8((char)pad); /* Padding bytes            */
+U32     m;                              /* Unequal byte mask         */
+int     i;                              /* Work variable             */
+
+    for (i = 0; i + 32 <= len; i += 32)
+    {
+        m = ~(U32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i *)(a + i)), p));
+        if (m)
+            return i + __builtin_ctz(m);
+    }
+
+    for ( ; i < len && a[i] == pad; i++);
+
+    return i;
+}
+
+static __inline__ __attribute__((target("avx2")))
+int hsimd_match_avx2 (const BYTE *a, const BYTE *b, int len)
+{
+U32     m;                              /* Equal byte mask           */
+int     i;                              /* Work variable             */
+
+    for (i = 0; i + 32 <= len; i += 32)
+    {
+        m = (U32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i *)(a + i)),
+                _mm256_loadu_si256((const __m256i *)(b + i))));
+        if (m)
+            return i + __builtin_ctz(m);
+    }
+
+    for ( ; i < len && a[i] != b[i]; i++);
+
+    return i;
+}
+
+/* Each matching halfword sets two adjacent bits of the mask, and    */
+/* halfwords are compared at even offsets from p, so the index of    */
+/* the first match is half the number of trailing zeroes             */
+static __inline__ __attribute__((target("avx2")))
+int hsimd_srchu_avx2 (BYTE *p, U16 c, int len)
+{
+__m256i t = _mm256_set1_epi16((short)CSWAP16(c)); /* Search value   */
+U32     m;                              /* Equal halfword mask       */
+int     i;                              /* Work variable             */
+
+    for (i = 0; i + 16 <= len; i += 16)
+    {
+        m = (U32)_mm256_movemask_epi8(_mm256_cmpeq_epi16(
+                _mm256_loadu_si256((const __m256i *)(p + 2*i)), t));
+        if (m)
+            return i + (__builtin_ctz(m) >> 1);
+    }
+
+    for ( ; i < len && fetch_hw(p + 2*i) != c; i++);
+
+    return i;
+}
+
+/* The fullwords are byte swapped and added into four doubleword     */
+/* accumulators, each of which can take 2**32 fullwords without      */
+/* overflowing                                                       */
+static __inline__ __attribute__((target("avx2")))
+U64 hsimd_cksm_avx2 (const BYTE *p, int nwords)
+{
+__m256i swap = _mm256_setr_epi8( 3,  2,  1,  0,  7,  6,  5,  4,
+                                11, 10,  9,  8, 15, 14, 13, 12,
+                                 3,  2,  1,  0,  7,  6,  5,  4,
+                                11, 10,  9,  8, 15, 14, 13, 12);
+__m256i low = _mm256_set1_epi64x(0xFFFFFFFFLL); /* Low word mask    */
+__m256i acc = _mm256_setzero_si256();   /* Doubleword sums           */
+__m256i x;                              /* Eight fullwords           */
+__m128i s;                              /* Horizontal sum            */
+U64     sum;                            /* Result                    */
+int     i;                              /* Work variable             */
+
+    for (i = 0; i + 8 <= nwords; i += 8)
+    {
+        x = _mm256_shuffle_epi8(
+                _mm256_loadu_si256((const __m256i *)(p + 4*i)), swap);
+        acc = _mm256_add_epi64(acc, _mm256_and_si256(x, low));
+        acc = _mm256_add_epi64(acc, _mm256_srli_epi64(x, 32));
+    }
+
+    s = _mm_add_epi64(_mm256_castsi256_si128(acc),
+                      _mm256_extracti128_si256(acc, 1));
+    sum = (U64)_mm_cvtsi128_si64(s)
+        + (U64)_mm_cvtsi128_si64(_mm_unpackhi_epi64(s, s));
+
+    for ( ; i < nwords; i++)
+        sum += fetch_fw(p + 4*i);
+
+    return sum;
+}
+
+/* Copy len bytes between operands that do not overlap.  The         */
+/* destination is brought to a 32 byte boundary with doubleword      */
+/* moves and is then stored with aligned 32 byte VMOVDQA, which      */
+/* never splits an aligned doubleword, so each doubleword of the     */
+/* destination is updated concurrently as with concpy                */
+static __inline__ __attribute__((target("avx2")))
+void hsimd_copy_avx2 (BYTE *dest, const BYTE *src, int len)
+{
+    for ( ; (intptr_t)dest & 7; len--)
+        *(dest++) = *(src++);
+    for ( ; (intptr_t)dest & 31; len -= 8, dest += 8, src += 8)
+        *(U64 *)dest = *(const U64 *)src;
+
+    for ( ; len >= 32; len -= 32, dest += 32, src += 32)
+        _mm256_store_si256((__m256i *)dest,
+                           _mm256_loadu_si256((const __m256i *)src));
+
+    for ( ; len >= 8; len -= 8, dest += 8, src += 8)
+        *(U64 *)dest = *(const U64 *)src;
+    for ( ; len; len--)
+        *(dest++) = *(src++);
+}
+
+#endif /*defined(OPTION_HOST_SIMD)*/
+
+/*-------------------------------------------------------------------*/
+/* Translate len bytes from src to dst (src and dst may be equal).   */
+/* The vector loop holds the table in registers, so a table that     */
+/* overlaps dst, and may be changed by the translation itself, is    */
+/* always translated by the byte loop.                               */
+/*-------------------------------------------------------------------*/
+static __inline__ void hsimd_tr (BYTE *dst, const BYTE *src, int len,
+                                 const BYTE *tab)
+{
+int     i;                              /* Work variable             */
+
+#if defined(OPTION_HOST_SIMD)
+    if (len >= HSIMD_TR_MINLEN && hostinfo.avx2_avail
+     && (tab >= dst + len || tab + 256 <= dst))
+    {
+        hsimd_tr_avx2(dst, src, len, tab);
+        return;
+    }
+#endif /*defined(OPTION_HOST_SIMD)*/
+
+    for (i = 0; i < len; i++)
+        dst[i] = tab[src[i]];
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the index of the first byte that selects a non-zero        */
+/* function byte, or -1                                              */
+/*-------------------------------------------------------------------*/
+static __inline__ int hsimd_trt (const BYTE *src, int len, const BYTE *tab)
+{
+int     i;                              /* Work variable             */
+
+#if defined(OPTION_HOST_SIMD)
+    if (len >= HSIMD_TRT_MINLEN)
+    {
+        if (hostinfo.avx2_avail)
+            return hsimd_trt_avx2(src, len, tab);
+        if (hostinfo.ssse3_avail)
+            return hsimd_trt_ssse3(src, len, tab);
+    }
+#endif /*defined(OPTION_HOST_SIMD)*/
+
+    for (i = 0; i < len; i++)
+        if (tab[src[i]])
+            return i;
+
+    return -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the index of the last byte that selects a non-zero         */
+/* function byte, or -1                                              */
+/*-------------------------------------------------------------------*/
+static __inline__ int hsimd_trtr (const BYTE *src, int len, const BYTE *tab)
+{
+int     i;                              /* Work variable             */
+
+#if defined(OPTION_HOST_SIMD)
+    if (len >= HSIMD_TRT_MINLEN)
+    {
+        if (hostinfo.avx2_avail)
+            return hsimd_trtr_avx2(src, len, tab);
+        if (hostinfo.ssse3_avail)
+            return hsimd_trtr_ssse3(src, len, tab);
+    }
+#endif /*defined(OPTION_HOST_SIMD)*/
+
+    for (i = len - 1; i >= 0; i--)
+        if (tab[src[i]])
+            return i;
+
+    return -1;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the index of the first unequal byte, or len                */
+/*-------------------------------------------------------------------*/
+static __inline__ int hsimd_cmp (const BYTE *a, const BYTE *b, int len)
+{
+int     i, n;                           /* Work variables            */
+
+#if defined(OPTION_HOST_SIMD)
+    if (len >= HSIMD_CMP_MINLEN && hostinfo.avx2_avail)
+        return hsimd_cmp_avx2(a, b, len);
+#endif /*defined(OPTION_HOST_SIMD)*/
+
+    /* Locate the first unequal 256 byte block, then the byte */
+    for (i = 0; i < len; i += n)
+    {
+        n = len - i < 256 ? len - i : 256;
+        if (memcmp(a + i, b + i, n))
+            break;
+    }
+
+    for ( ; i < len && a[i] == b[i]; i++);
+
+    return i;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the index of the first byte not equal to pad, or len       */
+/*-------------------------------------------------------------------*/
+static __inline__ int hsimd_cmp_pad (const BYTE *a, BYTE pad, int len)
+{
+int     i;                              /* Work variable             */
+
+#if defined(OPTION_HOST_SIMD)
+    if (len >= HSIMD_CMP_MINLEN && hostinfo.avx2_avail)
+        return hsimd_cmp_pad_avx2(a, pad, len);
+#endif /*defined(OPTION_HOST_SIMD)*/
+
+    for (i = 0; i < len && a[i] == pad; i++);
+
+    return i;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the index of the first equal byte, or len                  */
+/*-------------------------------------------------------------------*/
+static __inline__ int hsimd_match (const BYTE *a, const BYTE *b, int len)
+{
+int     i;                              /* Work variable             */
+
+#if defined(OPTION_HOST_SIMD)
+    if (len >= HSIMD_CMP_MINLEN && hostinfo.avx2_avail)
+        return hsimd_match_avx2(a, b, len);
+#endif /*defined(OPTION_HOST_SIMD)*/
+
+    for (i = 0; i < len && a[i] != b[i]; i++);
+
+    return i;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the index of the first of len big-endian halfwords that    */
+/* is equal to c, or len                                             */
+/*-------------------------------------------------------------------*/
+static __inline__ int hsimd_srchu (BYTE *p, U16 c, int len)
+{
+int     i;                              /* Work variable             */
+
+#if defined(OPTION_HOST_SIMD)
+    if (len >= HSIMD_CMP_MINLEN / 2 && hostinfo.avx2_avail)
+        return hsimd_srchu_avx2(p, c, len);
+#endif /*defined(OPTION_HOST_SIMD)*/
+
+    for (i = 0; i < len && fetch_hw(p + 2*i) != c; i++);
+
+    return i;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return the sum of nwords big-endian fullwords                     */
+/*-------------------------------------------------------------------*/
+static __inline__ U64 hsimd_cksm (const BYTE *p, int nwords)
+{
+U64     sum = 0;                        /* Result                    */
+int     i;                              /* Work variable             */
+
+#if defined(OPTION_HOST_SIMD)
+    if (nwords >= HSIMD_CMP_MINLEN / 4 && hostinfo.avx2_avail)
+        return hsimd_cksm_avx2(p, nwords);
+#endif /*defined(OPTION_HOST_SIMD)*/
+
+    for (i = 0; i < nwords; i++)
+        sum += fetch_fw(p + 4*i);
+
+    return sum;
+}
+
+#endif /*_HSIMD_H*/
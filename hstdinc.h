@@ -153,6 +153,18 @@
     #define HET_BZIP2
   #endif
 #endif
+#ifdef HAVE_ZSTD_H
+  #include <zstd.h>
+  #if !defined(HAVE_CONFIG_H)
+    #define CCKD_ZSTD
+  #endif
+#endif
+#ifdef HAVE_LZ4_H
+  #include <lz4.h>
+  #if !defined(HAVE_CONFIG_H)
+    #define CCKD_LZ4
+  #endif
+#endif
 #ifdef HAVE_DIRENT_H
   #include <dirent.h>
 #endif
@@ -209,6 +221,13 @@
 #ifdef HAVE_SYS_PRCTL_H
   #include <sys/prctl.h>
 #endif
+#ifdef HAVE_LINUX_IO_URING_H
+  #include <linux/io_uring.h>
+  #include <sys/syscall.h>
+#endif
+#if defined(OPTION_STORAGE_POLICY)
+  #include <sys/syscall.h>
+#endif
 
 // Some Hercules specific files, NOT guest arch dependent
 #if defined(_MSVC_)
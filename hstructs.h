@@ -210,6 +210,8 @@ struct REGS {                           /* Processor registers       */
         CPU_BITMAP cpubit;              /* Only this CPU's bit is 1  */
         U32     ints_state;             /* CPU Interrupts Status     */
         U32     ints_mask;              /* Respective Interrupts Mask*/
+        U32     iopostseen;             /* sysblk.iopost when last
+                                           checked for I/O interrupt */
      /*
       * Making the following flags 'stand-alone' (instead of bit-
       * flags like they were) addresses a compiler bit-flag serial-
@@ -242,6 +244,18 @@ struct REGS {                           /* Processor registers       */
                                            CPU thread exit           */
         COND    intcond;                /* CPU interrupt condition   */
         LOCK    *cpulock;               /* CPU lock for this CPU     */
+#if defined(OPTION_IDLE_WAIT)
+        LOCK    idlelock;               /* Idle wait lock            */
+        COND    idlecond;               /* Idle wait condition       */
+        int     idlewait;               /* 1=In enabled wait state   */
+        int     idlepost;               /* 1=Woken from idle wait    */
+        int     idlespin;               /* Current spin limit (us)   */
+        U64     idleposttod;            /* Time of day of wakeup (us)*/
+        U64     idlewakes;              /* Idle wait wakeups         */
+        U64     idlespun;               /* ...while still spinning   */
+        U64     idlelat;                /* Total wakeup latency (us) */
+        U64     idlemaxlat;             /* Maximum wakeup latency    */
+#endif /*defined(OPTION_IDLE_WAIT)*/
 
      /* Mainstor address lookup accelerator                          */
 
@@ -352,11 +366,37 @@ struct REGS {                           /* Processor registers       */
                *z900_opcode_ecxx,
                *z900_opcode_edxx;
 
+#if defined(OPTION_DECODE_CACHE)
+        DCACHE *dcache;                 /* Pre-decoded instructions  */
+#endif /*defined(OPTION_DECODE_CACHE)*/
+
+#if defined(OPTION_CMPSC_DICT_CACHE)
+        CMPSCDC *cmpscdc;               /* CMPSC dictionary cache    */
+#endif /*defined(OPTION_CMPSC_DICT_CACHE)*/
+
+#if defined(OPTION_PLO_LOCKS)
+        LOCK   *plolock;                /* PLO lock held or NULL     */
+        U64     plocount[PLO_FUNCS];    /* PLO count by function code*/
+        U64     plowait[PLO_FUNCS];     /* PLO lock was busy count   */
+#endif /*defined(OPTION_PLO_LOCKS)*/
+
      /* TLB - Translation lookaside buffer                           */
 
         unsigned int tlbID;             /* Validation identifier     */
+        U64     tlbhit;                 /* Translations found in TLB */
+        U64     tlbhit2;                /* ...found in second way    */
+        U64     tlbmiss;                /* Translations not in TLB   */
+        U64     tlbpurge;               /* Full TLB purges           */
+        U64     tlbpurgesel;            /* Selective TLB purges      */
         TLB     tlb;                    /* Translation lookaside buf */
 
+#if defined(OPTION_PAGE_WALK_CACHE)
+        U64     pwcseghit;              /* Misses found in segment
+                                           part of page-walk cache   */
+        U64     pwcreghit;              /* ...found in region part   */
+        PWC     pwc;                    /* Page-walk cache           */
+#endif /*defined(OPTION_PAGE_WALK_CACHE)*/
+
 };
 
 /*-------------------------------------------------------------------*/
@@ -373,6 +413,100 @@ struct VFREGS {                          /* Vector Facility Registers*/
 };
 #endif /*defined(_FEATURE_VECTOR_FACILITY)*/
 
+#if defined(OPTION_DECODE_CACHE)
+/*-------------------------------------------------------------------*/
+/* Pre-decoded instruction cache                                     */
+/*                                                                   */
+/* Each entry holds the eight bytes found at an instruction address  */
+/* together with the handler that the first and second level opcode  */
+/* tables resolve those bytes to.  Entries are direct-mapped on the  */
+/* mainstor address of the instruction but are tagged only by the    */
+/* instruction bytes: they are compared before each use, so an entry */
+/* is rebuilt after any store to it by a CPU or a channel program.   */
+/*-------------------------------------------------------------------*/
+struct DCENT {                          /* Decode cache entry        */
+        U64     key;                    /* Instruction bytes 0-7     */
+        FUNC    func;                   /* Resolved handler          */
+};
+
+#if defined(OPTION_INSTRUCTION_FUSION)
+#define FUSED_L_LTR     0               /* L   followed by LTR       */
+#define FUSED_LA_BCT    1               /* LA  followed by BCT       */
+#define FUSED_CLI_BC    2               /* CLI followed by BC        */
+#define FUSED_ICM_BC    3               /* ICM followed by BC        */
+#define FUSED_LR_AR     4               /* LR  followed by AR        */
+#define FUSED_PAIRS     5               /* Number of fused pairs     */
+#endif /*defined(OPTION_INSTRUCTION_FUSION)*/
+
+struct DCACHE {                         /* Decode cache              */
+        DCENT   ent[OPTION_DECODE_CACHE];  /* Cache entries          */
+        U32     gen;                    /* Opcode table generation   */
+        BYTE    arch;                   /* Architecture of entries   */
+        BYTE    mode;                   /* Tracing/PER when built    */
+#if defined(OPTION_INSTRUCTION_FUSION)
+        U64     pairs[FUSED_PAIRS];     /* Adjacent pairs decoded    */
+        U64     fused[FUSED_PAIRS];     /* Fused pairs executed      */
+#endif /*defined(OPTION_INSTRUCTION_FUSION)*/
+};
+#endif /*defined(OPTION_DECODE_CACHE)*/
+
+#if defined(OPTION_CMPSC_DICT_CACHE)
+/*-------------------------------------------------------------------*/
+/* CMPSC dictionary cache                                            */
+/*                                                                   */
+/* Keeps the dead end administration built by compression and the   */
+/* index symbols expanded by expansion from one CMPSC instruction to */
+/* the next while the dictionary origin and format stay the same.    */
+/* A copy is kept of every 2K dictionary page the work was derived   */
+/* from, and it is compared with main storage the first time a later */
+/* instruction uses that page; any difference discards the cache.    */
+/* Each entry records the pages it depends on and is only used once  */
+/* all of them have been compared by the current instruction.        */
+/*-------------------------------------------------------------------*/
+struct CMPSCDC {                        /* CMPSC dictionary cache    */
+        /* Compression                                               */
+        GREG    cdictor;                /* Dictionary origin         */
+        U32     cgr0;                   /* GR0 cdss and f1 bits      */
+        U64     cpages;                 /* Pages held in cpage       */
+        BYTE    cpage[64][0x800];       /* Dictionary pages 0-31 and
+                                           expansion dictionary pages
+                                           32-63 (format-1 sibling
+                                           descriptor second half)   */
+        U64     deaddep[8192];          /* Pages of each dead end row*/
+        BYTE    deadadm[8192][0x100 / 8];  /* Dead end administration*/
+
+        /* Expansion                                                 */
+        GREG    edictor;                /* Dictionary origin         */
+        U32     egr0;                   /* GR0 cdss bits             */
+        U32     epages;                 /* Pages held in epage       */
+        BYTE    epage[32][0x800];       /* Dictionary pages          */
+        U32     ecdep[8192];            /* Pages of each expanded is */
+        int     eci[8192];              /* Index within ec for is    */
+        int     ecl[8192];              /* Size of expanded is       */
+        int     ecwm;                   /* Water mark within ec      */
+        BYTE    ec[8192 * 7];           /* Expanded index symbols    */
+};
+#endif /*defined(OPTION_CMPSC_DICT_CACHE)*/
+
+#if !defined(OPTION_FISHIO)
+/*-------------------------------------------------------------------*/
+/* Device thread I/O queue                                           */
+/*-------------------------------------------------------------------*/
+struct DEVTQ {                          /* Device thread I/O queue   */
+        LOCK    lock;                   /* Queue lock                */
+        DEVBLK *ioq;                    /* I/O queue, priority order */
+        struct DEVTW *idleq;            /* Idle threads homed here   */
+        int     idle;                   /* Number of idle threads    */
+        int     depth;                  /* Requests now queued       */
+        int     hwm;                    /* Queue depth high water    */
+        U64     queued;                 /* Requests queued           */
+        U64     executed;               /* Requests run by a thread
+                                           homed on this queue       */
+        U64     stolen;                 /* Requests run by a thread
+                                           homed on another queue    */
+};
+#endif // !defined(OPTION_FISHIO)
+
 // #if defined(FEATURE_REGION_RELOCATE)
 /*-------------------------------------------------------------------*/
 /* Zone Parameter Block                                              */
@@ -406,6 +540,11 @@ struct SYSBLK {
         BYTE   *storkeys;               /* -> Main storage key array */
         U32     xpndsize;               /* Expanded size (4K pages)  */
         BYTE   *xpndstor;               /* -> Expanded storage       */
+#if defined(OPTION_STORAGE_POLICY)
+        int     storpage;               /* Storage page backing      */
+        int     numapol;                /* Storage NUMA policy       */
+        U64     numanodes;              /* Storage NUMA node mask    */
+#endif /*defined(OPTION_STORAGE_POLICY)*/
         U64     todstart;               /* Time of initialisation    */
         U64     cpuid;                  /* CPU identifier for STIDP  */
         TID     impltid;                /* Thread-id for main progr. */
@@ -419,6 +558,14 @@ struct SYSBLK {
         int     numvec;                 /* Number vector processors  */
         int     maxcpu;                 /* Max number of CPUs        */
         int     cpus;                   /* Number CPUs configured    */
+#if defined(OPTION_CPU_AFFINITY)
+        int     cpuaffinity;            /* CPU thread affinity...    */
+#define CPUAFF_NONE     0               /* ...left to the host       */
+#define CPUAFF_AUTO     1               /* ...host CPUs chosen       */
+#define CPUAFF_LIST     2               /* ...host CPUs listed       */
+        int     cpuaffnum;              /* Number of host CPUs bound */
+        int     cpuafflist[MAX_CPU_ENGINES]; /* Host CPU for each CPU*/
+#endif /*defined(OPTION_CPU_AFFINITY)*/
         int     hicpu;                  /* Hi cpu + 1 configured     */
         int     sysepoch;               /* TOD clk epoch (1900/1960) */
         int     topology;               /* Configuration topology... */
@@ -432,6 +579,17 @@ struct SYSBLK {
         BYTE    ptyp[MAX_CPU_ENGINES];  /* SCCB ptyp for each engine */
         LOCK    todlock;                /* TOD clock update lock     */
         TID     todtid;                 /* Thread-id for TOD update  */
+        COND    timercond;              /* Timer thread idle wakeup  */
+        int     timeridle;              /* 1=Timer thread is asleep
+                                           with no CPU running       */
+        int     timerstale;             /* 1=CPUs may have set timer
+                                           events since they were
+                                           last checked              */
+#if defined(OPTION_TIMER_LATENCY)
+        U64     timerwake;              /* Timer thread wakeups      */
+        U64     timerlat[TIMER_LAT_BUCKETS]; /* Timer interrupt
+                                           latency histogram         */
+#endif /*defined(OPTION_TIMER_LATENCY)*/
         REGS   *regs[MAX_CPU_ENGINES+1];   /* Registers for each CPU */
 
 #if defined(_FEATURE_MESSAGE_SECURITY_ASSIST)
@@ -467,6 +625,9 @@ struct SYSBLK {
         LOCK    intlock;                /* Interrupt lock            */
         LOCK    iointqlk;               /* I/O Interrupt Queue lock  */
         LOCK    sigplock;               /* Signal processor lock     */
+#if defined(OPTION_PLO_LOCKS)
+        LOCK    plolock[OPTION_PLO_LOCKS];  /* PLO locks             */
+#endif /*defined(OPTION_PLO_LOCKS)*/
         ATTR    detattr;                /* Detached thread attribute */
         ATTR    joinattr;               /* Joinable thread attribute */
 #define  DETACHED  &sysblk.detattr      /* (helper macro)            */
@@ -499,6 +660,10 @@ struct SYSBLK {
 #define SHCMDOPT_NODIAG8  0x40          /* Disallow only for DIAG8   */
         int     panrate;                /* Panel refresh rate        */
         int     timerint;               /* microsecs timer interval  */
+#if defined(OPTION_IDLE_WAIT)
+        int     idlespin;               /* Max spin before sleeping
+                                           in wait state (us)        */
+#endif /*defined(OPTION_IDLE_WAIT)*/
         char   *pantitle;               /* Alt console panel title   */
 #if defined(OPTION_HAO)
         TID     haotid;                 /* Herc Auto-Oper thread-id  */
@@ -530,10 +695,9 @@ struct SYSBLK {
         U32     chp_reset[8];           /* Channel path reset masks  */
         IOINT  *iointq;                 /* I/O interrupt queue       */
 #if !defined(OPTION_FISHIO)
-        DEVBLK *ioq;                    /* I/O queue                 */
-        LOCK    ioqlock;                /* I/O queue lock            */
-        COND    ioqcond;                /* I/O queue condition       */
-        int     devtwait;               /* Device threads waiting    */
+        DEVTQ   devtq[MAX_DEVICE_THREAD_QUEUES]; /* I/O queues       */
+        LOCK    ioqlock;                /* Device thread count lock  */
+        unsigned int devtnext;          /* Next home queue to assign */
         int     devtnbr;                /* Number of device threads  */
         int     devtmax;                /* Max device threads        */
         int     devthwm;                /* High water mark           */
@@ -574,6 +738,7 @@ struct SYSBLK {
 #endif
                 logoptnotime:1;         /* 1 = don't timestamp log   */
         U32     ints_state;             /* Common Interrupts Status  */
+        U32     iopost;                 /* I/O pending post count    */
         CPU_BITMAP config_mask;         /* Configured CPUs           */
         CPU_BITMAP started_mask;        /* Started CPUs              */
         CPU_BITMAP waiting_mask;        /* Waiting CPUs              */
@@ -582,7 +747,7 @@ struct SYSBLK {
 #if defined(OPTION_IPLPARM)
         BYTE    iplparmstring[64];      /* 64 bytes loadable at IPL  */
 #endif
-#ifdef FEATURE_ECPSVM
+#ifdef _FEATURE_ECPSVM
 //
         /* ECPS:VM */
         struct {
@@ -705,6 +870,13 @@ struct SYSBLK {
 
         int     regs_copy_len;          /* Length to copy for REGS   */
 
+#if defined(OPTION_DECODE_CACHE)
+        U32     dcachegen;              /* Opcode table generation   */
+#endif /*defined(OPTION_DECODE_CACHE)*/
+#if defined(OPTION_INSTRUCTION_FUSION)
+        int     fusion;                 /* 1=Fuse instruction pairs  */
+#endif /*defined(OPTION_INSTRUCTION_FUSION)*/
+
         REGS    dummyregs;              /* Regs for unconfigured CPU */
 
 #ifdef OPTION_MSGHLD
@@ -822,6 +994,7 @@ struct DEVBLK {                         /* Device configuration block*/
         TID     tid;                    /* Thread-id executing CCW   */
         int     priority;               /* I/O q scehduling priority */
         DEVBLK *nextioq;                /* -> next device in I/O q   */
+        int     devtqix;                /* Index of I/O queue        */
         IOINT   ioint;                  /* Normal i/o interrupt
                                                queue entry           */
         IOINT   pciioint;               /* PCI i/o interrupt
@@ -1198,6 +1371,16 @@ struct DEVBLK {                         /* Device configuration block*/
 
         char   *dasdsfn;                /* Shadow file name          */
         char   *dasdsfx;                /* Pointer to suffix char    */
+#if defined(OPTION_DASD_MMAP)
+        BYTE   *dasdmap[CKD_MAXFILES];  /* -> Mapped image files     */
+        size_t  dasdmaplen[CKD_MAXFILES]; /* Mapped lengths          */
+        BYTE   *dasdmapadv;             /* -> Sequential advice area */
+        size_t  dasdmapadvlen;          /* Sequential advice length  */
+        u_int   dasdmmap:1;             /* 1=Image files are mapped  */
+        u_int   dasdmapro:1;            /* 1=Mapped read only        */
+        u_int   dasdmapseq:1;           /* 1=Advise sequential access
+                                             for multitrack reads    */
+#endif /*defined(OPTION_DASD_MMAP)*/
 
 
         /*  Device dependent fields for fbadasd                      */
@@ -1368,7 +1551,8 @@ struct CCKDDASD_DEVHDR {                /* Compress device header    */
 /* 44 */BYTE             nullfmt;       /* Null track format         */
 /* 45 */BYTE             compress;      /* Compression algorithm     */
 /* 46 */S16              compress_parm; /* Compression parameter     */
-/* 48 */BYTE             resv2[464];    /* Reserved                  */
+/* 48 */FWORD            dictid;        /* zstd dictionary id        */
+/* 52 */BYTE             resv2[460];    /* Reserved                  */
 };
 #define CCKD_DEVHDR      CCKDDASD_DEVHDR
 
@@ -1386,7 +1570,12 @@ struct CCKDDASD_DEVHDR {                /* Compress device header    */
 #define CCKD_COMPRESS_NONE     0x00
 #define CCKD_COMPRESS_ZLIB     0x01
 #define CCKD_COMPRESS_BZIP2    0x02
-#define CCKD_COMPRESS_MASK     0x03
+#define CCKD_COMPRESS_ZSTD     0x04
+#define CCKD_COMPRESS_LZ4      0x08
+#define CCKD_COMPRESS_MASK     0x0f
+
+#define CCKD_ZSTD_DEFLEVEL     3         /* Default zstd level       */
+#define CCKD_ZSTD_MAXLEVEL     22        /* Maximum zstd level       */
 
 #define CCKD_STRESS_MINLEN     4096
 #if defined(HAVE_LIBZ)
@@ -1423,6 +1612,47 @@ struct CCKD_RA {                        /* Readahead queue entry     */
         int              next;          /* Index to next entry       */
 };
 
+struct CCKD_IOREQ {                     /* I/O engine request        */
+        int              fd;            /* File descriptor           */
+        int              write;         /* 1=Write, 0=Read           */
+        off_t            off;           /* File offset               */
+        void            *buf;           /* I/O buffer                */
+        size_t           len;           /* I/O length                */
+        int              rc;            /* Bytes transferred or -1   */
+        int              err;           /* errno if rc < 0           */
+};
+
+struct CCKD_TRKIO {                     /* Track image i/o entry     */
+        int              trk;           /* Track number              */
+        BYTE            *buf;           /* Track image buffer        */
+        int              len;           /* Track image length        */
+        int              rc;            /* Return code               */
+        int              sfx;           /* File index                */
+        int              io;            /* I/O request index or -1   */
+        CCKD_L2ENT       l2;            /* Level 2 entry             */
+        CCKD_L2ENT       oldl2;         /* Previous level 2 entry    */
+};
+
+struct CCKD_COMPJOB {                   /* Track compression job     */
+        DEVBLK          *dev;           /* Device block              */
+        BYTE            *from;          /* Uncompressed image        */
+        int              len;           /* Uncompressed length       */
+        int              comp;          /* Compression algorithm     */
+        int              parm;          /* Compression parameter     */
+        BYTE            *to;            /* Compress buffer / image   */
+        int              rc;            /* Compressed length         */
+        U64              usecs;         /* Time compressing          */
+};
+
+struct CCKD_COMPQ {                     /* Compression queue entry   */
+        CCKD_COMPQ      *next;          /* -> Next queue entry       */
+        CCKD_COMPJOB    *job;           /* -> Compression jobs       */
+        int              n;             /* Number of jobs            */
+        int              taken;         /* Number of jobs taken      */
+        int              done;          /* Number of jobs completed  */
+        COND             cond;          /* Jobs completed condition  */
+};
+
 typedef  U32          CCKD_L1ENT;       /* Level 1 table entry       */
 typedef  CCKD_L1ENT   CCKD_L1TAB[];     /* Level 1 table             */
 typedef  CCKD_L2ENT   CCKD_L2TAB[256];  /* Level 2 table             */
@@ -1457,18 +1687,23 @@ typedef  char         CCKD_TRACE[128];  /* Trace table entry         */
 #define CCKD_MAX_RA_SIZE       16       /* Readahead queue size      */
 #define CCKD_MAX_RA            9        /* Max readahead threads     */
 #define CCKD_MAX_WRITER        9        /* Max writer threads        */
+#define CCKD_MAX_COMPRESS      16       /* Max compression threads   */
 #define CCKD_MAX_GCOL          1        /* Max garbage collectors    */
 #define CCKD_MAX_TRACE         200000   /* Max nbr trace entries     */
 #define CCKD_MAX_FREEPEND      4        /* Max free pending cycles   */
+#define CCKD_MAX_IOBATCH       16       /* Max requests per submit   */
+#define CCKD_MAX_WRBATCH       8        /* Max tracks per writer pass*/
 
 #define CCKD_MIN_READAHEADS    0        /* Min readahead trks        */
 #define CCKD_MIN_RA            0        /* Min readahead threads     */
 #define CCKD_MIN_WRITER        1        /* Min writer threads        */
+#define CCKD_MIN_COMPRESS      0        /* Min compression threads   */
 #define CCKD_MIN_GCOL          0        /* Min garbage collectors    */
 
 #define CCKD_DEFAULT_RA_SIZE   4        /* Readahead queue size      */
 #define CCKD_DEFAULT_RA        2        /* Default number readaheads */
 #define CCKD_DEFAULT_WRITER    2        /* Default number writers    */
+#define CCKD_DEFAULT_COMPRESS  2        /* Default compression thds  */
 #define CCKD_DEFAULT_GCOL      1        /* Default number garbage
                                               collectors             */
 #define CCKD_DEFAULT_GCOLWAIT  10       /* Default wait (seconds)    */
@@ -1476,6 +1711,9 @@ typedef  char         CCKD_TRACE[128];  /* Trace table entry         */
 #define CCKD_DEFAULT_READAHEADS 2       /* Default nbr to read ahead */
 #define CCKD_DEFAULT_FREEPEND  -1       /* Default freepend cycles   */
 
+#define CCKD_IO_SYNC           0        /* pread/pwrite i/o engine   */
+#define CCKD_IO_URING          1        /* io_uring i/o engine       */
+
 #define CFBA_BLOCK_NUM         120      /* Number fba blocks / group */
 #define CFBA_BLOCK_SIZE        61440    /* Size of a block group 60k */
                                         /* Number of bytes in an fba
@@ -1494,6 +1732,12 @@ struct CCKDBLK {                        /* Global cckd dasd block    */
         BYTE             comps;         /* Supported compressions    */
         BYTE             comp;          /* Override compression      */
         int              compparm;      /* Override compression parm */
+        BYTE            *zdict;         /* zstd dictionary           */
+        int              zdictlen;      /* zstd dictionary length    */
+        U32              zdictid;       /* zstd dictionary id        */
+        void            *zddict;        /* zstd decompression dict   */
+        void            *zcdict[CCKD_ZSTD_MAXLEVEL+1];
+                                        /* zstd compression dicts    */
 
         LOCK             gclock;        /* Garbage collector lock    */
         COND             gccond;        /* Garbage collector cond    */
@@ -1510,6 +1754,13 @@ struct CCKDBLK {                        /* Global cckd dasd block    */
         int              wrmax;         /* Max writer threads        */
         int              wrprio;        /* Writer thread priority    */
 
+        LOCK             cplock;        /* Compression lock          */
+        COND             cpcond;        /* Compression condition     */
+        CCKD_COMPQ      *cpq;           /* Compression queue         */
+        int              cps;           /* Number compression threads*/
+        int              cpmax;         /* Max compression threads   */
+        int              cpwaiting;     /* Number threads waiting    */
+
         LOCK             ralock;        /* Readahead lock            */
         COND             racond;        /* Readahead condition       */
         int              ras;           /* Number readahead threads  */
@@ -1533,6 +1784,11 @@ struct CCKDBLK {                        /* Global cckd dasd block    */
         int              fsync;         /* 1=Perform fsync()         */
         COND             termcond;      /* Termination condition     */
 
+        LOCK             ioelock;       /* I/O engine lock           */
+        int              ioengine;      /* I/O engine (CCKD_IO_xxx)  */
+        int              iodepth;       /* Requests in flight        */
+        int              iohwm;         /* Requests in flight hwm    */
+
         U64              stats_switches;       /* Switches           */
         U64              stats_cachehits;      /* Cache hits         */
         U64              stats_cachemisses;    /* Cache misses       */
@@ -1552,6 +1808,17 @@ struct CCKDBLK {                        /* Global cckd dasd block    */
         U64              stats_writebytes;     /* Bytes written      */
         U64              stats_gcolmoves;      /* Spaces moved       */
         U64              stats_gcolbytes;      /* Bytes moved        */
+        U64              stats_iosubmits;      /* Engine submits     */
+        U64              stats_ioreqs;         /* Engine requests    */
+        U64              stats_iobatched;      /* Requests batched   */
+        U64              stats_comptrks[CCKD_COMPRESS_MASK+1];
+                                               /* Tracks compressed  */
+        U64              stats_compin[CCKD_COMPRESS_MASK+1];
+                                               /* Bytes in           */
+        U64              stats_compout[CCKD_COMPRESS_MASK+1];
+                                               /* Bytes out          */
+        U64              stats_comptime[CCKD_COMPRESS_MASK+1];
+                                               /* Microseconds       */
 
         CCKD_TRACE      *itrace;        /* Internal trace table      */
         CCKD_TRACE      *itracep;       /* Current pointer           */
@@ -188,6 +188,10 @@ typedef struct VFREGS    VFREGS;    // Vector Facility Registers
 typedef struct ZPBLK     ZPBLK;     // Zone Parameter Block
 typedef struct DEVBLK    DEVBLK;    // Device configuration block
 typedef struct IOINT     IOINT;     // I/O interrupt queue
+typedef struct DCENT     DCENT;     // Decode cache entry
+typedef struct DCACHE    DCACHE;    // Pre-decoded instruction cache
+typedef struct CMPSCDC   CMPSCDC;   // CMPSC dictionary cache
+typedef struct DEVTQ     DEVTQ;     // Device thread I/O queue
 
 typedef struct DEVDATA   DEVDATA;   // xxxxxxxxx
 typedef struct DEVGRP    DEVGRP;    // xxxxxxxxx
@@ -211,6 +215,10 @@ typedef struct CCKD_L2ENT       CCKD_L2ENT;       // Level 2 table entry
 typedef struct CCKD_FREEBLK     CCKD_FREEBLK;     // Free block
 typedef struct CCKD_IFREEBLK    CCKD_IFREEBLK;    // Free block (internal)
 typedef struct CCKD_RA          CCKD_RA;          // Readahead queue entry
+typedef struct CCKD_IOREQ       CCKD_IOREQ;       // I/O engine request
+typedef struct CCKD_TRKIO       CCKD_TRKIO;       // Track image i/o entry
+typedef struct CCKD_COMPJOB     CCKD_COMPJOB;     // Track compression job
+typedef struct CCKD_COMPQ       CCKD_COMPQ;       // Compression queue entry
 
 typedef struct CCKDBLK          CCKDBLK;          // Global cckd dasd block
 typedef struct CCKDDASD_EXT     CCKDDASD_EXT;     // Ext for compressed ckd
@@ -294,6 +294,32 @@ static inline void put_float128(float128 *op, U32 *fpr) {
     fpr[FPREX] = (U32)(op->low >> 32);
     fpr[FPREX+1] = (U32)(op->low & 0xFFFFFFFF);
 }
+
+#if defined(OPTION_BFP_HOST_FPU)
+#include "ieeehost.h"
+
+/*
+ * Accept the result of a host operation, setting the inexact flag in
+ * the FPC.  Returns 0 if softfloat must redo the operation instead,
+ * either because the host could not do it or because the inexact
+ * exception is unmasked and must be presented by softfloat.
+ */
+static inline int host_bfp_result(REGS *regs, int rc)
+{
+    if (rc < 0)
+        return 0;
+    if (rc) {
+        if (regs->fpc & FPC_MASK_IMX)
+            return 0;
+        regs->fpc |= FPC_FLAG_SFX;
+    }
+    return 1;
+}
+
+/* The host is used only when the FPC selects round to nearest       */
+#define HOST_BFP_ROUNDING(_regs) (((_regs)->fpc & FPC_BRM_3BIT) == 0)
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+
 #define _IEEE_C
 #endif  /* !defined(_IEEE_C) */
 
@@ -669,10 +695,18 @@ static int add_lbfp(float64 *op1, float64 *op2, REGS *regs)
     int code;
     float64 result;
 
-    float_clear_exception_flags();
-    set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
-    result = float64_add(*op1, *op2);
-    code = float_exception(regs);
+#if defined(OPTION_BFP_HOST_FPU)
+    if (HOST_BFP_ROUNDING(regs)
+     && host_bfp_result(regs, host_add_lbfp(*op1, *op2, &result)))
+        code = 0;
+    else
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+    {
+        float_clear_exception_flags();
+        set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
+        result = float64_add(*op1, *op2);
+        code = float_exception(regs);
+    }
     *op1 = result;
     regs->psw.cc = float64_is_nan(result) ? 3 :
                    float64_is_zero(result) ? 0 :
@@ -742,10 +776,18 @@ static int add_sbfp(float32 *op1, float32 *op2, REGS *regs)
     int code;
     float32 result;
 
-    float_clear_exception_flags();
-    set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
-    result = float32_add(*op1, *op2);
-    code = float_exception(regs);
+#if defined(OPTION_BFP_HOST_FPU)
+    if (HOST_BFP_ROUNDING(regs)
+     && host_bfp_result(regs, host_add_sbfp(*op1, *op2, &result)))
+        code = 0;
+    else
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+    {
+        float_clear_exception_flags();
+        set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
+        result = float32_add(*op1, *op2);
+        code = float_exception(regs);
+    }
     *op1 = result;
     regs->psw.cc = float32_is_nan(result) ? 3 :
                    float32_is_zero(result) ? 0 :
@@ -1973,10 +2015,18 @@ static int divide_lbfp(float64 *op1, float64 *op2, REGS *regs)
     int code;
     float64 result;
 
-    float_clear_exception_flags();
-    set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
-    result = float64_div(*op1, *op2);
-    code = float_exception(regs);
+#if defined(OPTION_BFP_HOST_FPU)
+    if (HOST_BFP_ROUNDING(regs)
+     && host_bfp_result(regs, host_div_lbfp(*op1, *op2, &result)))
+        code = 0;
+    else
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+    {
+        float_clear_exception_flags();
+        set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
+        result = float64_div(*op1, *op2);
+        code = float_exception(regs);
+    }
     *op1 = result;
     return code;
 
@@ -2043,10 +2093,18 @@ static int divide_sbfp(float32 *op1, float32 *op2, REGS *regs)
     int code;
     float32 result;
 
-    float_clear_exception_flags();
-    set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
-    result = float32_div(*op1, *op2);
-    code = float_exception(regs);
+#if defined(OPTION_BFP_HOST_FPU)
+    if (HOST_BFP_ROUNDING(regs)
+     && host_bfp_result(regs, host_div_sbfp(*op1, *op2, &result)))
+        code = 0;
+    else
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+    {
+        float_clear_exception_flags();
+        set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
+        result = float32_div(*op1, *op2);
+        code = float_exception(regs);
+    }
     *op1 = result;
     return code;
 
@@ -2929,10 +2987,18 @@ static int multiply_lbfp(float64 *op1, float64 *op2, REGS *regs)
     int code;
     float64 result;
 
-    float_clear_exception_flags();
-    set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
-    result = float64_mul(*op1, *op2);
-    code = float_exception(regs);
+#if defined(OPTION_BFP_HOST_FPU)
+    if (HOST_BFP_ROUNDING(regs)
+     && host_bfp_result(regs, host_mul_lbfp(*op1, *op2, &result)))
+        code = 0;
+    else
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+    {
+        float_clear_exception_flags();
+        set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
+        result = float64_mul(*op1, *op2);
+        code = float_exception(regs);
+    }
     *op1 = result;
     return code;
 
@@ -3060,10 +3126,18 @@ static int multiply_sbfp(float32 *op1, float32 *op2, REGS *regs)
     int code;
     float32 result;
 
-    float_clear_exception_flags();
-    set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
-    result = float32_mul(*op1, *op2);
-    code = float_exception(regs);
+#if defined(OPTION_BFP_HOST_FPU)
+    if (HOST_BFP_ROUNDING(regs)
+     && host_bfp_result(regs, host_mul_sbfp(*op1, *op2, &result)))
+        code = 0;
+    else
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+    {
+        float_clear_exception_flags();
+        set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
+        result = float32_mul(*op1, *op2);
+        code = float_exception(regs);
+    }
     *op1 = result;
     return code;
 
@@ -3480,10 +3554,18 @@ static int squareroot_lbfp(float64 *op, REGS *regs)
     int code;
     float64 result;
 
-    float_clear_exception_flags();
-    set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
-    result = float64_sqrt(*op);
-    code = float_exception(regs);
+#if defined(OPTION_BFP_HOST_FPU)
+    if (HOST_BFP_ROUNDING(regs)
+     && host_bfp_result(regs, host_sqrt_lbfp(*op, &result)))
+        code = 0;
+    else
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+    {
+        float_clear_exception_flags();
+        set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
+        result = float64_sqrt(*op);
+        code = float_exception(regs);
+    }
     *op = result;
     return code;
 
@@ -3548,10 +3630,18 @@ static int squareroot_sbfp(float32 *op, REGS *regs)
     int code;
     float32 result;
 
-    float_clear_exception_flags();
-    set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
-    result = float32_sqrt(*op);
-    code = float_exception(regs);
+#if defined(OPTION_BFP_HOST_FPU)
+    if (HOST_BFP_ROUNDING(regs)
+     && host_bfp_result(regs, host_sqrt_sbfp(*op, &result)))
+        code = 0;
+    else
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+    {
+        float_clear_exception_flags();
+        set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
+        result = float32_sqrt(*op);
+        code = float_exception(regs);
+    }
     *op = result;
     return code;
 
@@ -3668,10 +3758,18 @@ static int subtract_lbfp(float64 *op1, float64 *op2, REGS *regs)
     int code;
     float64 result;
 
-    float_clear_exception_flags();
-    set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
-    result = float64_sub(*op1, *op2);
-    code = float_exception(regs);
+#if defined(OPTION_BFP_HOST_FPU)
+    if (HOST_BFP_ROUNDING(regs)
+     && host_bfp_result(regs, host_add_lbfp(*op1, *op2 ^ 0x8000000000000000ULL, &result)))
+        code = 0;
+    else
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+    {
+        float_clear_exception_flags();
+        set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
+        result = float64_sub(*op1, *op2);
+        code = float_exception(regs);
+    }
     *op1 = result;
     regs->psw.cc = float64_is_nan(result) ? 3 :
                    float64_is_zero(result) ? 0 :
@@ -3741,10 +3839,18 @@ static int subtract_sbfp(float32 *op1, float32 *op2, REGS *regs)
     int code;
     float32 result;
 
-    float_clear_exception_flags();
-    set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
-    result = float32_sub(*op1, *op2);
-    code = float_exception(regs);
+#if defined(OPTION_BFP_HOST_FPU)
+    if (HOST_BFP_ROUNDING(regs)
+     && host_bfp_result(regs, host_add_sbfp(*op1, *op2 ^ 0x80000000, &result)))
+        code = 0;
+    else
+#endif /*defined(OPTION_BFP_HOST_FPU)*/
+    {
+        float_clear_exception_flags();
+        set_rounding_mode(regs->fpc, RM_DEFAULT_ROUNDING);
+        result = float32_sub(*op1, *op2);
+        code = float_exception(regs);
+    }
     *op1 = result;
     regs->psw.cc = float32_is_nan(result) ? 3 :
                    float32_is_zero(result) ? 0 :
@@ -0,0 +1,194 @@
+/* IEEEHOST.H   Host floating point fast path for ieee.c             */
+/*              Short and long BFP arithmetic in float and double    */
+
+/*-------------------------------------------------------------------*/
+/* This header is included by ieee.c when OPTION_BFP_HOST_FPU is     */
+/* defined, and by ieeetest.c which checks each function below       */
+/* against softfloat.  The caller must include softfloat.h first.    */
+/*-------------------------------------------------------------------*/
+
+#ifndef _IEEEHOST_H
+#define _IEEEHOST_H
+
+/*
+ * Host floating point fast path
+ *
+ * When the guest rounds to nearest, the common cases of ADD, SUBTRACT,
+ * MULTIPLY, DIVIDE and SQUARE ROOT on short and long BFP operands are
+ * done with host float and double arithmetic, which yields the same
+ * correctly rounded result as softfloat.  Short operations are done in
+ * double and then rounded to float: the double result is exact for
+ * multiply, and for the other operations the double rounding cannot
+ * change the result because double has more than twice the precision.
+ *
+ * The host exception flags are not used, because reading and clearing
+ * them through fenv costs several times more than the softfloat call.
+ * Instead the inexact condition is derived from the exact error of the
+ * host operation (TwoSum for add, Dekker's product for the others),
+ * and any operation which could involve a NaN, an infinity, a zero or
+ * tiny result, overflow or underflow is left to softfloat.
+ *
+ * Each function returns -1 if softfloat must be used, otherwise 0 if
+ * the result is exact or 1 if it is inexact.
+ */
+typedef union { float32 u; float f; } HOST_FLOAT32;
+typedef union { float64 u; double d; } HOST_FLOAT64;
+
+/* Long operands of multiply, divide and square root must have a     */
+/* biased exponent in this range, so that neither the result nor the */
+/* partial products of Dekker's algorithm can overflow or underflow  */
+#define HOST_LBFP_EXP_LOW   (1023 - 480)
+#define HOST_LBFP_EXP_SPAN  960
+#define HOST_LBFP_IN_RANGE(_u) \
+        ((U32)((((_u) >> 52) & 0x7FF) - HOST_LBFP_EXP_LOW) <= HOST_LBFP_EXP_SPAN)
+
+/* Short results must be normal, finite and larger than the smallest */
+/* normal number, which might have been reached by rounding up       */
+#define HOST_SBFP_RESULT_OK(_u) \
+        ((U32)((((_u) >> 23) & 0xFF) - 2) < 0xFD)
+
+/* The rounding error of the sum s = x + y (Knuth's TwoSum)          */
+static inline double host_add_err(double x, double y, double s)
+{
+    double yy = s - x;
+    return (x - (s - yy)) + (y - yy);
+}
+
+/* The rounding error of the product p = x * y                       */
+static inline double host_mul_err(double x, double y, double p)
+{
+#if defined(FP_FAST_FMA)
+    return fma(x, y, -p);
+#else
+    /* Dekker's product with Veltkamp splitting at 27 bits */
+    double t, xh, xl, yh, yl;
+
+    t = 134217729.0 * x; xh = t - (t - x); xl = x - xh;
+    t = 134217729.0 * y; yh = t - (t - y); yl = y - yh;
+    return ((xh * yh - p) + xh * yl + xl * yh) + xl * yl;
+#endif
+}
+
+static inline int host_add_lbfp(float64 op1, float64 op2, float64 *result)
+{
+    HOST_FLOAT64 x, y, s;
+    U32 exp;
+
+    x.u = op1; y.u = op2;
+    s.d = x.d + y.d;
+    exp = (s.u >> 52) & 0x7FF;
+    if (exp == 0x7FF || (exp == 0 && (s.u << 1) != 0))
+        return -1;
+    *result = s.u;
+    return host_add_err(x.d, y.d, s.d) != 0;
+}
+
+static inline int host_mul_lbfp(float64 op1, float64 op2, float64 *result)
+{
+    HOST_FLOAT64 x, y, p;
+
+    x.u = op1; y.u = op2;
+    if (!HOST_LBFP_IN_RANGE(x.u) || !HOST_LBFP_IN_RANGE(y.u))
+        return -1;
+    p.d = x.d * y.d;
+    *result = p.u;
+    return host_mul_err(x.d, y.d, p.d) != 0;
+}
+
+static inline int host_div_lbfp(float64 op1, float64 op2, float64 *result)
+{
+    HOST_FLOAT64 x, y, q;
+    double p;
+
+    x.u = op1; y.u = op2;
+    if (!HOST_LBFP_IN_RANGE(x.u) || !HOST_LBFP_IN_RANGE(y.u))
+        return -1;
+    q.d = x.d / y.d;
+    *result = q.u;
+    /* The quotient is exact if the remainder x - q*y is zero        */
+#if defined(FP_FAST_FMA)
+    UNREFERENCED(p);
+    return fma(-q.d, y.d, x.d) != 0;
+#else
+    /* x - p is exact because p lies within a factor of two of x     */
+    p = q.d * y.d;
+    return (x.d - p) != host_mul_err(q.d, y.d, p);
+#endif
+}
+
+static inline int host_sqrt_lbfp(float64 op, float64 *result)
+{
+    HOST_FLOAT64 x, r;
+    double p;
+
+    x.u = op;
+    if ((x.u >> 63) || !HOST_LBFP_IN_RANGE(x.u))
+        return -1;
+    r.d = sqrt(x.d);
+    *result = r.u;
+    p = r.d * r.d;
+    return p != x.d || host_mul_err(r.d, r.d, p) != 0;
+}
+
+static inline int host_add_sbfp(float32 op1, float32 op2, float32 *result)
+{
+    HOST_FLOAT32 x, y, r;
+    double s;
+    U32 exp;
+
+    x.u = op1; y.u = op2;
+    s = (double)x.f + (double)y.f;
+    r.f = (float)s;
+    exp = (r.u >> 23) & 0xFF;
+    if (exp == 0xFF || (exp == 0 && (r.u << 1) != 0))
+        return -1;
+    *result = r.u;
+    return (double)r.f != s || host_add_err(x.f, y.f, s) != 0;
+}
+
+/* For multiply, divide and square root the double result is either */
+/* exact or has more significant bits than a float can hold, so the  */
+/* result is inexact exactly when rounding to float changes it       */
+static inline int host_mul_sbfp(float32 op1, float32 op2, float32 *result)
+{
+    HOST_FLOAT32 x, y, r;
+    double p;
+
+    x.u = op1; y.u = op2;
+    p = (double)x.f * (double)y.f;
+    r.f = (float)p;
+    if (!HOST_SBFP_RESULT_OK(r.u))
+        return -1;
+    *result = r.u;
+    return (double)r.f != p;
+}
+
+static inline int host_div_sbfp(float32 op1, float32 op2, float32 *result)
+{
+    HOST_FLOAT32 x, y, r;
+    double q;
+
+    x.u = op1; y.u = op2;
+    q = (double)x.f / (double)y.f;
+    r.f = (float)q;
+    if (!HOST_SBFP_RESULT_OK(r.u))
+        return -1;
+    *result = r.u;
+    return (double)r.f != q;
+}
+
+static inline int host_sqrt_sbfp(float32 op, float32 *result)
+{
+    HOST_FLOAT32 x, r;
+    double s;
+
+    x.u = op;
+    s = sqrt((double)x.f);
+    r.f = (float)s;
+    if (!HOST_SBFP_RESULT_OK(r.u))
+        return -1;
+    *result = r.u;
+    return (double)r.f != s;
+}
+
+#endif /*_IEEEHOST_H*/
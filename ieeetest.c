@@ -0,0 +1,259 @@
+/* IEEETEST.C   Host BFP fast path conformance test                  */
+
+/*-------------------------------------------------------------------*/
+/* This program checks the host floating point fast path used by     */
+/* ieee.c (ieeehost.h) against softfloat.  Every short and long BFP  */
+/* add, subtract, multiply, divide and square root which the host    */
+/* accepts must give the same result bits as softfloat rounding to   */
+/* nearest, the same inexact indication, and no other exception.     */
+/* The operands are random, with exponents at the edges of the host  */
+/* ranges, special values, and nearly equal or opposite operands.    */
+/*                                                                   */
+/* Usage: ieeetest [count [seed]]                                    */
+/*                                                                   */
+/* Any difference is displayed; the return code is the number of     */
+/* differences found, up to 255.                                     */
+/*-------------------------------------------------------------------*/
+
+#include "hstdinc.h"
+
+#include "hercules.h"
+
+#include "milieu.h"
+#include "softfloat.h"
+
+#if defined(OPTION_BFP_HOST_FPU)
+
+#include "ieeehost.h"
+
+#define SBFP_SIGN       0x80000000
+#define LBFP_SIGN       0x8000000000000000ULL
+
+/* Operations under test */
+#define OP_ADD          0
+#define OP_SUB          1
+#define OP_MUL          2
+#define OP_DIV          3
+#define OP_SQRT         4
+#define OPS             5
+
+static char *opname[OPS] = { "ADD", "SUB", "MUL", "DIV", "SQRT" };
+
+static U32 sbfp_special[] = {
+        0x00000000, 0x80000000,         /* Zero                      */
+        0x7F800000, 0xFF800000,         /* Infinity                  */
+        0x7FC00000, 0x7F800001,         /* Quiet and signaling NaN   */
+        0x00000001, 0x007FFFFF,         /* Denormals                 */
+        0x00800000, 0x00800001,         /* Smallest normals          */
+        0x7F7FFFFF, 0x3F800000,         /* Largest finite, one       */
+    };
+
+static U64 lbfp_special[] = {
+        0x0000000000000000ULL, 0x8000000000000000ULL,
+        0x7FF0000000000000ULL, 0xFFF0000000000000ULL,
+        0x7FF8000000000000ULL, 0x7FF0000000000001ULL,
+        0x0000000000000001ULL, 0x000FFFFFFFFFFFFFULL,
+        0x0010000000000000ULL, 0x0010000000000001ULL,
+        0x7FEFFFFFFFFFFFFFULL, 0x3FF0000000000000ULL,
+    };
+
+#define SPECIALS (int)(sizeof(sbfp_special) / sizeof(sbfp_special[0]))
+
+/*-------------------------------------------------------------------*/
+/* Random numbers                                                    */
+/*-------------------------------------------------------------------*/
+static U32 rand32 (void)
+{
+    return ((U32)rand() << 16) ^ (U32)rand();
+}
+
+static U64 rand64 (void)
+{
+    return ((U64)rand32() << 32) | rand32();
+}
+
+/*-------------------------------------------------------------------*/
+/* Return a random short BFP operand                                 */
+/*-------------------------------------------------------------------*/
+static float32 test_sbfp (void)
+{
+U32     exp;                            /* Biased exponent           */
+U32     frac;                           /* Fraction                  */
+
+    frac = rand32() & 0x007FFFFF;
+    switch (rand() % 8) {
+    case 0:  return sbfp_special[rand() % SPECIALS];
+    case 1:  exp = rand() % 4; break;                   /* Tiny      */
+    case 2:  exp = 0xFB + rand() % 4; break;            /* Huge      */
+    case 3:  frac &= 0x007F0000; /* Few significant bits */
+             /* FALLTHRU */
+    default: exp = 127 - 40 + rand() % 81; break;
+    }
+    return (rand32() & SBFP_SIGN) | (exp << 23) | frac;
+}
+
+/*-------------------------------------------------------------------*/
+/* Return a random long BFP operand                                  */
+/*-------------------------------------------------------------------*/
+static float64 test_lbfp (void)
+{
+U64     exp;                            /* Biased exponent           */
+U64     frac;                           /* Fraction                  */
+
+    frac = rand64() & 0x000FFFFFFFFFFFFFULL;
+    switch (rand() % 8) {
+    case 0:  return lbfp_special[rand() % SPECIALS];
+    case 1:  exp = HOST_LBFP_EXP_LOW - 2 + rand() % 5; break;
+    case 2:  exp = HOST_LBFP_EXP_LOW + HOST_LBFP_EXP_SPAN - 2
+                 + rand() % 5; break;
+    case 3:  exp = (rand() & 1) ? rand() % 4 : 0x7FB + rand() % 4; break;
+    case 4:  frac &= 0x000FF00000000000ULL; /* Few significant bits */
+             /* FALLTHRU */
+    default: exp = 1023 - 80 + rand() % 161; break;
+    }
+    return (rand64() & LBFP_SIGN) | (exp << 52) | frac;
+}
+
+/*-------------------------------------------------------------------*/
+/* Display a difference                                              */
+/*-------------------------------------------------------------------*/
+static void test_diff (int i, char *fmt, int op, U64 x, U64 y,
+                       U64 r, int rc, U64 s, int flags)
+{
+    printf ("Test %d: %s %s x=%16.16" I64_FMT "X y=%16.16" I64_FMT "X\n",
+            i, opname[op], fmt, x, y);
+    printf ("  host      %16.16" I64_FMT "X inexact=%d\n", r, rc);
+    printf ("  softfloat %16.16" I64_FMT "X flags=%2.2X\n", s, flags);
+}
+
+/*-------------------------------------------------------------------*/
+/* IEEETEST main entry point                                         */
+/*-------------------------------------------------------------------*/
+int main (int argc, char *argv[])
+{
+int     count = 1000000;                /* Number of tests           */
+int     seed = 1;                       /* Random number seed        */
+int     errors = 0;                     /* Number of differences     */
+int     hosted[2][OPS];                 /* Operations done by host   */
+int     op;                             /* Operation                 */
+int     rc;                             /* Host return code          */
+int     flags;                          /* Softfloat exception flags */
+int     i;                              /* Test number               */
+float32 sx, sy, sr = 0, ss = 0;         /* Short operands and results*/
+float64 lx, ly, lr = 0, ls = 0;         /* Long operands and results */
+
+    if (argc > 1) count = atoi (argv[1]);
+    if (argc > 2) seed = atoi (argv[2]);
+    srand (seed);
+    memset (hosted, 0, sizeof(hosted));
+
+    for (i = 0; i < count; i++)
+    {
+        op = rand() % OPS;
+
+        /* Short BFP; the second operand is sometimes close to the
+           first one, to exercise cancellation and exact results */
+        sx = test_sbfp();
+        sy = test_sbfp();
+        if (rand() % 4 == 0)
+            sy = (sx ^ (rand32() & SBFP_SIGN)) + rand() % 5 - 2;
+
+        float_set_rounding_mode (float_round_nearest_even);
+        float_clear_exception_flags ();
+        switch (op) {
+        case OP_ADD:
+            rc = host_add_sbfp (sx, sy, &sr);
+            ss = float32_add (sx, sy);
+            break;
+        case OP_SUB:
+            rc = host_add_sbfp (sx, sy ^ SBFP_SIGN, &sr);
+            ss = float32_sub (sx, sy);
+            break;
+        case OP_MUL:
+            rc = host_mul_sbfp (sx, sy, &sr);
+            ss = float32_mul (sx, sy);
+            break;
+        case OP_DIV:
+            rc = host_div_sbfp (sx, sy, &sr);
+            ss = float32_div (sx, sy);
+            break;
+        default:
+            rc = host_sqrt_sbfp (sx, &sr);
+            ss = float32_sqrt (sx);
+            break;
+        }
+        flags = float_get_exception_flags ();
+
+        if (rc >= 0)
+        {
+            hosted[0][op]++;
+            if (sr != ss || rc != (flags & float_flag_inexact)
+             || (flags & ~float_flag_inexact))
+            {
+                test_diff (i, "short", op, sx, sy, sr, rc, ss, flags);
+                if (++errors >= 255) break;
+            }
+        }
+
+        /* Long BFP */
+        lx = test_lbfp();
+        ly = test_lbfp();
+        if (rand() % 4 == 0)
+            ly = (lx ^ (rand64() & LBFP_SIGN)) + rand() % 5 - 2;
+
+        float_set_rounding_mode (float_round_nearest_even);
+        float_clear_exception_flags ();
+        switch (op) {
+        case OP_ADD:
+            rc = host_add_lbfp (lx, ly, &lr);
+            ls = float64_add (lx, ly);
+            break;
+        case OP_SUB:
+            rc = host_add_lbfp (lx, ly ^ LBFP_SIGN, &lr);
+            ls = float64_sub (lx, ly);
+            break;
+        case OP_MUL:
+            rc = host_mul_lbfp (lx, ly, &lr);
+            ls = float64_mul (lx, ly);
+            break;
+        case OP_DIV:
+            rc = host_div_lbfp (lx, ly, &lr);
+            ls = float64_div (lx, ly);
+            break;
+        default:
+            rc = host_sqrt_lbfp (lx, &lr);
+            ls = float64_sqrt (lx);
+            break;
+        }
+        flags = float_get_exception_flags ();
+
+        if (rc >= 0)
+        {
+            hosted[1][op]++;
+            if (lr != ls || rc != (flags & float_flag_inexact)
+             || (flags & ~float_flag_inexact))
+            {
+                test_diff (i, "long", op, lx, ly, lr, rc, ls, flags);
+                if (++errors >= 255) break;
+            }
+        }
+    }
+
+    for (op = 0; op < OPS; op++)
+        printf ("ieeetest: %-4s short %d, long %d done by host\n",
+                opname[op], hosted[0][op], hosted[1][op]);
+    printf ("ieeetest: %d tests, %d differences\n", i, errors);
+    return errors;
+}
+
+#else /*!defined(OPTION_BFP_HOST_FPU)*/
+
+int main (int argc, char *argv[])
+{
+    UNREFERENCED(argc);
+    UNREFERENCED(argv);
+    printf ("ieeetest: OPTION_BFP_HOST_FPU is not defined\n");
+    return 0;
+}
+
+#endif /*!defined(OPTION_BFP_HOST_FPU)*/
@@ -110,8 +110,8 @@ BOOL WINAPI console_ctrl_handler (DWORD signo)
 
             ON_IC_INTKEY;
 
-            /* Signal waiting CPUs that an interrupt is pending */
-            WAKEUP_CPUS_MASK (sysblk.waiting_mask);
+            /* Signal a waiting CPU that an interrupt is pending */
+            WAKEUP_ENABLED_CPU (BIT(IC_INTKEY));
 
             RELEASE_INTLOCK(NULL);
 
@@ -30,6 +30,8 @@ _DAT_C_STATIC void ARCH_DEP(purge_tlb_all) ();
 _DAT_C_STATIC void ARCH_DEP(purge_tlb) (REGS *regs);
 _DAT_C_STATIC void ARCH_DEP(purge_tlbe_all) (RADR pfra);
 _DAT_C_STATIC void ARCH_DEP(purge_tlbe) (REGS *regs, RADR pfra);
+_DAT_C_STATIC void ARCH_DEP(purge_tlb_asce_all) (RADR asd);
+_DAT_C_STATIC void ARCH_DEP(purge_tlb_asce) (REGS *regs, RADR asd);
 _DAT_C_STATIC void ARCH_DEP(invalidate_tlb) (REGS *regs, BYTE mask);
 #if ARCH_MODE == ARCH_390 && defined(_900)
 _DAT_C_STATIC void z900_invalidate_tlb (REGS *regs, BYTE mask);
@@ -80,11 +82,15 @@ _VSTORE_C_STATIC void ARCH_DEP(validate_operand) (VADR addr, int arn,
         int len, int acctype, REGS *regs);
 _VFETCH_C_STATIC BYTE * ARCH_DEP(instfetch) (REGS *regs, int exec);
 
-#if defined(_FEATURE_SIE) && defined(_370) && !defined(_IEEE_C_)
+/* A program which is built for one architecture only, such as the   */
+/* make check tests, defines _ONE_ARCH_ so that the instfetch of     */
+/* the other architectures, which it never defines, is not declared  */
+#if defined(_FEATURE_SIE) && defined(_370) && !defined(_IEEE_C_) \
+ && !defined(_ONE_ARCH_)
 _VFETCH_C_STATIC BYTE * s370_instfetch (REGS *regs, int exec);
 #endif /*defined(_FEATURE_SIE)*/
 
-#if defined(_FEATURE_ZSIE) && defined(_900)
+#if defined(_FEATURE_ZSIE) && defined(_900) && !defined(_ONE_ARCH_)
 _VFETCH_C_STATIC BYTE * s390_instfetch (REGS *regs, int exec);
 #endif /*defined(_FEATURE_ZSIE)*/
 
@@ -319,7 +319,7 @@ BYTE    chpid;
         OBTAIN_INTLOCK(regs);
         sysblk.chp_reset[chpid/32] |= 0x80000000 >> (chpid % 32);
         ON_IC_CHANRPT;
-        WAKEUP_CPUS_MASK (sysblk.waiting_mask);
+        WAKEUP_ENABLED_CPU (BIT(IC_CHANRPT));
         RELEASE_INTLOCK(regs);
     }
 
@@ -72,7 +72,7 @@ CPU_BITMAP mask;
                         regs->opinterv = 1;
                         regs->cpustate = CPUSTATE_STOPPING;
                         ON_IC_INTERRUPT(regs);
-                        signal_condition(&regs->intcond);
+                        WAKEUP_CPU(regs);
                     }
                     mask >>= 1;
                 }
@@ -92,7 +92,7 @@ void machine_check_crwpend()
     /* Signal waiting CPUs that an interrupt may be pending */
     OBTAIN_INTLOCK(NULL);
     ON_IC_CHANRPT;
-    WAKEUP_CPUS_MASK (sysblk.waiting_mask);
+    WAKEUP_ENABLED_CPU (BIT(IC_CHANRPT));
     RELEASE_INTLOCK(NULL);
 
 } /* end function machine_check_crwpend */
@@ -207,6 +207,22 @@ RADR    fsta = 0;
     if (regs->cpuad == sysblk.mainowner)
         RELEASE_MAINLOCK(regs);
 
+#if defined(OPTION_PLO_LOCKS)
+    /* Release the PLO lock if held */
+    if (regs->plolock)
+    {
+        release_lock(regs->plolock);
+        regs->plolock = NULL;
+    }
+#if defined(FEATURE_INTERPRETIVE_EXECUTION)
+    if (regs->sie_active && regs->guestregs->plolock)
+    {
+        release_lock(regs->guestregs->plolock);
+        regs->guestregs->plolock = NULL;
+    }
+#endif /*defined(FEATURE_INTERPRETIVE_EXECUTION)*/
+#endif /*defined(OPTION_PLO_LOCKS)*/
+
     /* Exit SIE when active */
 #if defined(FEATURE_INTERPRETIVE_EXECUTION)
     if(regs->sie_active)
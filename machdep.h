@@ -431,6 +431,36 @@ static __inline__ BYTE cmpxchg8_amd64(U64 *old, U64 new, void *ptr) {
  return code;
 }
 
+#define cmpxchg16(x1,x2,y1,y2,z) cmpxchg16_amd64(x1,x2,y1,y2,z)
+#define CMPXCHG16_AVAIL (hostinfo.cmpxchg16_avail)
+static __inline__ int cmpxchg16_amd64(U64 *old1, U64 *old2, U64 new1, U64 new2, volatile void *ptr) {
+/* returns zero on success otherwise returns 1 */
+/* ptr must be quadword aligned.  Early amd64 processors lack the
+   CMPXCHG16B instruction, in which case the exchange is not atomic
+   and the caller must hold mainlock (see CMPXCHG_LOCKFREE) */
+ BYTE code;
+ U64 *ptr_data=(U64 *)ptr;
+ if (!CMPXCHG16_AVAIL)
+ {
+     if (*old1 == ptr_data[0] && *old2 == ptr_data[1])
+     {
+         ptr_data[0] = new1;
+         ptr_data[1] = new2;
+         return 0;
+     }
+     *old1 = ptr_data[0];
+     *old2 = ptr_data[1];
+     return 1;
+ }
+ __asm__ __volatile__ (
+         "lock;   cmpxchg16b %1\n\t"
+         "setnz   %b0\n\t"
+         : "=r"(code), "+m"(*ptr_data), "+a"(*old1), "+d"(*old2)
+         : "b"(new1), "c"(new2)
+         : "cc", "memory");
+ return code;
+}
+
 #endif /* defined(_ext_amd64) */
 
 /*-------------------------------------------------------------------
@@ -563,6 +593,24 @@ U32  *ptr4, val4, old4, new4;
  #define ASSIST_CMPXCHG16
 #endif
 
+/*-------------------------------------------------------------------
+ * CMPXCHG_LOCKFREE is nonzero if cmpxchg1, 4, 8 and 16 are all atomic
+ * on this host, so that the interlocked-update instructions need not
+ * hold mainlock (OPTION_LOCKFREE_CS).  If any width uses the plain C
+ * version below then every width must hold mainlock, since a locked
+ * non-atomic CDS would not exclude an unlocked CS on the same word.
+ *-------------------------------------------------------------------*/
+#if defined(ASSIST_CMPXCHG1) && defined(ASSIST_CMPXCHG4) \
+ && defined(ASSIST_CMPXCHG8) && defined(ASSIST_CMPXCHG16)
+ #if defined(CMPXCHG16_AVAIL)
+  #define CMPXCHG_LOCKFREE  CMPXCHG16_AVAIL
+ #else
+  #define CMPXCHG_LOCKFREE  1
+ #endif
+#else
+ #define CMPXCHG_LOCKFREE   0
+#endif
+
 #if defined(fetch_dw) || defined(fetch_dw_noswap)
  #define ASSIST_FETCH_DW
 #endif
@@ -797,6 +845,61 @@ static __inline__ int cmpxchg16(U64 *old1, U64 *old2, U64 new1, U64 new2, volati
 }
 #endif
 
+/*-------------------------------------------------------------------
+ * Atomic fullword OR and AND used to post interrupt state bits
+ * without holding intlock (OPTION_LOCKFREE_INTS).  Each returns the
+ * number of times cmpxchg4 failed because another thread updated
+ * the word first.  ic_fence is a full memory barrier.
+ *-------------------------------------------------------------------*/
+#if defined(OPTION_LOCKFREE_INTS)
+#if defined(ASSIST_CMPXCHG4)
+static __inline__ int or_fw_atomic(U32 *ptr, U32 bits) {
+ U32 old = *(volatile U32 *)ptr;
+ int retry = 0;
+ while (cmpxchg4(&old, old | bits, ptr))
+     retry++;
+ return retry;
+}
+static __inline__ int and_fw_atomic(U32 *ptr, U32 bits) {
+ U32 old = *(volatile U32 *)ptr;
+ int retry = 0;
+ while (cmpxchg4(&old, old & bits, ptr))
+     retry++;
+ return retry;
+}
+#elif defined(__GNUC__)
+static __inline__ int or_fw_atomic(U32 *ptr, U32 bits) {
+ __sync_fetch_and_or(ptr, bits);
+ return 0;
+}
+static __inline__ int and_fw_atomic(U32 *ptr, U32 bits) {
+ __sync_fetch_and_and(ptr, bits);
+ return 0;
+}
+#else
+ #error OPTION_LOCKFREE_INTS requires an atomic cmpxchg4
+#endif
+#if defined(_MSVC_)
+ #define ic_fence() MemoryBarrier()
+#else
+ #define ic_fence() __sync_synchronize()
+#endif
+#endif /*defined(OPTION_LOCKFREE_INTS)*/
+
+/*-------------------------------------------------------------------*
+ * spin_pause tells the host processor that the thread is polling a  *
+ * memory location, and stops the compiler caching it in a register  *
+ *-------------------------------------------------------------------*/
+#if defined(_MSVC_)
+ #define spin_pause() YieldProcessor()
+#elif defined(__GNUC__) && (defined(_ext_ia32) || defined(_ext_amd64))
+ #define spin_pause() __asm__ __volatile__ ("pause" ::: "memory")
+#elif defined(__GNUC__)
+ #define spin_pause() __asm__ __volatile__ ("" ::: "memory")
+#else
+ #define spin_pause()
+#endif
+
 #ifndef BIT
 #define BIT(nr) (1<<(nr))
 #endif
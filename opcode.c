@@ -1339,6 +1339,172 @@ DEF_INST(execute_e4xx)
 #endif /*defined(FEATURE_VECTOR_FACILITY)*/
 
 
+#if defined(OPTION_INSTRUCTION_FUSION)
+/*-------------------------------------------------------------------*/
+/* Fused instruction pairs                                           */
+/*                                                                   */
+/* A fused handler executes the first instruction of the pair and    */
+/* then, without returning to the dispatch loop, the instruction     */
+/* which follows it.  Only instructions which never branch and never */
+/* alter storage are fused as the first of a pair, so on return      */
+/* regs->ip addresses the second instruction.  The second one is not */
+/* executed if the first has left fewer than six bytes in the page   */
+/* or has invalidated the AIA; the dispatch loop then fetches it.    */
+/*-------------------------------------------------------------------*/
+#define FUSED_INST(_pair, _inst1, _len1, _inst2) \
+DEF_INST(fused_ ## _pair) \
+{ \
+    ARCH_DEP(_inst1) (inst, regs); \
+    if (likely(regs->ip < regs->aie)) \
+    { \
+        regs->instcount++; \
+        regs->dcache->fused[FUSED_ ## _pair]++; \
+        ARCH_DEP(_inst2) (inst + (_len1), regs); \
+    } \
+}
+
+FUSED_INST(L_LTR,  load,                         4, load_and_test_register)
+FUSED_INST(LA_BCT, load_address,                 4, branch_on_count)
+FUSED_INST(CLI_BC, compare_logical_immediate,    4, branch_on_condition)
+FUSED_INST(ICM_BC, insert_characters_under_mask, 4, branch_on_condition)
+FUSED_INST(LR_AR,  load_register,                2, add_register)
+
+#undef FUSED_INST
+
+
+/*-------------------------------------------------------------------*/
+/* Return the fused handler for the pair starting at ip, or the      */
+/* handler of the first instruction if the pair is not fused         */
+/*-------------------------------------------------------------------*/
+#define FUSED_PAIR(_op1, _inst1, _inst2, _pair) \
+    case (_op1): \
+        if (func == ARCH_DEP(_inst1) && next == ARCH_DEP(_inst2)) \
+        { \
+            regs->dcache->pairs[FUSED_ ## _pair]++; \
+            if (sysblk.fusion) \
+                func = ARCH_DEP(fused_ ## _pair); \
+        } \
+        break;
+
+static zz_func ARCH_DEP(fuse_pair) (BYTE *ip, REGS *regs, zz_func func)
+{
+zz_func next;                           /* Handler of next inst      */
+
+    next = regs->ARCH_DEP(opcode_table)[ip[ILC(ip[0])]];
+
+    switch (ip[0]) {
+    FUSED_PAIR(0x58, load, load_and_test_register, L_LTR)
+    FUSED_PAIR(0x41, load_address, branch_on_count, LA_BCT)
+    FUSED_PAIR(0x95, compare_logical_immediate, branch_on_condition, CLI_BC)
+    FUSED_PAIR(0xBF, insert_characters_under_mask, branch_on_condition, ICM_BC)
+    FUSED_PAIR(0x18, load_register, add_register, LR_AR)
+    }
+
+    return func;
+}
+
+#undef FUSED_PAIR
+#endif /*defined(OPTION_INSTRUCTION_FUSION)*/
+
+
+#if defined(OPTION_DECODE_CACHE)
+/*-------------------------------------------------------------------*/
+/* Build the decode cache entry for the instruction at ip            */
+/*                                                                   */
+/* The handler is resolved through the execute_xxxx routines above   */
+/* so that a cached multi-byte opcode is dispatched with a single    */
+/* indirect call.  Table entries which have been replaced (for       */
+/* example by the multi-byte assist jump code) are cached as is.     */
+/*-------------------------------------------------------------------*/
+#define DCACHE_RESOLVE(_op, _i) \
+    case 0x ## _op: \
+        if (func == ARCH_DEP(execute_ ## _op ## xx)) \
+            func = regs->ARCH_DEP(opcode_ ## _op ## xx)[ip[(_i)]]; \
+        break;
+
+void ARCH_DEP(decode_cache_fill) (BYTE *ip, REGS *regs, DCENT *dce)
+{
+zz_func func;                           /* Instruction handler       */
+
+    func = regs->ARCH_DEP(opcode_table)[ip[0]];
+
+    switch (ip[0]) {
+#if ARCH_MODE != ARCH_370
+    DCACHE_RESOLVE(01, 1)
+#endif
+    DCACHE_RESOLVE(a7, 1)
+    DCACHE_RESOLVE(b2, 1)
+    DCACHE_RESOLVE(b9, 1)
+    DCACHE_RESOLVE(eb, 5)
+#if defined(FEATURE_BASIC_FP_EXTENSIONS)
+    DCACHE_RESOLVE(b3, 1)
+    DCACHE_RESOLVE(ed, 5)
+#endif /*defined(FEATURE_BASIC_FP_EXTENSIONS)*/
+    DCACHE_RESOLVE(e5, 1)
+#if ARCH_MODE == ARCH_370
+    DCACHE_RESOLVE(e6, 1)
+#endif
+#if defined(FEATURE_ESAME) || defined(FEATURE_ESAME_N3_ESA390) \
+ || defined(FEATURE_VECTOR_FACILITY)
+    DCACHE_RESOLVE(a5, 1)
+#endif
+#if defined(FEATURE_ESAME) || defined(FEATURE_ESAME_N3_ESA390)
+    DCACHE_RESOLVE(e3, 5)
+    DCACHE_RESOLVE(ec, 5)
+    DCACHE_RESOLVE(c0, 1)
+    DCACHE_RESOLVE(c2, 1)
+#endif /*defined(FEATURE_ESAME) || defined(FEATURE_ESAME_N3_ESA390)*/
+    DCACHE_RESOLVE(c4, 1)
+    DCACHE_RESOLVE(c6, 1)
+#if defined(FEATURE_ESAME)
+    DCACHE_RESOLVE(c8, 1)
+    DCACHE_RESOLVE(cc, 1)
+#endif /*defined(FEATURE_ESAME)*/
+#if defined(FEATURE_VECTOR_FACILITY)
+    DCACHE_RESOLVE(a4, 1)
+    DCACHE_RESOLVE(a6, 1)
+    DCACHE_RESOLVE(e4, 1)
+#endif /*defined(FEATURE_VECTOR_FACILITY)*/
+    }
+
+#if defined(OPTION_INSTRUCTION_FUSION)
+    /* The key also covers the opcode of the next instruction */
+    func = ARCH_DEP(fuse_pair) (ip, regs, func);
+#endif /*defined(OPTION_INSTRUCTION_FUSION)*/
+
+    memcpy (&dce->key, ip, sizeof(dce->key));
+    dce->func = (FUNC)func;
+}
+
+
+/*-------------------------------------------------------------------*/
+/* Discard all pre-decoded instructions of a CPU                     */
+/*                                                                   */
+/* Every entry is set to a key of binary zeroes, which is a valid    */
+/* image of an invalid (x'00') instruction.                          */
+/*-------------------------------------------------------------------*/
+void ARCH_DEP(decode_cache_flush) (REGS *regs)
+{
+int     i;                              /* Entry index               */
+FUNC    func;                           /* Handler for opcode x'00'  */
+
+    func = (FUNC)regs->ARCH_DEP(opcode_table)[0x00];
+
+    for (i = 0; i < OPTION_DECODE_CACHE; i++)
+    {
+        regs->dcache->ent[i].key  = 0;
+        regs->dcache->ent[i].func = func;
+    }
+
+    regs->dcache->gen  = sysblk.dcachegen;
+    regs->dcache->arch = ARCH_MODE;
+    regs->dcache->mode = DCACHE_MODE(regs);
+}
+
+#undef DCACHE_RESOLVE
+#endif /*defined(OPTION_DECODE_CACHE)*/
+
+
 DEF_INST(operation_exception)
 {
     INST_UPDATE_PSW (regs, ILC(inst[0]), ILC(inst[0]));
@@ -2455,6 +2621,11 @@ int i;
         z900_opcode_edxx [i] = opcode_edxx [i][ARCH_900];
 #endif
     }
+
+#if defined(OPTION_DECODE_CACHE)
+    /* Cause each CPU to discard its pre-decoded instructions */
+    sysblk.dcachegen++;
+#endif /*defined(OPTION_DECODE_CACHE)*/
 }
 
 void set_opcode_pointers(REGS *regs)
@@ -383,10 +383,53 @@ do { \
     (_regs)->ARCH_DEP(opcode_table)[_ip[0]]((_ip), (_regs)); \
 } while(0)
 
+#if defined(OPTION_DECODE_CACHE)
+
+/* Pre-decoded instruction cache.  UNROLLED_EXECUTE is only reached
+   while the AIA is valid, ie. when neither tracing nor PER is active.
+   The eight byte key may extend past the end of the page, which is
+   safe as mainstor is allocated with 8K of slack at its end         */
+
+#define DCACHE_IX(_ip) \
+  (((uintptr_t)(_ip) >> 1) & (OPTION_DECODE_CACHE - 1))
+
+#define DCACHE_MODE(_regs) \
+  ((_regs)->tracing | ((_regs)->permode << 1))
+
+#define DCACHE_VALIDATE(_regs) \
+do { \
+    if (unlikely((_regs)->dcache->arch != ARCH_MODE \
+              || (_regs)->dcache->gen != sysblk.dcachegen \
+              || (_regs)->dcache->mode != DCACHE_MODE((_regs)))) \
+        ARCH_DEP(decode_cache_flush) ((_regs)); \
+} while(0)
+
+#define DCACHE_EXECUTE(_ip, _regs) \
+do { \
+    DCENT *_dce = (_regs)->dcache->ent + DCACHE_IX((_ip)); \
+    U64    _key; \
+    memcpy (&_key, (_ip), sizeof(_key)); \
+    if (unlikely(_dce->key != _key)) \
+        ARCH_DEP(decode_cache_fill) ((_ip), (_regs), _dce); \
+    FOOTPRINT ((_ip), (_regs)); \
+    COUNT_INST ((_ip), (_regs)); \
+    _dce->func ((_ip), (_regs)); \
+} while(0)
+
+#define UNROLLED_EXECUTE(_regs) \
+ if ((_regs)->ip >= (_regs)->aie) break; \
+ DCACHE_EXECUTE((_regs)->ip, (_regs))
+
+#else /*!defined(OPTION_DECODE_CACHE)*/
+
+#define DCACHE_VALIDATE(_regs)
+
 #define UNROLLED_EXECUTE(_regs) \
  if ((_regs)->ip >= (_regs)->aie) break; \
  EXECUTE_INSTRUCTION((_regs)->ip, (_regs))
 
+#endif /*!defined(OPTION_DECODE_CACHE)*/
+
 /* Branching */
 
 #define SUCCESSFUL_BRANCH(_regs, _addr, _len) \
@@ -871,6 +914,39 @@ do { \
 
 #define TLBIX(_addr) (((VADR_L)(_addr) >> TLB_PAGESHIFT) & TLB_MASK)
 
+/* Test whether TLB entry _ix translates _vaddr in the address space
+   described by _regs->dat.asd and _regs->dat.private */
+#define TLB_MATCH(_regs, _vaddr, _ix) \
+   (   (((_vaddr) & TLBID_PAGEMASK) | (_regs)->tlbID) \
+                                        == (_regs)->tlb.TLB_VADDR((_ix)) \
+    && ((_regs)->tlb.common[(_ix)] \
+        || (_regs)->dat.asd == (_regs)->tlb.TLB_ASD((_ix))) \
+    && !((_regs)->tlb.common[(_ix)] && (_regs)->dat.private) )
+
+#if defined(OPTION_PAGE_WALK_CACHE)
+/* Index of the page-walk cache entries for segment or region _vaddr
+   in the address space _asd */
+#define PWC_SEGIX(_vaddr, _asd) \
+   ((int)(((_vaddr) >> 20) ^ ((_asd) >> 12)) & (PWC_SEGN - 1))
+#define PWC_REGIX(_vaddr, _asd) \
+   ((int)(((_vaddr) >> 31) ^ ((_asd) >> 12)) & (PWC_REGN - 1))
+#define PWC_SEGMASK     0xFFFFFFFFFFF00000ULL
+#define PWC_REGMASK     0xFFFFFFFF80000000ULL
+
+/* Test whether page-walk cache entry _pwce was formed for the
+   segment or region _vaddr in the address space _regs->dat.asd */
+#define PWC_MATCH(_regs, _pwce, _vaddr) \
+   (   (_pwce)->id == (_regs)->tlbID \
+    && (_pwce)->vaddr == (_vaddr) \
+    && (_pwce)->asd == (_regs)->dat.asd )
+
+/* Clear all page-walk cache entries */
+#define PURGE_PWC(_regs) \
+    memset (&(_regs)->pwc, 0, sizeof(PWC))
+#else /*!defined(OPTION_PAGE_WALK_CACHE)*/
+#define PURGE_PWC(_regs)
+#endif /*!defined(OPTION_PAGE_WALK_CACHE)*/
+
 #define MAINADDR(_main, _addr) \
    (BYTE*)((uintptr_t)(_main) ^ (uintptr_t)(_addr))
 
@@ -2829,6 +2905,10 @@ int ARCH_DEP(present_zone_io_interrupt) (U32 *ioid, U32 *ioparm,
 void io_reset (void);
 int  chp_reset(REGS *, BYTE chpid);
 void channelset_reset(REGS *regs);
+#if !defined(OPTION_FISHIO)
+void *device_thread (void *arg);
+void device_thread_wakeup (void);
+#endif // !defined(OPTION_FISHIO)
 DLL_EXPORT int  device_attention (DEVBLK *dev, BYTE unitstat);
 DLL_EXPORT int  ARCH_DEP(device_attention) (DEVBLK *dev, BYTE unitstat);
 
@@ -2951,6 +3031,10 @@ void sigabend_handler (int signo);
 /* Functions in module opcode.c */
 OPC_DLL_IMPORT void copy_opcode_tables ();
 void set_opcode_pointers (REGS *regs);
+#if defined(OPTION_DECODE_CACHE)
+void ARCH_DEP(decode_cache_fill) (BYTE *ip, REGS *regs, DCENT *dce);
+void ARCH_DEP(decode_cache_flush) (REGS *regs);
+#endif /*defined(OPTION_DECODE_CACHE)*/
 
 
 /* Functions in module panel.c */
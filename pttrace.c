@@ -117,6 +117,16 @@ DLL_EXPORT int ptt_cmd(int argc, char *argv[], char* cmdline)
                 pttclass &= ~PTT_CL_CSF;
                 continue;
             }
+            else if (strcasecmp("ints", argv[0]) == 0)
+            {
+                pttclass |= PTT_CL_INT;
+                continue;
+            }
+            else if (strcasecmp("noints", argv[0]) == 0)
+            {
+                pttclass &= ~PTT_CL_INT;
+                continue;
+            }
             else if (strcasecmp("sie", argv[0]) == 0)
             {
                 pttclass |= PTT_CL_SIE;
@@ -268,11 +278,12 @@ DLL_EXPORT int ptt_cmd(int argc, char *argv[], char* cmdline)
         if (pttracen)
             rc = ptt_pthread_print();
     
-        logmsg( _("HHCPT003I ptt %s%s%s%s%s%s%s%s%s%s%s %s %s to=%d %d\n"),
+        logmsg( _("HHCPT003I ptt %s%s%s%s%s%s%s%s%s%s%s%s %s %s to=%d %d\n"),
                (pttclass & PTT_CL_INF) ? "control " : "",
                (pttclass & PTT_CL_ERR) ? "error " : "",
                (pttclass & PTT_CL_PGM) ? "prog " : "",
                (pttclass & PTT_CL_CSF) ? "inter " : "",
+               (pttclass & PTT_CL_INT) ? "ints " : "",
                (pttclass & PTT_CL_SIE) ? "sie " : "",
                (pttclass & PTT_CL_SIG) ? "signal " : "",
                (pttclass & PTT_CL_IO) ? "io " : "",
@@ -77,6 +77,7 @@ typedef struct _PTT_TRACE {
 #define PTT_CL_LOG  0x0001              /* Logger records             */
 #define PTT_CL_TMR  0x0002              /* Timer/Clock records        */
 #define PTT_CL_THR  0x0004              /* Thread records             */
+#define PTT_CL_INT  0x0008              /* Interrupt posting contention*/
 #define PTT_CL_INF  0x0100              /* Instruction info           */
 #define PTT_CL_ERR  0x0200              /* Instruction error/unsup    */
 #define PTT_CL_PGM  0x0400              /* Program interrupt          */
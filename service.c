@@ -87,7 +87,7 @@ void sclp_attention(U16 type)
 
         /* Set service signal interrupt pending for read event data */
         ON_IC_SERVSIG;
-        WAKEUP_CPUS_MASK (sysblk.waiting_mask);
+        WAKEUP_ENABLED_CPU (BIT(IC_SERVSIG));
     }
 }
 
@@ -290,7 +290,15 @@ U64     dreg;
 #endif
              return;
          }
-        cpu_init (regs->cpuad, GUESTREGS, regs);
+        if (cpu_init (regs->cpuad, GUESTREGS, regs))
+        {
+            free (GUESTREGS);
+            GUESTREGS = NULL;
+#if !defined(NO_SIGABEND_HANDLER)
+            signal_thread(sysblk.cputid[regs->cpuad], SIGUSR1);
+#endif
+            return;
+        }
      }
 
     /* Direct pointer to state descriptor block */
@@ -1037,6 +1045,7 @@ int ARCH_DEP(run_sie) (REGS *regs)
                                  wait_condition (&sysblk.sync_bc_cond, &sysblk.intlock);
                             sysblk.intowner = regs->cpuad;
                             sysblk.waiting_mask ^= regs->cpubit;
+                            WAKEUP_TIMER();
 #ifdef OPTION_MIPS_COUNTING
                             regs->waittime += host_tod() - regs->waittod;
                             regs->waittod = 0;
@@ -1058,6 +1067,8 @@ int ARCH_DEP(run_sie) (REGS *regs)
                                           )
                     break;
 
+                DCACHE_VALIDATE(GUESTREGS);
+
                 ip = INSTRUCTION_FETCH(GUESTREGS, 0);
 
 #if defined(SIE_DEBUG)
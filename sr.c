@@ -81,7 +81,7 @@ BYTE     psw[16];
             {
                 sysblk.regs[i]->cpustate = CPUSTATE_STOPPING;
                 ON_IC_INTERRUPT(sysblk.regs[i]);
-                signal_condition(&sysblk.regs[i]->intcond);
+                WAKEUP_CPU(sysblk.regs[i]);
             }
         }
         RELEASE_INTLOCK(NULL);
@@ -94,14 +94,17 @@ BYTE     psw[16];
 #ifdef OPTION_FISHIO
     SLEEP (2);
 #else
-    obtain_lock (&sysblk.ioqlock);
-    while (sysblk.ioq)
+    for (i = 0; i < MAX_DEVICE_THREAD_QUEUES; i++)
     {
-        release_lock (&sysblk.ioqlock);
-        usleep (1000);
-        obtain_lock (&sysblk.ioqlock);
+        obtain_lock (&sysblk.devtq[i].lock);
+        while (sysblk.devtq[i].ioq)
+        {
+            release_lock (&sysblk.devtq[i].lock);
+            usleep (1000);
+            obtain_lock (&sysblk.devtq[i].lock);
+        }
+        release_lock (&sysblk.devtq[i].lock);
     }
-    release_lock (&sysblk.ioqlock);
 #endif
 
     /* Wait for active I/Os to complete */
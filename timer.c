@@ -14,6 +14,43 @@
 
 // ZZ int ecpsvm_testvtimer(REGS *,int);
 
+/* Hardware clock value when the next timer event found by the last
+   update_cpu_timer call is due; protected by the intlock            */
+static U64 timer_due;
+
+/* Microseconds for the timer thread to sleep while any CPU is
+   running, or zero if it may go idle; set by update_cpu_timer with
+   the intlock held, so that the timer thread need not take it again */
+static U64 timer_sleep;
+
+#if defined(OPTION_TIMER_LATENCY)
+/*-------------------------------------------------------------------*/
+/* Count the time from a timer event falling due until it was made   */
+/* pending, in the timer interrupt latency histogram                 */
+/*-------------------------------------------------------------------*/
+static inline void timer_latency(U64 late)
+{
+int     i;                              /* Histogram bucket          */
+U64     usecs = late / TOD_USEC;        /* Latency in microseconds   */
+
+    for (i = 0; usecs && i < TIMER_LAT_BUCKETS - 1; i++)
+        usecs >>= 1;
+    sysblk.timerlat[i]++;
+}
+#define TIMER_LATENCY(_late) timer_latency(_late)
+#else /*!defined(OPTION_TIMER_LATENCY)*/
+#define TIMER_LATENCY(_late)
+#endif /*!defined(OPTION_TIMER_LATENCY)*/
+
+/* Keep the hardware clock units until the earliest timer event;    */
+/* zero means that no event is due                                   */
+#define TIMER_DUE(_wait) \
+    do { \
+        U64 due = (_wait); \
+        if (due && due < wait) \
+            wait = due; \
+    } while (0)
+
 /*-------------------------------------------------------------------*/
 /* Check for timer event                                             */
 /*                                                                   */
@@ -23,6 +60,9 @@
 /* [3] Interval timer                                                */
 /* CPUs with an outstanding interrupt are signalled                  */
 /*                                                                   */
+/* The time at which the earliest timer event which is not yet       */
+/* pending falls due is saved for the timer thread                   */
+/*                                                                   */
 /* tod_delta is in hercules internal clock format (>> 8)             */
 /*-------------------------------------------------------------------*/
 void update_cpu_timer(void)
@@ -30,6 +70,7 @@ void update_cpu_timer(void)
 int             cpu;                    /* CPU counter               */
 REGS           *regs;                   /* -> CPU register context   */
 CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
+U64             wait = TOD_SEC;         /* Time to next timer event  */
 
     /* Access the diffent register contexts with the intlock held */
     OBTAIN_INTLOCK(NULL);
@@ -56,10 +97,15 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
             {
                 ON_IC_CLKC(regs);
                 intmask |= regs->cpubit;
+                TIMER_LATENCY(TOD_CLOCK(regs) - regs->clkc);
             }
         }
-        else if (IS_IC_CLKC(regs))
-            OFF_IC_CLKC(regs);
+        else
+        {
+            if (IS_IC_CLKC(regs))
+                OFF_IC_CLKC(regs);
+            TIMER_DUE(regs->clkc - TOD_CLOCK(regs) + 1);
+        }
 
 #if defined(_FEATURE_SIE)
         /* If running under SIE also check the SIE copy */
@@ -72,7 +118,11 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
                 intmask |= regs->cpubit;
             }
             else
+            {
                 OFF_IC_CLKC(regs->guestregs);
+                TIMER_DUE(regs->guestregs->clkc
+                          - TOD_CLOCK(regs->guestregs) + 1);
+            }
         }
 #endif /*defined(_FEATURE_SIE)*/
 
@@ -87,10 +137,15 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
             {
                 ON_IC_PTIMER(regs);
                 intmask |= regs->cpubit;
+                TIMER_LATENCY(-CPU_TIMER(regs));
             }
         }
-        else if(IS_IC_PTIMER(regs))
-            OFF_IC_PTIMER(regs);
+        else
+        {
+            if(IS_IC_PTIMER(regs))
+                OFF_IC_PTIMER(regs);
+            TIMER_DUE((U64)CPU_TIMER(regs) + 1);
+        }
 
 #if defined(_FEATURE_SIE)
         /* When running under SIE also update the SIE copy */
@@ -103,7 +158,10 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
                 intmask |= regs->cpubit;
             }
             else
+            {
                 OFF_IC_PTIMER(regs->guestregs);
+                TIMER_DUE((U64)CPU_TIMER(regs->guestregs) + 1);
+            }
         }
 #endif /*defined(_FEATURE_SIE)*/
 
@@ -116,6 +174,7 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
         {
             if( chk_int_timer(regs) )
                 intmask |= regs->cpubit;
+            TIMER_DUE(int_timer_due(regs));
         }
 
 
@@ -128,6 +187,7 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
             {
                 if( chk_int_timer(regs->guestregs) )
                     intmask |= regs->cpubit;
+                TIMER_DUE(int_timer_due(regs->guestregs));
             }
         }
 #endif /*defined(_FEATURE_SIE)*/
@@ -136,6 +196,21 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
 
     } /* end for(cpu) */
 
+    /* A running CPU may set an earlier timer event at any time */
+    timer_due = hw_tod + wait;
+    sysblk.timerstale = (sysblk.started_mask & ~sysblk.waiting_mask) != 0;
+
+    /* While any CPU is running the timer thread sleeps for another
+       timer update interval, or until the next timer event is due */
+    if (sysblk.timerstale)
+    {
+        timer_sleep = (wait + TOD_USEC - 1) / TOD_USEC;
+        if (timer_sleep > (U64)sysblk.timerint)
+            timer_sleep = sysblk.timerint;
+    }
+    else
+        timer_sleep = 0;
+
     /* If a timer interrupt condition was detected for any CPU
        then wake up those CPUs if they are waiting */
     WAKEUP_CPUS_MASK (intmask);
@@ -144,17 +219,55 @@ CPU_BITMAP      intmask = 0;            /* Interrupt CPU mask        */
 
 } /* end function check_timer_event */
 
+/*-------------------------------------------------------------------*/
+/* Wait until the given number of microseconds have passed or until  */
+/* a CPU wakes the timer thread.  The intlock must be held.          */
+/*-------------------------------------------------------------------*/
+static void timer_wait(U64 usecs)
+{
+struct timespec waittime;               /* Time to stop waiting      */
+#if defined(OPTION_MONOTONIC_TOD)
+
+    /* The timer condition waits against the monotonic clock */
+    clock_gettime (CLOCK_MONOTONIC, &waittime);
+#else /*!defined(OPTION_MONOTONIC_TOD)*/
+struct timeval  now;                    /* Current time of day       */
+
+    gettimeofday (&now, NULL);
+    waittime.tv_sec = now.tv_sec;
+    waittime.tv_nsec = now.tv_usec * 1000;
+#endif /*!defined(OPTION_MONOTONIC_TOD)*/
+
+    waittime.tv_sec += usecs / 1000000;
+    waittime.tv_nsec += (usecs % 1000000) * 1000;
+    if (waittime.tv_nsec >= 1000000000)
+    {
+        waittime.tv_sec++;
+        waittime.tv_nsec -= 1000000000;
+    }
+
+    sysblk.intowner = LOCK_OWNER_NONE;
+    timed_wait_condition (&sysblk.timercond, &sysblk.intlock, &waittime);
+    sysblk.intowner = LOCK_OWNER_OTHER;
+
+} /* end function timer_wait */
+
 /*-------------------------------------------------------------------*/
 /* TOD clock and timer thread                                        */
 /*                                                                   */
-/* This function runs as a separate thread.  It wakes up every       */
-/* 1 microsecond, updates the TOD clock, and decrements the          */
-/* CPU timer for each CPU.  If any CPU timer goes negative, or       */
-/* if the TOD clock exceeds the clock comparator for any CPU,        */
-/* it signals any waiting CPUs to wake up and process interrupts.    */
+/* This function runs as a separate thread.  It updates the TOD      */
+/* clock, and decrements the CPU timer for each CPU.  If any CPU     */
+/* timer goes negative, or if the TOD clock exceeds the clock        */
+/* comparator for any CPU, it signals any waiting CPUs to wake up    */
+/* and process interrupts.  It then sleeps until the next timer      */
+/* event is due, but for no longer than the timer update interval    */
+/* while any CPU is running.  While all CPUs are waiting or stopped  */
+/* it sleeps until the next event or MIPS rate update, or until a    */
+/* CPU resumes and wakes it.                                         */
 /*-------------------------------------------------------------------*/
 void *timer_update_thread (void *argp)
 {
+U64     interval;                       /* Time to sleep (us)        */
 #ifdef OPTION_MIPS_COUNTING
 int     i;                              /* Loop index                */
 REGS   *regs;                           /* -> REGS                   */
@@ -170,6 +283,11 @@ U64     total_sios;                     /* Total SIO rate            */
 
     UNREFERENCED(argp);
 
+#if defined(OPTION_CPU_AFFINITY)
+    /* Keep off the host CPUs of the CPU thread which started us */
+    bind_thread_affinity(-1);
+#endif /*defined(OPTION_CPU_AFFINITY)*/
+
     /* Set root mode in order to set priority */
     SETMODE(ROOT);
 
@@ -181,6 +299,12 @@ U64     total_sios;                     /* Total SIO rate            */
     /* Back to user mode */
     SETMODE(USER);
 
+#if defined(PR_SET_TIMERSLACK)
+    /* Wake at the timer event rather than up to the default 50us
+       of host timer slack later */
+    prctl(PR_SET_TIMERSLACK, 1);
+#endif /*defined(PR_SET_TIMERSLACK)*/
+
     /* Display thread started message on control panel */
     logmsg (_("HHCTT002I Timer thread started: tid="TIDPAT", pid=%d, "
             "priority=%d\n"),
@@ -270,8 +394,56 @@ U64     total_sios;                     /* Total SIO rate            */
         } /* end if(diff >= 1000000) */
 #endif /*OPTION_MIPS_COUNTING*/
 
-        /* Sleep for another timer update interval... */
-        usleep ( sysblk.timerint );
+        /* Sleep for another timer update interval while any CPU is
+           running, as it may set new timer events without waking us;
+           update_cpu_timer has already decided for how long */
+        if ((interval = timer_sleep) != 0)
+        {
+            usleep (interval);
+#if defined(OPTION_TIMER_LATENCY)
+            sysblk.timerwake++;
+#endif /*defined(OPTION_TIMER_LATENCY)*/
+            continue;
+        }
+
+        OBTAIN_INTLOCK(NULL);
+
+        /* A CPU may have started running since */
+        interval = sysblk.timerint;
+
+        /* With no CPU running sleep until the next MIPS rate update,
+           but first find the timer events which the CPUs set before
+           they stopped running */
+        if (!(sysblk.started_mask & ~sysblk.waiting_mask))
+        {
+            if (sysblk.timerstale)
+            {
+                RELEASE_INTLOCK(NULL);
+                continue;
+            }
+#ifdef OPTION_MIPS_COUNTING
+            interval = then + 1000000 - now;
+#else
+            interval = 1000000;
+#endif
+            sysblk.timeridle = 1;
+        }
+
+        /* ...or until the next timer event is due */
+        if ((S64)(timer_due - hw_tod) <= 0)
+            interval = 0;
+        else if ((timer_due - hw_tod + TOD_USEC - 1) / TOD_USEC < interval)
+            interval = (timer_due - hw_tod + TOD_USEC - 1) / TOD_USEC;
+
+        if (interval)
+            timer_wait (interval);
+
+        sysblk.timeridle = 0;
+#if defined(OPTION_TIMER_LATENCY)
+        sysblk.timerwake++;
+#endif /*defined(OPTION_TIMER_LATENCY)*/
+
+        RELEASE_INTLOCK(NULL);
 
     } /* end while */
 
@@ -101,6 +101,14 @@ static const char *build_info[] = {
     "No CCKD BZIP2 support",
 #endif
 
+#if !defined(CCKD_ZSTD)
+    "No CCKD ZSTD support",
+#endif
+
+#if !defined(CCKD_LZ4)
+    "No CCKD LZ4 support",
+#endif
+
 #if !defined(HAVE_LIBZ)
     "No ZLIB support",
 #endif
@@ -378,8 +378,8 @@ void d250_bio_interrupt(DEVBLK *dev, U64 intparm, BYTE status, BYTE subcode)
    
    /* Make the "service signal" interrupt pending                     */
    ON_IC_SERVSIG;
-   /* Wake up any waiters */
-   WAKEUP_CPUS_MASK (sysblk.waiting_mask);
+   /* Wake up a waiter */
+   WAKEUP_ENABLED_CPU (BIT(IC_SERVSIG));
    
    if (dev->ccwtrace)
    {
@@ -22,6 +22,8 @@
 /* instfetch    Fetch instruction from virtual storage               */
 /* move_chars   Move characters using specified keys and addrspaces  */
 /* move_charx   Move characters with optional specifications         */
+/* move_long_unit     Move one page unit of a long operand           */
+/* compare_long_unit  Compare one page unit of long operands         */
 /* validate_operand   Validate addressing, protection, translation   */
 /*-------------------------------------------------------------------*/
 /* And provided by means of macro's address wrapping versions of     */
@@ -740,6 +742,7 @@ int     len;                            /* Length for page crossing  */
 /*-------------------------------------------------------------------*/
 #ifndef _VSTORE_CONCPY
 #define _VSTORE_CONCPY
+#include "hsimd.h"
 static __inline__ void concpy (REGS *regs, void *d, void *s, int n)
 {
  int   n2;
@@ -781,6 +784,16 @@ static __inline__ void concpy (REGS *regs, void *d, void *s, int n)
     */
     UNREFERENCED(regs);
 
+#if defined(OPTION_HOST_SIMD)
+    /* copy long operands that do not overlap 32 bytes at a time */
+    if (n >= HSIMD_COPY_MINLEN && hostinfo.avx2_avail
+     && (dest + n <= src || src + n <= dest))
+    {
+        hsimd_copy_avx2 (dest, src, n);
+        return;
+    }
+#endif /*defined(OPTION_HOST_SIMD)*/
+
     /* copy 8 bytes at a time */
     for ( ; n >= 8; n -= 8, dest += 8, src += 8)
         *(U64 *)dest = *(U64 *)src;
@@ -1051,6 +1064,134 @@ int     len1, len2, len3;               /* Work areas for lengths    */
 #endif /*defined(FEATURE_MOVE_WITH_OPTIONAL_SPECIFICATIONS)*/
 
 
+/*-------------------------------------------------------------------*/
+/* Move one unit of a long operand (MVCL, MVCLE)                     */
+/*                                                                   */
+/* Input:                                                            */
+/*      addr1   Effective address of first operand                   */
+/*      arn1    Access register number of first operand              */
+/*      len1    Remaining length of first operand (non-zero)         */
+/*      addr2   Effective address of second operand                  */
+/*      arn2    Access register number of second operand             */
+/*      len2    Remaining length of second operand                   */
+/*      pad     Padding byte                                         */
+/*      regs    Pointer to the CPU register context                  */
+/* Returns:                                                          */
+/*      Number of bytes moved or padded                              */
+/*                                                                   */
+/*      The unit ends at the nearer page boundary of the operands,   */
+/*      so each page of either operand is translated only once.      */
+/*      Once the second operand is exhausted the first operand is    */
+/*      padded up to its next page boundary.  The caller updates     */
+/*      the registers after each unit, so that an access exception   */
+/*      leaves them addressing the unit that was not processed.      */
+/*-------------------------------------------------------------------*/
+_VSTORE_C_STATIC int ARCH_DEP(move_long_unit) (VADR addr1, int arn1,
+       GREG len1, VADR addr2, int arn2, GREG len2, BYTE pad,
+       REGS *regs)
+{
+BYTE   *dest, *source;                  /* Mainstor addresses        */
+int     len, len3;                      /* Unit lengths              */
+
+    len = PAGEFRAME_PAGESIZE - (int)(addr1 & PAGEFRAME_BYTEMASK);
+    if ((GREG)len > len1)
+        len = (int)len1;
+
+    if (len2 == 0)
+    {
+        dest = MADDRL (addr1, len1, arn1, regs, ACCTYPE_WRITE,
+                       regs->psw.pkey);
+        memset (dest, pad, len);
+        return len;
+    }
+
+    len3 = PAGEFRAME_PAGESIZE - (int)(addr2 & PAGEFRAME_BYTEMASK);
+    if (len3 < len)
+        len = len3;
+    if ((GREG)len > len2)
+        len = (int)len2;
+
+    source = MADDR (addr2, arn2, regs, ACCTYPE_READ, regs->psw.pkey);
+    dest = MADDRL (addr1, len1, arn1, regs, ACCTYPE_WRITE, regs->psw.pkey);
+
+    /* Use concpy to ensure Concurrent block update consistency */
+    concpy (regs, dest, source, len);
+
+    return len;
+
+} /* end function ARCH_DEP(move_long_unit) */
+
+
+/*-------------------------------------------------------------------*/
+/* Compare one unit of long operands (CLCL, CLCLE)                   */
+/*                                                                   */
+/* Input:                                                            */
+/*      addr1   Effective address of first operand                   */
+/*      arn1    Access register number of first operand              */
+/*      len1    Remaining length of first operand                    */
+/*      addr2   Effective address of second operand                  */
+/*      arn2    Access register number of second operand             */
+/*      len2    Remaining length of second operand                   */
+/*      pad     Padding byte                                         */
+/*      cc      Set to 1 or 2 if an unequal byte is found            */
+/*      regs    Pointer to the CPU register context                  */
+/* Returns:                                                          */
+/*      Number of equal bytes                                        */
+/*                                                                   */
+/*      At least one of the lengths must be non-zero.  The unit      */
+/*      ends at the nearer page boundary of the operands that are    */
+/*      not exhausted, and an exhausted operand compares as padding  */
+/*      bytes.  If all bytes of the unit are equal the length of     */
+/*      the unit is returned and cc is unchanged.                    */
+/*-------------------------------------------------------------------*/
+_VSTORE_C_STATIC int ARCH_DEP(compare_long_unit) (VADR addr1, int arn1,
+       GREG len1, VADR addr2, int arn2, GREG len2, BYTE pad,
+       int *cc, REGS *regs)
+{
+BYTE   *main1 = NULL, *main2 = NULL;    /* Mainstor addresses        */
+BYTE    byte1, byte2;                   /* Unequal operand bytes     */
+int     len = PAGEFRAME_PAGESIZE;       /* Unit length               */
+int     len3;                           /* Work length               */
+int     i;                              /* Number of equal bytes     */
+
+    if (len1)
+    {
+        len3 = PAGEFRAME_PAGESIZE - (int)(addr1 & PAGEFRAME_BYTEMASK);
+        if ((GREG)len3 > len1)
+            len3 = (int)len1;
+        len = len3;
+        main1 = MADDR (addr1, arn1, regs, ACCTYPE_READ, regs->psw.pkey);
+    }
+
+    if (len2)
+    {
+        len3 = PAGEFRAME_PAGESIZE - (int)(addr2 & PAGEFRAME_BYTEMASK);
+        if ((GREG)len3 > len2)
+            len3 = (int)len2;
+        if (len3 < len)
+            len = len3;
+        main2 = MADDR (addr2, arn2, regs, ACCTYPE_READ, regs->psw.pkey);
+    }
+
+    if (main1 && main2)
+        i = hsimd_cmp (main1, main2, len);
+    else if (main1)
+        i = hsimd_cmp_pad (main1, pad, len);
+    else
+        i = hsimd_cmp_pad (main2, pad, len);
+
+    if (i < len)
+    {
+        byte1 = main1 ? main1[i] : pad;
+        byte2 = main2 ? main2[i] : pad;
+        *cc = (byte1 < byte2) ? 1 : 2;
+    }
+
+    return i;
+
+} /* end function ARCH_DEP(compare_long_unit) */
+
+
 /*-------------------------------------------------------------------*/
 /* Validate operand for addressing, protection, translation          */
 /*                                                                   */